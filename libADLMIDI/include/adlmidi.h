@@ -223,6 +223,47 @@ extern ADLMIDI_DECLSPEC int adl_getNumChips(struct ADL_MIDIPlayer *device);
  */
 extern ADLMIDI_DECLSPEC int adl_getNumChipsObtained(struct ADL_MIDIPlayer *device);
 
+/**
+ * @brief Sets number of threads used to render multiple emulated chips concurrently
+ *
+ * When more than one chip is emulated, every chip will render its part of the output
+ * on the small pool of worker threads, and results will be mixed together. The calling
+ * thread takes a part in rendering, so, value 1 (default) disables threaded rendering.
+ * The output is identical to the single-threaded rendering.
+ *
+ * @param device Instance of the library
+ * @param threads Total count of rendering threads including the caller's thread (1 - disabled, 0 - use count of CPU cores, up to the maximum count of chips)
+ * @return 0 on success, <0 when any error has occurred or threaded rendering is not supported
+ */
+extern ADLMIDI_DECLSPEC int adl_setThreadCount(struct ADL_MIDIPlayer *device, int threads);
+
+/**
+ * @brief Get current number of threads used to render emulated chips
+ * @param device Instance of the library
+ * @return Count of rendering threads including the caller's thread
+ */
+extern ADLMIDI_DECLSPEC int adl_getThreadCount(struct ADL_MIDIPlayer *device);
+
+/**
+ * @brief Start recording of the chips register-write trace into the file
+ *
+ * Every register write of every emulated chip gets recorded together with the count of
+ * output frames rendered between writes. The trace can be replayed later directly
+ * into any chip emulator, without the MIDI sequencer. Chips will be reset to make
+ * the trace self-contained, so, start the recording before the playback.
+ *
+ * @param device Instance of the library
+ * @param tracePath Path to the trace file to create
+ * @return 0 on success, <0 when any error has occurred
+ */
+extern ADLMIDI_DECLSPEC int adl_startChipTrace(struct ADL_MIDIPlayer *device, const char *tracePath);
+
+/**
+ * @brief Stop recording of the chips register-write trace and close the trace file
+ * @param device Instance of the library
+ */
+extern ADLMIDI_DECLSPEC void adl_stopChipTrace(struct ADL_MIDIPlayer *device);
+
 /**
  * @brief Sets a number of the patches bank from 0 to N banks.
  *
@@ -705,6 +746,8 @@ enum ADL_Emulator
     ADLMIDI_EMU_OPAL,
     /*! Java */
     ADLMIDI_EMU_JAVA,
+    /*! Nuked OPL3 v. 1.8, operators processed in SIMD batches */
+    ADLMIDI_EMU_NUKED_SIMD,
     /*! Count instrument on the level */
     ADLMIDI_EMU_end
 };
@@ -1096,6 +1139,51 @@ extern ADLMIDI_DECLSPEC int  adl_play(struct ADL_MIDIPlayer *device, int sampleC
  */
 extern ADLMIDI_DECLSPEC int  adl_playFormat(struct ADL_MIDIPlayer *device, int sampleCount, ADL_UInt8 *left, ADL_UInt8 *right, const struct ADLMIDI_AudioFormat *format);
 
+/**
+ * @brief Flags of the offline song rendering
+ */
+enum ADL_RenderFlags
+{
+    /*! Don't run chip emulators while all chip channels are keyed off and their
+        release is over, write silence instead. Output is not bit-identical to
+        the adl_playFormat() and very long release tails may be cut */
+    ADLMIDI_Render_SkipSilence = 0x01
+};
+
+/**
+ * @brief Render the song from the current position until its end in sample format declared by given context
+ *
+ * Offline alternative to the adl_playFormat() loop: the whole song is rendered by one call,
+ * the loop is ignored. Use adl_totalTimeLength() to estimate the size of the buffer. If the
+ * buffer gets filled before the song end, the next call continues from the same place.
+ *
+ * Don't use count of frames, use instead count of samples. One frame is two samples.
+ *
+ * Available when library is built with built-in MIDI Sequencer support.
+ *
+ * @param device Instance of the library
+ * @param sampleCount Capacity of the output buffer in samples (not frames!)
+ * @param left Left channel buffer output (Must be casted into bytes array)
+ * @param right Right channel buffer output (Must be casted into bytes array)
+ * @param format Destination PCM format format context
+ * @param flags Combination of ADL_RenderFlags values
+ * @return Count of given samples, otherwise, -1 when catching an error
+ */
+extern ADLMIDI_DECLSPEC long adl_renderToBuffer(struct ADL_MIDIPlayer *device, long sampleCount, ADL_UInt8 *left, ADL_UInt8 *right, const struct ADLMIDI_AudioFormat *format, int flags);
+
+/**
+ * @brief Render the song from the current position until its end into the WAV file
+ *
+ * Available when library is built with built-in MIDI Sequencer support.
+ *
+ * @param device Instance of the library
+ * @param wavePath Path to the output WAV file (in UTF-8 encoding)
+ * @param sampleType Sample format of the file, ADLMIDI_SampleType_S16 or ADLMIDI_SampleType_F32
+ * @param flags Combination of ADL_RenderFlags values
+ * @return 0 on success, <0 when any error has occurred
+ */
+extern ADLMIDI_DECLSPEC int adl_renderFile(struct ADL_MIDIPlayer *device, const char *wavePath, int sampleType, int flags);
+
 /**
  * @brief Generate PCM signed 16-bit stereo audio output without iteration of MIDI timers
  *
@@ -61,6 +61,15 @@ __inline int c99_snprintf(char *outBuf, size_t size, const char *format, ...)
 }
 #endif
 
+#if defined(ADLMIDI_ENABLE_THREADED_RENDER) && !defined(_WIN32)
+#include <unistd.h> // sysconf
+#endif
+
+#if defined(ADLMIDI_ENABLE_THREADED_RENDER) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#include <emmintrin.h>
+#define ADLMIDI_SSE2_MIX
+#endif
+
 /* Unify MIDI player casting and interface between ADLMIDI and OPNMIDI */
 #define GET_MIDI_PLAYER(device) reinterpret_cast<MIDIplay *>((device)->adl_midiPlayer)
 typedef MIDIplay MidiPlayer;
@@ -183,6 +192,104 @@ ADLMIDI_EXPORT int adl_getNumChipsObtained(struct ADL_MIDIPlayer *device)
     return (int)play->m_synth->m_numChips;
 }
 
+#if defined(ADLMIDI_ENABLE_THREADED_RENDER)
+static int adlCpuCoresCount()
+{
+#   if defined(_WIN32)
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return (int)info.dwNumberOfProcessors;
+#   elif defined(_SC_NPROCESSORS_ONLN)
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    return cores > 0 ? (int)cores : 1;
+#   else
+    return 1;
+#   endif
+}
+#endif
+
+ADLMIDI_EXPORT int adl_setThreadCount(struct ADL_MIDIPlayer *device, int threads)
+{
+    if(device == NULL)
+        return -2;
+    MidiPlayer *play = GET_MIDI_PLAYER(device);
+    assert(play);
+#if defined(ADLMIDI_ENABLE_THREADED_RENDER)
+    if(threads == 0)
+    {
+        /* More threads than chips would have nothing to do */
+        threads = adlCpuCoresCount();
+        if(threads > ADL_MAX_CHIPS)
+            threads = ADL_MAX_CHIPS;
+    }
+    if(threads < 1 || threads > ADL_MAX_CHIPS)
+    {
+        play->setErrorString("number of threads may only be 0.." ADL_MAX_CHIPS_STR ".\n");
+        return -1;
+    }
+    if(!play->m_renderPool.setWorkersCount(static_cast<unsigned>(threads - 1)))
+    {
+        play->m_renderPool.setWorkersCount(0);
+        play->setErrorString("Failed to start rendering threads.");
+        return -1;
+    }
+    return 0;
+#else
+    if(threads == 1)
+        return 0;
+    play->setErrorString("Threaded rendering is not supported by this build.");
+    return -1;
+#endif
+}
+
+ADLMIDI_EXPORT int adl_getThreadCount(struct ADL_MIDIPlayer *device)
+{
+    if(device == NULL)
+        return -2;
+#if defined(ADLMIDI_ENABLE_THREADED_RENDER)
+    MidiPlayer *play = GET_MIDI_PLAYER(device);
+    assert(play);
+    return (int)play->m_renderPool.workersCount() + 1;
+#else
+    return 1;
+#endif
+}
+
+ADLMIDI_EXPORT int adl_startChipTrace(struct ADL_MIDIPlayer *device, const char *tracePath)
+{
+    if(device == NULL)
+        return -2;
+    MidiPlayer *play = GET_MIDI_PLAYER(device);
+    assert(play);
+#ifndef ADLMIDI_HW_OPL
+    Synth &synth = *play->m_synth;
+    AdlMIDI_UPtr<ChipTraceWriter> trace(new ChipTraceWriter);
+    if(!tracePath || !trace->open(tracePath))
+    {
+        play->setErrorString("Can't create the chip trace file.");
+        return -1;
+    }
+    synth.m_trace.swap(trace);
+    play->partialReset();
+    return 0;
+#else
+    ADL_UNUSED(tracePath);
+    play->setErrorString("Chip trace is not supported by the hardware OPL3 build.");
+    return -1;
+#endif
+}
+
+ADLMIDI_EXPORT void adl_stopChipTrace(struct ADL_MIDIPlayer *device)
+{
+    if(device == NULL)
+        return;
+#ifndef ADLMIDI_HW_OPL
+    MidiPlayer *play = GET_MIDI_PLAYER(device);
+    assert(play);
+    play->m_synth->m_trace.reset();
+#endif
+}
+
 ADLMIDI_EXPORT int adl_setBank(ADL_MIDIPlayer *device, int bank)
 {
 #ifdef DISABLE_EMBEDDED_BANKS
@@ -273,9 +380,9 @@ ADLMIDI_EXPORT int adl_getBank(ADL_MIDIPlayer *device, const ADL_BankId *idp, in
     {
         std::pair<size_t, Synth::Bank> value;
         value.first = idnumber;
-        memset(&value.second, 0, sizeof(value.second));
+        OplInstMeta *ins = value.second.edit();
         for (unsigned i = 0; i < 128; ++i)
-            value.second.ins[i].flags = OplInstMeta::Flag_NoSound;
+            ins[i].flags = OplInstMeta::Flag_NoSound;
 
         std::pair<Synth::BankMap::iterator, bool> ir;
         if((flags & ADLMIDI_Bank_CreateRt) == ADLMIDI_Bank_CreateRt)
@@ -374,7 +481,7 @@ ADLMIDI_EXPORT int adl_setInstrument(ADL_MIDIPlayer *device, ADL_Bank *bank, uns
         return -1;
 
     Synth::BankMap::iterator it = Synth::BankMap::iterator::from_ptrs(bank->pointer);
-    cvt_ADLI_to_FMIns(it->second.ins[index], *ins);
+    cvt_ADLI_to_FMIns(it->second.edit()[index], *ins);
     return 0;
 }
 
@@ -409,16 +516,17 @@ ADLMIDI_EXPORT int adl_loadEmbeddedBank(struct ADL_MIDIPlayer *device, ADL_Bank
     size_t bankIndex = g_embeddedBanksMidiIndex[banksOffset + bankID];
     const BanksDump::MidiBank &bankData = g_embeddedBanksMidi[bankIndex];
 
+    OplInstMeta *bankIns = it->second.edit();
     for (unsigned i = 0; i < 128; ++i)
     {
         midi_bank_idx_t instIdx = bankData.insts[i];
         if(instIdx < 0)
         {
-            it->second.ins[i].flags = OplInstMeta::Flag_NoSound;
+            bankIns[i].flags = OplInstMeta::Flag_NoSound;
             continue;
         }
         BanksDump::InstrumentEntry instIn = g_embeddedBanksInstruments[instIdx];
-        adlFromInstrument(instIn, it->second.ins[i]);
+        adlFromInstrument(instIn, bankIns[i]);
     }
     return 0;
 #endif
@@ -1400,6 +1508,89 @@ static int SendStereoAudio(int        samples_requested,
 
 #endif // ADLMIDI_HW_OPL
 
+#ifndef ADLMIDI_HW_OPL
+
+#   if defined(ADLMIDI_ENABLE_THREADED_RENDER)
+struct ChipsRenderJob
+{
+    Synth   *synth;
+    int32_t *firstBuf;
+    int32_t *otherBufs;
+    size_t   frames;
+};
+
+static void RenderChipJob(void *userData, size_t chip)
+{
+    ChipsRenderJob *job = static_cast<ChipsRenderJob *>(userData);
+    int32_t *buf = (chip == 0) ? job->firstBuf : (job->otherBufs + (chip - 1) * 1024);
+    job->synth->m_chips[chip]->generate32(buf, job->frames);
+}
+
+static void MixChipBuffer(int32_t *dst, const int32_t *src, size_t count)
+{
+    size_t i = 0;
+#       if defined(ADLMIDI_SSE2_MIX)
+    for(; i + 4 <= count; i += 4)
+    {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(dst + i));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), _mm_add_epi32(a, b));
+    }
+#       endif
+    for(; i < count; ++i)
+        dst[i] += src[i];
+}
+#   endif
+
+/**
+ * @brief Generate the mixed output of all emulated chips
+ * @param player MIDI player instance
+ * @param out_buf Output buffer, 1024 samples long
+ * @param frames Count of stereo frames to generate, up to 512
+ */
+static void GenerateChips(MidiPlayer *player, int32_t *out_buf, size_t frames)
+{
+    Synth &synth = *player->m_synth;
+    unsigned int chips = synth.m_numChips;
+
+    if(synth.m_trace.get())
+        synth.m_trace->wait(frames);
+
+    if(chips == 1)
+    {
+        synth.m_chips[0]->generate32(out_buf, frames);
+        return;
+    }
+
+#   if defined(ADLMIDI_ENABLE_THREADED_RENDER)
+    if(player->m_renderPool.workersCount() > 0)
+    {
+        /* Every chip renders into own buffer, then all of them get summed */
+        std::vector<int32_t> &bufs = player->m_chipOutBufs;
+        if(bufs.size() < (chips - 1) * 1024)
+            bufs.resize((chips - 1) * 1024);
+
+        ChipsRenderJob job;
+        job.synth = &synth;
+        job.firstBuf = out_buf;
+        job.otherBufs = &bufs[0];
+        job.frames = frames;
+        player->m_renderPool.run(&RenderChipJob, &job, chips);
+
+        for(size_t card = 1; card < chips; ++card)
+            MixChipBuffer(out_buf, &bufs[(card - 1) * 1024], frames * 2);
+        return;
+    }
+#   endif
+
+    /* Generate data from every chip and mix result */
+    std::memset(out_buf, 0, frames * 2 * sizeof(out_buf[0]));
+    for(size_t card = 0; card < chips; ++card)
+        synth.m_chips[card]->generateAndMix32(out_buf, frames);
+}
+
+#endif // ADLMIDI_HW_OPL
+
 
 ADLMIDI_EXPORT int adl_play(struct ADL_MIDIPlayer *device, int sampleCount, short *out)
 {
@@ -1469,20 +1660,8 @@ ADLMIDI_EXPORT int adl_playFormat(ADL_MIDIPlayer *device, int sampleCount,
             ssize_t in_generatedStereo = (n_periodCountStereo > 512) ? 512 : n_periodCountStereo;
             //! Total count of samples
             ssize_t in_generatedPhys = in_generatedStereo * 2;
-            //! Unsigned total sample count
-            //fill buffer with zeros
             int32_t *out_buf = player->m_outBuf;
-            std::memset(out_buf, 0, static_cast<size_t>(in_generatedPhys) * sizeof(out_buf[0]));
-            Synth &synth = *player->m_synth;
-            unsigned int chips = synth.m_numChips;
-            if(chips == 1)
-                synth.m_chips[0]->generate32(out_buf, (size_t)in_generatedStereo);
-            else/* if(n_periodCountStereo > 0)*/
-            {
-                /* Generate data from every chip and mix result */
-                for(size_t card = 0; card < chips; ++card)
-                    synth.m_chips[card]->generateAndMix32(out_buf, (size_t)in_generatedStereo);
-            }
+            GenerateChips(player, out_buf, (size_t)in_generatedStereo);
 
             /* Process it */
             if(SendStereoAudio(sampleCount, in_generatedStereo, out_buf, gotten_len, out_left, out_right, format) == -1)
@@ -1506,6 +1685,275 @@ ADLMIDI_EXPORT int adl_playFormat(ADL_MIDIPlayer *device, int sampleCount,
 }
 
 
+#if !defined(ADLMIDI_DISABLE_MIDI_SEQUENCER) && !defined(ADLMIDI_HW_OPL)
+/**
+ * @brief Receiver of the rendered output
+ * @param userData Receiver state
+ * @param buf Mixed output of all chips, interleaved stereo, up to 512 frames
+ * @param frames Count of frames in the buffer
+ * @return false to abort the rendering
+ */
+typedef bool (*RenderBlockFunc)(void *userData, int32_t *buf, size_t frames);
+
+/**
+ * @brief Render the song until its end or until the given count of frames
+ * @param player MIDI player instance
+ * @param maxFrames Maximum count of frames to render
+ * @param flags Combination of ADL_RenderFlags values
+ * @param func Receiver of the rendered output
+ * @param userData Receiver state
+ * @return Count of rendered frames or -1 when the receiver has failed
+ */
+static long RenderSong(MidiPlayer *player, size_t maxFrames, int flags,
+                       RenderBlockFunc func, void *userData)
+{
+    MidiPlayer::Setup &setup = player->m_setup;
+    MidiSequencer &seq = *player->m_sequencer;
+    int32_t *out_buf = player->m_outBuf;
+    const bool skipSilence = (flags & ADLMIDI_Render_SkipSilence) != 0;
+    size_t done = 0;
+    bool failed = false;
+
+    // The song is rendered only once
+    const bool loopEnabled = seq.getLoopEnabled();
+    seq.setLoopEnabled(false);
+
+    while(!failed && done < maxFrames)
+    {
+        // Remainder of the period which didn't fit the output of the previous call
+        const bool hasSkipped = setup.tick_skip_samples_delay > 0;
+        double eat_delay = 0.0;
+        size_t frames;
+
+        if(hasSkipped)
+            frames = static_cast<size_t>(setup.tick_skip_samples_delay / 2);
+        else
+        {
+            eat_delay = setup.delay < setup.maxdelay ? setup.delay : setup.maxdelay;
+            setup.delay -= eat_delay;
+            setup.carry += double(setup.PCM_RATE) * eat_delay;
+            frames = static_cast<size_t>(setup.carry);
+            setup.carry -= double(frames);
+        }
+
+        if(seq.positionAtEnd() && (setup.delay <= 0.0))
+            break; // The same as adl_playFormat() does
+
+        size_t toRender = std::min(frames, maxFrames - done);
+        setup.tick_skip_samples_delay = static_cast<ssize_t>(frames - toRender) * 2;
+
+        // All channels are silent until the next tick, chips can be left as is
+        const bool silent = skipSilence && player->isSilent();
+
+        while(toRender > 0)
+        {
+            size_t block = (toRender > 512) ? 512 : toRender;
+            if(silent)
+            {
+                std::memset(out_buf, 0, block * 2 * sizeof(int32_t));
+                // the chips are not run, but the trace still has to keep the time
+                if(player->m_synth->m_trace.get())
+                    player->m_synth->m_trace->wait(block);
+            }
+            else
+                GenerateChips(player, out_buf, block);
+            if(!func(userData, out_buf, block))
+            {
+                failed = true;
+                break;
+            }
+            toRender -= block;
+            done += block;
+        }
+
+        if(!hasSkipped)
+            setup.delay = player->Tick(eat_delay, setup.mindelay);
+    }
+
+    seq.setLoopEnabled(loopEnabled);
+
+    return failed ? -1 : static_cast<long>(done);
+}
+
+struct RenderBufferOut
+{
+    ADL_UInt8 *left;
+    ADL_UInt8 *right;
+    const ADLMIDI_AudioFormat *format;
+};
+
+static bool RenderBufferBlock(void *userData, int32_t *buf, size_t frames)
+{
+    RenderBufferOut *out = static_cast<RenderBufferOut *>(userData);
+    const int samples = static_cast<int>(frames * 2);
+    if(SendStereoAudio(samples, static_cast<ssize_t>(frames), buf, 0, out->left, out->right, out->format) == -1)
+        return false;
+    out->left  += frames * out->format->sampleOffset;
+    out->right += frames * out->format->sampleOffset;
+    return true;
+}
+
+struct RenderWaveOut
+{
+    FILE *file;
+    ADLMIDI_AudioFormat format;
+    bool swapBytes;
+    uint32_t dataSize;
+    std::vector<ADL_UInt8> buffer;
+};
+
+static void WriteLE(ADL_UInt8 *dst, uint32_t value, unsigned bytes)
+{
+    for(unsigned i = 0; i < bytes; ++i)
+        dst[i] = static_cast<ADL_UInt8>((value >> (i * 8)) & 0xFF);
+}
+
+static bool WriteWaveHeader(RenderWaveOut &out, uint32_t sampleRate)
+{
+    const uint32_t sampleSize = out.format.containerSize;
+    ADL_UInt8 h[44];
+    std::memcpy(h + 0, "RIFF", 4);
+    WriteLE(h + 4, 36 + out.dataSize, 4);
+    std::memcpy(h + 8, "WAVEfmt ", 8);
+    WriteLE(h + 16, 16, 4);
+    WriteLE(h + 20, (out.format.type == ADLMIDI_SampleType_F32) ? 3 : 1, 2); // IEEE float or PCM
+    WriteLE(h + 22, 2, 2);
+    WriteLE(h + 24, sampleRate, 4);
+    WriteLE(h + 28, sampleRate * sampleSize * 2, 4);
+    WriteLE(h + 32, sampleSize * 2, 2);
+    WriteLE(h + 34, sampleSize * 8, 2);
+    std::memcpy(h + 36, "data", 4);
+    WriteLE(h + 40, out.dataSize, 4);
+    return std::fseek(out.file, 0, SEEK_SET) == 0 &&
+           std::fwrite(h, 1, sizeof(h), out.file) == sizeof(h);
+}
+
+static bool RenderWaveBlock(void *userData, int32_t *buf, size_t frames)
+{
+    RenderWaveOut *out = static_cast<RenderWaveOut *>(userData);
+    const size_t bytes = frames * out->format.sampleOffset;
+    if(out->buffer.size() < bytes)
+        out->buffer.resize(bytes);
+
+    ADL_UInt8 *data = &out->buffer[0];
+    if(SendStereoAudio(static_cast<int>(frames * 2), static_cast<ssize_t>(frames), buf, 0,
+                       data, data + out->format.containerSize, &out->format) == -1)
+        return false;
+
+    // WAV samples are always little-endian
+    if(out->swapBytes)
+    {
+        const unsigned size = out->format.containerSize;
+        for(size_t i = 0; i < bytes; i += size)
+            std::reverse(data + i, data + i + size);
+    }
+
+    if(std::fwrite(data, 1, bytes, out->file) != bytes)
+        return false;
+    out->dataSize += static_cast<uint32_t>(bytes);
+    return true;
+}
+#endif // !ADLMIDI_DISABLE_MIDI_SEQUENCER && !ADLMIDI_HW_OPL
+
+ADLMIDI_EXPORT long adl_renderToBuffer(struct ADL_MIDIPlayer *device, long sampleCount,
+                                       ADL_UInt8 *out_left, ADL_UInt8 *out_right,
+                                       const ADLMIDI_AudioFormat *format, int flags)
+{
+#if defined(ADLMIDI_DISABLE_MIDI_SEQUENCER) || defined(ADLMIDI_HW_OPL)
+    ADL_UNUSED(device);
+    ADL_UNUSED(sampleCount);
+    ADL_UNUSED(out_left);
+    ADL_UNUSED(out_right);
+    ADL_UNUSED(format);
+    ADL_UNUSED(flags);
+    return -1;
+#else
+    if(!device || !format || sampleCount < 0)
+        return -1;
+
+    MidiPlayer *player = GET_MIDI_PLAYER(device);
+    assert(player);
+
+    RenderBufferOut out;
+    out.left = out_left;
+    out.right = out_right;
+    out.format = format;
+
+    long frames = RenderSong(player, static_cast<size_t>(sampleCount / 2), flags, &RenderBufferBlock, &out);
+    return (frames < 0) ? -1 : frames * 2;
+#endif
+}
+
+ADLMIDI_EXPORT int adl_renderFile(struct ADL_MIDIPlayer *device, const char *wavePath, int sampleType, int flags)
+{
+#if defined(ADLMIDI_DISABLE_MIDI_SEQUENCER) || defined(ADLMIDI_HW_OPL)
+    ADL_UNUSED(device);
+    ADL_UNUSED(wavePath);
+    ADL_UNUSED(sampleType);
+    ADL_UNUSED(flags);
+    return -1;
+#else
+    if(!device || !wavePath)
+        return -1;
+
+    MidiPlayer *player = GET_MIDI_PLAYER(device);
+    assert(player);
+
+    RenderWaveOut out;
+    out.dataSize = 0;
+    const uint16_t endianTest = 1;
+    out.swapBytes = *reinterpret_cast<const uint8_t *>(&endianTest) != 1;
+
+    switch(sampleType)
+    {
+    case ADLMIDI_SampleType_S16:
+        out.format.type = ADLMIDI_SampleType_S16;
+        out.format.containerSize = sizeof(int16_t);
+        out.format.sampleOffset = sizeof(int16_t) * 2;
+        break;
+    case ADLMIDI_SampleType_F32:
+        out.format.type = ADLMIDI_SampleType_F32;
+        out.format.containerSize = sizeof(float);
+        out.format.sampleOffset = sizeof(float) * 2;
+        break;
+    default:
+        player->setErrorString("Only S16 and F32 sample types are supported by WAV output");
+        return -1;
+    }
+
+#if !defined(_WIN32) || defined(__WATCOMC__)
+    out.file = std::fopen(wavePath, "wb");
+#else
+    wchar_t widePath[MAX_PATH];
+    int size = MultiByteToWideChar(CP_UTF8, 0, wavePath, static_cast<int>(std::strlen(wavePath)), widePath, MAX_PATH);
+    widePath[size] = '\0';
+    out.file = _wfopen(widePath, L"wb");
+#endif
+    if(!out.file)
+    {
+        player->setErrorString("Can't open the WAV file for writing");
+        return -1;
+    }
+
+    bool ok = WriteWaveHeader(out, static_cast<uint32_t>(player->m_setup.PCM_RATE));
+    if(ok)
+        ok = RenderSong(player, static_cast<size_t>(-1), flags, &RenderWaveBlock, &out) >= 0;
+    // Write the header again with the actual size of data
+    if(ok)
+        ok = WriteWaveHeader(out, static_cast<uint32_t>(player->m_setup.PCM_RATE));
+    if(std::fclose(out.file) != 0)
+        ok = false;
+
+    if(!ok)
+    {
+        player->setErrorString("Failed to write the WAV file");
+        return -1;
+    }
+    return 0;
+#endif
+}
+
+
 ADLMIDI_EXPORT int adl_generate(struct ADL_MIDIPlayer *device, int sampleCount, short *out)
 {
     return adl_generateFormat(device, sampleCount, (ADL_UInt8 *)out, (ADL_UInt8 *)(out + 1), &adl_DefaultAudioFormat);
@@ -1557,20 +2005,9 @@ ADLMIDI_EXPORT int adl_generateFormat(struct ADL_MIDIPlayer *device, int sampleC
             ssize_t in_generatedStereo = (n_periodCountStereo > 512) ? 512 : n_periodCountStereo;
             //! Total count of samples
             ssize_t in_generatedPhys = in_generatedStereo * 2;
-            //! Unsigned total sample count
-            //fill buffer with zeros
             int32_t *out_buf = player->m_outBuf;
-            std::memset(out_buf, 0, static_cast<size_t>(in_generatedPhys) * sizeof(out_buf[0]));
-            Synth &synth = *player->m_synth;
-            unsigned int chips = synth.m_numChips;
-            if(chips == 1)
-                synth.m_chips[0]->generate32(out_buf, (size_t)in_generatedStereo);
-            else if(n_periodCountStereo > 0)
-            {
-                /* Generate data from every chip and mix result */
-                for(unsigned card = 0; card < chips; ++card)
-                    synth.m_chips[card]->generateAndMix32(out_buf, (size_t)in_generatedStereo);
-            }
+            if(n_periodCountStereo > 0)
+                GenerateChips(player, out_buf, (size_t)in_generatedStereo);
             /* Process it */
             if(SendStereoAudio(sampleCount, in_generatedStereo, out_buf, gotten_len, out_left, out_right, format) == -1)
                 return 0;
@@ -0,0 +1,171 @@
+/*
+ * libADLMIDI is a free Software MIDI synthesizer library with OPL3 emulation
+ *
+ * Original ADLMIDI code: Copyright (c) 2010-2014 Joel Yliluoma <bisqwit@iki.fi>
+ * ADLMIDI Library API:   Copyright (c) 2015-2024 Vitaly Novichkov <admin@wohlnet.ru>
+ *
+ * Library is based on the ADLMIDI, a MIDI player for Linux and Windows with OPL3 emulation:
+ * http://iki.fi/bisqwit/source/adlmidi.html
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "adlmidi_bankcache.hpp"
+#include "chips/common/mutex.hpp"
+
+#include <cstring>
+#include <sys/types.h>
+#include <sys/stat.h>
+#if defined(_WIN32) && !defined(__WATCOMC__)
+#   include <windows.h> // MultiByteToWideChar
+#endif
+
+namespace BankCache
+{
+
+//! Guards the entries list and the reference counters
+static Mutex s_lock;
+//! All cached banks
+static std::vector<BankCacheEntry *> s_entries;
+
+uint64_t hashData(const void *data, size_t size)
+{
+    // 64-bit constants are composed to stay C++98-compatible
+    const uint64_t offsetBasis = (static_cast<uint64_t>(0xCBF29CE4) << 32) | 0x84222325;
+    const uint64_t prime = (static_cast<uint64_t>(1) << 40) | 0x1B3;
+    const uint8_t *p = static_cast<const uint8_t *>(data);
+    uint64_t h = offsetBasis;
+    for(size_t i = 0; i < size; ++i)
+    {
+        h ^= p[i];
+        h *= prime;
+    }
+    return h;
+}
+
+bool statFile(BankCacheEntry &entry, const std::string &path)
+{
+#if !defined(_WIN32) || defined(__WATCOMC__)
+    struct stat st;
+    if(stat(path.c_str(), &st) != 0)
+        return false;
+#else
+    wchar_t widePath[MAX_PATH];
+    int size = MultiByteToWideChar(CP_UTF8, 0, path.c_str(), static_cast<int>(std::strlen(path.c_str())), widePath, MAX_PATH);
+    widePath[size] = '\0';
+    struct _stat64 st;
+    if(_wstat64(widePath, &st) != 0)
+        return false;
+#endif
+    if((st.st_mode & S_IFMT) != S_IFREG)
+        return false;
+    entry.path = path;
+    entry.size = static_cast<uint64_t>(st.st_size);
+    // Seconds are too coarse: the file may be rewritten within the same second
+#if defined(__APPLE__)
+    entry.mtime = static_cast<int64_t>(st.st_mtimespec.tv_sec) * 1000000000 + st.st_mtimespec.tv_nsec;
+#elif defined(__linux__) || (defined(_POSIX_C_SOURCE) && _POSIX_C_SOURCE >= 200809L)
+    entry.mtime = static_cast<int64_t>(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+#else
+    entry.mtime = static_cast<int64_t>(st.st_mtime);
+#endif
+    return true;
+}
+
+static bool sameData(const BankCacheEntry *e, uint64_t hash, const void *data, size_t size)
+{
+    return e->hash == hash && e->data.size() == size &&
+           (size == 0 || std::memcmp(&e->data[0], data, size) == 0);
+}
+
+const BankCacheEntry *findFile(const std::string &path)
+{
+    BankCacheEntry file;
+    if(!statFile(file, path))
+        return NULL;
+
+    MutexHolder lock(s_lock);
+    for(size_t i = 0; i < s_entries.size(); ++i)
+    {
+        BankCacheEntry *e = s_entries[i];
+        if(e->path == path && e->size == file.size && e->mtime == file.mtime)
+        {
+            ++e->refCount;
+            return e;
+        }
+    }
+    return NULL;
+}
+
+const BankCacheEntry *findData(uint64_t hash, const void *data, size_t size)
+{
+    MutexHolder lock(s_lock);
+    for(size_t i = 0; i < s_entries.size(); ++i)
+    {
+        BankCacheEntry *e = s_entries[i];
+        if(sameData(e, hash, data, size))
+        {
+            ++e->refCount;
+            return e;
+        }
+    }
+    return NULL;
+}
+
+const BankCacheEntry *insert(BankCacheEntry *entry)
+{
+    MutexHolder lock(s_lock);
+    for(size_t i = 0; i < s_entries.size(); ++i)
+    {
+        BankCacheEntry *e = s_entries[i];
+        if(e->path == entry->path && e->size == entry->size && e->mtime == entry->mtime &&
+           sameData(e, entry->hash, entry->data.empty() ? NULL : &entry->data[0], entry->data.size()))
+        {
+            // Another player has been loaded the same bank meanwhile
+            delete entry;
+            ++e->refCount;
+            return e;
+        }
+    }
+    entry->refCount = 1;
+    s_entries.push_back(entry);
+    return entry;
+}
+
+void release(const BankCacheEntry *entry)
+{
+    if(!entry)
+        return;
+
+    BankCacheEntry *toDelete = NULL;
+    {
+        MutexHolder lock(s_lock);
+        for(size_t i = 0; i < s_entries.size(); ++i)
+        {
+            BankCacheEntry *e = s_entries[i];
+            if(e != entry)
+                continue;
+            if(--e->refCount == 0)
+            {
+                toDelete = e;
+                s_entries[i] = s_entries.back();
+                s_entries.pop_back();
+            }
+            break;
+        }
+    }
+    delete toDelete;
+}
+
+} // namespace BankCache
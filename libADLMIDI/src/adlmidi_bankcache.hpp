@@ -0,0 +1,156 @@
+/*
+ * libADLMIDI is a free Software MIDI synthesizer library with OPL3 emulation
+ *
+ * Original ADLMIDI code: Copyright (c) 2010-2014 Joel Yliluoma <bisqwit@iki.fi>
+ * ADLMIDI Library API:   Copyright (c) 2015-2024 Vitaly Novichkov <admin@wohlnet.ru>
+ *
+ * Library is based on the ADLMIDI, a MIDI player for Linux and Windows with OPL3 emulation:
+ * http://iki.fi/bisqwit/source/adlmidi.html
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ADLMIDI_BANKCACHE_HPP
+#define ADLMIDI_BANKCACHE_HPP
+
+#include <string>
+#include <vector>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "oplinst.h"
+
+/**
+ * Process-wide cache of the parsed WOPL banks.
+ *
+ * Every custom bank loaded by any player is converted once into the internal
+ * instruments format and kept here. Players are referring the cached
+ * instruments directly, so all players which are using the same bank are
+ * sharing one copy of it, and loading of the already cached bank skips the
+ * parsing completely. Entries are reference counted and are freed once the
+ * last player stops using them.
+ *
+ * Entries are looked up by the file path (validated by the file size and the
+ * modification time) and by the bank data itself: the hash only narrows the
+ * search, the data of the entry is always compared byte by byte.
+ */
+struct BankCacheEntry
+{
+    //! Path to the source file, empty for banks loaded from the memory
+    std::string path;
+    //! Size of the bank data
+    uint64_t    size;
+    //! Modification time of the source file, in nanoseconds where the system has it
+    int64_t     mtime;
+    //! FNV-1a hash of the bank data
+    uint64_t    hash;
+    //! Copy of the bank data to tell apart the banks with the same hash
+    std::vector<char> data;
+    //! Bank-wide setup
+    OplBankSetup setup;
+    //! MIDI bank numbers (the same as keys of the bank map)
+    std::vector<size_t> bankIds;
+    //! Instruments of all banks, 128 per every entry of the bankIds
+    std::vector<OplInstMeta> instruments;
+    //! Count of the players which are using this entry
+    size_t      refCount;
+
+    BankCacheEntry() :
+        size(0), mtime(0), hash(0), refCount(0)
+    {
+        setup.volumeModel = 0;
+        setup.deepTremolo = false;
+        setup.deepVibrato = false;
+        setup.scaleModulators = false;
+        setup.mt32defaults = false;
+    }
+};
+
+namespace BankCache
+{
+
+/**
+ * @brief Compute the hash of the bank data
+ * @param data Raw bank data
+ * @param size Size of the data
+ * @return 64-bit FNV-1a hash
+ */
+uint64_t hashData(const void *data, size_t size);
+
+/**
+ * @brief Find the bank which was loaded from the same unmodified file
+ * @param path Path to the bank file
+ * @return Acquired entry or NULL if the file is not in the cache
+ */
+const BankCacheEntry *findFile(const std::string &path);
+
+/**
+ * @brief Find the bank with the same content
+ * @param hash Hash of the bank data computed by hashData()
+ * @param data Raw bank data
+ * @param size Size of the bank data
+ * @return Acquired entry or NULL if such bank is not in the cache
+ */
+const BankCacheEntry *findData(uint64_t hash, const void *data, size_t size);
+
+/**
+ * @brief Add the new bank into the cache
+ * @param entry New entry allocated with the operator new, cache takes the ownership
+ * @return Acquired entry. If the same bank was added concurrently, the
+ *         given entry gets deleted and the existing one is returned instead.
+ */
+const BankCacheEntry *insert(BankCacheEntry *entry);
+
+/**
+ * @brief Release the entry acquired by one of the functions above
+ * @param entry Cache entry, may be NULL
+ */
+void release(const BankCacheEntry *entry);
+
+/**
+ * @brief Fill the file properties of the new entry
+ * @param entry New entry
+ * @param path Path to the bank file
+ * @return true if file properties has been received
+ */
+bool statFile(BankCacheEntry &entry, const std::string &path);
+
+} // namespace BankCache
+
+/**
+ * @brief Reference to the cache entry which is automatically released
+ */
+class BankCacheRef
+{
+    const BankCacheEntry *m_entry;
+    BankCacheRef(const BankCacheRef &);
+    BankCacheRef &operator=(const BankCacheRef &);
+public:
+    BankCacheRef() : m_entry(NULL) {}
+    ~BankCacheRef() { BankCache::release(m_entry); }
+
+    /**
+     * @brief Take the already acquired entry, and release the previous one
+     */
+    void reset(const BankCacheEntry *entry = NULL)
+    {
+        const BankCacheEntry *old = m_entry;
+        m_entry = entry;
+        BankCache::release(old);
+    }
+
+    const BankCacheEntry *get() const { return m_entry; }
+};
+
+#endif // ADLMIDI_BANKCACHE_HPP
@@ -33,6 +33,11 @@
 
 bool MIDIplay::LoadBank(const std::string &filename)
 {
+    // Already loaded and not modified since, no need to read it again
+    const BankCacheEntry *cached = BankCache::findFile(filename);
+    if(cached)
+        return LoadBank(cached);
+
     FileAndMemReader file;
     file.openFile(filename.c_str());
     return LoadBank(file);
@@ -55,12 +60,31 @@ void cvt_FMIns_to_ADLI(ADL_Instrument &ins, const OplInstMeta &in)
     cvt_FMIns_to_generic(ins, in);
 }
 
+bool MIDIplay::LoadBank(const BankCacheEntry *bank)
+{
+    Synth &synth = *m_synth;
+
+    synth.setEmbeddedBank(m_setup.bankId);
+    synth.setSharedBank(bank);
+    m_setup.deepTremoloMode = -1;
+    m_setup.deepVibratoMode = -1;
+    m_setup.volumeScaleModel = ADLMIDI_VolumeModel_AUTO;
+
+    synth.m_embeddedBank = Synth::CustomBankTag; // Use dynamic banks!
+    //Percussion offset is count of instruments multipled to count of melodic banks
+    applySetup();
+
+    return true;
+}
+
 bool MIDIplay::LoadBank(FileAndMemReader &fr)
 {
     int err = 0;
     WOPLFile *wopl = NULL;
     char *raw_file_data = NULL;
     size_t  fsize;
+    uint64_t hash;
+    const BankCacheEntry *cached;
     if(!fr.isValid())
     {
         errorStringOut = "Custom bank: Invalid data stream!";
@@ -79,10 +103,17 @@ bool MIDIplay::LoadBank(FileAndMemReader &fr)
     }
     fr.read(raw_file_data, 1, fsize);
 
+    // The same bank was already loaded from another file or from the memory
+    hash = BankCache::hashData(raw_file_data, fsize);
+    cached = BankCache::findData(hash, raw_file_data, fsize);
+    if(cached)
+    {
+        free(raw_file_data);
+        return LoadBank(cached);
+    }
+
     // Parse bank file from the memory
     wopl = WOPL_LoadBankFromMem((void*)raw_file_data, fsize, &err);
-    //Free the buffer no more needed
-    free(raw_file_data);
 
     // Check for any erros
     if(!wopl)
@@ -91,41 +122,48 @@ bool MIDIplay::LoadBank(FileAndMemReader &fr)
         {
         case WOPL_ERR_BAD_MAGIC:
             errorStringOut = "Custom bank: Invalid magic!";
-            return false;
+            break;
         case WOPL_ERR_UNEXPECTED_ENDING:
             errorStringOut = "Custom bank: Unexpected ending!";
-            return false;
+            break;
         case WOPL_ERR_INVALID_BANKS_COUNT:
             errorStringOut = "Custom bank: Invalid banks count!";
-            return false;
+            break;
         case WOPL_ERR_NEWER_VERSION:
             errorStringOut = "Custom bank: Version is newer than supported by this library!";
-            return false;
+            break;
         case WOPL_ERR_OUT_OF_MEMORY:
             errorStringOut = "Custom bank: Out of memory!";
-            return false;
+            break;
         default:
             errorStringOut = "Custom bank: Unknown error!";
-            return false;
+            break;
         }
+        free(raw_file_data);
+        return false;
     }
 
-    Synth &synth = *m_synth;
-
-    synth.setEmbeddedBank(m_setup.bankId);
+    BankCacheEntry *entry = new BankCacheEntry;
+    if(!fr.fileName().empty())
+        BankCache::statFile(*entry, fr.fileName());
+    entry->size = fsize;
+    entry->hash = hash;
+    entry->data.assign(raw_file_data, raw_file_data + fsize);
+    //Free the buffer no more needed
+    free(raw_file_data);
 
-    synth.m_insBankSetup.scaleModulators = false;
-    synth.m_insBankSetup.deepTremolo = (wopl->opl_flags & WOPL_FLAG_DEEP_TREMOLO) != 0;
-    synth.m_insBankSetup.deepVibrato = (wopl->opl_flags & WOPL_FLAG_DEEP_VIBRATO) != 0;
-    synth.m_insBankSetup.mt32defaults = (wopl->opl_flags & WOPL_FLAG_MT32) != 0;
-    synth.m_insBankSetup.volumeModel = wopl->volume_model;
-    m_setup.deepTremoloMode = -1;
-    m_setup.deepVibratoMode = -1;
-    m_setup.volumeScaleModel = ADLMIDI_VolumeModel_AUTO;
+    entry->setup.scaleModulators = false;
+    entry->setup.deepTremolo = (wopl->opl_flags & WOPL_FLAG_DEEP_TREMOLO) != 0;
+    entry->setup.deepVibrato = (wopl->opl_flags & WOPL_FLAG_DEEP_VIBRATO) != 0;
+    entry->setup.mt32defaults = (wopl->opl_flags & WOPL_FLAG_MT32) != 0;
+    entry->setup.volumeModel = wopl->volume_model;
 
     uint16_t slots_counts[2] = {wopl->banks_count_melodic, wopl->banks_count_percussion};
     WOPLBank *slots_src_ins[2] = { wopl->banks_melodic, wopl->banks_percussive };
 
+    entry->bankIds.reserve(slots_counts[0] + slots_counts[1]);
+    entry->instruments.resize((slots_counts[0] + slots_counts[1]) * 128);
+
     for(size_t ss = 0; ss < 2; ss++)
     {
         for(size_t i = 0; i < slots_counts[ss]; i++)
@@ -133,10 +171,11 @@ bool MIDIplay::LoadBank(FileAndMemReader &fr)
             size_t bankno = (slots_src_ins[ss][i].bank_midi_msb * 256) +
                             (slots_src_ins[ss][i].bank_midi_lsb) +
                             (ss ? size_t(Synth::PercussionTag) : 0);
-            Synth::Bank &bank = synth.m_insBanks[bankno];
+            OplInstMeta *bank = &entry->instruments[entry->bankIds.size() * 128];
+            entry->bankIds.push_back(bankno);
             for(int j = 0; j < 128; j++)
             {
-                OplInstMeta &ins = bank.ins[j];
+                OplInstMeta &ins = bank[j];
                 std::memset(&ins, 0, sizeof(OplInstMeta));
                 WOPLInstrument &inIns = slots_src_ins[ss][i].ins[j];
                 cvt_generic_to_FMIns(ins, inIns);
@@ -144,13 +183,9 @@ bool MIDIplay::LoadBank(FileAndMemReader &fr)
         }
     }
 
-    synth.m_embeddedBank = Synth::CustomBankTag; // Use dynamic banks!
-    //Percussion offset is count of instruments multipled to count of melodic banks
-    applySetup();
-
     WOPL_Free(wopl);
 
-    return true;
+    return LoadBank(BankCache::insert(entry));
 }
 
 #ifndef ADLMIDI_DISABLE_MIDI_SEQUENCER
@@ -181,6 +216,7 @@ bool MIDIplay::LoadMIDI_post()
     {
         const std::vector<MidiSequencer::CmfInstrument> &instruments = seq.getRawCmfInstruments();
         synth.m_insBanks.clear();//Clean up old banks
+        synth.m_sharedBank.reset();
 
         uint16_t ins_count = static_cast<uint16_t>(instruments.size());
         for(uint16_t i = 0; i < ins_count; ++i)
@@ -195,7 +231,7 @@ bool MIDIplay::LoadMIDI_post()
             /*std::printf("Ins %3u: %02X %02X %02X %02X  %02X %02X %02X %02X  %02X %02X %02X %02X  %02X %02X %02X %02X\n",
                         i, InsData[0],InsData[1],InsData[2],InsData[3], InsData[4],InsData[5],InsData[6],InsData[7],
                            InsData[8],InsData[9],InsData[10],InsData[11], InsData[12],InsData[13],InsData[14],InsData[15]);*/
-            OplInstMeta &adlins = synth.m_insBanks[bank].ins[i % 128];
+            OplInstMeta &adlins = synth.m_insBanks[bank].edit()[i % 128];
             OplTimbre    adl;
             adl.modulator_E862 =
                 ((static_cast<uint32_t>(insData[8] & 0x07) << 24) & 0xFF000000) //WaveForm
@@ -212,6 +212,18 @@ void MIDIplay::resetMIDIDefaults(int offset)
     }
 }
 
+bool MIDIplay::isSilent() const
+{
+    const Synth &synth = *m_synth;
+    for(uint32_t c = 0, n = synth.m_numChannels; c < n; ++c)
+    {
+        const AdlChannel &ch = m_chipChannels[c];
+        if(!ch.users.empty() || ch.koff_time_until_neglible_us > 0)
+            return false;
+    }
+    return true;
+}
+
 void MIDIplay::TickIterators(double s)
 {
     Synth &synth = *m_synth;
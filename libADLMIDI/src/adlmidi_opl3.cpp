@@ -44,6 +44,7 @@ static const unsigned OPLBase = 0x388;
 #   ifndef ADLMIDI_DISABLE_NUKED_EMULATOR
 #       include "chips/nuked_opl3.h"
 #       include "chips/nuked_opl3_v174.h"
+#       include "chips/nuked_opl3_soa.h"
 #   endif
 
 // DosBox 0.74 OPL3 emulator, Well-accurate and fast
@@ -66,6 +67,7 @@ static const unsigned adl_emulatorSupport = 0
 #ifndef ADLMIDI_HW_OPL
 #   ifndef ADLMIDI_DISABLE_NUKED_EMULATOR
     | (1u << ADLMIDI_EMU_NUKED) | (1u << ADLMIDI_EMU_NUKED_174)
+    | (1u << ADLMIDI_EMU_NUKED_SIMD)
 #   endif
 
 #   ifndef ADLMIDI_DISABLE_DOSBOX_EMULATOR
@@ -859,6 +861,44 @@ static OplInstMeta makeEmptyInstrument()
 
 const OplInstMeta OPL3::m_emptyInstrument = makeEmptyInstrument();
 
+OPL3::Bank::Bank() :
+    m_own(128)
+{
+    ins = &m_own[0];
+}
+
+OPL3::Bank::Bank(const Bank &o) :
+    m_own(o.m_own)
+{
+    ins = o.isShared() ? o.ins : &m_own[0];
+}
+
+OPL3::Bank &OPL3::Bank::operator=(const Bank &o)
+{
+    if(this != &o)
+    {
+        m_own = o.m_own;
+        ins = o.isShared() ? o.ins : &m_own[0];
+    }
+    return *this;
+}
+
+OplInstMeta *OPL3::Bank::edit()
+{
+    if(isShared())
+    {
+        m_own.assign(ins, ins + 128);
+        ins = &m_own[0];
+    }
+    return &m_own[0];
+}
+
+void OPL3::Bank::share(const OplInstMeta *data)
+{
+    std::vector<OplInstMeta>().swap(m_own);
+    ins = data;
+}
+
 OPL3::OPL3() :
     m_numChips(1),
     m_numFourOps(0),
@@ -908,6 +948,8 @@ void OPL3::setEmbeddedBank(uint32_t bank)
     m_embeddedBank = bank;
     //Embedded banks are supports 128:128 GM set only
     m_insBanks.clear();
+    // No bank refers the cached custom bank anymore
+    m_sharedBank.reset();
 
     if(bank >= static_cast<uint32_t>(g_embeddedBanksCount))
         return;
@@ -929,18 +971,18 @@ void OPL3::setEmbeddedBank(uint32_t bank)
             size_t bankIndex = g_embeddedBanksMidiIndex[banksOffset + bankID];
             const BanksDump::MidiBank &bankData = g_embeddedBanksMidi[bankIndex];
             size_t bankMidiIndex = static_cast<size_t>((bankData.msb * 256) + bankData.lsb) + (ss ? static_cast<size_t>(PercussionTag) : 0);
-            Bank &bankTarget = m_insBanks[bankMidiIndex];
+            OplInstMeta *bankTarget = m_insBanks[bankMidiIndex].edit();
 
             for(size_t instId = 0; instId < 128; instId++)
             {
                 midi_bank_idx_t instIndex = bankData.insts[instId];
                 if(instIndex < 0)
                 {
-                    bankTarget.ins[instId].flags = OplInstMeta::Flag_NoSound;
+                    bankTarget[instId].flags = OplInstMeta::Flag_NoSound;
                     continue;
                 }
                 BanksDump::InstrumentEntry instIn = g_embeddedBanksInstruments[instIndex];
-                OplInstMeta &instOut = bankTarget.ins[instId];
+                OplInstMeta &instOut = bankTarget[instId];
 
                 adlFromInstrument(instIn, instOut);
             }
@@ -952,6 +994,22 @@ void OPL3::setEmbeddedBank(uint32_t bank)
 #endif
 }
 
+void OPL3::setSharedBank(const BankCacheEntry *entry)
+{
+    // Banks which are still referring the previous entry are getting their own copies
+    for(BankMap::iterator it = m_insBanks.begin(); it != m_insBanks.end(); ++it)
+    {
+        if(it->second.isShared())
+            it->second.edit();
+    }
+
+    for(size_t i = 0; i < entry->bankIds.size(); ++i)
+        m_insBanks[entry->bankIds[i]].share(&entry->instruments[i * 128]);
+
+    m_insBankSetup = entry->setup;
+    m_sharedBank.reset(entry);
+}
+
 void OPL3::writeReg(size_t chip, uint16_t address, uint8_t value)
 {
 #ifdef ADLMIDI_HW_OPL
@@ -974,6 +1032,8 @@ void OPL3::writeReg(size_t chip, uint16_t address, uint8_t value)
 #   endif//__WATCOMC__
 
 #else//ADLMIDI_HW_OPL
+    if(m_trace.get())
+        m_trace->writeReg(chip, 0, address, value);
     m_chips[chip]->writeReg(address, value);
 #endif
 }
@@ -983,6 +1043,8 @@ void OPL3::writeRegI(size_t chip, uint32_t address, uint32_t value)
 #ifdef ADLMIDI_HW_OPL
     writeReg(chip, static_cast<uint16_t>(address), static_cast<uint8_t>(value));
 #else//ADLMIDI_HW_OPL
+    if(m_trace.get())
+        m_trace->writeReg(chip, 0, static_cast<uint16_t>(address), static_cast<uint8_t>(value));
     m_chips[chip]->writeReg(static_cast<uint16_t>(address), static_cast<uint8_t>(value));
 #endif
 }
@@ -990,6 +1052,8 @@ void OPL3::writeRegI(size_t chip, uint32_t address, uint32_t value)
 void OPL3::writePan(size_t chip, uint32_t address, uint32_t value)
 {
 #ifndef ADLMIDI_HW_OPL
+    if(m_trace.get())
+        m_trace->writePan(chip, static_cast<uint16_t>(address), static_cast<uint8_t>(value));
     m_chips[chip]->writePan(static_cast<uint16_t>(address), static_cast<uint8_t>(value));
 #else
     ADL_UNUSED(chip);
@@ -1737,6 +1801,8 @@ void OPL3::reset(int emulator, unsigned long PCM_RATE, void *audioTickHandler)
 
 #ifndef ADLMIDI_HW_OPL
     m_chips.resize(m_numChips, AdlMIDI_SPtr<OPLChipBase>());
+    if(m_trace.get())
+        m_trace->reset(ChipTrace_OPL3, m_numChips, (uint32_t)PCM_RATE, 14318181, m_runAtPcmRate);
 #endif
 
     const struct OplTimbre defaultInsCache = { 0x1557403,0x005B381, 0x49,0x80, 0x4, +0 };
@@ -1778,6 +1844,9 @@ void OPL3::reset(int emulator, unsigned long PCM_RATE, void *audioTickHandler)
         case ADLMIDI_EMU_NUKED_174: /* Old Nuked OPL3 1.4.7 modified and optimized */
             chip = new NukedOPL3v174;
             break;
+        case ADLMIDI_EMU_NUKED_SIMD: /* Latest Nuked OPL3 with SoA operators */
+            chip = new NukedOPL3SoA;
+            break;
 #endif
 #ifndef ADLMIDI_DISABLE_DOSBOX_EMULATOR
         case ADLMIDI_EMU_DOSBOX:
@@ -28,6 +28,10 @@
 #include "adlmidi_ptr.hpp"
 #include "adlmidi_private.hpp"
 #include "adlmidi_bankmap.h"
+#include "adlmidi_bankcache.hpp"
+#ifndef ADLMIDI_HW_OPL
+#include "chips/common/chip_trace.hpp"
+#endif
 
 #define BEND_COEFFICIENT                172.4387
 
@@ -62,6 +66,8 @@ public:
 #ifndef ADLMIDI_HW_OPL
     //! Running chip emulators
     std::vector<AdlMIDI_SPtr<OPLChipBase > > m_chips;
+    //! Register-write trace being recorded, or NULL
+    AdlMIDI_UPtr<ChipTraceWriter> m_trace;
 #endif
 
 private:
@@ -80,14 +86,39 @@ public:
      */
     struct Bank
     {
-        //! MIDI Bank instruments
-        OplInstMeta ins[128];
+        //! MIDI Bank instruments (read-only, may point into the bank cache)
+        const OplInstMeta *ins;
+
+        Bank();
+        Bank(const Bank &o);
+        Bank &operator=(const Bank &o);
+
+        /**
+         * @brief Get the writable instruments, shared instruments are copied first
+         * @return Array of 128 instruments
+         */
+        OplInstMeta *edit();
+
+        /**
+         * @brief Refer the shared read-only instruments instead of private ones
+         * @param data Array of 128 instruments which outlives this bank
+         */
+        void share(const OplInstMeta *data);
+
+        //! Is this bank refers the shared instruments
+        bool isShared() const { return m_own.empty(); }
+
+    private:
+        //! Private instruments, empty while the bank is shared
+        std::vector<OplInstMeta> m_own;
     };
     typedef BasicBankMap<Bank> BankMap;
     //! MIDI bank instruments data
     BankMap         m_insBanks;
     //! MIDI bank-wide setup
     OplBankSetup    m_insBankSetup;
+    //! Cached custom bank which is referred by shared banks of the bank map
+    BankCacheRef    m_sharedBank;
 
 public:
     //! Blank instrument template
@@ -227,6 +258,12 @@ public:
      */
     void setEmbeddedBank(uint32_t bank);
 
+    /**
+     * @brief Use banks of the cached custom bank
+     * @param entry Acquired cache entry, ownership of the reference is taken
+     */
+    void setSharedBank(const BankCacheEntry *entry);
+
     /**
      * @brief Write data to OPL3 chip register
      * @param chip Index of emulated chip. In hardware OPL3 builds, this parameter is ignored
@@ -56,7 +56,7 @@ int adlCalculateFourOpChannels(MIDIplay *play, bool silent)
             size_t div = (bank & Synth::PercussionTag) ? 1 : 0;
             for(size_t i = 0; i < 128; ++i)
             {
-                OplInstMeta &ins = it->second.ins[i];
+                const OplInstMeta &ins = it->second.ins[i];
                 if(ins.flags & OplInstMeta::Flag_NoSound)
                     continue;
                 if((ins.flags & OplInstMeta::Flag_Real4op) != 0)
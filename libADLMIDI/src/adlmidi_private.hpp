@@ -131,6 +131,7 @@ typedef int32_t ssize_t;
 #endif
 
 class FileAndMemReader;
+struct BankCacheEntry;
 
 #ifndef ADLMIDI_DISABLE_MIDI_SEQUENCER
 // Rename class to avoid ABI collisions
@@ -165,6 +166,11 @@ class MIDIplay;
 #define ADL_MAX_CHIPS_STR "100"
 #endif
 
+#if defined(ADLMIDI_ENABLE_THREADED_RENDER) && (defined(ADLMIDI_HW_OPL) || defined(ADLMIDI_AUDIO_TICK_HANDLER))
+// Chips are either not emulated, or are calling back the MIDI player on every tick
+#undef ADLMIDI_ENABLE_THREADED_RENDER
+#endif
+
 extern std::string ADLMIDI_ErrorString;
 
 /*
@@ -0,0 +1,373 @@
+/*
+ * libADLMIDI is a free Software MIDI synthesizer library with OPL3 emulation
+ *
+ * Original ADLMIDI code: Copyright (c) 2010-2014 Joel Yliluoma <bisqwit@iki.fi>
+ * ADLMIDI Library API:   Copyright (c) 2015-2024 Vitaly Novichkov <admin@wohlnet.ru>
+ *
+ * Library is based on the ADLMIDI, a MIDI player for Linux and Windows with OPL3 emulation:
+ * http://iki.fi/bisqwit/source/adlmidi.html
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CHIP_TRACE_HPP
+#define CHIP_TRACE_HPP
+
+#include <stdio.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <vector>
+
+/*
+ * Register-write trace of the FM chips, shared by libADLMIDI and libOPNMIDI.
+ *
+ * The trace keeps every register write of every chip together with the
+ * count of output frames rendered between the writes, so any emulator can
+ * be driven from it later without the MIDI sequencer: the same trace played
+ * through the same emulator gives the same output, bit by bit.
+ *
+ * File layout, all numbers are little-endian:
+ *
+ *   "CHIPTRC\x1A"  magic, 8 bytes
+ *   u16            format version (1)
+ *   u16            reserved, zero
+ *   records...     until the End record or the end of the file
+ *
+ * Records start with the one-byte code:
+ *
+ *   Reset  u8 family, u8 chips, u8 flags, u32 rate, u32 clock
+ *          All chips are (re)created at the given output rate.
+ *   Wait   LEB128 count of the frames rendered by every chip
+ *   Write  u8 chip, u8 port, u16 address, u8 value
+ *   Pan    u8 chip, u16 address, u8 value
+ *   End    no payload
+ */
+
+enum ChipTraceFamily
+{
+    ChipTrace_OPL3 = 0,
+    ChipTrace_OPN2 = 1,
+    ChipTrace_OPNA = 2
+};
+
+enum ChipTraceFlags
+{
+    // chips are running at the PCM rate rather than the native one
+    ChipTrace_PcmRate = 0x01
+};
+
+struct ChipTraceEvent
+{
+    enum Type
+    {
+        End = 0,
+        Reset = 1,
+        Wait = 2,
+        Write = 3,
+        Pan = 4
+    };
+
+    Type type;
+    uint8_t family;
+    uint8_t flags;
+    uint8_t chip;
+    uint8_t port;
+    uint16_t address;
+    uint8_t value;
+    // chips count of Reset
+    uint32_t chips;
+    // count of frames of Wait
+    uint32_t frames;
+    // output rate of Reset
+    uint32_t rate;
+    uint32_t clock;
+};
+
+static const char chipTraceMagic[8] = {'C', 'H', 'I', 'P', 'T', 'R', 'C', '\x1A'};
+static const uint16_t chipTraceVersion = 1;
+
+/**
+ * @brief Writes the register trace of the chips into the file
+ */
+class ChipTraceWriter
+{
+public:
+    ChipTraceWriter() : m_file(NULL), m_waitFrames(0)
+    {}
+
+    ~ChipTraceWriter()
+    {
+        close();
+    }
+
+    bool open(const char *path)
+    {
+        close();
+        m_file = fopen(path, "wb");
+        if(!m_file)
+            return false;
+        m_waitFrames = 0;
+        m_buffer.clear();
+        m_buffer.insert(m_buffer.end(), chipTraceMagic, chipTraceMagic + 8);
+        put16(chipTraceVersion);
+        put16(0);
+        return true;
+    }
+
+    void close()
+    {
+        if(!m_file)
+            return;
+        flushWait();
+        m_buffer.push_back(ChipTraceEvent::End);
+        flush();
+        fclose(m_file);
+        m_file = NULL;
+    }
+
+    bool isOpen() const
+    {
+        return m_file != NULL;
+    }
+
+    void reset(ChipTraceFamily family, size_t chips, uint32_t rate, uint32_t clock, bool pcmRate)
+    {
+        flushWait();
+        m_buffer.push_back(ChipTraceEvent::Reset);
+        m_buffer.push_back(static_cast<uint8_t>(family));
+        m_buffer.push_back(static_cast<uint8_t>(chips));
+        m_buffer.push_back(pcmRate ? ChipTrace_PcmRate : 0);
+        put32(rate);
+        put32(clock);
+    }
+
+    void writeReg(size_t chip, uint8_t port, uint16_t address, uint8_t value)
+    {
+        if(m_waitFrames > 0)
+            flushWait();
+        uint8_t rec[6] =
+        {
+            ChipTraceEvent::Write, static_cast<uint8_t>(chip), port,
+            static_cast<uint8_t>(address & 0xFF), static_cast<uint8_t>(address >> 8), value
+        };
+        m_buffer.insert(m_buffer.end(), rec, rec + 6);
+        if(m_buffer.size() >= bufferLimit)
+            flush();
+    }
+
+    void writePan(size_t chip, uint16_t address, uint8_t value)
+    {
+        if(m_waitFrames > 0)
+            flushWait();
+        uint8_t rec[5] =
+        {
+            ChipTraceEvent::Pan, static_cast<uint8_t>(chip),
+            static_cast<uint8_t>(address & 0xFF), static_cast<uint8_t>(address >> 8), value
+        };
+        m_buffer.insert(m_buffer.end(), rec, rec + 5);
+        if(m_buffer.size() >= bufferLimit)
+            flush();
+    }
+
+    // Frames are merged until the next write, rendering in small
+    // portions doesn't make the trace larger
+    void wait(size_t frames)
+    {
+        if(m_waitFrames + frames > 0x7FFFFFFF)
+            flushWait();
+        m_waitFrames += static_cast<uint32_t>(frames);
+    }
+
+private:
+    enum { bufferLimit = 65536 };
+
+    void put16(uint16_t v)
+    {
+        m_buffer.push_back(static_cast<uint8_t>(v & 0xFF));
+        m_buffer.push_back(static_cast<uint8_t>(v >> 8));
+    }
+
+    void put32(uint32_t v)
+    {
+        for(unsigned i = 0; i < 4; ++i)
+            m_buffer.push_back(static_cast<uint8_t>((v >> (8 * i)) & 0xFF));
+    }
+
+    void flushWait()
+    {
+        if(m_waitFrames == 0)
+            return;
+        m_buffer.push_back(ChipTraceEvent::Wait);
+        uint32_t n = m_waitFrames;
+        do
+        {
+            uint8_t byte = static_cast<uint8_t>(n & 0x7F);
+            n >>= 7;
+            m_buffer.push_back(n ? (byte | 0x80) : byte);
+        } while(n);
+        m_waitFrames = 0;
+    }
+
+    void flush()
+    {
+        if(!m_buffer.empty())
+            fwrite(&m_buffer[0], 1, m_buffer.size(), m_file);
+        m_buffer.clear();
+    }
+
+    FILE *m_file;
+    uint32_t m_waitFrames;
+    std::vector<uint8_t> m_buffer;
+};
+
+/**
+ * @brief Reads the register trace, the whole trace is kept in the memory
+ */
+class ChipTraceReader
+{
+public:
+    ChipTraceReader() : m_pos(0)
+    {}
+
+    bool open(const char *path)
+    {
+        m_data.clear();
+        m_pos = 0;
+        FILE *f = fopen(path, "rb");
+        if(!f)
+            return false;
+        uint8_t chunk[4096];
+        size_t got;
+        while((got = fread(chunk, 1, sizeof(chunk), f)) > 0)
+            m_data.insert(m_data.end(), chunk, chunk + got);
+        fclose(f);
+        return checkHeader();
+    }
+
+    bool openData(const void *data, size_t size)
+    {
+        const uint8_t *bytes = static_cast<const uint8_t *>(data);
+        m_data.assign(bytes, bytes + size);
+        m_pos = 0;
+        return checkHeader();
+    }
+
+    void rewind()
+    {
+        m_pos = headerSize;
+    }
+
+    /**
+     * @brief Take the next record
+     * @param e Destination event
+     * @return false at the end of the trace or on the broken record
+     */
+    bool next(ChipTraceEvent &e)
+    {
+        e.type = ChipTraceEvent::End;
+        if(m_pos >= m_data.size())
+            return false;
+
+        const uint8_t code = m_data[m_pos++];
+        switch(code)
+        {
+        case ChipTraceEvent::Reset:
+            if(!have(11))
+                return false;
+            e.family = m_data[m_pos];
+            e.chips = m_data[m_pos + 1];
+            e.flags = m_data[m_pos + 2];
+            e.rate = get32(m_pos + 3);
+            e.clock = get32(m_pos + 7);
+            m_pos += 11;
+            break;
+
+        case ChipTraceEvent::Wait:
+        {
+            uint32_t n = 0;
+            unsigned shift = 0;
+            uint8_t byte;
+            do
+            {
+                if(!have(1) || shift > 28)
+                    return false;
+                byte = m_data[m_pos++];
+                n |= static_cast<uint32_t>(byte & 0x7F) << shift;
+                shift += 7;
+            } while(byte & 0x80);
+            e.frames = n;
+            break;
+        }
+
+        case ChipTraceEvent::Write:
+            if(!have(5))
+                return false;
+            e.chip = m_data[m_pos];
+            e.port = m_data[m_pos + 1];
+            e.address = static_cast<uint16_t>(m_data[m_pos + 2] | (m_data[m_pos + 3] << 8));
+            e.value = m_data[m_pos + 4];
+            m_pos += 5;
+            break;
+
+        case ChipTraceEvent::Pan:
+            if(!have(4))
+                return false;
+            e.chip = m_data[m_pos];
+            e.port = 0;
+            e.address = static_cast<uint16_t>(m_data[m_pos + 1] | (m_data[m_pos + 2] << 8));
+            e.value = m_data[m_pos + 3];
+            m_pos += 4;
+            break;
+
+        default:
+            m_pos = m_data.size();
+            return false;
+        }
+
+        e.type = static_cast<ChipTraceEvent::Type>(code);
+        return true;
+    }
+
+private:
+    enum { headerSize = 12 };
+
+    bool checkHeader()
+    {
+        if(m_data.size() < headerSize || memcmp(&m_data[0], chipTraceMagic, 8) != 0)
+            return false;
+        if((m_data[8] | (m_data[9] << 8)) != chipTraceVersion)
+            return false;
+        m_pos = headerSize;
+        return true;
+    }
+
+    bool have(size_t bytes) const
+    {
+        return m_data.size() - m_pos >= bytes;
+    }
+
+    uint32_t get32(size_t at) const
+    {
+        return static_cast<uint32_t>(m_data[at]) |
+               (static_cast<uint32_t>(m_data[at + 1]) << 8) |
+               (static_cast<uint32_t>(m_data[at + 2]) << 16) |
+               (static_cast<uint32_t>(m_data[at + 3]) << 24);
+    }
+
+    std::vector<uint8_t> m_data;
+    size_t m_pos;
+};
+
+#endif // CHIP_TRACE_HPP
@@ -0,0 +1,1539 @@
+/* Nuked OPL3
+ * Copyright (C) 2013-2020 Nuke.YKT
+ *
+ * This file is part of Nuked OPL3.
+ *
+ * Nuked OPL3 is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * Nuked OPL3 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Nuked OPL3. If not, see <https://www.gnu.org/licenses/>.
+
+ *  Nuked OPL3 emulator, structure-of-arrays variant.
+ *  Thanks:
+ *      MAME Development Team(Jarek Burczynski, Tatsuyuki Satoh):
+ *          Feedback and Rhythm part calculation information.
+ *      forums.submarine.org.uk(carbon14, opl3):
+ *          Tremolo and phase generator calculation information.
+ *      OPLx decapsulated(Matthew Gambrell, Olli Niemitalo):
+ *          OPL2 ROMs.
+ *      siliconpr0n.org(John McMaster, digshadow):
+ *          YMF262 and VRC VII decaps and die shots.
+ *
+ * version: 1.8
+ */
+
+#include <string.h>
+#include "nukedopl3_soa.h"
+
+#if !defined(OPL3SOA_DISABLE_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#include <emmintrin.h>
+#define OPL3SOA_SSE2
+#endif
+
+/* Channel types */
+
+enum {
+    ch_2op = 0,
+    ch_4op = 1,
+    ch_4op2 = 2,
+    ch_drum = 3
+};
+
+/* Envelope key types */
+
+enum {
+    egk_norm = 0x01,
+    egk_drum = 0x02
+};
+
+/*
+    logsin table
+*/
+
+static const uint16_t logsinrom[512] = {
+    0x859, 0x6c3, 0x607, 0x58b, 0x52e, 0x4e4, 0x4a6, 0x471,
+    0x443, 0x41a, 0x3f5, 0x3d3, 0x3b5, 0x398, 0x37e, 0x365,
+    0x34e, 0x339, 0x324, 0x311, 0x2ff, 0x2ed, 0x2dc, 0x2cd,
+    0x2bd, 0x2af, 0x2a0, 0x293, 0x286, 0x279, 0x26d, 0x261,
+    0x256, 0x24b, 0x240, 0x236, 0x22c, 0x222, 0x218, 0x20f,
+    0x206, 0x1fd, 0x1f5, 0x1ec, 0x1e4, 0x1dc, 0x1d4, 0x1cd,
+    0x1c5, 0x1be, 0x1b7, 0x1b0, 0x1a9, 0x1a2, 0x19b, 0x195,
+    0x18f, 0x188, 0x182, 0x17c, 0x177, 0x171, 0x16b, 0x166,
+    0x160, 0x15b, 0x155, 0x150, 0x14b, 0x146, 0x141, 0x13c,
+    0x137, 0x133, 0x12e, 0x129, 0x125, 0x121, 0x11c, 0x118,
+    0x114, 0x10f, 0x10b, 0x107, 0x103, 0x0ff, 0x0fb, 0x0f8,
+    0x0f4, 0x0f0, 0x0ec, 0x0e9, 0x0e5, 0x0e2, 0x0de, 0x0db,
+    0x0d7, 0x0d4, 0x0d1, 0x0cd, 0x0ca, 0x0c7, 0x0c4, 0x0c1,
+    0x0be, 0x0bb, 0x0b8, 0x0b5, 0x0b2, 0x0af, 0x0ac, 0x0a9,
+    0x0a7, 0x0a4, 0x0a1, 0x09f, 0x09c, 0x099, 0x097, 0x094,
+    0x092, 0x08f, 0x08d, 0x08a, 0x088, 0x086, 0x083, 0x081,
+    0x07f, 0x07d, 0x07a, 0x078, 0x076, 0x074, 0x072, 0x070,
+    0x06e, 0x06c, 0x06a, 0x068, 0x066, 0x064, 0x062, 0x060,
+    0x05e, 0x05c, 0x05b, 0x059, 0x057, 0x055, 0x053, 0x052,
+    0x050, 0x04e, 0x04d, 0x04b, 0x04a, 0x048, 0x046, 0x045,
+    0x043, 0x042, 0x040, 0x03f, 0x03e, 0x03c, 0x03b, 0x039,
+    0x038, 0x037, 0x035, 0x034, 0x033, 0x031, 0x030, 0x02f,
+    0x02e, 0x02d, 0x02b, 0x02a, 0x029, 0x028, 0x027, 0x026,
+    0x025, 0x024, 0x023, 0x022, 0x021, 0x020, 0x01f, 0x01e,
+    0x01d, 0x01c, 0x01b, 0x01a, 0x019, 0x018, 0x017, 0x017,
+    0x016, 0x015, 0x014, 0x014, 0x013, 0x012, 0x011, 0x011,
+    0x010, 0x00f, 0x00f, 0x00e, 0x00d, 0x00d, 0x00c, 0x00c,
+    0x00b, 0x00a, 0x00a, 0x009, 0x009, 0x008, 0x008, 0x007,
+    0x007, 0x007, 0x006, 0x006, 0x005, 0x005, 0x005, 0x004,
+    0x004, 0x004, 0x003, 0x003, 0x003, 0x002, 0x002, 0x002,
+    0x002, 0x001, 0x001, 0x001, 0x001, 0x001, 0x001, 0x001,
+    0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000,
+    0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000,
+    0x001, 0x001, 0x001, 0x001, 0x001, 0x001, 0x001, 0x002,
+    0x002, 0x002, 0x002, 0x003, 0x003, 0x003, 0x004, 0x004,
+    0x004, 0x005, 0x005, 0x005, 0x006, 0x006, 0x007, 0x007,
+    0x007, 0x008, 0x008, 0x009, 0x009, 0x00a, 0x00a, 0x00b,
+    0x00c, 0x00c, 0x00d, 0x00d, 0x00e, 0x00f, 0x00f, 0x010,
+    0x011, 0x011, 0x012, 0x013, 0x014, 0x014, 0x015, 0x016,
+    0x017, 0x017, 0x018, 0x019, 0x01a, 0x01b, 0x01c, 0x01d,
+    0x01e, 0x01f, 0x020, 0x021, 0x022, 0x023, 0x024, 0x025,
+    0x026, 0x027, 0x028, 0x029, 0x02a, 0x02b, 0x02d, 0x02e,
+    0x02f, 0x030, 0x031, 0x033, 0x034, 0x035, 0x037, 0x038,
+    0x039, 0x03b, 0x03c, 0x03e, 0x03f, 0x040, 0x042, 0x043,
+    0x045, 0x046, 0x048, 0x04a, 0x04b, 0x04d, 0x04e, 0x050,
+    0x052, 0x053, 0x055, 0x057, 0x059, 0x05b, 0x05c, 0x05e,
+    0x060, 0x062, 0x064, 0x066, 0x068, 0x06a, 0x06c, 0x06e,
+    0x070, 0x072, 0x074, 0x076, 0x078, 0x07a, 0x07d, 0x07f,
+    0x081, 0x083, 0x086, 0x088, 0x08a, 0x08d, 0x08f, 0x092,
+    0x094, 0x097, 0x099, 0x09c, 0x09f, 0x0a1, 0x0a4, 0x0a7,
+    0x0a9, 0x0ac, 0x0af, 0x0b2, 0x0b5, 0x0b8, 0x0bb, 0x0be,
+    0x0c1, 0x0c4, 0x0c7, 0x0ca, 0x0cd, 0x0d1, 0x0d4, 0x0d7,
+    0x0db, 0x0de, 0x0e2, 0x0e5, 0x0e9, 0x0ec, 0x0f0, 0x0f4,
+    0x0f8, 0x0fb, 0x0ff, 0x103, 0x107, 0x10b, 0x10f, 0x114,
+    0x118, 0x11c, 0x121, 0x125, 0x129, 0x12e, 0x133, 0x137,
+    0x13c, 0x141, 0x146, 0x14b, 0x150, 0x155, 0x15b, 0x160,
+    0x166, 0x16b, 0x171, 0x177, 0x17c, 0x182, 0x188, 0x18f,
+    0x195, 0x19b, 0x1a2, 0x1a9, 0x1b0, 0x1b7, 0x1be, 0x1c5,
+    0x1cd, 0x1d4, 0x1dc, 0x1e4, 0x1ec, 0x1f5, 0x1fd, 0x206,
+    0x20f, 0x218, 0x222, 0x22c, 0x236, 0x240, 0x24b, 0x256,
+    0x261, 0x26d, 0x279, 0x286, 0x293, 0x2a0, 0x2af, 0x2bd,
+    0x2cd, 0x2dc, 0x2ed, 0x2ff, 0x311, 0x324, 0x339, 0x34e,
+    0x365, 0x37e, 0x398, 0x3b5, 0x3d3, 0x3f5, 0x41a, 0x443,
+    0x471, 0x4a6, 0x4e4, 0x52e, 0x58b, 0x607, 0x6c3, 0x859
+};
+
+/*
+    exp table
+*/
+
+static const uint16_t exprom[256] = {
+    0xff4, 0xfea, 0xfde, 0xfd4, 0xfc8, 0xfbe, 0xfb4, 0xfa8,
+    0xf9e, 0xf92, 0xf88, 0xf7e, 0xf72, 0xf68, 0xf5c, 0xf52,
+    0xf48, 0xf3e, 0xf32, 0xf28, 0xf1e, 0xf14, 0xf08, 0xefe,
+    0xef4, 0xeea, 0xee0, 0xed4, 0xeca, 0xec0, 0xeb6, 0xeac,
+    0xea2, 0xe98, 0xe8e, 0xe84, 0xe7a, 0xe70, 0xe66, 0xe5c,
+    0xe52, 0xe48, 0xe3e, 0xe34, 0xe2a, 0xe20, 0xe16, 0xe0c,
+    0xe04, 0xdfa, 0xdf0, 0xde6, 0xddc, 0xdd2, 0xdca, 0xdc0,
+    0xdb6, 0xdac, 0xda4, 0xd9a, 0xd90, 0xd88, 0xd7e, 0xd74,
+    0xd6a, 0xd62, 0xd58, 0xd50, 0xd46, 0xd3c, 0xd34, 0xd2a,
+    0xd22, 0xd18, 0xd10, 0xd06, 0xcfe, 0xcf4, 0xcec, 0xce2,
+    0xcda, 0xcd0, 0xcc8, 0xcbe, 0xcb6, 0xcae, 0xca4, 0xc9c,
+    0xc92, 0xc8a, 0xc82, 0xc78, 0xc70, 0xc68, 0xc60, 0xc56,
+    0xc4e, 0xc46, 0xc3c, 0xc34, 0xc2c, 0xc24, 0xc1c, 0xc12,
+    0xc0a, 0xc02, 0xbfa, 0xbf2, 0xbea, 0xbe0, 0xbd8, 0xbd0,
+    0xbc8, 0xbc0, 0xbb8, 0xbb0, 0xba8, 0xba0, 0xb98, 0xb90,
+    0xb88, 0xb80, 0xb78, 0xb70, 0xb68, 0xb60, 0xb58, 0xb50,
+    0xb48, 0xb40, 0xb38, 0xb32, 0xb2a, 0xb22, 0xb1a, 0xb12,
+    0xb0a, 0xb02, 0xafc, 0xaf4, 0xaec, 0xae4, 0xade, 0xad6,
+    0xace, 0xac6, 0xac0, 0xab8, 0xab0, 0xaa8, 0xaa2, 0xa9a,
+    0xa92, 0xa8c, 0xa84, 0xa7c, 0xa76, 0xa6e, 0xa68, 0xa60,
+    0xa58, 0xa52, 0xa4a, 0xa44, 0xa3c, 0xa36, 0xa2e, 0xa28,
+    0xa20, 0xa18, 0xa12, 0xa0c, 0xa04, 0x9fe, 0x9f6, 0x9f0,
+    0x9e8, 0x9e2, 0x9da, 0x9d4, 0x9ce, 0x9c6, 0x9c0, 0x9b8,
+    0x9b2, 0x9ac, 0x9a4, 0x99e, 0x998, 0x990, 0x98a, 0x984,
+    0x97c, 0x976, 0x970, 0x96a, 0x962, 0x95c, 0x956, 0x950,
+    0x948, 0x942, 0x93c, 0x936, 0x930, 0x928, 0x922, 0x91c,
+    0x916, 0x910, 0x90a, 0x904, 0x8fc, 0x8f6, 0x8f0, 0x8ea,
+    0x8e4, 0x8de, 0x8d8, 0x8d2, 0x8cc, 0x8c6, 0x8c0, 0x8ba,
+    0x8b4, 0x8ae, 0x8a8, 0x8a2, 0x89c, 0x896, 0x890, 0x88a,
+    0x884, 0x87e, 0x878, 0x872, 0x86c, 0x866, 0x860, 0x85a,
+    0x854, 0x850, 0x84a, 0x844, 0x83e, 0x838, 0x832, 0x82c,
+    0x828, 0x822, 0x81c, 0x816, 0x810, 0x80c, 0x806, 0x800
+};
+
+
+/*
+    freq mult table multiplied by 2
+
+    1/2, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 10, 12, 12, 15, 15
+*/
+
+static const uint8_t mt[16] = {
+    1, 2, 4, 6, 8, 10, 12, 14, 16, 18, 20, 20, 24, 24, 30, 30
+};
+
+/*
+    ksl table
+*/
+
+static const uint8_t kslrom[16] = {
+    0, 32, 40, 45, 48, 51, 53, 55, 56, 58, 59, 60, 61, 62, 63, 64
+};
+
+static const uint8_t kslshift[4] = {
+    8, 1, 2, 0
+};
+
+/*
+    envelope generator constants
+*/
+
+static const uint8_t eg_incstep[4][4] = {
+    { 0, 0, 0, 0 },
+    { 1, 0, 0, 0 },
+    { 1, 0, 1, 0 },
+    { 1, 1, 1, 0 }
+};
+
+/*
+    address decoding
+*/
+
+static const int8_t ad_slot[0x20] = {
+    0, 1, 2, 3, 4, 5, -1, -1, 6, 7, 8, 9, 10, 11, -1, -1,
+    12, 13, 14, 15, 16, 17, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1
+};
+
+static const uint8_t ch_slot[18] = {
+    0, 1, 2, 6, 7, 8, 12, 13, 14, 18, 19, 20, 24, 25, 26, 30, 31, 32
+};
+
+
+/*
+    Pan law table
+*/
+
+static const uint16_t panlawtable[] =
+{
+    65535, 65529, 65514, 65489, 65454, 65409, 65354, 65289,
+    65214, 65129, 65034, 64929, 64814, 64689, 64554, 64410,
+    64255, 64091, 63917, 63733, 63540, 63336, 63123, 62901,
+    62668, 62426, 62175, 61914, 61644, 61364, 61075, 60776,
+    60468, 60151, 59825, 59489, 59145, 58791, 58428, 58057,
+    57676, 57287, 56889, 56482, 56067, 55643, 55211, 54770,
+    54320, 53863, 53397, 52923, 52441, 51951, 51453, 50947,
+    50433, 49912, 49383, 48846, 48302, 47750, 47191,
+    46340, /* Center left */
+    46340, /* Center right */
+    45472, 44885, 44291, 43690, 43083, 42469, 41848, 41221,
+    40588, 39948, 39303, 38651, 37994, 37330, 36661, 35986,
+    35306, 34621, 33930, 33234, 32533, 31827, 31116, 30400,
+    29680, 28955, 28225, 27492, 26754, 26012, 25266, 24516,
+    23762, 23005, 22244, 21480, 20713, 19942, 19169, 18392,
+    17613, 16831, 16046, 15259, 14469, 13678, 12884, 12088,
+    11291, 10492, 9691, 8888, 8085, 7280, 6473, 5666,
+    4858, 4050, 3240, 2431, 1620, 810, 0
+};
+
+/*
+    Envelope generator
+*/
+
+enum envelope_gen_num
+{
+    envelope_gen_num_attack = 0,
+    envelope_gen_num_decay = 1,
+    envelope_gen_num_sustain = 2,
+    envelope_gen_num_release = 3
+};
+
+static void OPL3SoA_EnvelopeUpdateKSL(opl3soa_chip *chip, uint8_t slot)
+{
+    const opl3soa_channel *channel = &chip->channel[chip->slot_ch[slot]];
+    int16_t ksl = (kslrom[channel->f_num >> 6u] << 2)
+               - ((0x08 - channel->block) << 5);
+    if (ksl < 0)
+    {
+        ksl = 0;
+    }
+    chip->eg_ksl[slot] = (uint8_t)ksl;
+    chip->eg_tlksl[slot] = (chip->reg_tl[slot] << 2)
+                         + (chip->eg_ksl[slot] >> kslshift[chip->reg_ksl[slot]]);
+}
+
+/* Cache values depending on the channel frequency and the operator registers */
+static void OPL3SoA_SlotUpdateFreq(opl3soa_chip *chip, uint8_t slot)
+{
+    const opl3soa_channel *channel = &chip->channel[chip->slot_ch[slot]];
+    uint32_t basefreq = (channel->f_num << channel->block) >> 1;
+    chip->pg_inc[slot] = (basefreq * mt[chip->reg_mult[slot]]) >> 1;
+    chip->eg_ks[slot] = channel->ksv >> ((chip->reg_ksr[slot] ^ 1) << 1);
+}
+
+#if defined(OPL3SOA_SSE2)
+static void OPL3SoA_EnvelopeCalc(opl3soa_chip *chip)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i ones = _mm_cmpeq_epi16(zero, zero);
+    const __m128i c1 = _mm_set1_epi16(1);
+    const __m128i c2 = _mm_set1_epi16(2);
+    const __m128i c3 = _mm_set1_epi16(3);
+    const __m128i c4 = _mm_set1_epi16(4);
+    const __m128i c12 = _mm_set1_epi16(12);
+    const __m128i c13 = _mm_set1_epi16(13);
+    const __m128i c14 = _mm_set1_epi16(14);
+    const __m128i c15 = _mm_set1_epi16(15);
+    const __m128i c1f8 = _mm_set1_epi16(0x1f8);
+    const __m128i c1ff = _mm_set1_epi16(0x1ff);
+    const __m128i tremolo = _mm_set1_epi16(chip->tremolo);
+    const __m128i eg_add = _mm_set1_epi16(chip->eg_add);
+    const __m128i eg_state = _mm_set1_epi16(chip->eg_state);
+    const __m128i eg_state_mask = chip->eg_state ? ones : zero;
+    const uint8_t timer = chip->timer & 0x03u;
+    const __m128i step0 = _mm_set1_epi16(eg_incstep[0][timer]);
+    const __m128i step1 = _mm_set1_epi16(eg_incstep[1][timer]);
+    const __m128i step2 = _mm_set1_epi16(eg_incstep[2][timer]);
+    const __m128i step3 = _mm_set1_epi16(eg_incstep[3][timer]);
+    uint8_t i;
+
+    for (i = 0; i < OPL3SOA_SLOTS; i += 8)
+    {
+        __m128i rout = _mm_loadu_si128((const __m128i *)&chip->eg_rout[i]);
+        __m128i gen = _mm_loadu_si128((const __m128i *)&chip->eg_gen[i]);
+        __m128i key_off = _mm_cmpeq_epi16(_mm_loadu_si128((const __m128i *)&chip->key[i]), zero);
+        __m128i key_on = _mm_andnot_si128(key_off, ones);
+        __m128i out, is_att, is_dec, is_sus, is_rel, reset, sel_ar, sel_rr, reg_rate, nonzero;
+        __m128i rate, rate_hi, rate_lo, eg_shift, lo_shift, hi_shift, step, is_low, shift;
+        __m128i rate_max, eg_off, shift_nz, rout_v, force_off, rout_zero, not_rout;
+        __m128i att_on, att_inc, to_sus, to_dec, lin_on, lin_inc;
+
+        out = _mm_add_epi16(rout, _mm_loadu_si128((const __m128i *)&chip->eg_tlksl[i]));
+        out = _mm_add_epi16(out, _mm_and_si128(tremolo, _mm_loadu_si128((const __m128i *)&chip->eg_trem[i])));
+        out = _mm_min_epi16(out, c1ff);
+        _mm_storeu_si128((__m128i *)&chip->eg_out[i], _mm_slli_epi16(out, 3));
+
+        is_att = _mm_cmpeq_epi16(gen, zero);
+        is_dec = _mm_cmpeq_epi16(gen, c1);
+        is_sus = _mm_cmpeq_epi16(gen, c2);
+        is_rel = _mm_cmpeq_epi16(gen, c3);
+        reset = _mm_and_si128(key_on, is_rel);
+
+        /* Select rate */
+        sel_ar = _mm_or_si128(reset, is_att);
+        sel_rr = _mm_and_si128(is_sus, _mm_cmpeq_epi16(_mm_loadu_si128((const __m128i *)&chip->eg_type[i]), zero));
+        sel_rr = _mm_or_si128(sel_rr, _mm_andnot_si128(reset, is_rel));
+        reg_rate = _mm_and_si128(sel_ar, _mm_loadu_si128((const __m128i *)&chip->eg_ar[i]));
+        reg_rate = _mm_or_si128(reg_rate, _mm_and_si128(is_dec, _mm_loadu_si128((const __m128i *)&chip->eg_dr[i])));
+        reg_rate = _mm_or_si128(reg_rate, _mm_and_si128(sel_rr, _mm_loadu_si128((const __m128i *)&chip->eg_rr[i])));
+        nonzero = _mm_andnot_si128(_mm_cmpeq_epi16(reg_rate, zero), ones);
+
+        rate = _mm_add_epi16(_mm_loadu_si128((const __m128i *)&chip->eg_ks[i]), _mm_slli_epi16(reg_rate, 2));
+        rate_hi = _mm_min_epi16(_mm_srli_epi16(rate, 2), c15);
+        rate_lo = _mm_and_si128(rate, c3);
+        eg_shift = _mm_add_epi16(rate_hi, eg_add);
+
+        /* Low rates */
+        lo_shift = _mm_and_si128(_mm_cmpeq_epi16(eg_shift, c12), c1);
+        lo_shift = _mm_or_si128(lo_shift, _mm_and_si128(_mm_cmpeq_epi16(eg_shift, c13),
+                                                        _mm_and_si128(_mm_srli_epi16(rate_lo, 1), c1)));
+        lo_shift = _mm_or_si128(lo_shift, _mm_and_si128(_mm_cmpeq_epi16(eg_shift, c14),
+                                                        _mm_and_si128(rate_lo, c1)));
+        lo_shift = _mm_and_si128(lo_shift, eg_state_mask);
+
+        /* High rates */
+        step = _mm_and_si128(_mm_cmpeq_epi16(rate_lo, zero), step0);
+        step = _mm_or_si128(step, _mm_and_si128(_mm_cmpeq_epi16(rate_lo, c1), step1));
+        step = _mm_or_si128(step, _mm_and_si128(_mm_cmpeq_epi16(rate_lo, c2), step2));
+        step = _mm_or_si128(step, _mm_and_si128(_mm_cmpeq_epi16(rate_lo, c3), step3));
+        hi_shift = _mm_min_epi16(_mm_add_epi16(_mm_and_si128(rate_hi, c3), step), c3);
+        hi_shift = _mm_or_si128(hi_shift, _mm_and_si128(_mm_cmpeq_epi16(hi_shift, zero), eg_state));
+
+        is_low = _mm_cmplt_epi16(rate_hi, c12);
+        shift = _mm_or_si128(_mm_and_si128(is_low, lo_shift), _mm_andnot_si128(is_low, hi_shift));
+        shift = _mm_and_si128(shift, nonzero);
+        shift_nz = _mm_cmpgt_epi16(shift, zero);
+
+        rate_max = _mm_cmpeq_epi16(rate_hi, c15);
+        eg_off = _mm_cmpeq_epi16(_mm_and_si128(rout, c1f8), c1f8);
+        rout_zero = _mm_cmpeq_epi16(rout, zero);
+
+        /* Instant attack */
+        rout_v = _mm_andnot_si128(_mm_and_si128(reset, rate_max), rout);
+        /* Envelope off */
+        force_off = _mm_andnot_si128(is_att, _mm_andnot_si128(reset, eg_off));
+        rout_v = _mm_or_si128(_mm_andnot_si128(force_off, rout_v), _mm_and_si128(force_off, c1ff));
+
+        /* Attack increment: ~eg_rout >> (4 - shift) */
+        att_on = _mm_andnot_si128(rout_zero, is_att);
+        att_on = _mm_and_si128(att_on, _mm_and_si128(key_on, shift_nz));
+        att_on = _mm_andnot_si128(rate_max, att_on);
+        not_rout = _mm_xor_si128(rout, ones);
+        att_inc = _mm_and_si128(_mm_cmpeq_epi16(shift, c3), _mm_srai_epi16(not_rout, 1));
+        att_inc = _mm_or_si128(att_inc, _mm_and_si128(_mm_cmpeq_epi16(shift, c2), _mm_srai_epi16(not_rout, 2)));
+        att_inc = _mm_or_si128(att_inc, _mm_and_si128(_mm_cmpeq_epi16(shift, c1), _mm_srai_epi16(not_rout, 3)));
+        att_inc = _mm_and_si128(att_inc, att_on);
+
+        /* Decay, sustain and release increment: 1 << (shift - 1) */
+        to_sus = _mm_and_si128(is_dec, _mm_cmpeq_epi16(_mm_srli_epi16(rout, 4),
+                                                       _mm_loadu_si128((const __m128i *)&chip->eg_sl[i])));
+        lin_on = _mm_andnot_si128(_mm_or_si128(to_sus, is_att), ones);
+        lin_on = _mm_and_si128(lin_on, _mm_andnot_si128(_mm_or_si128(eg_off, reset), shift_nz));
+        lin_inc = _mm_and_si128(_mm_cmpeq_epi16(shift, c1), c1);
+        lin_inc = _mm_or_si128(lin_inc, _mm_and_si128(_mm_cmpeq_epi16(shift, c2), c2));
+        lin_inc = _mm_or_si128(lin_inc, _mm_and_si128(_mm_cmpeq_epi16(shift, c3), c4));
+        lin_inc = _mm_and_si128(lin_inc, lin_on);
+
+        rout = _mm_and_si128(_mm_add_epi16(rout_v, _mm_or_si128(att_inc, lin_inc)), c1ff);
+        _mm_storeu_si128((__m128i *)&chip->eg_rout[i], rout);
+
+        /* Generator state */
+        to_dec = _mm_and_si128(is_att, rout_zero);
+        gen = _mm_andnot_si128(_mm_or_si128(to_dec, to_sus), gen);
+        gen = _mm_or_si128(gen, _mm_or_si128(_mm_and_si128(to_dec, c1), _mm_and_si128(to_sus, c2)));
+        gen = _mm_andnot_si128(reset, gen);
+        gen = _mm_or_si128(_mm_andnot_si128(key_off, gen), _mm_and_si128(key_off, c3));
+        _mm_storeu_si128((__m128i *)&chip->eg_gen[i], gen);
+        _mm_storeu_si128((__m128i *)&chip->pg_reset[i], _mm_and_si128(reset, c1));
+    }
+}
+#else
+static void OPL3SoA_EnvelopeCalc(opl3soa_chip *chip)
+{
+    uint8_t slot;
+    for (slot = 0; slot < 36; slot++)
+    {
+        uint8_t nonzero;
+        uint8_t rate;
+        uint8_t rate_hi;
+        uint8_t rate_lo;
+        uint8_t reg_rate = 0;
+        uint8_t eg_shift, shift;
+        uint16_t eg_rout;
+        uint16_t eg_out;
+        int16_t eg_inc;
+        uint8_t eg_off;
+        uint8_t reset = 0;
+        uint16_t eg_gen = chip->eg_gen[slot];
+        uint16_t key = chip->key[slot];
+
+        eg_out = chip->eg_rout[slot] + chip->eg_tlksl[slot]
+               + (chip->tremolo & chip->eg_trem[slot]);
+        if (eg_out > 0x1ff)
+        {
+            eg_out = 0x1ff;
+        }
+        chip->eg_out[slot] = eg_out << 3;
+
+        if (key && eg_gen == envelope_gen_num_release)
+        {
+            reset = 1;
+            reg_rate = (uint8_t)chip->eg_ar[slot];
+        }
+        else
+        {
+            switch (eg_gen)
+            {
+            case envelope_gen_num_attack:
+                reg_rate = (uint8_t)chip->eg_ar[slot];
+                break;
+            case envelope_gen_num_decay:
+                reg_rate = (uint8_t)chip->eg_dr[slot];
+                break;
+            case envelope_gen_num_sustain:
+                if (!chip->eg_type[slot])
+                {
+                    reg_rate = (uint8_t)chip->eg_rr[slot];
+                }
+                break;
+            case envelope_gen_num_release:
+                reg_rate = (uint8_t)chip->eg_rr[slot];
+                break;
+            }
+        }
+        chip->pg_reset[slot] = reset;
+        nonzero = (reg_rate != 0);
+        rate = (uint8_t)chip->eg_ks[slot] + (reg_rate << 2);
+        rate_hi = rate >> 2;
+        rate_lo = rate & 0x03;
+        if (rate_hi & 0x10)
+        {
+            rate_hi = 0x0f;
+        }
+        eg_shift = rate_hi + chip->eg_add;
+        shift = 0;
+        if (nonzero)
+        {
+            if (rate_hi < 12)
+            {
+                if (chip->eg_state)
+                {
+                    switch (eg_shift)
+                    {
+                    case 12:
+                        shift = 1;
+                        break;
+                    case 13:
+                        shift = (rate_lo >> 1) & 0x01;
+                        break;
+                    case 14:
+                        shift = rate_lo & 0x01;
+                        break;
+                    default:
+                        break;
+                    }
+                }
+            }
+            else
+            {
+                shift = (rate_hi & 0x03) + eg_incstep[rate_lo][chip->timer & 0x03u];
+                if (shift & 0x04)
+                {
+                    shift = 0x03;
+                }
+                if (!shift)
+                {
+                    shift = chip->eg_state;
+                }
+            }
+        }
+        eg_rout = chip->eg_rout[slot];
+        eg_inc = 0;
+        eg_off = 0;
+        /* Instant attack */
+        if (reset && rate_hi == 0x0f)
+        {
+            eg_rout = 0x00;
+        }
+        /* Envelope off */
+        if ((chip->eg_rout[slot] & 0x1f8) == 0x1f8)
+        {
+            eg_off = 1;
+        }
+        if (eg_gen != envelope_gen_num_attack && !reset && eg_off)
+        {
+            eg_rout = 0x1ff;
+        }
+        switch (eg_gen)
+        {
+        case envelope_gen_num_attack:
+            if (!chip->eg_rout[slot])
+            {
+                eg_gen = envelope_gen_num_decay;
+            }
+            else if (key && shift > 0 && rate_hi != 0x0f)
+            {
+                eg_inc = ~chip->eg_rout[slot] >> (4 - shift);
+            }
+            break;
+        case envelope_gen_num_decay:
+            if ((chip->eg_rout[slot] >> 4) == chip->eg_sl[slot])
+            {
+                eg_gen = envelope_gen_num_sustain;
+            }
+            else if (!eg_off && !reset && shift > 0)
+            {
+                eg_inc = 1 << (shift - 1);
+            }
+            break;
+        case envelope_gen_num_sustain:
+        case envelope_gen_num_release:
+            if (!eg_off && !reset && shift > 0)
+            {
+                eg_inc = 1 << (shift - 1);
+            }
+            break;
+        }
+        chip->eg_rout[slot] = (eg_rout + eg_inc) & 0x1ff;
+        /* Key off */
+        if (reset)
+        {
+            eg_gen = envelope_gen_num_attack;
+        }
+        if (!key)
+        {
+            eg_gen = envelope_gen_num_release;
+        }
+        chip->eg_gen[slot] = eg_gen;
+    }
+}
+#endif
+
+static void OPL3SoA_EnvelopeKeyOn(opl3soa_chip *chip, uint8_t slot, uint8_t type)
+{
+    chip->key[slot] |= type;
+}
+
+static void OPL3SoA_EnvelopeKeyOff(opl3soa_chip *chip, uint8_t slot, uint8_t type)
+{
+    chip->key[slot] &= ~type;
+}
+
+/*
+    Phase Generator
+*/
+
+static uint32_t OPL3SoA_NoiseStep(uint32_t noise, uint8_t steps)
+{
+    uint32_t n_bit;
+    while (steps--)
+    {
+        n_bit = ((noise >> 14) ^ noise) & 0x01;
+        noise = (noise >> 1) | (n_bit << 22);
+    }
+    return noise;
+}
+
+static void OPL3SoA_PhaseGenerate(opl3soa_chip *chip)
+{
+    uint8_t slot;
+    uint8_t vibpos = chip->vibpos;
+    uint32_t noise13, noise16;
+    uint16_t phase;
+    uint8_t rm_xor;
+
+    for (slot = 0; slot < 36; slot++)
+    {
+        uint32_t pg_phase = chip->pg_phase[slot];
+        uint32_t pg_inc = chip->pg_inc[slot];
+        if (chip->reg_vib[slot])
+        {
+            const opl3soa_channel *channel = &chip->channel[chip->slot_ch[slot]];
+            uint16_t f_num = channel->f_num;
+            uint32_t basefreq;
+            int8_t range;
+
+            range = (f_num >> 7) & 7;
+            if (!(vibpos & 3))
+            {
+                range = 0;
+            }
+            else if (vibpos & 1)
+            {
+                range >>= 1;
+            }
+            range >>= chip->vibshift;
+
+            if (vibpos & 4)
+            {
+                range = -range;
+            }
+            f_num += range;
+            basefreq = (f_num << channel->block) >> 1;
+            pg_inc = (basefreq * mt[chip->reg_mult[slot]]) >> 1;
+        }
+        chip->pg_phase_out[slot] = (uint16_t)(pg_phase >> 9);
+        if (chip->pg_reset[slot])
+        {
+            pg_phase = 0;
+        }
+        chip->pg_phase[slot] = pg_phase + pg_inc;
+    }
+
+    /* Noise generator steps once per operator */
+    noise13 = OPL3SoA_NoiseStep(chip->noise, 13);
+    noise16 = OPL3SoA_NoiseStep(noise13, 3);
+    chip->noise = OPL3SoA_NoiseStep(noise16, 36 - 16);
+
+    /* Rhythm mode */
+    phase = chip->pg_phase_out[13]; /* hh */
+    chip->rm_hh_bit2 = (phase >> 2) & 1;
+    chip->rm_hh_bit3 = (phase >> 3) & 1;
+    chip->rm_hh_bit7 = (phase >> 7) & 1;
+    chip->rm_hh_bit8 = (phase >> 8) & 1;
+
+    if (chip->rhy & 0x20)
+    {
+        rm_xor = (chip->rm_hh_bit2 ^ chip->rm_hh_bit7)
+               | (chip->rm_hh_bit3 ^ chip->rm_tc_bit5)
+               | (chip->rm_tc_bit3 ^ chip->rm_tc_bit5);
+        chip->pg_phase_out[13] = rm_xor << 9;
+        if (rm_xor ^ (noise13 & 1))
+        {
+            chip->pg_phase_out[13] |= 0xd0;
+        }
+        else
+        {
+            chip->pg_phase_out[13] |= 0x34;
+        }
+
+        /* sd */
+        chip->pg_phase_out[16] = (chip->rm_hh_bit8 << 9)
+                               | ((chip->rm_hh_bit8 ^ (noise16 & 1)) << 8);
+
+        /* tc */
+        phase = chip->pg_phase_out[17];
+        chip->rm_tc_bit3 = (phase >> 3) & 1;
+        chip->rm_tc_bit5 = (phase >> 5) & 1;
+        rm_xor = (chip->rm_hh_bit2 ^ chip->rm_hh_bit7)
+               | (chip->rm_hh_bit3 ^ chip->rm_tc_bit5)
+               | (chip->rm_tc_bit3 ^ chip->rm_tc_bit5);
+        chip->pg_phase_out[17] = (rm_xor << 9) | 0x80;
+    }
+}
+
+/*
+    Slot
+*/
+
+static void OPL3SoA_SlotWrite20(opl3soa_chip *chip, uint8_t slot, uint8_t data)
+{
+    chip->eg_trem[slot] = ((data >> 7) & 0x01) ? 0xffff : 0;
+    chip->reg_vib[slot] = (data >> 6) & 0x01;
+    chip->eg_type[slot] = (data >> 5) & 0x01;
+    chip->reg_ksr[slot] = (data >> 4) & 0x01;
+    chip->reg_mult[slot] = data & 0x0f;
+    OPL3SoA_SlotUpdateFreq(chip, slot);
+}
+
+static void OPL3SoA_SlotWrite40(opl3soa_chip *chip, uint8_t slot, uint8_t data)
+{
+    chip->reg_ksl[slot] = (data >> 6) & 0x03;
+    chip->reg_tl[slot] = data & 0x3f;
+    OPL3SoA_EnvelopeUpdateKSL(chip, slot);
+}
+
+static void OPL3SoA_SlotWrite60(opl3soa_chip *chip, uint8_t slot, uint8_t data)
+{
+    chip->eg_ar[slot] = (data >> 4) & 0x0f;
+    chip->eg_dr[slot] = data & 0x0f;
+}
+
+static void OPL3SoA_SlotWrite80(opl3soa_chip *chip, uint8_t slot, uint8_t data)
+{
+    chip->eg_sl[slot] = (data >> 4) & 0x0f;
+    if (chip->eg_sl[slot] == 0x0f)
+    {
+        chip->eg_sl[slot] = 0x1f;
+    }
+    chip->eg_rr[slot] = data & 0x0f;
+}
+
+static void OPL3SoA_SlotWriteE0(opl3soa_chip *chip, uint8_t slot, uint8_t data)
+{
+    uint8_t wf = data & 0x07;
+    if (chip->newm == 0x00)
+    {
+        wf &= 0x03;
+    }
+    chip->reg_wf[slot] = wf;
+
+    switch (wf)
+    {
+    case 1:
+    case 4:
+    case 5:
+        chip->maskzero[slot] = 0x200;
+        break;
+    case 3:
+        chip->maskzero[slot] = 0x100;
+        break;
+    default:
+        chip->maskzero[slot] = 0;
+        break;
+    }
+
+    switch (wf)
+    {
+    case 4:
+        chip->signpos[slot] = (31-8);  /* sigext of (phase & 0x100) */
+        break;
+    case 0:
+    case 6:
+    case 7:
+        chip->signpos[slot] = (31-9);  /* sigext of (phase & 0x200) */
+        break;
+    default:
+        chip->signpos[slot] = (31-16);  /* set "neg" to zero */
+        break;
+    }
+
+    switch (wf)
+    {
+    case 4:
+    case 5:
+        chip->phaseshift[slot] = 1;
+        break;
+    case 6:
+        chip->phaseshift[slot] = 16; /* set phase to zero and flag for non-sin wave */
+        break;
+    case 7:
+        chip->phaseshift[slot] = 32; /* no shift (work by mod 32), but flag for non-sin wave */
+        break;
+    default:
+        chip->phaseshift[slot] = 0;
+        break;
+    }
+}
+
+/* Feedback and waveform generation, operators are processed one by one */
+static void OPL3SoA_ProcessSlots(opl3soa_chip *chip, uint8_t from, uint8_t to)
+{
+    uint8_t slot;
+    for (slot = from; slot < to; slot++)
+    {
+        uint8_t fb = chip->channel[chip->slot_ch[slot]].fb;
+        uint16_t phase;
+        uint32_t neg, level;
+        uint8_t phaseshift;
+
+        if (fb != 0x00)
+        {
+            chip->fbmod[slot] = (chip->prout[slot] + chip->out[slot]) >> (0x09 - fb);
+        }
+        else
+        {
+            chip->fbmod[slot] = 0;
+        }
+        chip->prout[slot] = chip->out[slot];
+
+        phase = chip->pg_phase_out[slot] + *chip->mod[slot];
+
+        /* Fast paths for mute segments */
+        if (phase & chip->maskzero[slot])
+        {
+            chip->out[slot] = 0;
+            continue;
+        }
+
+        neg = (int32_t)((uint32_t)phase << chip->signpos[slot]) >> 31;
+        phaseshift = chip->phaseshift[slot];
+        level = chip->eg_out[slot];
+
+        phase <<= phaseshift;
+        if (phaseshift <= 1)
+        {
+            level += logsinrom[phase & 0x1ff];
+        }
+        else
+        {
+            level += ((phase ^ neg) & 0x3ff) << 3;
+        }
+        chip->out[slot] = exprom[level & 0xff] >> (level >> 8) ^ neg;
+    }
+}
+
+/*
+    Channel
+*/
+
+static void OPL3SoA_ChannelSetupAlg(opl3soa_chip *chip, opl3soa_channel *channel);
+
+static void OPL3SoA_ChannelUpdateRhythm(opl3soa_chip *chip, uint8_t data)
+{
+    opl3soa_channel *channel6;
+    opl3soa_channel *channel7;
+    opl3soa_channel *channel8;
+    uint8_t chnum;
+
+    chip->rhy = data & 0x3f;
+    if (chip->rhy & 0x20)
+    {
+        channel6 = &chip->channel[6];
+        channel7 = &chip->channel[7];
+        channel8 = &chip->channel[8];
+        channel6->out[0] = &chip->out[channel6->slotz[1]];
+        channel6->out[1] = &chip->out[channel6->slotz[1]];
+        channel6->out[2] = &chip->zeromod;
+        channel6->out[3] = &chip->zeromod;
+        channel7->out[0] = &chip->out[channel7->slotz[0]];
+        channel7->out[1] = &chip->out[channel7->slotz[0]];
+        channel7->out[2] = &chip->out[channel7->slotz[1]];
+        channel7->out[3] = &chip->out[channel7->slotz[1]];
+        channel8->out[0] = &chip->out[channel8->slotz[0]];
+        channel8->out[1] = &chip->out[channel8->slotz[0]];
+        channel8->out[2] = &chip->out[channel8->slotz[1]];
+        channel8->out[3] = &chip->out[channel8->slotz[1]];
+        for (chnum = 6; chnum < 9; chnum++)
+        {
+            chip->channel[chnum].chtype = ch_drum;
+        }
+        OPL3SoA_ChannelSetupAlg(chip, channel6);
+        OPL3SoA_ChannelSetupAlg(chip, channel7);
+        OPL3SoA_ChannelSetupAlg(chip, channel8);
+        /* hh */
+        if (chip->rhy & 0x01)
+        {
+            OPL3SoA_EnvelopeKeyOn(chip, channel7->slotz[0], egk_drum);
+        }
+        else
+        {
+            OPL3SoA_EnvelopeKeyOff(chip, channel7->slotz[0], egk_drum);
+        }
+        /* tc */
+        if (chip->rhy & 0x02)
+        {
+            OPL3SoA_EnvelopeKeyOn(chip, channel8->slotz[1], egk_drum);
+        }
+        else
+        {
+            OPL3SoA_EnvelopeKeyOff(chip, channel8->slotz[1], egk_drum);
+        }
+        /* tom */
+        if (chip->rhy & 0x04)
+        {
+            OPL3SoA_EnvelopeKeyOn(chip, channel8->slotz[0], egk_drum);
+        }
+        else
+        {
+            OPL3SoA_EnvelopeKeyOff(chip, channel8->slotz[0], egk_drum);
+        }
+        /* sd */
+        if (chip->rhy & 0x08)
+        {
+            OPL3SoA_EnvelopeKeyOn(chip, channel7->slotz[1], egk_drum);
+        }
+        else
+        {
+            OPL3SoA_EnvelopeKeyOff(chip, channel7->slotz[1], egk_drum);
+        }
+        /* bd */
+        if (chip->rhy & 0x10)
+        {
+            OPL3SoA_EnvelopeKeyOn(chip, channel6->slotz[0], egk_drum);
+            OPL3SoA_EnvelopeKeyOn(chip, channel6->slotz[1], egk_drum);
+        }
+        else
+        {
+            OPL3SoA_EnvelopeKeyOff(chip, channel6->slotz[0], egk_drum);
+            OPL3SoA_EnvelopeKeyOff(chip, channel6->slotz[1], egk_drum);
+        }
+    }
+    else
+    {
+        for (chnum = 6; chnum < 9; chnum++)
+        {
+            chip->channel[chnum].chtype = ch_2op;
+            OPL3SoA_ChannelSetupAlg(chip, &chip->channel[chnum]);
+            OPL3SoA_EnvelopeKeyOff(chip, chip->channel[chnum].slotz[0], egk_drum);
+            OPL3SoA_EnvelopeKeyOff(chip, chip->channel[chnum].slotz[1], egk_drum);
+        }
+    }
+}
+
+static void OPL3SoA_ChannelUpdateFreq(opl3soa_chip *chip, opl3soa_channel *channel)
+{
+    OPL3SoA_EnvelopeUpdateKSL(chip, channel->slotz[0]);
+    OPL3SoA_EnvelopeUpdateKSL(chip, channel->slotz[1]);
+    OPL3SoA_SlotUpdateFreq(chip, channel->slotz[0]);
+    OPL3SoA_SlotUpdateFreq(chip, channel->slotz[1]);
+}
+
+static void OPL3SoA_ChannelWriteA0(opl3soa_chip *chip, opl3soa_channel *channel, uint8_t data)
+{
+    opl3soa_channel *pair;
+    if (chip->newm && channel->chtype == ch_4op2)
+    {
+        return;
+    }
+    channel->f_num = (channel->f_num & 0x300) | data;
+    channel->ksv = (channel->block << 1)
+                 | ((channel->f_num >> (0x09 - chip->nts)) & 0x01);
+    OPL3SoA_ChannelUpdateFreq(chip, channel);
+    if (chip->newm && channel->chtype == ch_4op)
+    {
+        pair = &chip->channel[channel->pair];
+        pair->f_num = channel->f_num;
+        pair->ksv = channel->ksv;
+        OPL3SoA_ChannelUpdateFreq(chip, pair);
+    }
+}
+
+static void OPL3SoA_ChannelWriteB0(opl3soa_chip *chip, opl3soa_channel *channel, uint8_t data)
+{
+    opl3soa_channel *pair;
+    if (chip->newm && channel->chtype == ch_4op2)
+    {
+        return;
+    }
+    channel->f_num = (channel->f_num & 0xff) | ((data & 0x03) << 8);
+    channel->block = (data >> 2) & 0x07;
+    channel->ksv = (channel->block << 1)
+                 | ((channel->f_num >> (0x09 - chip->nts)) & 0x01);
+    OPL3SoA_ChannelUpdateFreq(chip, channel);
+    if (chip->newm && channel->chtype == ch_4op)
+    {
+        pair = &chip->channel[channel->pair];
+        pair->f_num = channel->f_num;
+        pair->block = channel->block;
+        pair->ksv = channel->ksv;
+        OPL3SoA_ChannelUpdateFreq(chip, pair);
+    }
+}
+
+static void OPL3SoA_ChannelSetupAlg(opl3soa_chip *chip, opl3soa_channel *channel)
+{
+    opl3soa_channel *pair = &chip->channel[channel->pair];
+    uint8_t s0 = channel->slotz[0];
+    uint8_t s1 = channel->slotz[1];
+    uint8_t p0 = pair->slotz[0];
+    uint8_t p1 = pair->slotz[1];
+
+    if (channel->chtype == ch_drum)
+    {
+        if (channel->ch_num == 7 || channel->ch_num == 8)
+        {
+            chip->mod[s0] = &chip->zeromod;
+            chip->mod[s1] = &chip->zeromod;
+            return;
+        }
+        switch (channel->alg & 0x01)
+        {
+        case 0x00:
+            chip->mod[s0] = &chip->fbmod[s0];
+            chip->mod[s1] = &chip->out[s0];
+            break;
+        case 0x01:
+            chip->mod[s0] = &chip->fbmod[s0];
+            chip->mod[s1] = &chip->zeromod;
+            break;
+        }
+        return;
+    }
+    if (channel->alg & 0x08)
+    {
+        return;
+    }
+    if (channel->alg & 0x04)
+    {
+        pair->out[0] = &chip->zeromod;
+        pair->out[1] = &chip->zeromod;
+        pair->out[2] = &chip->zeromod;
+        pair->out[3] = &chip->zeromod;
+        switch (channel->alg & 0x03)
+        {
+        case 0x00:
+            chip->mod[p0] = &chip->fbmod[p0];
+            chip->mod[p1] = &chip->out[p0];
+            chip->mod[s0] = &chip->out[p1];
+            chip->mod[s1] = &chip->out[s0];
+            channel->out[0] = &chip->out[s1];
+            channel->out[1] = &chip->zeromod;
+            channel->out[2] = &chip->zeromod;
+            channel->out[3] = &chip->zeromod;
+            break;
+        case 0x01:
+            chip->mod[p0] = &chip->fbmod[p0];
+            chip->mod[p1] = &chip->out[p0];
+            chip->mod[s0] = &chip->zeromod;
+            chip->mod[s1] = &chip->out[s0];
+            channel->out[0] = &chip->out[p1];
+            channel->out[1] = &chip->out[s1];
+            channel->out[2] = &chip->zeromod;
+            channel->out[3] = &chip->zeromod;
+            break;
+        case 0x02:
+            chip->mod[p0] = &chip->fbmod[p0];
+            chip->mod[p1] = &chip->zeromod;
+            chip->mod[s0] = &chip->out[p1];
+            chip->mod[s1] = &chip->out[s0];
+            channel->out[0] = &chip->out[p0];
+            channel->out[1] = &chip->out[s1];
+            channel->out[2] = &chip->zeromod;
+            channel->out[3] = &chip->zeromod;
+            break;
+        case 0x03:
+            chip->mod[p0] = &chip->fbmod[p0];
+            chip->mod[p1] = &chip->zeromod;
+            chip->mod[s0] = &chip->out[p1];
+            chip->mod[s1] = &chip->zeromod;
+            channel->out[0] = &chip->out[p0];
+            channel->out[1] = &chip->out[s0];
+            channel->out[2] = &chip->out[s1];
+            channel->out[3] = &chip->zeromod;
+            break;
+        }
+    }
+    else
+    {
+        switch (channel->alg & 0x01)
+        {
+        case 0x00:
+            chip->mod[s0] = &chip->fbmod[s0];
+            chip->mod[s1] = &chip->out[s0];
+            channel->out[0] = &chip->out[s1];
+            channel->out[1] = &chip->zeromod;
+            channel->out[2] = &chip->zeromod;
+            channel->out[3] = &chip->zeromod;
+            break;
+        case 0x01:
+            chip->mod[s0] = &chip->fbmod[s0];
+            chip->mod[s1] = &chip->zeromod;
+            channel->out[0] = &chip->out[s0];
+            channel->out[1] = &chip->out[s1];
+            channel->out[2] = &chip->zeromod;
+            channel->out[3] = &chip->zeromod;
+            break;
+        }
+    }
+}
+
+static void OPL3SoA_ChannelUpdateAlg(opl3soa_chip *chip, opl3soa_channel *channel)
+{
+    opl3soa_channel *pair = &chip->channel[channel->pair];
+    channel->alg = channel->con;
+    if (chip->newm)
+    {
+        if (channel->chtype == ch_4op)
+        {
+            pair->alg = 0x04 | (channel->con << 1) | (pair->con);
+            channel->alg = 0x08;
+            OPL3SoA_ChannelSetupAlg(chip, pair);
+        }
+        else if (channel->chtype == ch_4op2)
+        {
+            channel->alg = 0x04 | (pair->con << 1) | (channel->con);
+            pair->alg = 0x08;
+            OPL3SoA_ChannelSetupAlg(chip, channel);
+        }
+        else
+        {
+            OPL3SoA_ChannelSetupAlg(chip, channel);
+        }
+    }
+    else
+    {
+        OPL3SoA_ChannelSetupAlg(chip, channel);
+    }
+}
+
+static void OPL3SoA_ChannelWriteC0(opl3soa_chip *chip, opl3soa_channel *channel, uint8_t data)
+{
+    channel->fb = (data & 0x0e) >> 1;
+    channel->con = data & 0x01;
+    OPL3SoA_ChannelUpdateAlg(chip, channel);
+    if (chip->newm)
+    {
+        channel->cha = ((data >> 4) & 0x01) ? ~0 : 0;
+        channel->chb = ((data >> 5) & 0x01) ? ~0 : 0;
+        channel->chc = ((data >> 6) & 0x01) ? ~0 : 0;
+        channel->chd = ((data >> 7) & 0x01) ? ~0 : 0;
+    }
+    else
+    {
+        channel->cha = channel->chb = (uint16_t)~0;
+        channel->chc = channel->chd = 0;
+    }
+}
+
+static void OPL3SoA_ChannelKeyOn(opl3soa_chip *chip, opl3soa_channel *channel)
+{
+    if (chip->newm)
+    {
+        if (channel->chtype == ch_4op)
+        {
+            opl3soa_channel *pair = &chip->channel[channel->pair];
+            OPL3SoA_EnvelopeKeyOn(chip, channel->slotz[0], egk_norm);
+            OPL3SoA_EnvelopeKeyOn(chip, channel->slotz[1], egk_norm);
+            OPL3SoA_EnvelopeKeyOn(chip, pair->slotz[0], egk_norm);
+            OPL3SoA_EnvelopeKeyOn(chip, pair->slotz[1], egk_norm);
+        }
+        else if (channel->chtype == ch_2op || channel->chtype == ch_drum)
+        {
+            OPL3SoA_EnvelopeKeyOn(chip, channel->slotz[0], egk_norm);
+            OPL3SoA_EnvelopeKeyOn(chip, channel->slotz[1], egk_norm);
+        }
+    }
+    else
+    {
+        OPL3SoA_EnvelopeKeyOn(chip, channel->slotz[0], egk_norm);
+        OPL3SoA_EnvelopeKeyOn(chip, channel->slotz[1], egk_norm);
+    }
+}
+
+static void OPL3SoA_ChannelKeyOff(opl3soa_chip *chip, opl3soa_channel *channel)
+{
+    if (chip->newm)
+    {
+        if (channel->chtype == ch_4op)
+        {
+            opl3soa_channel *pair = &chip->channel[channel->pair];
+            OPL3SoA_EnvelopeKeyOff(chip, channel->slotz[0], egk_norm);
+            OPL3SoA_EnvelopeKeyOff(chip, channel->slotz[1], egk_norm);
+            OPL3SoA_EnvelopeKeyOff(chip, pair->slotz[0], egk_norm);
+            OPL3SoA_EnvelopeKeyOff(chip, pair->slotz[1], egk_norm);
+        }
+        else if (channel->chtype == ch_2op || channel->chtype == ch_drum)
+        {
+            OPL3SoA_EnvelopeKeyOff(chip, channel->slotz[0], egk_norm);
+            OPL3SoA_EnvelopeKeyOff(chip, channel->slotz[1], egk_norm);
+        }
+    }
+    else
+    {
+        OPL3SoA_EnvelopeKeyOff(chip, channel->slotz[0], egk_norm);
+        OPL3SoA_EnvelopeKeyOff(chip, channel->slotz[1], egk_norm);
+    }
+}
+
+static void OPL3SoA_ChannelSet4Op(opl3soa_chip *chip, uint8_t data)
+{
+    uint8_t bit;
+    uint8_t chnum;
+    for (bit = 0; bit < 6; bit++)
+    {
+        chnum = bit;
+        if (bit >= 3)
+        {
+            chnum += 9 - 3;
+        }
+        if ((data >> bit) & 0x01)
+        {
+            chip->channel[chnum].chtype = ch_4op;
+            chip->channel[chnum + 3u].chtype = ch_4op2;
+            OPL3SoA_ChannelUpdateAlg(chip, &chip->channel[chnum]);
+        }
+        else
+        {
+            chip->channel[chnum].chtype = ch_2op;
+            chip->channel[chnum + 3u].chtype = ch_2op;
+            OPL3SoA_ChannelUpdateAlg(chip, &chip->channel[chnum]);
+            OPL3SoA_ChannelUpdateAlg(chip, &chip->channel[chnum + 3u]);
+        }
+    }
+}
+
+static int16_t OPL3SoA_ClipSample(int32_t sample)
+{
+    if (sample > 32767)
+    {
+        sample = 32767;
+    }
+    else if (sample < -32768)
+    {
+        sample = -32768;
+    }
+    return (int16_t)sample;
+}
+
+static void OPL3SoA_MixChannels(opl3soa_chip *chip, int32_t *mix, uint8_t right)
+{
+    const opl3soa_channel *channel;
+    int16_t **out;
+    int16_t accm;
+    uint8_t ii;
+
+    mix[0] = mix[1] = 0;
+    for (ii = 0; ii < 18; ii++)
+    {
+        channel = &chip->channel[ii];
+        out = (int16_t **)channel->out;
+        accm = *out[0] + *out[1] + *out[2] + *out[3];
+        if (right)
+        {
+            mix[0] += (int16_t)((accm * channel->chr / 65535) & channel->chb);
+            mix[1] += (int16_t)(accm & channel->chd);
+        }
+        else
+        {
+            mix[0] += (int16_t)((accm * channel->chl / 65535) & channel->cha);
+            mix[1] += (int16_t)(accm & channel->chc);
+        }
+    }
+}
+
+void OPL3SoA_Generate4Ch(opl3soa_chip *chip, int16_t *buf4)
+{
+    opl3soa_writebuf *writebuf;
+    int32_t mix[2];
+    uint8_t shift = 0;
+
+    buf4[1] = OPL3SoA_ClipSample(chip->mixbuff[1]);
+    buf4[3] = OPL3SoA_ClipSample(chip->mixbuff[3]);
+
+    /* Envelope and phase generators don't depend on the operator outputs */
+    OPL3SoA_EnvelopeCalc(chip);
+    OPL3SoA_PhaseGenerate(chip);
+
+    /* Quirk: Some FM channels are output one sample later on the left side than the right. */
+    OPL3SoA_ProcessSlots(chip, 0, 15);
+
+    OPL3SoA_MixChannels(chip, mix, 0);
+    chip->mixbuff[0] = mix[0];
+    chip->mixbuff[2] = mix[1];
+
+    OPL3SoA_ProcessSlots(chip, 15, 18);
+
+    buf4[0] = OPL3SoA_ClipSample(chip->mixbuff[0]);
+    buf4[2] = OPL3SoA_ClipSample(chip->mixbuff[2]);
+
+    OPL3SoA_ProcessSlots(chip, 18, 33);
+
+    OPL3SoA_MixChannels(chip, mix, 1);
+    chip->mixbuff[1] = mix[0];
+    chip->mixbuff[3] = mix[1];
+
+    OPL3SoA_ProcessSlots(chip, 33, 36);
+
+    if ((chip->timer & 0x3f) == 0x3f)
+    {
+        chip->tremolopos = (chip->tremolopos + 1) % 210;
+    }
+    if (chip->tremolopos < 105)
+    {
+        chip->tremolo = chip->tremolopos >> chip->tremoloshift;
+    }
+    else
+    {
+        chip->tremolo = (210 - chip->tremolopos) >> chip->tremoloshift;
+    }
+
+    if ((chip->timer & 0x3ff) == 0x3ff)
+    {
+        chip->vibpos = (chip->vibpos + 1) & 7;
+    }
+
+    chip->timer++;
+
+    chip->eg_add = 0;
+    if (chip->eg_timer)
+    {
+        while (shift < 36 && ((chip->eg_timer >> shift) & 1) == 0)
+        {
+            shift++;
+        }
+        if (shift > 12)
+        {
+            chip->eg_add = 0;
+        }
+        else
+        {
+            chip->eg_add = shift + 1;
+        }
+    }
+
+    if (chip->eg_timerrem || chip->eg_state)
+    {
+        if (chip->eg_timer == UINT64_C(0xfffffffff))
+        {
+            chip->eg_timer = 0;
+            chip->eg_timerrem = 1;
+        }
+        else
+        {
+            chip->eg_timer++;
+            chip->eg_timerrem = 0;
+        }
+    }
+
+    chip->eg_state ^= 1;
+
+    while ((writebuf = &chip->writebuf[chip->writebuf_cur]), writebuf->time <= chip->writebuf_samplecnt)
+    {
+        if (!(writebuf->reg & 0x200))
+        {
+            break;
+        }
+        writebuf->reg &= 0x1ff;
+        OPL3SoA_WriteReg(chip, writebuf->reg, writebuf->data);
+        chip->writebuf_cur = (chip->writebuf_cur + 1) % OPL3SOA_WRITEBUF_SIZE;
+    }
+    chip->writebuf_samplecnt++;
+}
+
+void OPL3SoA_Generate(opl3soa_chip *chip, int16_t *buf)
+{
+    int16_t samples[4];
+    OPL3SoA_Generate4Ch(chip, samples);
+    buf[0] = samples[0];
+    buf[1] = samples[1];
+}
+
+void OPL3SoA_Reset(opl3soa_chip *chip)
+{
+    opl3soa_channel *channel;
+    uint8_t slotnum;
+    uint8_t channum;
+    uint8_t local_ch_slot;
+
+    memset(chip, 0, sizeof(opl3soa_chip));
+    for (slotnum = 0; slotnum < OPL3SOA_SLOTS; slotnum++)
+    {
+        chip->mod[slotnum] = &chip->zeromod;
+        chip->eg_rout[slotnum] = 0x1ff;
+        chip->eg_out[slotnum] = 0x1ff << 3;
+        chip->eg_gen[slotnum] = envelope_gen_num_release;
+        chip->signpos[slotnum] = (31-9);  /* for wf=0 need use sigext of (phase & 0x200) */
+    }
+    for (channum = 0; channum < 18; channum++)
+    {
+        channel = &chip->channel[channum];
+        local_ch_slot = ch_slot[channum];
+        channel->slotz[0] = local_ch_slot;
+        channel->slotz[1] = local_ch_slot + 3u;
+        chip->slot_ch[local_ch_slot] = channum;
+        chip->slot_ch[local_ch_slot + 3u] = channum;
+        if ((channum % 9) < 3)
+        {
+            channel->pair = channum + 3u;
+        }
+        else if ((channum % 9) < 6)
+        {
+            channel->pair = channum - 3u;
+        }
+        else
+        {
+            channel->pair = channum; /* Has no pair, never used */
+        }
+        channel->out[0] = &chip->zeromod;
+        channel->out[1] = &chip->zeromod;
+        channel->out[2] = &chip->zeromod;
+        channel->out[3] = &chip->zeromod;
+        channel->chtype = ch_2op;
+        channel->cha = 0xffff;
+        channel->chb = 0xffff;
+        channel->chl = 46340;
+        channel->chr = 46340;
+        channel->ch_num = channum;
+        OPL3SoA_ChannelSetupAlg(chip, channel);
+    }
+    chip->noise = 1;
+    chip->tremoloshift = 4;
+    chip->vibshift = 1;
+}
+
+static void OPL3SoA_ChannelWritePan(opl3soa_channel *channel, uint8_t data)
+{
+    channel->chl = panlawtable[data & 0x7F];
+    channel->chr = panlawtable[0x7F - (data & 0x7F)];
+}
+
+void OPL3SoA_WritePan(opl3soa_chip *chip, uint16_t reg, uint8_t v)
+{
+    uint8_t high = (reg >> 8) & 0x01;
+    uint8_t regm = reg & 0xff;
+    OPL3SoA_ChannelWritePan(&chip->channel[9 * high + (regm & 0x0f)], v);
+}
+
+void OPL3SoA_WriteReg(opl3soa_chip *chip, uint16_t reg, uint8_t v)
+{
+    uint8_t high = (reg >> 8) & 0x01;
+    uint8_t regm = reg & 0xff;
+    switch (regm & 0xf0)
+    {
+    case 0x00:
+        if (high)
+        {
+            switch (regm & 0x0f)
+            {
+            case 0x04:
+                OPL3SoA_ChannelSet4Op(chip, v);
+                break;
+            case 0x05:
+                chip->newm = v & 0x01;
+                break;
+            }
+        }
+        else
+        {
+            switch (regm & 0x0f)
+            {
+            case 0x08:
+                chip->nts = (v >> 6) & 0x01;
+                break;
+            }
+        }
+        break;
+    case 0x20:
+    case 0x30:
+        if (ad_slot[regm & 0x1fu] >= 0)
+        {
+            OPL3SoA_SlotWrite20(chip, 18u * high + ad_slot[regm & 0x1fu], v);
+        }
+        break;
+    case 0x40:
+    case 0x50:
+        if (ad_slot[regm & 0x1fu] >= 0)
+        {
+            OPL3SoA_SlotWrite40(chip, 18u * high + ad_slot[regm & 0x1fu], v);
+        }
+        break;
+    case 0x60:
+    case 0x70:
+        if (ad_slot[regm & 0x1fu] >= 0)
+        {
+            OPL3SoA_SlotWrite60(chip, 18u * high + ad_slot[regm & 0x1fu], v);
+        }
+        break;
+    case 0x80:
+    case 0x90:
+        if (ad_slot[regm & 0x1fu] >= 0)
+        {
+            OPL3SoA_SlotWrite80(chip, 18u * high + ad_slot[regm & 0x1fu], v);
+        }
+        break;
+    case 0xe0:
+    case 0xf0:
+        if (ad_slot[regm & 0x1fu] >= 0)
+        {
+            OPL3SoA_SlotWriteE0(chip, 18u * high + ad_slot[regm & 0x1fu], v);
+        }
+        break;
+    case 0xa0:
+        if ((regm & 0x0f) < 9)
+        {
+            OPL3SoA_ChannelWriteA0(chip, &chip->channel[9u * high + (regm & 0x0fu)], v);
+        }
+        break;
+    case 0xb0:
+        if (regm == 0xbd && !high)
+        {
+            chip->tremoloshift = (((v >> 7) ^ 1) << 1) + 2;
+            chip->vibshift = ((v >> 6) & 0x01) ^ 1;
+            OPL3SoA_ChannelUpdateRhythm(chip, v);
+        }
+        else if ((regm & 0x0f) < 9)
+        {
+            OPL3SoA_ChannelWriteB0(chip, &chip->channel[9u * high + (regm & 0x0fu)], v);
+            if (v & 0x20)
+            {
+                OPL3SoA_ChannelKeyOn(chip, &chip->channel[9u * high + (regm & 0x0fu)]);
+            }
+            else
+            {
+                OPL3SoA_ChannelKeyOff(chip, &chip->channel[9u * high + (regm & 0x0fu)]);
+            }
+        }
+        break;
+    case 0xc0:
+        if ((regm & 0x0f) < 9)
+        {
+            OPL3SoA_ChannelWriteC0(chip, &chip->channel[9u * high + (regm & 0x0fu)], v);
+        }
+        break;
+    }
+}
+
+void OPL3SoA_WriteRegBuffered(opl3soa_chip *chip, uint16_t reg, uint8_t v)
+{
+    uint64_t time1, time2;
+    opl3soa_writebuf *writebuf;
+    uint32_t writebuf_last;
+
+    writebuf_last = chip->writebuf_last;
+    writebuf = &chip->writebuf[writebuf_last];
+
+    if (writebuf->reg & 0x200)
+    {
+        OPL3SoA_WriteReg(chip, writebuf->reg & 0x1ff, writebuf->data);
+
+        chip->writebuf_cur = (writebuf_last + 1) % OPL3SOA_WRITEBUF_SIZE;
+        chip->writebuf_samplecnt = writebuf->time;
+    }
+
+    writebuf->reg = reg | 0x200;
+    writebuf->data = v;
+    time1 = chip->writebuf_lasttime + OPL3SOA_WRITEBUF_DELAY;
+    time2 = chip->writebuf_samplecnt;
+
+    if (time1 < time2)
+    {
+        time1 = time2;
+    }
+
+    writebuf->time = time1;
+    chip->writebuf_lasttime = time1;
+    chip->writebuf_last = (writebuf_last + 1) % OPL3SOA_WRITEBUF_SIZE;
+}
@@ -0,0 +1,150 @@
+/* Nuked OPL3
+ * Copyright (C) 2013-2020 Nuke.YKT
+ *
+ * This file is part of Nuked OPL3.
+ *
+ * Nuked OPL3 is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * Nuked OPL3 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Nuked OPL3. If not, see <https://www.gnu.org/licenses/>.
+
+ *  Nuked OPL3 emulator, structure-of-arrays variant.
+ *
+ *  The same emulation as nukedopl3.c (v 1.8, OPL_FAST_WAVEGEN, no stereo
+ *  extension), but the operator state of the chip is stored in per-field
+ *  arrays. Envelope and phase generators are stepped for all operators at
+ *  once (with SSE2 when available), and only the waveform generation which
+ *  depends on the modulator chain runs operator by operator.
+ *  Output is bit-identical to nukedopl3.c.
+ *
+ * version: 1.8
+ */
+
+#ifndef OPL_OPL3_SOA_H
+#define OPL_OPL3_SOA_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <inttypes.h>
+
+/* Count of operators, padded to the multiple of SIMD vector width */
+#define OPL3SOA_SLOTS       40
+#define OPL3SOA_WRITEBUF_SIZE   1024
+#define OPL3SOA_WRITEBUF_DELAY  2
+
+typedef struct _opl3soa_channel {
+    int16_t *out[4];
+    uint8_t slotz[2];
+    uint8_t pair;
+    uint8_t chtype;
+    uint16_t f_num;
+    uint8_t block;
+    uint8_t fb;
+    uint8_t con;
+    uint8_t alg;
+    uint8_t ksv;
+    uint16_t cha, chb;
+    uint16_t chc, chd;
+    uint16_t chl, chr;
+    uint8_t ch_num;
+} opl3soa_channel;
+
+typedef struct _opl3soa_writebuf {
+    uint64_t time;
+    uint16_t reg;
+    uint8_t data;
+} opl3soa_writebuf;
+
+typedef struct _opl3soa_chip {
+    /* Envelope generator state, 16-bit lanes */
+    uint16_t eg_rout[OPL3SOA_SLOTS];
+    uint16_t eg_out[OPL3SOA_SLOTS];
+    uint16_t eg_gen[OPL3SOA_SLOTS];
+    uint16_t eg_tlksl[OPL3SOA_SLOTS];   /* (tl << 2) + (eg_ksl >> kslshift[ksl]) */
+    uint16_t eg_trem[OPL3SOA_SLOTS];    /* 0xffff when tremolo is on */
+    uint16_t eg_ks[OPL3SOA_SLOTS];      /* Key scale of rate */
+    uint16_t eg_ar[OPL3SOA_SLOTS];
+    uint16_t eg_dr[OPL3SOA_SLOTS];
+    uint16_t eg_rr[OPL3SOA_SLOTS];
+    uint16_t eg_sl[OPL3SOA_SLOTS];
+    uint16_t eg_type[OPL3SOA_SLOTS];
+    uint16_t key[OPL3SOA_SLOTS];
+    uint16_t pg_reset[OPL3SOA_SLOTS];
+
+    /* Phase generator state */
+    uint32_t pg_phase[OPL3SOA_SLOTS];
+    uint32_t pg_inc[OPL3SOA_SLOTS];     /* Phase increment without vibrato */
+    uint16_t pg_phase_out[OPL3SOA_SLOTS];
+
+    /* Waveform generator state */
+    int16_t out[OPL3SOA_SLOTS];
+    int16_t fbmod[OPL3SOA_SLOTS];
+    int16_t prout[OPL3SOA_SLOTS];
+    int16_t *mod[OPL3SOA_SLOTS];
+    uint16_t maskzero[OPL3SOA_SLOTS];
+    uint8_t signpos[OPL3SOA_SLOTS];
+    uint8_t phaseshift[OPL3SOA_SLOTS];
+
+    /* Operator registers */
+    uint8_t reg_vib[OPL3SOA_SLOTS];
+    uint8_t reg_ksr[OPL3SOA_SLOTS];
+    uint8_t reg_mult[OPL3SOA_SLOTS];
+    uint8_t reg_ksl[OPL3SOA_SLOTS];
+    uint8_t reg_tl[OPL3SOA_SLOTS];
+    uint8_t reg_wf[OPL3SOA_SLOTS];
+    uint8_t eg_ksl[OPL3SOA_SLOTS];
+    uint8_t slot_ch[OPL3SOA_SLOTS];
+
+    opl3soa_channel channel[18];
+    uint16_t timer;
+    uint64_t eg_timer;
+    uint8_t eg_timerrem;
+    uint8_t eg_state;
+    uint8_t eg_add;
+    uint8_t newm;
+    uint8_t nts;
+    uint8_t rhy;
+    uint8_t vibpos;
+    uint8_t vibshift;
+    uint8_t tremolo;
+    uint8_t tremolopos;
+    uint8_t tremoloshift;
+    uint32_t noise;
+    int16_t zeromod;
+    int32_t mixbuff[4];
+    uint8_t rm_hh_bit2;
+    uint8_t rm_hh_bit3;
+    uint8_t rm_hh_bit7;
+    uint8_t rm_hh_bit8;
+    uint8_t rm_tc_bit3;
+    uint8_t rm_tc_bit5;
+
+    uint64_t writebuf_samplecnt;
+    uint32_t writebuf_cur;
+    uint32_t writebuf_last;
+    uint64_t writebuf_lasttime;
+    opl3soa_writebuf writebuf[OPL3SOA_WRITEBUF_SIZE];
+} opl3soa_chip;
+
+void OPL3SoA_Generate(opl3soa_chip *chip, int16_t *buf);
+void OPL3SoA_Generate4Ch(opl3soa_chip *chip, int16_t *buf4);
+void OPL3SoA_Reset(opl3soa_chip *chip);
+void OPL3SoA_WriteReg(opl3soa_chip *chip, uint16_t reg, uint8_t v);
+void OPL3SoA_WriteRegBuffered(opl3soa_chip *chip, uint16_t reg, uint8_t v);
+void OPL3SoA_WritePan(opl3soa_chip *chip, uint16_t reg, uint8_t v);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,77 @@
+/*
+ * Interfaces over Yamaha OPL3 (YMF262) chip emulators
+ *
+ * Copyright (c) 2017-2024 Vitaly Novichkov (Wohlstand)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "nuked_opl3_soa.h"
+#include "nuked/nukedopl3_soa.h"
+
+NukedOPL3SoA::NukedOPL3SoA() :
+    OPLChipBaseT()
+{
+    m_chip = new opl3soa_chip;
+    setRate(m_rate);
+}
+
+NukedOPL3SoA::~NukedOPL3SoA()
+{
+    opl3soa_chip *chip_r = reinterpret_cast<opl3soa_chip*>(m_chip);
+    delete chip_r;
+}
+
+void NukedOPL3SoA::setRate(uint32_t rate)
+{
+    OPLChipBaseT::setRate(rate);
+    opl3soa_chip *chip_r = reinterpret_cast<opl3soa_chip*>(m_chip);
+    OPL3SoA_Reset(chip_r);
+}
+
+void NukedOPL3SoA::reset()
+{
+    OPLChipBaseT::reset();
+    opl3soa_chip *chip_r = reinterpret_cast<opl3soa_chip*>(m_chip);
+    OPL3SoA_Reset(chip_r);
+}
+
+void NukedOPL3SoA::writeReg(uint16_t addr, uint8_t data)
+{
+    opl3soa_chip *chip_r = reinterpret_cast<opl3soa_chip*>(m_chip);
+    OPL3SoA_WriteRegBuffered(chip_r, addr, data);
+}
+
+void NukedOPL3SoA::writePan(uint16_t addr, uint8_t data)
+{
+    opl3soa_chip *chip_r = reinterpret_cast<opl3soa_chip*>(m_chip);
+    OPL3SoA_WritePan(chip_r, addr, data);
+}
+
+void NukedOPL3SoA::nativeGenerate(int16_t *frame)
+{
+    opl3soa_chip *chip_r = reinterpret_cast<opl3soa_chip*>(m_chip);
+    OPL3SoA_Generate(chip_r, frame);
+}
+
+const char *NukedOPL3SoA::emulatorName()
+{
+    return "Nuked OPL3 (v 1.8, SIMD)";
+}
+
+OPLChipBase::ChipType NukedOPL3SoA::chipType()
+{
+    return CHIPTYPE_OPL3;
+}
@@ -28,6 +28,7 @@
 
 #include <list>
 #include <vector>
+#include <map>
 
 #include "fraction.hpp"
 #include "file_reader.hpp"
@@ -36,6 +37,11 @@
 //! Helper for unused values
 #define BW_MidiSequencer_UNUSED(x) (void)x;
 
+#ifndef BWMIDI_SEEK_INDEX_INTERVAL
+//! Interval in seconds between keyframes of the seek index
+#define BWMIDI_SEEK_INDEX_INTERVAL 5.0
+#endif
+
 class BW_MidiSequencer
 {
     /**
@@ -285,6 +291,109 @@ class BW_MidiSequencer
      */
     void handleEvent(size_t tk, const MidiEvent &evt, int32_t &status);
 
+    /**
+     * @brief Event which must be sent again to restore the synthesizer state on seek
+     */
+    struct SeekLogEntry
+    {
+        //! Track of the event
+        size_t track;
+        //! Event in the track data
+        const MidiEvent *event;
+        //! Size of the log when a later event did override this one, or ~0 if it's still in effect
+        size_t droppedAt;
+    };
+
+    /**
+     * @brief Builder of the list of events needed to restore the synthesizer state
+     *
+     * An event that sets a state value is dropped once a later event sets the same
+     * value again, unless something has used the value in between. Nothing gets
+     * removed from the log: the dropped event is only marked with the log size at
+     * the moment, so every keyframe shares the same log and keeps its size only.
+     */
+    class SeekLog
+    {
+    public:
+        //! Kinds of the state values
+        enum KeyKinds
+        {
+            KEY_CTRL        = 0x01000000,
+            KEY_PROGRAM     = 0x02000000,
+            KEY_PITCHBEND   = 0x03000000,
+            KEY_CHANTOUCH   = 0x04000000,
+            KEY_NOTETOUCH   = 0x05000000,
+            KEY_RAWOPL      = 0x06000000
+        };
+
+        //! Make the state key of the channel of the track
+        static uint64_t channelKey(size_t track, size_t channel)
+        {
+            return (static_cast<uint64_t>(track) << 32) | (static_cast<uint64_t>(channel & 0xFF) << 16);
+        }
+
+        /**
+         * @brief Append the event which always must be re-sent
+         */
+        void append(size_t track, const MidiEvent *evt);
+        /**
+         * @brief Append the event which sets the state value
+         * @param key State value key, previous event that did set this value gets dropped
+         */
+        void append(size_t track, const MidiEvent *evt, uint64_t key);
+        /**
+         * @brief Mark the state value as used, the last event that did set it will be kept
+         */
+        void use(uint64_t key);
+        /**
+         * @brief Mark all state values of the track as used
+         */
+        void useTrack(size_t track);
+        /**
+         * @brief Get the current size of the log
+         */
+        size_t size() const
+        {
+            return m_events.size();
+        }
+        /**
+         * @brief Take out all logged events
+         */
+        void takeEvents(std::vector<SeekLogEntry> &out);
+
+    private:
+        //! All logged events in order
+        std::vector<SeekLogEntry> m_events;
+        //! Index of the last event which did set the state value
+        std::map<uint64_t, size_t> m_lastSet;
+    };
+
+    /**
+     * @brief Snapshot of the song position to restore on seek
+     */
+    struct SeekKeyframe
+    {
+        //! Position of all tracks
+        Position position;
+        //! Tempo at this position
+        fraction<uint64_t> tempo;
+        //! Count of the seek log events before this position, those of them not dropped yet restore the synthesizer state
+        size_t events;
+    };
+
+    /**
+     * @brief Scan the song and take keyframes of the seek index
+     */
+    void buildSeekIndex();
+
+    /**
+     * @brief Handle the event while building of the seek index
+     * @param tk MIDI track
+     * @param evt MIDI event entry
+     * @param status Recent event type, -1 returned when end of track event was handled.
+     */
+    void recordSeekEvent(size_t tk, const MidiEvent &evt, int32_t &status);
+
 public:
     /**
      * @brief MIDI marker entry
@@ -351,6 +460,15 @@ private:
     //! Loop start point
     Position m_loopBeginPosition;
 
+    //! Keyframes of the seek index, sorted by time
+    std::vector<SeekKeyframe> m_seekIndex;
+    //! Events log shared by all keyframes of the seek index
+    std::vector<SeekLogEntry> m_seekEvents;
+    //! The seek index must be rebuilt before use
+    bool    m_seekIndexDirty;
+    //! Events collector, set while building of the seek index only
+    SeekLog *m_seekLog;
+
     //! Is looping enabled or not
     bool    m_loopEnabled;
     //! Don't process loop: trigger hooks only if they are set
@@ -385,6 +503,8 @@ private:
     fraction<uint64_t> m_invDeltaTicks;
     //! Current tempo
     fraction<uint64_t> m_tempo;
+    //! Tempo at begin of the song
+    fraction<uint64_t> m_beginTempo;
 
     //! Tempo multiplier factor
     double  m_tempoMultiplier;
@@ -0,0 +1,136 @@
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef FIXED_LIST_HPP
+#define FIXED_LIST_HPP
+
+#include <iterator>
+#include <cstddef>
+
+/*
+  fixed_cell: the list cell, holds only the value
+
+  Links are kept aside in the compact index arrays of the list, so
+  walking the list touches a few bytes per element, and the values are
+  stored in one contiguous block inside of the list object itself.
+ */
+template <class T>
+struct fixed_cell
+{
+    T value;
+};
+
+/*
+  fixed_iterator: the list iterator, a pair of list and cell index
+ */
+template <class List, class Cell>
+class fixed_iterator
+{
+public:
+    typedef std::bidirectional_iterator_tag iterator_category;
+    typedef Cell value_type;
+    typedef Cell &reference;
+    typedef Cell *pointer;
+    typedef std::ptrdiff_t difference_type;
+
+    fixed_iterator(List *list = NULL, std::size_t index = 0);
+    bool is_end() const;
+    std::size_t index() const;
+    Cell &operator*() const;
+    Cell *operator->() const;
+    bool operator==(const fixed_iterator &i) const;
+    bool operator!=(const fixed_iterator &i) const;
+    fixed_iterator &operator++();
+    fixed_iterator operator++(int);
+    fixed_iterator &operator--();
+    fixed_iterator operator--(int);
+
+private:
+    List *list_;
+    std::size_t index_;
+};
+
+/*
+  fixed_list: the fixed-capacity index-linked list
+
+  Has the same interface as pl_list, but does no heap allocations, and
+  the position of every element is a stable slot number, which can be
+  used to make a direct lookup table of elements (see slot()).
+ */
+template <class T, std::size_t N>
+class fixed_list
+{
+public:
+    typedef fixed_cell<T> value_type;
+    typedef value_type *pointer;
+    typedef value_type &reference;
+    typedef const value_type *const_pointer;
+    typedef const value_type &const_reference;
+    typedef fixed_iterator<fixed_list, fixed_cell<T> > iterator;
+    typedef fixed_iterator<const fixed_list, const fixed_cell<T> > const_iterator;
+    typedef unsigned short index_type;
+
+    fixed_list();
+
+    std::size_t size() const;
+    std::size_t capacity() const;
+    bool empty() const;
+
+    iterator begin();
+    iterator end();
+    const_iterator begin() const;
+    const_iterator end() const;
+
+    // the element at the given slot, or the end if the slot is free
+    iterator slot(std::size_t index);
+    const_iterator slot(std::size_t index) const;
+
+    void clear();
+
+    fixed_cell<T> &front();
+    const fixed_cell<T> &front() const;
+    fixed_cell<T> &back();
+    const fixed_cell<T> &back() const;
+
+    iterator insert(iterator pos, const T &x);
+    iterator erase(iterator pos);
+    void push_front(const T &x);
+    void push_back(const T &x);
+    void pop_front();
+    void pop_back();
+
+    iterator find(const T &x);
+    const_iterator find(const T &x) const;
+    template <class Pred> iterator find_if(const Pred &p);
+    template <class Pred> const_iterator find_if(const Pred &p) const;
+
+private:
+    friend class fixed_iterator<fixed_list, fixed_cell<T> >;
+    friend class fixed_iterator<const fixed_list, const fixed_cell<T> >;
+
+    enum
+    {
+        // index of the value-less cell which terminates the list
+        endcell = N,
+        // mark of the slot which is not in use
+        freecell = 0xFFFF
+    };
+
+    // the capacity must be representable by the index type
+    typedef char capacity_check[(N > 0 && N < freecell) ? 1 : -1];
+
+    // number of cells in the list
+    std::size_t size_;
+    // head of the singly linked stack of free cells
+    index_type free_;
+    // links of the cells, the last one is the end cell
+    index_type next_[N + 1];
+    index_type prev_[N + 1];
+    // cell values
+    fixed_cell<T> cells_[N];
+};
+
+#include "fixed_list.tcc"
+
+#endif // FIXED_LIST_HPP
@@ -0,0 +1,189 @@
+#include <catch.hpp>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+#include "adlmidi.h"
+#include "adlmidi_bankcache.hpp"
+#include "wopl/wopl_file.h"
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/stat.h>
+#endif
+
+static const char *test_file = "fm_banks/wopl_files/GM-By-J.A.Nguyen-and-Wohlstand.wopl";
+static const char *other_file = "fm_banks/wopl_files/lostvik.wopl";
+
+static bool readFile(const char *path, std::vector<char> &out)
+{
+    FILE *f = fopen(path, "rb");
+    if(!f)
+        return false;
+    fseek(f, 0, SEEK_END);
+    out.resize(static_cast<size_t>(ftell(f)));
+    fseek(f, 0, SEEK_SET);
+    bool ok = fread(out.data(), 1, out.size(), f) == out.size();
+    fclose(f);
+    return ok;
+}
+
+static bool getInstrument(ADL_MIDIPlayer *p, unsigned index, ADL_Instrument &ins)
+{
+    ADL_Bank bank;
+    ADL_BankId id = {0, 0, 0};
+    if(adl_getBank(p, &id, 0, &bank) < 0)
+        return false;
+    return adl_getInstrument(p, &bank, index, &ins) == 0;
+}
+
+static bool sameInstrument(const ADL_Instrument &a, const ADL_Instrument &b)
+{
+    return memcmp(&a, &b, sizeof(ADL_Instrument)) == 0;
+}
+
+TEST_CASE("[BankCache] Players share banks and keep private changes")
+{
+    ADL_MIDIPlayer *a = adl_init(44100);
+    ADL_MIDIPlayer *b = adl_init(44100);
+    REQUIRE(a);
+    REQUIRE(b);
+
+    std::vector<char> data;
+    REQUIRE(readFile(test_file, data));
+
+    REQUIRE(adl_openBankFile(a, test_file) == 0);
+    // Loaded from the memory, same content is found by the hash
+    REQUIRE(adl_openBankData(b, data.data(), static_cast<long>(data.size())) == 0);
+
+    ADL_Instrument insA, insB, orig;
+    for(unsigned i = 0; i < 128; ++i)
+    {
+        REQUIRE(getInstrument(a, i, insA));
+        REQUIRE(getInstrument(b, i, insB));
+        REQUIRE(sameInstrument(insA, insB));
+    }
+
+    // Change of the one player must not affect another
+    REQUIRE(getInstrument(a, 0, orig));
+    ADL_Instrument changed = orig;
+    changed.operators[0].ksl_l_40 ^= 0x3F;
+    changed.note_offset1 += 12;
+    {
+        ADL_Bank bank;
+        ADL_BankId id = {0, 0, 0};
+        REQUIRE(adl_getBank(a, &id, 0, &bank) == 0);
+        REQUIRE(adl_setInstrument(a, &bank, 0, &changed) == 0);
+    }
+
+    REQUIRE(getInstrument(a, 0, insA));
+    REQUIRE(getInstrument(b, 0, insB));
+    REQUIRE(sameInstrument(insA, changed));
+    REQUIRE(sameInstrument(insB, orig));
+
+    // Shared bank stays valid when other players are gone or switched
+    adl_close(a);
+    REQUIRE(getInstrument(b, 1, insB));
+
+    ADL_MIDIPlayer *c = adl_init(44100);
+    REQUIRE(c);
+    REQUIRE(adl_openBankFile(c, test_file) == 0);
+    REQUIRE(getInstrument(c, 0, insA));
+    REQUIRE(sameInstrument(insA, orig));
+
+    REQUIRE(adl_openBankFile(c, other_file) == 0);
+    REQUIRE(getInstrument(b, 0, insB));
+    REQUIRE(sameInstrument(insB, orig));
+
+    adl_close(b);
+    adl_close(c);
+}
+
+TEST_CASE("[BankCache] Data with the same hash is not taken for the cached bank")
+{
+    std::vector<char> data;
+    REQUIRE(readFile(test_file, data));
+
+    BankCacheEntry *entry = new BankCacheEntry;
+    entry->size = data.size();
+    entry->hash = BankCache::hashData(data.data(), data.size());
+    entry->data = data;
+    const BankCacheEntry *cached = BankCache::insert(entry);
+    REQUIRE(cached);
+
+    // Pretend the other bank has collided with this one
+    std::vector<char> other(data);
+    other[other.size() / 2] ^= 0x55;
+    REQUIRE(BankCache::findData(cached->hash, other.data(), other.size()) == NULL);
+
+    const BankCacheEntry *same = BankCache::findData(cached->hash, data.data(), data.size());
+    REQUIRE(same == cached);
+    BankCache::release(same);
+    BankCache::release(cached);
+}
+
+TEST_CASE("[BankCache] Switch to the embedded bank releases the cached bank")
+{
+    ADL_MIDIPlayer *a = adl_init(44100);
+    REQUIRE(a);
+    REQUIRE(adl_openBankFile(a, other_file) == 0);
+
+    const BankCacheEntry *e = BankCache::findFile(other_file);
+    REQUIRE(e);
+    BankCache::release(e);
+
+    REQUIRE(adl_setBank(a, 0) == 0);
+    REQUIRE(BankCache::findFile(other_file) == NULL);
+
+    adl_close(a);
+}
+
+#if !defined(_WIN32)
+static bool writeFileAt(const char *path, const std::vector<char> &data, long nsec)
+{
+    FILE *f = fopen(path, "wb");
+    if(!f)
+        return false;
+    bool ok = fwrite(data.data(), 1, data.size(), f) == data.size();
+    fclose(f);
+    struct timespec times[2];
+    times[0].tv_sec = times[1].tv_sec = 1500000000;
+    times[0].tv_nsec = times[1].tv_nsec = nsec;
+    return ok && utimensat(AT_FDCWD, path, times, 0) == 0;
+}
+
+TEST_CASE("[BankCache] File rewritten within the same second is loaded again")
+{
+    const char *path = "bank_cache_rewrite.wopl";
+    std::vector<char> data;
+    REQUIRE(readFile(test_file, data));
+
+    ADL_MIDIPlayer *a = adl_init(44100);
+    ADL_MIDIPlayer *b = adl_init(44100);
+    REQUIRE(a);
+    REQUIRE(b);
+
+    REQUIRE(writeFileAt(path, data, 100));
+    REQUIRE(adl_openBankFile(a, path) == 0);
+    ADL_Instrument before, after;
+    REQUIRE(getInstrument(a, 0, before));
+
+    // Same size and the same second, only the first instrument differs
+    int err = 0;
+    WOPLFile *wopl = WOPL_LoadBankFromMem(data.data(), data.size(), &err);
+    REQUIRE(wopl);
+    wopl->banks_melodic[0].ins[0].operators[0].ksl_l_40 ^= 0x3F;
+    std::vector<char> changed(WOPL_CalculateBankFileSize(wopl, wopl->version));
+    REQUIRE(changed.size() == data.size());
+    REQUIRE(WOPL_SaveBankToMem(wopl, changed.data(), changed.size(), wopl->version, 0) == 0);
+    WOPL_Free(wopl);
+    REQUIRE(writeFileAt(path, changed, 200));
+
+    REQUIRE(adl_openBankFile(b, path) == 0);
+    REQUIRE(getInstrument(b, 0, after));
+    REQUIRE(!sameInstrument(before, after));
+    REQUIRE(after.operators[0].ksl_l_40 == (before.operators[0].ksl_l_40 ^ 0x3F));
+
+    adl_close(a);
+    adl_close(b);
+    remove(path);
+}
+#endif
@@ -0,0 +1,237 @@
+#include <catch.hpp>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "adlmidi.h"
+#include "adlmidi_private.hpp"
+#include "chips/common/chip_trace.hpp"
+#include "chips/opl_chip_base.h"
+#ifndef ADLMIDI_DISABLE_NUKED_EMULATOR
+#include "chips/nuked_opl3.h"
+#include "chips/nuked_opl3_v174.h"
+#include "chips/nuked_opl3_soa.h"
+#endif
+#ifndef ADLMIDI_DISABLE_DOSBOX_EMULATOR
+#include "chips/dosbox_opl3.h"
+#endif
+#ifndef ADLMIDI_DISABLE_OPAL_EMULATOR
+#include "chips/opal_opl3.h"
+#endif
+#ifndef ADLMIDI_DISABLE_JAVA_EMULATOR
+#include "chips/java_opl3.h"
+#endif
+
+static const char *test_song = "projects/watcom/onestop.mid";
+static const char *trace_path = TRACE_OUTPUT_DIR "/onestop.trc";
+
+static OPLChipBase *createChip(int emulator)
+{
+    switch(emulator)
+    {
+#ifndef ADLMIDI_DISABLE_NUKED_EMULATOR
+    case ADLMIDI_EMU_NUKED:
+        return new NukedOPL3;
+    case ADLMIDI_EMU_NUKED_174:
+        return new NukedOPL3v174;
+    case ADLMIDI_EMU_NUKED_SIMD:
+        return new NukedOPL3SoA;
+#endif
+#ifndef ADLMIDI_DISABLE_DOSBOX_EMULATOR
+    case ADLMIDI_EMU_DOSBOX:
+        return new DosBoxOPL3;
+#endif
+#ifndef ADLMIDI_DISABLE_OPAL_EMULATOR
+    case ADLMIDI_EMU_OPAL:
+        return new OpalOPL3;
+#endif
+#ifndef ADLMIDI_DISABLE_JAVA_EMULATOR
+    case ADLMIDI_EMU_JAVA:
+        return new JavaOPL3;
+#endif
+    default:
+        return NULL;
+    }
+}
+
+static bool isAvailable(int emulator)
+{
+    OPLChipBase *chip = createChip(emulator);
+    delete chip;
+    return chip != NULL;
+}
+
+struct ReplayStats
+{
+    size_t frames;
+    size_t writes;
+};
+
+// Drives the chips by the trace, the output is mixed the same way as the library does
+static bool replay(ChipTraceReader &trace, int emulator, std::vector<int16_t> *out, ReplayStats &stats)
+{
+    std::vector<AdlMIDI_SPtr<OPLChipBase> > chips;
+    int32_t buf[1024];
+    ChipTraceEvent e;
+
+    stats.frames = 0;
+    stats.writes = 0;
+    trace.rewind();
+
+    while(trace.next(e))
+    {
+        switch(e.type)
+        {
+        case ChipTraceEvent::Reset:
+            if(e.family != ChipTrace_OPL3)
+                return false;
+            chips.clear();
+            for(uint32_t i = 0; i < e.chips; ++i)
+            {
+                OPLChipBase *chip = createChip(emulator);
+                if(!chip)
+                    return false;
+                chips.push_back(AdlMIDI_SPtr<OPLChipBase>(chip));
+                chip->setChipId(i);
+                chip->setRate(e.rate);
+                if(e.flags & ChipTrace_PcmRate)
+                    chip->setRunningAtPcmRate(true);
+            }
+            break;
+
+        case ChipTraceEvent::Write:
+            if(e.chip >= chips.size())
+                return false;
+            chips[e.chip]->writeReg(e.address, e.value);
+            ++stats.writes;
+            break;
+
+        case ChipTraceEvent::Pan:
+            if(e.chip >= chips.size())
+                return false;
+            chips[e.chip]->writePan(e.address, e.value);
+            break;
+
+        case ChipTraceEvent::Wait:
+            for(uint32_t left = e.frames; left > 0;)
+            {
+                size_t frames = (left > 512) ? 512 : left;
+                if(chips.size() == 1)
+                    chips[0]->generate32(buf, frames);
+                else
+                {
+                    std::memset(buf, 0, sizeof(buf));
+                    for(size_t i = 0; i < chips.size(); ++i)
+                        chips[i]->generateAndMix32(buf, frames);
+                }
+                if(out)
+                {
+                    for(size_t i = 0; i < 2 * frames; ++i)
+                        out->push_back(static_cast<int16_t>(adl_cvtS16(buf[i])));
+                }
+                stats.frames += frames;
+                left -= static_cast<uint32_t>(frames);
+            }
+            break;
+
+        default:
+            break;
+        }
+    }
+
+    return true;
+}
+
+static std::vector<int16_t> recordSong(int emulator, int chips, double seconds)
+{
+    std::vector<int16_t> output;
+    ADL_MIDIPlayer *p = adl_init(44100);
+    REQUIRE(p);
+    REQUIRE(adl_switchEmulator(p, emulator) == 0);
+    REQUIRE(adl_setNumChips(p, chips) == 0);
+    REQUIRE(adl_startChipTrace(p, trace_path) == 0);
+    REQUIRE(adl_openFile(p, test_song) == 0);
+
+    short buf[4096];
+    size_t total = static_cast<size_t>(seconds * 44100) * 2;
+    while(output.size() < total)
+    {
+        int got = adl_play(p, 4096, buf);
+        if(got <= 0)
+            break;
+        output.insert(output.end(), buf, buf + got);
+    }
+
+    adl_stopChipTrace(p);
+    adl_close(p);
+    return output;
+}
+
+TEST_CASE("[ChipTrace] Replay of the trace is bit-exact")
+{
+    const int emulator = ADLMIDI_EMU_DOSBOX;
+    if(!isAvailable(emulator))
+        return;
+
+    std::vector<int16_t> recorded = recordSong(emulator, 2, 10.0);
+    REQUIRE(!recorded.empty());
+
+    ChipTraceReader trace;
+    REQUIRE(trace.open(trace_path));
+
+    std::vector<int16_t> replayed;
+    ReplayStats stats;
+    REQUIRE(replay(trace, emulator, &replayed, stats));
+    REQUIRE(stats.writes > 0);
+    REQUIRE(replayed.size() == recorded.size());
+    REQUIRE(std::memcmp(replayed.data(), recorded.data(), recorded.size() * sizeof(int16_t)) == 0);
+}
+
+TEST_CASE("[ChipTrace] Broken traces are rejected")
+{
+    ChipTraceReader trace;
+    const char garbage[] = "MThd\0\0\0\6\0\1\0\2";
+    REQUIRE(!trace.openData(garbage, sizeof(garbage)));
+
+    // Truncated write record
+    const uint8_t truncated[] =
+    {
+        'C', 'H', 'I', 'P', 'T', 'R', 'C', 0x1A, 1, 0, 0, 0,
+        ChipTraceEvent::Write, 0, 0, 0x20
+    };
+    REQUIRE(trace.openData(truncated, sizeof(truncated)));
+    ChipTraceEvent e;
+    REQUIRE(!trace.next(e));
+}
+
+TEST_CASE("[ChipTrace] Chip-only throughput benchmark")
+{
+    if(!isAvailable(ADLMIDI_EMU_DOSBOX))
+        return;
+
+    recordSong(ADLMIDI_EMU_DOSBOX, 1, 20.0);
+
+    ChipTraceReader trace;
+    REQUIRE(trace.open(trace_path));
+
+    for(int emulator = 0; emulator < ADLMIDI_EMU_end; ++emulator)
+    {
+        OPLChipBase *probe = createChip(emulator);
+        if(!probe)
+            continue;
+        std::string name = probe->emulatorName();
+        delete probe;
+
+        ReplayStats stats;
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        REQUIRE(replay(trace, emulator, NULL, stats));
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        std::printf("%-32s %u frames, %u writes: %.2f ms (%.1fx realtime)\n",
+                    name.c_str(),
+                    static_cast<unsigned>(stats.frames), static_cast<unsigned>(stats.writes),
+                    ms, (stats.frames / 44.1) / (ms > 0.0 ? ms : 1.0));
+    }
+}
@@ -0,0 +1,198 @@
+#include <catch.hpp>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "adlmidi_midiplay.hpp"
+#include "structures/pl_list.hpp"
+
+typedef MIDIplay::MIDIchannel Channel;
+typedef Channel::NoteInfo NoteInfo;
+typedef MIDIplay::AdlChannel::Location Location;
+typedef MIDIplay::AdlChannel::LocationData LocationData;
+
+struct StormEvent
+{
+    bool on;
+    uint8_t note;
+};
+
+// Keys are pressed and released by clusters, like in the dense orchestral MIDIs
+static std::vector<StormEvent> makeStorm(size_t count)
+{
+    std::mt19937 rng(12345);
+    std::vector<StormEvent> events(count);
+    for(size_t i = 0; i < count; ++i)
+    {
+        events[i].on = (rng() % 3) != 0;
+        events[i].note = static_cast<uint8_t>(32 + rng() % 64);
+    }
+    return events;
+}
+
+static double elapsedMs(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// The lookup how it was done with the linked list of the active notes
+static void runReference(pl_list<NoteInfo> &notes, const std::vector<StormEvent> &events)
+{
+    for(size_t i = 0; i < events.size(); ++i)
+    {
+        const StormEvent &e = events[i];
+        pl_list<NoteInfo>::iterator it = notes.find_if(NoteInfo::FindPredicate(e.note));
+        if(e.on && it.is_end())
+        {
+            NoteInfo ni;
+            ni.note = e.note;
+            notes.push_back(ni);
+        }
+        else if(!e.on && !it.is_end())
+            notes.erase(it);
+    }
+}
+
+static void runChannel(Channel &channel, const std::vector<StormEvent> &events)
+{
+    for(size_t i = 0; i < events.size(); ++i)
+    {
+        const StormEvent &e = events[i];
+        if(e.on)
+            channel.ensure_find_or_create_activenote(e.note);
+        else
+        {
+            Channel::notes_iterator it = channel.find_activenote(e.note);
+            if(!it.is_end())
+                channel.activenotes.erase(it);
+        }
+    }
+}
+
+TEST_CASE("[MIDIchannel] Note lookup matches the linear search")
+{
+    Channel channel;
+    pl_list<NoteInfo> reference(128);
+
+    std::vector<StormEvent> events = makeStorm(20000);
+    for(size_t i = 0; i < events.size(); ++i)
+    {
+        std::vector<StormEvent> one(1, events[i]);
+        runReference(reference, one);
+        runChannel(channel, one);
+
+        REQUIRE(channel.activenotes.size() == reference.size());
+        pl_list<NoteInfo>::iterator r = reference.begin();
+        Channel::notes_iterator c = channel.activenotes.begin();
+        for(; !r.is_end(); ++r, ++c)
+        {
+            REQUIRE(!c.is_end());
+            REQUIRE(c->value.note == r->value.note);
+        }
+        REQUIRE(c.is_end());
+    }
+
+    for(unsigned note = 0; note < 128; ++note)
+    {
+        bool inReference = !reference.find_if(NoteInfo::FindPredicate(note)).is_end();
+        REQUIRE(channel.find_activenote(note).is_end() == !inReference);
+    }
+}
+
+TEST_CASE("[MIDIchannel] Erasing while iterating")
+{
+    Channel channel;
+    for(unsigned note = 0; note < 128; ++note)
+        channel.ensure_find_or_create_activenote(note);
+    REQUIRE(channel.activenotes.size() == 128);
+    REQUIRE_THROWS_AS(channel.find_or_create_activenote(200), std::bad_alloc);
+
+    for(Channel::notes_iterator inext = channel.activenotes.begin(); !inext.is_end();)
+    {
+        Channel::notes_iterator i(inext++);
+        if(i->value.note % 2)
+            channel.activenotes.erase(i);
+    }
+
+    REQUIRE(channel.activenotes.size() == 64);
+    for(unsigned note = 0; note < 128; ++note)
+        REQUIRE(channel.find_activenote(note).is_end() == ((note % 2) != 0));
+
+    // Freed slots are reused, and the lookup table must follow them
+    for(unsigned note = 1; note < 128; note += 2)
+        REQUIRE(channel.ensure_find_or_create_activenote(note)->value.note == note);
+    for(unsigned note = 0; note < 128; ++note)
+        REQUIRE(channel.find_activenote(note)->value.note == note);
+}
+
+TEST_CASE("[MIDIchannel] Note-on/off storm benchmark")
+{
+    const std::vector<StormEvent> events = makeStorm(2000000);
+
+    pl_list<NoteInfo> reference(128);
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    runReference(reference, events);
+    double referenceMs = elapsedMs(start);
+
+    Channel channel;
+    start = std::chrono::steady_clock::now();
+    runChannel(channel, events);
+    double channelMs = elapsedMs(start);
+
+    REQUIRE(channel.activenotes.size() == reference.size());
+    std::printf("Note storm of %u events: linked list %.2f ms, slot table %.2f ms\n",
+                static_cast<unsigned>(events.size()), referenceMs, channelMs);
+}
+
+TEST_CASE("[AdlChannel] Users storm benchmark")
+{
+    std::mt19937 rng(54321);
+    std::vector<Location> locs(1000000);
+    for(size_t i = 0; i < locs.size(); ++i)
+    {
+        locs[i].MidCh = static_cast<uint16_t>(rng() % 16);
+        locs[i].note = static_cast<uint8_t>(rng() % 8);
+    }
+
+    pl_list<LocationData> reference(128);
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for(size_t i = 0; i < locs.size(); ++i)
+    {
+        pl_list<LocationData>::iterator it = reference.find_if(LocationData::FindPredicate(locs[i]));
+        if(it.is_end())
+        {
+            LocationData ld;
+            ld.loc = locs[i];
+            reference.push_back(ld);
+        }
+        else
+            reference.erase(it);
+    }
+    double referenceMs = elapsedMs(start);
+
+    MIDIplay::AdlChannel channel;
+    start = std::chrono::steady_clock::now();
+    for(size_t i = 0; i < locs.size(); ++i)
+    {
+        MIDIplay::AdlChannel::users_iterator it = channel.find_user(locs[i]);
+        if(it.is_end())
+        {
+            LocationData ld;
+            ld.loc = locs[i];
+            channel.users.push_back(ld);
+        }
+        else
+            channel.users.erase(it);
+    }
+    double channelMs = elapsedMs(start);
+
+    REQUIRE(channel.users.size() == reference.size());
+    pl_list<LocationData>::iterator r = reference.begin();
+    MIDIplay::AdlChannel::users_iterator c = channel.users.begin();
+    for(; !r.is_end(); ++r, ++c)
+        REQUIRE(c->value.loc == r->value.loc);
+
+    std::printf("Users storm of %u events: linked list %.2f ms, fixed list %.2f ms\n",
+                static_cast<unsigned>(locs.size()), referenceMs, channelMs);
+}
@@ -0,0 +1,408 @@
+#include <catch.hpp>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <cstring>
+#include <vector>
+#include "chips/nuked/nukedopl3.h"
+#include "chips/nuked/nukedopl3_soa.h"
+#include "wopl/wopl_file.h"
+
+/*
+ * The SoA core must produce exactly the same output as the reference one
+ */
+
+struct ChipPair
+{
+    opl3_chip ref;
+    opl3soa_chip soa;
+
+    ChipPair()
+    {
+        std::memset(&ref, 0, sizeof(ref));
+        OPL3_Reset(&ref, 49716);
+        OPL3SoA_Reset(&soa);
+    }
+
+    void write(uint16_t reg, uint8_t data)
+    {
+        OPL3_WriteRegBuffered(&ref, reg, data);
+        OPL3SoA_WriteRegBuffered(&soa, reg, data);
+    }
+
+    void pan(uint16_t reg, uint8_t data)
+    {
+        OPL3_WritePan(&ref, reg, data);
+        OPL3SoA_WritePan(&soa, reg, data);
+    }
+
+    //! Generates given count of samples, returns count of mismatching ones
+    size_t compare(size_t samples)
+    {
+        size_t mismatches = 0;
+        for(size_t i = 0; i < samples; ++i)
+        {
+            int16_t a[4], b[4];
+            OPL3_Generate4Ch(&ref, a);
+            OPL3SoA_Generate4Ch(&soa, b);
+            if(std::memcmp(a, b, sizeof(a)) != 0)
+                ++mismatches;
+        }
+        return mismatches;
+    }
+};
+
+static const uint8_t s_slotOffsets[18] =
+{
+    0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x08, 0x09, 0x0A,
+    0x0B, 0x0C, 0x0D, 0x10, 0x11, 0x12, 0x13, 0x14, 0x15
+};
+
+static uint16_t randomReg(std::mt19937 &rng)
+{
+    static const uint8_t groups[] = {0x20, 0x40, 0x60, 0x80, 0xE0};
+    uint16_t high = (rng() & 1) ? 0x100 : 0x000;
+    switch(rng() % 8)
+    {
+    default:
+        return high | (groups[rng() % 5] + s_slotOffsets[rng() % 18]);
+    case 5:
+        return high | (0xA0 + rng() % 9);
+    case 6:
+        return high | (0xB0 + rng() % 9);
+    case 7:
+        return high | (0xC0 + rng() % 9);
+    }
+}
+
+TEST_CASE("[NukedSimd] Random register writes")
+{
+    std::mt19937 rng(1234);
+
+    for(int round = 0; round < 8; ++round)
+    {
+        ChipPair chips;
+        chips.write(0x105, round & 1);
+        chips.write(0x104, (round & 2) ? 0x3F : 0x00);
+
+        for(int step = 0; step < 4000; ++step)
+        {
+            unsigned writes = rng() % 4;
+            for(unsigned w = 0; w < writes; ++w)
+                chips.write(randomReg(rng), (uint8_t)rng());
+            if(rng() % 64 == 0)
+                chips.write(0x0BD, (uint8_t)rng());
+            if(rng() % 128 == 0)
+                chips.write(0x008, (uint8_t)rng());
+            if(rng() % 256 == 0)
+                chips.pan(0xC0 + (rng() % 9), (uint8_t)rng());
+            REQUIRE(chips.compare(1 + rng() % 16) == 0);
+        }
+    }
+}
+
+static void setupVoice(ChipPair &chips, uint16_t high, unsigned ch, uint8_t mod, uint8_t car)
+{
+    const unsigned base = (ch / 3) * 8 + (ch % 3);
+    chips.write(high | (0x20 + base), mod);
+    chips.write(high | (0x23 + base), car);
+    chips.write(high | (0x40 + base), 0x10);
+    chips.write(high | (0x43 + base), 0x00);
+    chips.write(high | (0x60 + base), 0xF3);
+    chips.write(high | (0x63 + base), 0xC4);
+    chips.write(high | (0x80 + base), 0x35);
+    chips.write(high | (0x83 + base), 0x27);
+    chips.write(high | (0xE0 + base), ch & 3);
+    chips.write(high | (0xE3 + base), (ch + 1) & 7);
+    chips.write(high | (0xC0 + ch), 0x30 | ((ch & 7) << 1) | (ch & 1));
+}
+
+TEST_CASE("[NukedSimd] Notes with vibrato, tremolo, 4-op and rhythm")
+{
+    ChipPair chips;
+    chips.write(0x105, 0x01);
+    chips.write(0x104, 0x09);
+    chips.write(0x0BD, 0xC0);
+
+    for(unsigned ch = 0; ch < 9; ++ch)
+    {
+        setupVoice(chips, 0x000, ch, 0xE1, 0x61);
+        setupVoice(chips, 0x100, ch, 0x21, 0xA2);
+    }
+
+    for(unsigned note = 0; note < 24; ++note)
+    {
+        for(unsigned ch = 0; ch < 6; ++ch)
+        {
+            uint16_t high = (note & 1) ? 0x100 : 0x000;
+            uint16_t fnum = 0x157 + note * 13 + ch * 7;
+            chips.write(high | (0xA0 + ch), fnum & 0xFF);
+            chips.write(high | (0xB0 + ch), 0x20 | ((note % 8) << 2) | (fnum >> 8));
+        }
+        // Toggle percussion keys
+        chips.write(0x0BD, 0xE0 | (note & 0x1F));
+        REQUIRE(chips.compare(2000) == 0);
+
+        for(unsigned ch = 0; ch < 6; ++ch)
+        {
+            uint16_t high = (note & 1) ? 0x100 : 0x000;
+            chips.write(high | (0xB0 + ch), (note % 8) << 2);
+        }
+        chips.write(0x0BD, 0xE0);
+        REQUIRE(chips.compare(1500) == 0);
+    }
+
+    // Leave the rhythm mode and keep playing the melodic channels
+    chips.write(0x0BD, 0x00);
+    for(unsigned ch = 6; ch < 9; ++ch)
+    {
+        chips.write(0x0A0 + ch, 0x98);
+        chips.write(0x0B0 + ch, 0x31);
+    }
+    REQUIRE(chips.compare(20000) == 0);
+}
+
+/*
+ * Real instruments of the bundled banks, played the same way as the library
+ * lays them out: 4-op voices on the channel pairs, 2-op and pseudo 4-op ones
+ * on the rest of channels, rhythm-mode drums on the percussion channels.
+ */
+
+static const char *s_bankFiles[] =
+{
+    "fm_banks/wopl_files/Apogee-IMF-90.wopl",
+    "fm_banks/wopl_files/DMXOPL3-by-sneakernets-GS.wopl",
+    "fm_banks/wopl_files/GM-By-J.A.Nguyen-and-Wohlstand.wopl",
+    "fm_banks/wopl_files/lostvik.wopl",
+    "fm_banks/wopl_files/msadlib.wopl",
+    "fm_banks/wopl_files/Wohlstand's-modded-FatMan.wopl"
+};
+
+static WOPLFile *loadBank(const char *path)
+{
+    FILE *f = std::fopen(path, "rb");
+    if(!f)
+        return NULL;
+    std::vector<char> data;
+    std::fseek(f, 0, SEEK_END);
+    data.resize(static_cast<size_t>(std::ftell(f)));
+    std::fseek(f, 0, SEEK_SET);
+    bool ok = std::fread(data.data(), 1, data.size(), f) == data.size();
+    std::fclose(f);
+    if(!ok)
+        return NULL;
+    int error = 0;
+    return WOPL_LoadBankFromMem(data.data(), data.size(), &error);
+}
+
+static void writeOperator(ChipPair &chips, uint16_t slot, const WOPLOperator &op)
+{
+    chips.write(slot + 0x20, op.avekf_20);
+    chips.write(slot + 0x40, op.ksl_l_40);
+    chips.write(slot + 0x60, op.atdec_60);
+    chips.write(slot + 0x80, op.susrel_80);
+    chips.write(slot + 0xE0, op.waveform_E0);
+}
+
+//! Operator pair of the channel 0...17: carrier and modulator
+static void writeVoice(ChipPair &chips, unsigned ch, const WOPLOperator *ops, uint8_t feedconn)
+{
+    const uint16_t high = (ch >= 9) ? 0x100 : 0x000;
+    const unsigned c = ch % 9;
+    const uint16_t mod = high | ((c / 3) * 8 + (c % 3));
+    writeOperator(chips, mod + 3, ops[0]);
+    writeOperator(chips, mod, ops[1]);
+    chips.write(high | (0xC0 + c), feedconn | 0x30);
+}
+
+static void keyOn(ChipPair &chips, unsigned ch, int note)
+{
+    const uint16_t high = (ch >= 9) ? 0x100 : 0x000;
+    const unsigned c = ch % 9;
+    if(note < 0)
+        note = 0;
+    else if(note > 127)
+        note = 127;
+    double hz = 440.0 * std::pow(2.0, (note - 69) / 12.0);
+    unsigned block = 0;
+    double fnum = hz * 1048576.0 / 49716.0;
+    while(fnum >= 1024.0 && block < 7)
+    {
+        fnum /= 2.0;
+        ++block;
+    }
+    unsigned f = (fnum >= 1024.0) ? 1023 : static_cast<unsigned>(fnum);
+    chips.write(high | (0xA0 + c), f & 0xFF);
+    chips.write(high | (0xB0 + c), 0x20 | (block << 2) | (f >> 8));
+}
+
+static void keyOff(ChipPair &chips, unsigned ch)
+{
+    const uint16_t high = (ch >= 9) ? 0x100 : 0x000;
+    chips.write(high | (0xB0 + (ch % 9)), 0x00);
+}
+
+// Channels of the 4-op pairs (the second channel is +3) and of the 2-op voices
+static const unsigned s_pairChannels[6] = {0, 1, 2, 9, 10, 11};
+static const unsigned s_twoOpChannels[6] = {6, 7, 8, 15, 16, 17};
+
+//! Plays every instrument of the bank, returns count of mismatching samples
+static size_t playMelodic(ChipPair &chips, const WOPLBank &bank, bool drums)
+{
+    size_t mismatches = 0;
+    std::vector<unsigned> used;
+    unsigned pairs = 0, twoOps = 0;
+
+    for(unsigned i = 0; i <= 128; ++i)
+    {
+        const WOPLInstrument *ins = (i < 128) ? &bank.ins[i] : NULL;
+        bool real4op = false, pseudo4op = false;
+        if(ins)
+        {
+            if((ins->inst_flags & WOPL_Ins_IsBlank) || (ins->inst_flags & WOPL_RhythmModeMask))
+                continue;
+            real4op = (ins->inst_flags & WOPL_Ins_4op) && !(ins->inst_flags & WOPL_Ins_Pseudo4op);
+            pseudo4op = (ins->inst_flags & WOPL_Ins_4op) && (ins->inst_flags & WOPL_Ins_Pseudo4op);
+        }
+
+        // Play the gathered chord once the channels run out
+        if(!ins || (real4op && pairs == 6) || (!real4op && twoOps + (pseudo4op ? 2 : 1) > 6))
+        {
+            mismatches += chips.compare(1800);
+            for(size_t u = 0; u < used.size(); ++u)
+                keyOff(chips, used[u]);
+            mismatches += chips.compare(700);
+            used.clear();
+            pairs = twoOps = 0;
+            if(!ins)
+                break;
+        }
+
+        const int note = drums ? (ins->percussion_key_number ? ins->percussion_key_number : 60)
+                               : static_cast<int>(36 + (i * 7) % 48);
+
+        if(real4op)
+        {
+            unsigned ch = s_pairChannels[pairs++];
+            writeVoice(chips, ch, &ins->operators[0], ins->fb_conn1_C0);
+            writeVoice(chips, ch + 3, &ins->operators[2], ins->fb_conn2_C0);
+            keyOn(chips, ch, note + ins->note_offset1);
+            keyOn(chips, ch + 3, note + ins->note_offset1);
+            used.push_back(ch);
+            used.push_back(ch + 3);
+        }
+        else
+        {
+            unsigned ch = s_twoOpChannels[twoOps++];
+            writeVoice(chips, ch, &ins->operators[0], ins->fb_conn1_C0);
+            keyOn(chips, ch, note + ins->note_offset1);
+            used.push_back(ch);
+            if(pseudo4op)
+            {
+                ch = s_twoOpChannels[twoOps++];
+                writeVoice(chips, ch, &ins->operators[2], ins->fb_conn2_C0);
+                keyOn(chips, ch, note + ins->note_offset2);
+                used.push_back(ch);
+            }
+        }
+    }
+
+    return mismatches;
+}
+
+//! Plays rhythm-mode drums of the bank, returns count of mismatching samples
+static size_t playRhythm(ChipPair &chips, const WOPLBank &bank, uint8_t depth, unsigned &played)
+{
+    size_t mismatches = 0;
+    chips.write(0x0BD, depth | 0x20);
+
+    for(unsigned i = 0; i < 128; ++i)
+    {
+        const WOPLInstrument &ins = bank.ins[i];
+        const uint8_t rm = ins.inst_flags & WOPL_RhythmModeMask;
+        if(!rm || (ins.inst_flags & WOPL_Ins_IsBlank))
+            continue;
+
+        const int note = ins.percussion_key_number ? ins.percussion_key_number : 60;
+        uint8_t key = 0;
+        switch(rm)
+        {
+        case WOPL_RM_BassDrum:
+            writeVoice(chips, 6, &ins.operators[0], ins.fb_conn1_C0);
+            keyOn(chips, 6, note);
+            key = 0x10;
+            break;
+        case WOPL_RM_Snare:
+            writeOperator(chips, 0x14, ins.operators[0]);
+            keyOn(chips, 7, note);
+            key = 0x08;
+            break;
+        case WOPL_RM_TomTom:
+            writeOperator(chips, 0x12, ins.operators[0]);
+            keyOn(chips, 8, note);
+            key = 0x04;
+            break;
+        case WOPL_RM_Cymbal:
+            writeOperator(chips, 0x15, ins.operators[0]);
+            keyOn(chips, 8, note);
+            key = 0x02;
+            break;
+        case WOPL_RM_HiHat:
+            writeOperator(chips, 0x11, ins.operators[0]);
+            keyOn(chips, 7, note);
+            key = 0x01;
+            break;
+        default:
+            continue;
+        }
+
+        // Key-on bit of the rhythm channels is not used, drums are keyed by 0xBD
+        for(unsigned ch = 6; ch < 9; ++ch)
+            chips.write(0x0B0 + ch, 0x00);
+        chips.write(0x0BD, depth | 0x20 | key);
+        mismatches += chips.compare(1500);
+        chips.write(0x0BD, depth | 0x20);
+        mismatches += chips.compare(500);
+        ++played;
+    }
+
+    chips.write(0x0BD, depth);
+    return mismatches;
+}
+
+TEST_CASE("[NukedSimd] Instruments of the bundled banks")
+{
+    unsigned rhythm = 0;
+
+    for(size_t f = 0; f < sizeof(s_bankFiles) / sizeof(s_bankFiles[0]); ++f)
+    {
+        INFO("Bank file " << s_bankFiles[f]);
+        WOPLFile *wopl = loadBank(s_bankFiles[f]);
+        REQUIRE(wopl);
+        REQUIRE(wopl->banks_count_melodic > 0);
+
+        uint8_t depth = 0;
+        if(wopl->opl_flags & WOPL_FLAG_DEEP_TREMOLO)
+            depth |= 0x80;
+        if(wopl->opl_flags & WOPL_FLAG_DEEP_VIBRATO)
+            depth |= 0x40;
+
+        ChipPair chips;
+        chips.write(0x105, 0x01);
+        chips.write(0x104, 0x3F);
+        chips.write(0x0BD, depth);
+
+        REQUIRE(playMelodic(chips, wopl->banks_melodic[0], false) == 0);
+
+        if(wopl->banks_count_percussion > 0)
+        {
+            REQUIRE(playMelodic(chips, wopl->banks_percussive[0], true) == 0);
+            REQUIRE(playRhythm(chips, wopl->banks_percussive[0], depth, rhythm) == 0);
+        }
+
+        WOPL_Free(wopl);
+    }
+
+    // Some of the banks must have the rhythm-mode drums
+    REQUIRE(rhythm > 0);
+}
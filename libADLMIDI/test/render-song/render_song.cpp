@@ -0,0 +1,192 @@
+#include <catch.hpp>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include "adlmidi.h"
+
+static const char *test_song = "projects/watcom/bass.mid";
+
+static const ADLMIDI_AudioFormat s16Format =
+{
+    ADLMIDI_SampleType_S16,
+    sizeof(short),
+    2 * sizeof(short)
+};
+
+static ADL_MIDIPlayer *openSong(bool loop)
+{
+    ADL_MIDIPlayer *p = adl_init(44100);
+    REQUIRE(p);
+    REQUIRE(adl_switchEmulator(p, ADLMIDI_EMU_DOSBOX) == 0);
+    REQUIRE(adl_setBank(p, 58) == 0);
+    REQUIRE(adl_openFile(p, test_song) == 0);
+    adl_setLoopEnabled(p, loop ? 1 : 0);
+    return p;
+}
+
+// The song through the adl_play() loop, the way players render it
+static std::vector<short> playSong(int chunk)
+{
+    ADL_MIDIPlayer *p = openSong(false);
+    std::vector<short> out;
+    std::vector<short> buf(static_cast<size_t>(chunk));
+    int got;
+    while((got = adl_play(p, chunk, buf.data())) > 0)
+        out.insert(out.end(), buf.begin(), buf.begin() + got);
+    REQUIRE(adl_atEnd(p));
+    adl_close(p);
+    return out;
+}
+
+// Renders the song in calls of the given capacity until one gives nothing,
+// the loop is enabled to see the rendering ignores it
+static std::vector<short> renderSong(long capacity, int flags, std::vector<long> *calls)
+{
+    ADL_MIDIPlayer *p = openSong(true);
+    std::vector<short> out;
+    std::vector<short> buf(static_cast<size_t>(capacity));
+    long got;
+    do
+    {
+        got = adl_renderToBuffer(p, capacity, reinterpret_cast<ADL_UInt8 *>(buf.data()),
+                                 reinterpret_cast<ADL_UInt8 *>(buf.data() + 1), &s16Format, flags);
+        REQUIRE(got >= 0);
+        REQUIRE(got <= capacity);
+        out.insert(out.end(), buf.begin(), buf.begin() + got);
+        if(calls)
+            calls->push_back(got);
+    } while(got > 0);
+    REQUIRE(adl_atEnd(p));
+    adl_close(p);
+    return out;
+}
+
+// Index of the first different sample, -1 when both are the same
+static long firstDifference(const std::vector<short> &a, const std::vector<short> &b)
+{
+    for(size_t i = 0; i < a.size() && i < b.size(); ++i)
+    {
+        if(a[i] != b[i])
+            return static_cast<long>(i);
+    }
+    return (a.size() == b.size()) ? -1 : static_cast<long>(std::min(a.size(), b.size()));
+}
+
+static uint32_t readLE(const unsigned char *p, unsigned bytes)
+{
+    uint32_t v = 0;
+    for(unsigned i = 0; i < bytes; ++i)
+        v |= static_cast<uint32_t>(p[i]) << (8 * i);
+    return v;
+}
+
+TEST_CASE("[Render] The buffer gets the same song as adl_play gives")
+{
+    ADL_MIDIPlayer *p = openSong(false);
+    const double length = adl_totalTimeLength(p);
+    adl_close(p);
+    REQUIRE(length > 1.0);
+    const long songCapacity = static_cast<long>(length * 44100.0 + 44100.0) * 2;
+
+    // adl_play() ticks the sequencer before the rest of a period which didn't
+    // fit its buffer, so both are compared with the same size of the buffer
+    SECTION("Whole song by one call")
+    {
+        const std::vector<short> played = playSong(static_cast<int>(songCapacity));
+        std::vector<long> calls;
+        std::vector<short> rendered = renderSong(songCapacity, 0, &calls);
+        // the song ends before the buffer is full, the next call has nothing
+        REQUIRE(calls.size() == 2);
+        REQUIRE(calls[0] < songCapacity);
+        REQUIRE(calls[1] == 0);
+        REQUIRE(rendered.size() == played.size());
+        REQUIRE(firstDifference(rendered, played) == -1);
+
+        // the frame count is the song length, up to the last period
+        const double frames = static_cast<double>(rendered.size() / 2);
+        REQUIRE(frames > length * 44100.0 - 512.0);
+        REQUIRE(frames < length * 44100.0 + 512.0);
+    }
+
+    SECTION("Song continues from the same place when the buffer is filled")
+    {
+        const long capacity = 4096 * 2 + 6;
+        const std::vector<short> played = playSong(static_cast<int>(capacity));
+        std::vector<long> calls;
+        std::vector<short> rendered = renderSong(capacity, 0, &calls);
+        REQUIRE(calls.size() > 2);
+        for(size_t i = 0; i + 2 < calls.size(); ++i)
+            REQUIRE(calls[i] == capacity);
+        REQUIRE(calls[calls.size() - 2] > 0);
+        REQUIRE(calls.back() == 0);
+        REQUIRE(rendered.size() == played.size());
+        REQUIRE(firstDifference(rendered, played) == -1);
+    }
+
+    SECTION("Skipping the silence keeps the length")
+    {
+        std::vector<short> rendered = renderSong(songCapacity, 0, NULL);
+        std::vector<short> skipped = renderSong(songCapacity, ADLMIDI_Render_SkipSilence, NULL);
+        REQUIRE(skipped.size() == rendered.size());
+    }
+
+    SECTION("Odd sample count gives whole frames")
+    {
+        ADL_MIDIPlayer *q = openSong(false);
+        short buf[8];
+        REQUIRE(adl_renderToBuffer(q, 7, reinterpret_cast<ADL_UInt8 *>(buf),
+                                   reinterpret_cast<ADL_UInt8 *>(buf + 1), &s16Format, 0) == 6);
+        REQUIRE(adl_renderToBuffer(q, -2, reinterpret_cast<ADL_UInt8 *>(buf),
+                                   reinterpret_cast<ADL_UInt8 *>(buf + 1), &s16Format, 0) == -1);
+        adl_close(q);
+    }
+}
+
+TEST_CASE("[Render] The WAV file gets the same song as adl_play gives")
+{
+    ADL_MIDIPlayer *p = openSong(false);
+    const long songCapacity = static_cast<long>(adl_totalTimeLength(p) * 44100.0 + 44100.0) * 2;
+    adl_close(p);
+    const std::vector<short> played = playSong(static_cast<int>(songCapacity));
+    const char *tmp = getenv("TMPDIR");
+    const std::string path = std::string(tmp ? tmp : "/tmp") + "/adlmidi_render_test.wav";
+
+    p = openSong(true);
+    REQUIRE(adl_renderFile(p, path.c_str(), ADLMIDI_SampleType_S16, 0) == 0);
+    REQUIRE(adl_atEnd(p));
+    adl_close(p);
+
+    FILE *f = fopen(path.c_str(), "rb");
+    REQUIRE(f);
+    std::vector<unsigned char> wav;
+    unsigned char chunk[4096];
+    size_t got;
+    while((got = fread(chunk, 1, sizeof(chunk), f)) > 0)
+        wav.insert(wav.end(), chunk, chunk + got);
+    fclose(f);
+    remove(path.c_str());
+
+    REQUIRE(wav.size() == 44 + played.size() * sizeof(short));
+    REQUIRE(memcmp(wav.data(), "RIFF", 4) == 0);
+    REQUIRE(readLE(&wav[4], 4) == wav.size() - 8);
+    REQUIRE(memcmp(&wav[8], "WAVEfmt ", 8) == 0);
+    REQUIRE(readLE(&wav[20], 2) == 1);
+    REQUIRE(readLE(&wav[22], 2) == 2);
+    REQUIRE(readLE(&wav[24], 4) == 44100);
+    REQUIRE(readLE(&wav[34], 2) == 16);
+    REQUIRE(memcmp(&wav[36], "data", 4) == 0);
+    REQUIRE(readLE(&wav[40], 4) == played.size() * sizeof(short));
+
+    bool same = true;
+    for(size_t i = 0; i < played.size() && same; ++i)
+        same = static_cast<short>(readLE(&wav[44 + 2 * i], 2)) == played[i];
+    REQUIRE(same);
+
+    // Unsupported sample type
+    ADL_MIDIPlayer *q = openSong(false);
+    REQUIRE(adl_renderFile(q, path.c_str(), ADLMIDI_SampleType_U8, 0) == -1);
+    adl_close(q);
+}
@@ -0,0 +1,12 @@
+// The sequencer which never takes keyframes and always seeks from the song begin
+#define BW_MidiSequencer PlainSeekSequencer
+#define BWMIDI_SEEK_INDEX_INTERVAL 1e9
+#include "midi_sequencer_impl.hpp"
+
+#define SEEK_STATE_IMPLEMENTATION
+#include "seek_state.hpp"
+
+SeekState seekFromStart(const std::vector<uint8_t> &midi, double seconds)
+{
+    return seekState<PlainSeekSequencer>(midi, seconds);
+}
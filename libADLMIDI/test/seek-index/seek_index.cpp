@@ -0,0 +1,193 @@
+#include <catch.hpp>
+#include <random>
+#include <vector>
+
+#include "seek_state.hpp"
+
+static void putVarLen(std::vector<uint8_t> &out, uint32_t value)
+{
+    uint8_t buf[5];
+    size_t n = 0;
+    buf[n++] = value & 0x7F;
+    while((value >>= 7) != 0)
+        buf[n++] = 0x80 | (value & 0x7F);
+    while(n > 0)
+        out.push_back(buf[--n]);
+}
+
+static void put32(std::vector<uint8_t> &out, uint32_t value)
+{
+    out.push_back((value >> 24) & 0xFF);
+    out.push_back((value >> 16) & 0xFF);
+    out.push_back((value >> 8) & 0xFF);
+    out.push_back(value & 0xFF);
+}
+
+// One-track SMF with lots of state changes between the notes
+static std::vector<uint8_t> makeSong(uint32_t seed, double seconds)
+{
+    std::mt19937 rng(seed);
+    std::vector<uint8_t> trk;
+    const uint32_t ticks = static_cast<uint32_t>(seconds * 960.0); // 480 PPQN, 120 BPM
+    uint32_t t = 0, last = 0;
+    int noteOn[16];
+    for(int i = 0; i < 16; ++i)
+        noteOn[i] = -1;
+
+    while(t < ticks)
+    {
+        putVarLen(trk, t - last);
+        last = t;
+
+        uint8_t ch = rng() % 16;
+        switch(rng() % 10)
+        {
+        case 0: // Program change
+            trk.push_back(0xC0 | ch);
+            trk.push_back(rng() % 128);
+            break;
+        case 1: // Pitch bend
+            trk.push_back(0xE0 | ch);
+            trk.push_back(rng() % 128);
+            trk.push_back(rng() % 128);
+            break;
+        case 2: // Channel aftertouch
+            trk.push_back(0xD0 | ch);
+            trk.push_back(rng() % 128);
+            break;
+        case 3: // GS parameter
+        {
+            const uint8_t msg[] = {0x41, 0x10, 0x42, 0x12, 0x40, static_cast<uint8_t>(0x10 | ch), 0x15,
+                                   static_cast<uint8_t>(rng() % 128), 0x00, 0xF7};
+            trk.push_back(0xF0);
+            putVarLen(trk, sizeof(msg));
+            trk.insert(trk.end(), msg, msg + sizeof(msg));
+            break;
+        }
+        case 4: // RPN select and data entry
+            trk.push_back(0xB0 | ch);
+            trk.push_back(101);
+            trk.push_back(0);
+            trk.push_back(0);
+            trk.push_back(100);
+            trk.push_back(rng() % 3);
+            trk.push_back(0);
+            trk.push_back(6);
+            trk.push_back(rng() % 128);
+            break;
+        case 5: // Reset all controllers
+            if(rng() % 4 == 0)
+            {
+                trk.push_back(0xB0 | ch);
+                trk.push_back(121);
+                trk.push_back(0);
+                break;
+            }
+            // fallthrough
+        case 6: // Controller
+        {
+            static const uint8_t ctrls[] = {0, 1, 7, 10, 11, 32, 64, 71, 74, 91, 93};
+            trk.push_back(0xB0 | ch);
+            trk.push_back(ctrls[rng() % sizeof(ctrls)]);
+            trk.push_back(rng() % 128);
+            break;
+        }
+        case 7: // Tempo
+        {
+            const uint32_t tempo = 400000 + rng() % 200000;
+            trk.push_back(0xFF);
+            trk.push_back(0x51);
+            trk.push_back(0x03);
+            trk.push_back((tempo >> 16) & 0xFF);
+            trk.push_back((tempo >> 8) & 0xFF);
+            trk.push_back(tempo & 0xFF);
+            break;
+        }
+        default: // Note
+            if(noteOn[ch] >= 0)
+            {
+                trk.push_back(0x80 | ch);
+                trk.push_back(static_cast<uint8_t>(noteOn[ch]));
+                trk.push_back(0);
+                noteOn[ch] = -1;
+            }
+            else
+            {
+                noteOn[ch] = 36 + rng() % 48;
+                trk.push_back(0x90 | ch);
+                trk.push_back(static_cast<uint8_t>(noteOn[ch]));
+                trk.push_back(100);
+            }
+            break;
+        }
+
+        t += rng() % 120;
+    }
+
+    putVarLen(trk, 0);
+    trk.push_back(0xFF);
+    trk.push_back(0x2F);
+    trk.push_back(0x00);
+
+    std::vector<uint8_t> smf;
+    const uint8_t head[] = {'M', 'T', 'h', 'd', 0, 0, 0, 6, 0, 0, 0, 1, 0x01, 0xE0};
+    smf.insert(smf.end(), head, head + sizeof(head));
+    smf.push_back('M');
+    smf.push_back('T');
+    smf.push_back('r');
+    smf.push_back('k');
+    put32(smf, static_cast<uint32_t>(trk.size()));
+    smf.insert(smf.end(), trk.begin(), trk.end());
+    return smf;
+}
+
+static void requireSameState(const SeekState &a, const SeekState &b)
+{
+    REQUIRE(a.position == Approx(b.position));
+    for(int ch = 0; ch < 16; ++ch)
+    {
+        INFO("Channel " << ch);
+        REQUIRE(a.program[ch] == b.program[ch]);
+        REQUIRE(a.chanTouch[ch] == b.chanTouch[ch]);
+        REQUIRE(a.bend[ch] == b.bend[ch]);
+        for(int c = 0; c < 128; ++c)
+        {
+            INFO("Controller " << c);
+            REQUIRE(a.ctrl[ch][c] == b.ctrl[ch][c]);
+        }
+    }
+    REQUIRE(a.rpn == b.rpn);
+    REQUIRE(a.sysex == b.sysex);
+    REQUIRE(a.after == b.after);
+}
+
+TEST_CASE("[BW_MidiSequencer] Seek from a keyframe gives the same state as seek from the begin")
+{
+    const std::vector<uint8_t> song = makeSong(777, 60.0);
+    const double points[] = {0.5, 1.9, 2.0, 2.1, 7.3, 15.0, 29.99, 41.2, 55.0};
+
+    for(size_t i = 0; i < sizeof(points) / sizeof(double); ++i)
+    {
+        INFO("Seek to " << points[i]);
+        SeekState fromStart = seekFromStart(song, points[i]);
+        SeekState indexed = seekIndexed(song, points[i]);
+        REQUIRE(fromStart.position > 0.0);
+        REQUIRE(!fromStart.sysex.empty());
+        requireSameState(indexed, fromStart);
+    }
+}
+
+TEST_CASE("[BW_MidiSequencer] Seek to random points of random songs gives the same state")
+{
+    for(uint32_t seed = 1; seed <= 4; ++seed)
+    {
+        const std::vector<uint8_t> song = makeSong(seed, 30.0);
+        std::mt19937 rng(seed);
+        for(int i = 0; i < 5; ++i)
+        {
+            const double to = (rng() % 2800) / 100.0;
+            INFO("Song " << seed << ", seek to " << to);
+            requireSameState(seekIndexed(song, to), seekFromStart(song, to));
+        }
+    }
+}
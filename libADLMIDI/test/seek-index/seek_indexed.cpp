@@ -0,0 +1,12 @@
+// The sequencer which takes keyframes often
+#define BW_MidiSequencer IndexedSeekSequencer
+#define BWMIDI_SEEK_INDEX_INTERVAL 2.0
+#include "midi_sequencer_impl.hpp"
+
+#define SEEK_STATE_IMPLEMENTATION
+#include "seek_state.hpp"
+
+SeekState seekIndexed(const std::vector<uint8_t> &midi, double seconds)
+{
+    return seekState<IndexedSeekSequencer>(midi, seconds);
+}
@@ -0,0 +1,136 @@
+#ifndef SEEK_STATE_HPP
+#define SEEK_STATE_HPP
+
+#include <cstring>
+#include <map>
+#include <stdint.h>
+#include <vector>
+
+// Synthesizer state as it gets seen through the real-time interface
+struct SeekState
+{
+    int program[16];
+    int chanTouch[16];
+    int bend[16];
+    int ctrl[16][128];
+    //! Data entry values by the channel and the selected RPN
+    std::map<uint32_t, int> rpn;
+    std::vector<std::vector<uint8_t> > sysex;
+
+    //! Position after seek
+    double position;
+    //! Events played after seek
+    std::vector<uint32_t> after;
+    bool playing;
+
+    SeekState() : position(0.0), playing(false)
+    {
+        std::memset(program, -1, sizeof(program));
+        std::memset(chanTouch, -1, sizeof(chanTouch));
+        std::memset(bend, -1, sizeof(bend));
+        std::memset(ctrl, -1, sizeof(ctrl));
+    }
+
+    void event(uint8_t type, uint8_t channel, uint8_t d1, uint8_t d2)
+    {
+        if(playing)
+            after.push_back((uint32_t(type) << 24) | (uint32_t(channel) << 16) | (uint32_t(d1) << 8) | d2);
+    }
+};
+
+// Returns the state reached by seek() of the given sequencer class
+SeekState seekIndexed(const std::vector<uint8_t> &midi, double seconds);
+SeekState seekFromStart(const std::vector<uint8_t> &midi, double seconds);
+
+#ifdef SEEK_STATE_IMPLEMENTATION
+
+static void stNoteOn(void *u, uint8_t ch, uint8_t note, uint8_t vel)
+{
+    static_cast<SeekState *>(u)->event(0x90, ch, note, vel);
+}
+
+static void stNoteOff(void *u, uint8_t ch, uint8_t note)
+{
+    static_cast<SeekState *>(u)->event(0x80, ch, note, 0);
+}
+
+static void stNoteTouch(void *u, uint8_t ch, uint8_t note, uint8_t val)
+{
+    static_cast<SeekState *>(u)->event(0xA0, ch, note, val);
+}
+
+static void stChanTouch(void *u, uint8_t ch, uint8_t val)
+{
+    SeekState *s = static_cast<SeekState *>(u);
+    s->chanTouch[ch & 15] = val;
+    s->event(0xD0, ch, val, 0);
+}
+
+static void stController(void *u, uint8_t ch, uint8_t type, uint8_t value)
+{
+    SeekState *s = static_cast<SeekState *>(u);
+    int *c = s->ctrl[ch & 15];
+    if(type == 121) // Reset all controllers
+        std::memset(c, -1, 128 * sizeof(int));
+    else if(type == 6)
+        s->rpn[(uint32_t(ch & 15) << 16) | (uint32_t(c[101] & 0xFF) << 8) | (c[100] & 0xFF)] = value;
+    c[type & 127] = value;
+    s->event(0xB0, ch, type, value);
+}
+
+static void stPatch(void *u, uint8_t ch, uint8_t patch)
+{
+    SeekState *s = static_cast<SeekState *>(u);
+    s->program[ch & 15] = patch;
+    s->event(0xC0, ch, patch, 0);
+}
+
+static void stPitchBend(void *u, uint8_t ch, uint8_t msb, uint8_t lsb)
+{
+    SeekState *s = static_cast<SeekState *>(u);
+    s->bend[ch & 15] = (msb << 7) | lsb;
+    s->event(0xE0, ch, msb, lsb);
+}
+
+static void stSysEx(void *u, const uint8_t *msg, size_t size)
+{
+    SeekState *s = static_cast<SeekState *>(u);
+    s->sysex.push_back(std::vector<uint8_t>(msg, msg + size));
+    s->event(0xF0, 0, static_cast<uint8_t>(size), 0);
+}
+
+template<class Sequencer>
+static SeekState seekState(const std::vector<uint8_t> &midi, double seconds)
+{
+    SeekState state;
+    BW_MidiRtInterface iface;
+    std::memset(&iface, 0, sizeof(iface));
+    iface.rtUserData = &state;
+    iface.rt_noteOn = stNoteOn;
+    iface.rt_noteOff = stNoteOff;
+    iface.rt_noteAfterTouch = stNoteTouch;
+    iface.rt_channelAfterTouch = stChanTouch;
+    iface.rt_controllerChange = stController;
+    iface.rt_patchChange = stPatch;
+    iface.rt_pitchBend = stPitchBend;
+    iface.rt_systemExclusive = stSysEx;
+
+    Sequencer seq;
+    seq.setInterface(&iface);
+    if(!seq.loadMIDI(midi.data(), midi.size()))
+        return state;
+
+    seq.seek(seconds, 0.001);
+    state.position = seq.tell();
+
+    // Play a bit to see the song continues the same way
+    state.playing = true;
+    for(int i = 0; i < 300; ++i)
+        seq.Tick(0.01, 0.001);
+
+    return state;
+}
+
+#endif // SEEK_STATE_IMPLEMENTATION
+
+#endif // SEEK_STATE_HPP
@@ -184,6 +184,10 @@ void mch_delay(int32_t msec)
 
 #include "wave_writer.h"
 
+#ifndef HARDWARE_OPL3
+#   include "batch_render.h"
+#endif
+
 #   ifndef OUTPUT_WAVE_ONLY
 class MutexType
 {
@@ -455,11 +459,21 @@ int main(int argc, char **argv)
         return 0;
     }
 
+#ifndef HARDWARE_OPL3
+    if(argc >= 2 && std::string(argv[1]) == "--render-dir")
+        return batch_render_main(argc - 2, argv + 2);
+#endif
+
     if(argc < 2 || std::string(argv[1]) == "--help" || std::string(argv[1]) == "-h")
     {
         std::printf(
             "Usage: adlmidi <midifilename> [ <options> ] \n"
             "                              [ <bank> [ <numchips> [ <numfourops>] ] ]\n"
+#ifndef HARDWARE_OPL3
+            "       adlmidi --render-dir <directory> [ -j <threads> ] [ -f32 ] [ --skip-silence ]\n"
+            "                              [ --emu-<name> ] [ <bank> [ <numchips> ] ]\n"
+            "               Render all music files of the directory into WAV files\n"
+#endif
             // " -p Enables adlib percussion instrument mode\n"
             " -t Enables tremolo amplification mode\n"
             " -v Enables vibrato amplification mode\n"
@@ -494,9 +508,11 @@ int main(int argc, char **argv)
             " -fp Enables full-panning stereo support\n"
             " --emu-nuked  Uses Nuked OPL3 v 1.8 emulator\n"
             " --emu-nuked7 Uses Nuked OPL3 v 1.7.4 emulator\n"
+            " --emu-nuked-simd Uses Nuked OPL3 v 1.8 emulator with SIMD operators processing\n"
             " --emu-dosbox Uses DosBox 0.74 OPL3 emulator\n"
             " --emu-opal   Uses Opal OPL3 emulator\n"
             " --emu-java   Uses Java OPL3 emulator\n"
+            " --threads <count> Render multiple chips on several threads (0 - by count of CPU cores)\n"
 #endif
 #ifdef HARDWARE_OPL3
             "\n"
@@ -640,6 +656,8 @@ int main(int argc, char **argv)
             emulator = ADLMIDI_EMU_NUKED;
         else if(!std::strcmp("--emu-nuked7", argv[2]))
             emulator = ADLMIDI_EMU_NUKED_174;
+        else if(!std::strcmp("--emu-nuked-simd", argv[2]))
+            emulator = ADLMIDI_EMU_NUKED_SIMD;
         else if(!std::strcmp("--emu-dosbox", argv[2]))
             emulator = ADLMIDI_EMU_DOSBOX;
         else if(!std::strcmp("--emu-opal", argv[2]))
@@ -654,6 +672,22 @@ int main(int argc, char **argv)
         else if(!std::strcmp("-s", argv[2]))
             adl_setScaleModulators(myDevice, 1);//Turn on modulators scaling by volume
 
+#ifndef HARDWARE_OPL3
+        else if(!std::strcmp("--threads", argv[2]))
+        {
+            if(argc <= 3)
+            {
+                printError("The option --threads requires an argument!\n");
+                return 1;
+            }
+            if(adl_setThreadCount(myDevice, std::atoi(argv[3])) != 0)
+            {
+                printError(adl_errorInfo(myDevice));
+                return 1;
+            }
+            had_option = true;
+        }
+#endif
 #ifdef HARDWARE_OPL3
         else if(!std::strcmp("--time-freq", argv[2]))
         {
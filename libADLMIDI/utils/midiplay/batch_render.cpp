@@ -0,0 +1,339 @@
+/*
+ * libADLMIDI is a free Software MIDI synthesizer library with OPL3 emulation
+ *
+ * Original ADLMIDI code: Copyright (c) 2010-2014 Joel Yliluoma <bisqwit@iki.fi>
+ * ADLMIDI Library API:   Copyright (c) 2015-2024 Vitaly Novichkov <admin@wohlnet.ru>
+ *
+ * Library is based on the ADLMIDI, a MIDI player for Linux and Windows with OPL3 emulation:
+ * http://iki.fi/bisqwit/source/adlmidi.html
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cctype>
+
+#ifdef _WIN32
+#   include <windows.h>
+#else
+#   include <pthread.h>
+#   include <unistd.h>
+#   include <dirent.h>
+#   include <sys/stat.h>
+#endif
+
+#include <adlmidi.h>
+
+#include "batch_render.h"
+
+struct BatchSetup
+{
+    std::string bank;
+    int numChips;
+    int emulator;
+    int sampleType;
+    int flags;
+};
+
+struct BatchState
+{
+    const BatchSetup *setup;
+    std::vector<std::string> files;
+    size_t next;
+    size_t failed;
+#ifdef _WIN32
+    CRITICAL_SECTION lock;
+#else
+    pthread_mutex_t lock;
+#endif
+};
+
+static void batchLock(BatchState &st)
+{
+#ifdef _WIN32
+    EnterCriticalSection(&st.lock);
+#else
+    pthread_mutex_lock(&st.lock);
+#endif
+}
+
+static void batchUnlock(BatchState &st)
+{
+#ifdef _WIN32
+    LeaveCriticalSection(&st.lock);
+#else
+    pthread_mutex_unlock(&st.lock);
+#endif
+}
+
+static bool isMusicFile(const std::string &name)
+{
+    static const char *exts[] =
+    {
+        ".mid", ".midi", ".kar", ".rmi", ".smf", ".xmi", ".mus", ".cmf", ".imf", ".wlf", ".klm", NULL
+    };
+
+    std::string lower(name);
+    for(size_t i = 0; i < lower.size(); ++i)
+        lower[i] = static_cast<char>(std::tolower(static_cast<unsigned char>(lower[i])));
+
+    for(size_t i = 0; exts[i]; ++i)
+    {
+        size_t len = std::strlen(exts[i]);
+        if(lower.size() > len && lower.compare(lower.size() - len, len, exts[i]) == 0)
+            return true;
+    }
+    return false;
+}
+
+static bool listDirectory(const std::string &dir, std::vector<std::string> &out)
+{
+#ifdef _WIN32
+    WIN32_FIND_DATAA fd;
+    HANDLE h = FindFirstFileA((dir + "\\*").c_str(), &fd);
+    if(h == INVALID_HANDLE_VALUE)
+        return false;
+    do
+    {
+        if(!(fd.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) && isMusicFile(fd.cFileName))
+            out.push_back(dir + "\\" + fd.cFileName);
+    } while(FindNextFileA(h, &fd));
+    FindClose(h);
+#else
+    DIR *d = opendir(dir.c_str());
+    if(!d)
+        return false;
+    while(struct dirent *e = readdir(d))
+    {
+        std::string path = dir + "/" + e->d_name;
+        struct stat st;
+        if(stat(path.c_str(), &st) == 0 && S_ISREG(st.st_mode) && isMusicFile(e->d_name))
+            out.push_back(path);
+    }
+    closedir(d);
+#endif
+    std::sort(out.begin(), out.end());
+    return true;
+}
+
+static bool renderOne(const BatchSetup &setup, const std::string &path, std::string &error)
+{
+    ADL_MIDIPlayer *device = adl_init(44100);
+    if(!device)
+    {
+        error = "Failed to init MIDI device";
+        return false;
+    }
+
+    bool ok = true;
+    adl_switchEmulator(device, setup.emulator);
+
+    if(!setup.bank.empty())
+    {
+        char *end = NULL;
+        long bankno = std::strtol(setup.bank.c_str(), &end, 10);
+        if(end && *end == '\0')
+            ok = adl_setBank(device, static_cast<int>(bankno)) == 0;
+        else
+            ok = adl_openBankFile(device, setup.bank.c_str()) == 0;
+    }
+
+    if(ok)
+        ok = adl_setNumChips(device, setup.numChips) == 0;
+    if(ok)
+        ok = adl_openFile(device, path.c_str()) == 0;
+    if(ok)
+        ok = adl_renderFile(device, (path + ".wav").c_str(), setup.sampleType, setup.flags) == 0;
+
+    if(!ok)
+        error = adl_errorInfo(device);
+
+    adl_close(device);
+    return ok;
+}
+
+static void batchWorker(BatchState &st)
+{
+    for(;;)
+    {
+        batchLock(st);
+        size_t index = st.next++;
+        batchUnlock(st);
+        if(index >= st.files.size())
+            break;
+
+        const std::string &path = st.files[index];
+        std::string error;
+        bool ok = renderOne(*st.setup, path, error);
+
+        batchLock(st);
+        if(ok)
+            std::fprintf(stdout, " - [%lu/%lu] %s.wav\n",
+                         static_cast<unsigned long>(index + 1),
+                         static_cast<unsigned long>(st.files.size()), path.c_str());
+        else
+        {
+            std::fprintf(stderr, " - [%lu/%lu] %s: FAILED: %s\n",
+                         static_cast<unsigned long>(index + 1),
+                         static_cast<unsigned long>(st.files.size()), path.c_str(), error.c_str());
+            st.failed++;
+        }
+        std::fflush(stdout);
+        batchUnlock(st);
+    }
+}
+
+#ifdef _WIN32
+static DWORD WINAPI batchThread(LPVOID st)
+{
+    batchWorker(*static_cast<BatchState *>(st));
+    return 0;
+}
+#else
+static void *batchThread(void *st)
+{
+    batchWorker(*static_cast<BatchState *>(st));
+    return NULL;
+}
+#endif
+
+static unsigned cpuCount()
+{
+#ifdef _WIN32
+    SYSTEM_INFO si;
+    GetSystemInfo(&si);
+    return static_cast<unsigned>(si.dwNumberOfProcessors);
+#else
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0 ? static_cast<unsigned>(n) : 1;
+#endif
+}
+
+int batch_render_main(int argc, char **argv)
+{
+    if(argc < 1)
+    {
+        std::fprintf(stderr, "The option --render-dir requires a directory path!\n");
+        return 1;
+    }
+
+    BatchSetup setup;
+    setup.numChips = 4;
+    setup.emulator = ADLMIDI_EMU_NUKED;
+    setup.sampleType = ADLMIDI_SampleType_S16;
+    setup.flags = 0;
+
+    std::string dir = argv[0];
+    unsigned jobs = 0;
+    int positional = 0;
+
+    for(int i = 1; i < argc; ++i)
+    {
+        if(!std::strcmp("-j", argv[i]) && i + 1 < argc)
+            jobs = static_cast<unsigned>(std::strtoul(argv[++i], NULL, 10));
+        else if(!std::strcmp("-f32", argv[i]))
+            setup.sampleType = ADLMIDI_SampleType_F32;
+        else if(!std::strcmp("--skip-silence", argv[i]))
+            setup.flags |= ADLMIDI_Render_SkipSilence;
+        else if(!std::strcmp("--emu-nuked", argv[i]))
+            setup.emulator = ADLMIDI_EMU_NUKED;
+        else if(!std::strcmp("--emu-nuked7", argv[i]))
+            setup.emulator = ADLMIDI_EMU_NUKED_174;
+        else if(!std::strcmp("--emu-nuked-simd", argv[i]))
+            setup.emulator = ADLMIDI_EMU_NUKED_SIMD;
+        else if(!std::strcmp("--emu-dosbox", argv[i]))
+            setup.emulator = ADLMIDI_EMU_DOSBOX;
+        else if(!std::strcmp("--emu-opal", argv[i]))
+            setup.emulator = ADLMIDI_EMU_OPAL;
+        else if(!std::strcmp("--emu-java", argv[i]))
+            setup.emulator = ADLMIDI_EMU_JAVA;
+        else if(positional == 0)
+        {
+            setup.bank = argv[i];
+            positional++;
+        }
+        else if(positional == 1)
+        {
+            setup.numChips = std::atoi(argv[i]);
+            positional++;
+        }
+        else
+        {
+            std::fprintf(stderr, "Unknown argument: %s\n", argv[i]);
+            return 1;
+        }
+    }
+
+    BatchState st;
+    st.setup = &setup;
+    st.next = 0;
+    st.failed = 0;
+
+    if(!listDirectory(dir, st.files))
+    {
+        std::fprintf(stderr, "Can't open the directory %s\n", dir.c_str());
+        return 1;
+    }
+
+    if(jobs == 0)
+        jobs = cpuCount();
+    if(jobs > st.files.size())
+        jobs = static_cast<unsigned>(st.files.size());
+
+    std::fprintf(stdout, " - Rendering %lu files on %u threads...\n",
+                 static_cast<unsigned long>(st.files.size()), jobs);
+    std::fflush(stdout);
+
+#ifdef _WIN32
+    InitializeCriticalSection(&st.lock);
+    std::vector<HANDLE> threads;
+    for(unsigned i = 1; i < jobs; ++i)
+    {
+        HANDLE t = CreateThread(NULL, 0, &batchThread, &st, 0, NULL);
+        if(t)
+            threads.push_back(t);
+    }
+    batchWorker(st);
+    for(size_t i = 0; i < threads.size(); ++i)
+    {
+        WaitForSingleObject(threads[i], INFINITE);
+        CloseHandle(threads[i]);
+    }
+    DeleteCriticalSection(&st.lock);
+#else
+    pthread_mutex_init(&st.lock, NULL);
+    std::vector<pthread_t> threads;
+    for(unsigned i = 1; i < jobs; ++i)
+    {
+        pthread_t t;
+        if(pthread_create(&t, NULL, &batchThread, &st) == 0)
+            threads.push_back(t);
+    }
+    batchWorker(st);
+    for(size_t i = 0; i < threads.size(); ++i)
+        pthread_join(threads[i], NULL);
+    pthread_mutex_destroy(&st.lock);
+#endif
+
+    std::fprintf(stdout, " - Completed: %lu rendered, %lu failed\n",
+                 static_cast<unsigned long>(st.files.size() - st.failed),
+                 static_cast<unsigned long>(st.failed));
+
+    return st.failed ? 1 : 0;
+}
@@ -307,6 +307,8 @@ BW_MidiSequencer::BW_MidiSequencer() :
     m_format(Format_MIDI),
     m_smfFormat(0),
     m_loopFormat(Loop_Default),
+    m_seekIndexDirty(false),
+    m_seekLog(NULL),
     m_loopEnabled(false),
     m_loopHooksOnly(false),
     m_fullSongTimeLength(0.0),
@@ -416,6 +418,8 @@ bool BW_MidiSequencer::setTrackEnabled(size_t track, bool enable)
     size_t trackCount = m_trackData.size();
     if(track >= trackCount)
         return false;
+    if(m_trackDisable[track] != !enable)
+        m_seekIndexDirty = true;
     m_trackDisable[track] = !enable;
     return true;
 }
@@ -449,6 +453,8 @@ bool BW_MidiSequencer::setChannelEnabled(size_t channel, bool enable)
 
 void BW_MidiSequencer::setSoloTrack(size_t track)
 {
+    if(m_trackSolo != track)
+        m_seekIndexDirty = true;
     m_trackSolo = track;
 }
 
@@ -977,6 +983,7 @@ void BW_MidiSequencer::buildTimeLine(const std::vector<MidiEvent> &tempos,
     m_fullSongTimeLength += m_postSongWaitDelay;
     // Set begin of the music
     m_trackBeginPosition = m_currentPosition;
+    m_beginTempo = m_tempo;
     // Initial loop position will begin at begin of track until passing of the loop point
     m_loopBeginPosition  = m_currentPosition;
     // Set lowest level of the loop stack
@@ -1181,6 +1188,215 @@ void BW_MidiSequencer::buildTimeLine(const std::vector<MidiEvent> &tempos,
     }
 #endif
 
+    buildSeekIndex();
+}
+
+void BW_MidiSequencer::SeekLog::append(size_t track, const MidiEvent *evt)
+{
+    SeekLogEntry e;
+    e.track = track;
+    e.event = evt;
+    e.droppedAt = ~static_cast<size_t>(0);
+    m_events.push_back(e);
+}
+
+void BW_MidiSequencer::SeekLog::append(size_t track, const MidiEvent *evt, uint64_t key)
+{
+    std::map<uint64_t, size_t>::iterator it = m_lastSet.find(key);
+    if(it != m_lastSet.end())
+    {
+        m_events[it->second].droppedAt = m_events.size(); // Overridden by this event
+        it->second = m_events.size();
+    }
+    else
+        m_lastSet.insert(std::make_pair(key, m_events.size()));
+    append(track, evt);
+}
+
+void BW_MidiSequencer::SeekLog::use(uint64_t key)
+{
+    m_lastSet.erase(key);
+}
+
+void BW_MidiSequencer::SeekLog::useTrack(size_t track)
+{
+    m_lastSet.erase(m_lastSet.lower_bound(channelKey(track, 0)),
+                    m_lastSet.lower_bound(channelKey(track + 1, 0)));
+}
+
+void BW_MidiSequencer::SeekLog::takeEvents(std::vector<SeekLogEntry> &out)
+{
+    out.swap(m_events);
+    m_events.clear();
+    m_lastSet.clear();
+}
+
+static void bwSeekIndexControllerChange(void *, uint8_t, uint8_t, uint8_t)
+{}
+
+void BW_MidiSequencer::buildSeekIndex()
+{
+    m_seekIndex.clear();
+    m_seekEvents.clear();
+    m_seekIndexDirty = false;
+
+    if(m_trackBeginPosition.track.empty() || m_fullSongTimeLength <= BWMIDI_SEEK_INDEX_INTERVAL)
+        return; // Seeking the short song is cheap enough without keyframes
+
+    // Keep the playback state to return it back after the scan
+    const Position      savedPosition(m_currentPosition);
+    const fraction<uint64_t> savedTempo(m_tempo);
+    const LoopState     savedLoop(m_loop);
+    const SequencerTime savedTime(m_time);
+    const bool          savedLoopEnabled = m_loopEnabled;
+    const bool          savedAtEnd = m_atEnd;
+    const BW_MidiRtInterface *savedInterface = m_interface;
+
+    // Only the end of song handling still calls the interface directly
+    BW_MidiRtInterface scanInterface;
+    std::memset(&scanInterface, 0, sizeof(BW_MidiRtInterface));
+    scanInterface.rt_controllerChange = bwSeekIndexControllerChange;
+
+    // Scan the song exactly the same way as seek() does
+    SeekLog log;
+    m_interface = &scanInterface;
+    m_seekLog = &log;
+    m_loopEnabled = false;
+    this->rewind();
+    m_loop.caughtStart = false;
+    m_tempo = m_beginTempo;
+
+    const double beginWait = m_currentPosition.wait;
+    double nextKeyframe = BWMIDI_SEEK_INDEX_INTERVAL;
+
+    while(processEvents(true) && !m_atEnd)
+    {
+        const double time = m_currentPosition.wait - beginWait;
+        if(time < nextKeyframe)
+            continue;
+
+        m_seekIndex.push_back(SeekKeyframe());
+        SeekKeyframe &k = m_seekIndex.back();
+        k.position = m_currentPosition;
+        k.tempo = m_tempo;
+        k.events = log.size();
+
+        while(nextKeyframe <= time)
+            nextKeyframe += BWMIDI_SEEK_INDEX_INTERVAL;
+    }
+
+    log.takeEvents(m_seekEvents);
+    // Events after the last keyframe are never replayed
+    m_seekEvents.resize(m_seekIndex.empty() ? 0 : m_seekIndex.back().events);
+    m_seekLog = NULL;
+    m_interface = savedInterface;
+    m_currentPosition = savedPosition;
+    m_tempo = savedTempo;
+    m_loop = savedLoop;
+    m_time = savedTime;
+    m_loopEnabled = savedLoopEnabled;
+    m_atEnd = savedAtEnd;
+}
+
+void BW_MidiSequencer::recordSeekEvent(size_t track, const MidiEvent &evt, int32_t &status)
+{
+    SeekLog &log = *m_seekLog;
+
+    if(evt.type == MidiEvent::T_SYSEX || evt.type == MidiEvent::T_SYSEX2)
+    {
+        log.append(track, &evt);
+        return;
+    }
+
+    if(evt.type == MidiEvent::T_SPECIAL)
+    {
+        switch(evt.subtype)
+        {
+        case MidiEvent::ST_ENDTRACK:
+            status = -1;
+            break;
+
+        case MidiEvent::ST_TEMPOCHANGE: // Saved with the keyframe
+            m_tempo = m_invDeltaTicks * fraction<uint64_t>(readBEint(evt.data.data(), evt.data.size()));
+            break;
+
+        case MidiEvent::ST_DEVICESWITCH: // Channels of the track get mapped differently since now
+            log.useTrack(track);
+            log.append(track, &evt);
+            break;
+
+        case MidiEvent::ST_RAWOPL:
+            if(evt.data.size() >= 2)
+                log.append(track, &evt, SeekLog::channelKey(track, 0) | SeekLog::KEY_RAWOPL | evt.data[0]);
+            break;
+
+        case MidiEvent::ST_CALLBACK_TRIGGER:
+        case MidiEvent::ST_SONG_BEGIN_HOOK:
+            log.append(track, &evt);
+            break;
+
+        default: // Texts, markers and loop points (disabled while seeking) don't change the state
+            break;
+        }
+        return;
+    }
+
+    if(evt.type == MidiEvent::T_SYSCOMSNGSEL ||
+       evt.type == MidiEvent::T_SYSCOMSPOSPTR)
+        return;
+
+    const uint64_t chKey = SeekLog::channelKey(track, evt.channel);
+    status = evt.type;
+
+    switch(evt.type)
+    {
+    case MidiEvent::T_NOTETOUCH:
+        log.append(track, &evt, chKey | SeekLog::KEY_NOTETOUCH | evt.data[0]);
+        break;
+
+    case MidiEvent::T_CTRLCHANGE:
+    {
+        uint8_t ctrlno = evt.data[0];
+        switch(ctrlno)
+        {
+        case 6:
+        case 38:
+        case 96:
+        case 97: // Data entry applies to the selected (N)RPN
+            log.use(chKey | SeekLog::KEY_CTRL | 98);
+            log.use(chKey | SeekLog::KEY_CTRL | 99);
+            log.use(chKey | SeekLog::KEY_CTRL | 100);
+            log.use(chKey | SeekLog::KEY_CTRL | 101);
+            log.append(track, &evt);
+            break;
+
+        default:
+            if(ctrlno >= 120) // Channel mode messages
+                log.append(track, &evt);
+            else
+                log.append(track, &evt, chKey | SeekLog::KEY_CTRL | ctrlno);
+            break;
+        }
+        break;
+    }
+
+    case MidiEvent::T_PATCHCHANGE: // Program change may take the bank selected at this moment
+        log.use(chKey | SeekLog::KEY_CTRL | 0);
+        log.use(chKey | SeekLog::KEY_CTRL | 32);
+        log.append(track, &evt, chKey | SeekLog::KEY_PROGRAM);
+        break;
+
+    case MidiEvent::T_CHANAFTTOUCH:
+        log.append(track, &evt, chKey | SeekLog::KEY_CHANTOUCH);
+        break;
+
+    case MidiEvent::T_WHEEL:
+        log.append(track, &evt, chKey | SeekLog::KEY_PITCHBEND);
+        break;
+
+    default: // Notes are killed before seek
+        break;
+    }
 }
 
 bool BW_MidiSequencer::processEvents(bool isSeek)
@@ -1877,6 +2093,12 @@ void BW_MidiSequencer::handleEvent(size_t track, const BW_MidiSequencer::MidiEve
             return;
     }
 
+    if(m_seekLog) // Building the seek index, don't send anything
+    {
+        recordSeekEvent(track, evt, status);
+        return;
+    }
+
     if(m_interface->onEvent)
     {
         m_interface->onEvent(m_interface->onEvent_userData,
@@ -2131,6 +2353,9 @@ double BW_MidiSequencer::seek(double seconds, const double granularity)
         return 0.0;
     }
 
+    if(m_seekIndexDirty)
+        buildSeekIndex();
+
     bool loopFlagState = m_loopEnabled;
     // Turn loop pooints off because it causes wrong position rememberin on a quick seek
     m_loopEnabled = false;
@@ -2154,6 +2379,34 @@ double BW_MidiSequencer::seek(double seconds, const double granularity)
 
     m_loop.temporaryBroken = (seconds >= m_loopEndTime);
 
+    /*
+     * Start from the latest keyframe before the destination instead of the song begin:
+     * restore the synthesizer state and replay the rest only
+     */
+    size_t kfBegin = 0, kfEnd = m_seekIndex.size();
+    while(kfBegin < kfEnd)
+    {
+        size_t mid = kfBegin + (kfEnd - kfBegin) / 2;
+        if(m_seekIndex[mid].position.wait <= seconds)
+            kfBegin = mid + 1;
+        else
+            kfEnd = mid;
+    }
+
+    if(kfBegin > 0)
+    {
+        const SeekKeyframe &k = m_seekIndex[kfBegin - 1];
+        int32_t status = 0;
+        for(size_t i = 0; i < k.events; ++i)
+        {
+            const SeekLogEntry &e = m_seekEvents[i];
+            if(e.droppedAt >= k.events) // Still in effect at this keyframe
+                handleEvent(e.track, *e.event, status);
+        }
+        m_currentPosition = k.position;
+        m_tempo = k.tempo;
+    }
+
     while((m_currentPosition.absTimePosition < seconds) &&
           (m_currentPosition.absTimePosition < m_fullSongTimeLength))
     {
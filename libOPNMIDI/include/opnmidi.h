@@ -221,6 +221,47 @@ extern OPNMIDI_DECLSPEC int  opn2_getNumChips(struct OPN2_MIDIPlayer *device);
  */
 extern OPNMIDI_DECLSPEC int opn2_getNumChipsObtained(struct OPN2_MIDIPlayer *device);
 
+/**
+ * @brief Sets number of threads used to render multiple emulated chips concurrently
+ *
+ * When more than one chip is emulated, every chip will render and resample its part
+ * of the output on the small pool of worker threads, and results will be mixed together.
+ * The calling thread takes a part in rendering, so, value 1 (default) disables threaded
+ * rendering. The output is identical to the single-threaded rendering.
+ *
+ * @param device Instance of the library
+ * @param threads Total count of rendering threads including the caller's thread (1 - disabled, 0 - use count of CPU cores, up to the maximum count of chips)
+ * @return 0 on success, <0 when any error has occurred or threaded rendering is not supported
+ */
+extern OPNMIDI_DECLSPEC int opn2_setThreadCount(struct OPN2_MIDIPlayer *device, int threads);
+
+/**
+ * @brief Get current number of threads used to render emulated chips
+ * @param device Instance of the library
+ * @return Count of rendering threads including the caller's thread
+ */
+extern OPNMIDI_DECLSPEC int opn2_getThreadCount(struct OPN2_MIDIPlayer *device);
+
+/**
+ * @brief Start recording of the chips register-write trace into the file
+ *
+ * Every register write of every emulated chip gets recorded together with the count of
+ * output frames rendered between writes. The trace can be replayed later directly
+ * into any chip emulator, without the MIDI sequencer. Chips will be reset to make
+ * the trace self-contained, so, start the recording before the playback.
+ *
+ * @param device Instance of the library
+ * @param tracePath Path to the trace file to create
+ * @return 0 on success, <0 when any error has occurred
+ */
+extern OPNMIDI_DECLSPEC int opn2_startChipTrace(struct OPN2_MIDIPlayer *device, const char *tracePath);
+
+/**
+ * @brief Stop recording of the chips register-write trace and close the trace file
+ * @param device Instance of the library
+ */
+extern OPNMIDI_DECLSPEC void opn2_stopChipTrace(struct OPN2_MIDIPlayer *device);
+
 /**
  * @brief Reference to dynamic bank
  */
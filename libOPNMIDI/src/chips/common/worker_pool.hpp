@@ -0,0 +1,318 @@
+/*
+ * libOPNMIDI is a free Software MIDI synthesizer library with OPN2 (YM2612) emulation
+ *
+ * MIDI parser and player (Original code from ADLMIDI): Copyright (c) 2010-2014 Joel Yliluoma <bisqwit@iki.fi>
+ * OPNMIDI Library and YM2612 support:   Copyright (c) 2017-2024 Vitaly Novichkov <admin@wohlnet.ru>
+ *
+ * Library is based on the ADLMIDI, a MIDI player for Linux and Windows with OPL3 emulation:
+ * http://iki.fi/bisqwit/source/adlmidi.html
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef WORKER_POOL_HPP
+#define WORKER_POOL_HPP
+
+#include <stddef.h>
+#include <vector>
+
+/*
+ * Small persistent pool of worker threads, used to render independent chip
+ * emulators concurrently. The calling thread takes part in the work, so a pool
+ * of N workers runs jobs on N + 1 threads. Jobs are dispatched by index, and
+ * run() blocks until every job has been completed.
+ *
+ * On platforms without threads support the pool has no workers and run()
+ * simply executes all jobs serially on the caller's thread.
+ */
+
+#if !defined(DOSBOX_NO_MUTEX) && !defined(USE_LIBOGC_MUTEX) && !defined(USE_WUT_MUTEX)
+#   if !defined(_WIN32)
+#       include <pthread.h>
+#       define WORKER_POOL_PTHREAD
+#   else
+#       include <windows.h>
+#       define WORKER_POOL_WIN32
+#   endif
+#endif
+
+class WorkerPool
+{
+public:
+    typedef void (*JobFunc)(void *userData, size_t jobIndex);
+
+    WorkerPool();
+    ~WorkerPool();
+
+    /**
+     * @brief Change the number of worker threads (excluding the caller's thread)
+     * @param count Number of workers, 0 to stop all of them
+     * @return true if the requested count of threads is running
+     */
+    bool setWorkersCount(unsigned count);
+
+    /**
+     * @brief Number of running worker threads
+     */
+    unsigned workersCount() const { return static_cast<unsigned>(m_threads.size()); }
+
+    /**
+     * @brief Run the given number of jobs and wait for all of them to finish
+     * @param func Job function
+     * @param userData User data passed into the job function
+     * @param jobs Count of jobs, indices passed to the function are 0..jobs-1
+     */
+    void run(JobFunc func, void *userData, size_t jobs);
+
+private:
+#if defined(WORKER_POOL_PTHREAD)
+    typedef pthread_t ThreadHandle;
+#elif defined(WORKER_POOL_WIN32)
+    typedef HANDLE ThreadHandle;
+#else
+    typedef int ThreadHandle;
+#endif
+
+    std::vector<ThreadHandle> m_threads;
+
+#if defined(WORKER_POOL_PTHREAD)
+    pthread_mutex_t m_lock;
+    pthread_cond_t  m_wakeCond;
+    pthread_cond_t  m_doneCond;
+#elif defined(WORKER_POOL_WIN32)
+    CRITICAL_SECTION   m_lock;
+    CONDITION_VARIABLE m_wakeCond;
+    CONDITION_VARIABLE m_doneCond;
+#endif
+
+    //! Current batch
+    JobFunc m_func;
+    void   *m_userData;
+    size_t  m_jobsTotal;
+    size_t  m_jobsNext;
+    size_t  m_jobsDone;
+    //! Incremented on every new batch to wake the workers
+    unsigned long m_generation;
+    bool    m_quit;
+
+    void lock();
+    void unlock();
+    void wakeAll();
+    void waitWake();
+    void signalDone();
+    void waitDone();
+
+    void stopWorkers();
+    //! Take and run jobs of the current batch until none are left, lock must be held
+    void drainJobs();
+    void workerLoop();
+
+#if defined(WORKER_POOL_PTHREAD)
+    static void *threadEntry(void *self);
+#elif defined(WORKER_POOL_WIN32)
+    static DWORD WINAPI threadEntry(LPVOID self);
+#endif
+
+    WorkerPool(const WorkerPool &);
+    WorkerPool &operator=(const WorkerPool &);
+};
+
+inline WorkerPool::WorkerPool() :
+    m_func(NULL),
+    m_userData(NULL),
+    m_jobsTotal(0),
+    m_jobsNext(0),
+    m_jobsDone(0),
+    m_generation(0),
+    m_quit(false)
+{
+#if defined(WORKER_POOL_PTHREAD)
+    pthread_mutex_init(&m_lock, NULL);
+    pthread_cond_init(&m_wakeCond, NULL);
+    pthread_cond_init(&m_doneCond, NULL);
+#elif defined(WORKER_POOL_WIN32)
+    InitializeCriticalSection(&m_lock);
+    InitializeConditionVariable(&m_wakeCond);
+    InitializeConditionVariable(&m_doneCond);
+#endif
+}
+
+inline WorkerPool::~WorkerPool()
+{
+    stopWorkers();
+#if defined(WORKER_POOL_PTHREAD)
+    pthread_cond_destroy(&m_doneCond);
+    pthread_cond_destroy(&m_wakeCond);
+    pthread_mutex_destroy(&m_lock);
+#elif defined(WORKER_POOL_WIN32)
+    DeleteCriticalSection(&m_lock);
+#endif
+}
+
+#if defined(WORKER_POOL_PTHREAD)
+
+inline void WorkerPool::lock()       { pthread_mutex_lock(&m_lock); }
+inline void WorkerPool::unlock()     { pthread_mutex_unlock(&m_lock); }
+inline void WorkerPool::wakeAll()    { pthread_cond_broadcast(&m_wakeCond); }
+inline void WorkerPool::waitWake()   { pthread_cond_wait(&m_wakeCond, &m_lock); }
+inline void WorkerPool::signalDone() { pthread_cond_signal(&m_doneCond); }
+inline void WorkerPool::waitDone()   { pthread_cond_wait(&m_doneCond, &m_lock); }
+
+inline void *WorkerPool::threadEntry(void *self)
+{
+    static_cast<WorkerPool *>(self)->workerLoop();
+    return NULL;
+}
+
+#elif defined(WORKER_POOL_WIN32)
+
+inline void WorkerPool::lock()       { EnterCriticalSection(&m_lock); }
+inline void WorkerPool::unlock()     { LeaveCriticalSection(&m_lock); }
+inline void WorkerPool::wakeAll()    { WakeAllConditionVariable(&m_wakeCond); }
+inline void WorkerPool::waitWake()   { SleepConditionVariableCS(&m_wakeCond, &m_lock, INFINITE); }
+inline void WorkerPool::signalDone() { WakeConditionVariable(&m_doneCond); }
+inline void WorkerPool::waitDone()   { SleepConditionVariableCS(&m_doneCond, &m_lock, INFINITE); }
+
+inline DWORD WINAPI WorkerPool::threadEntry(LPVOID self)
+{
+    static_cast<WorkerPool *>(self)->workerLoop();
+    return 0;
+}
+
+#else // No threads
+
+inline void WorkerPool::lock()       {}
+inline void WorkerPool::unlock()     {}
+inline void WorkerPool::wakeAll()    {}
+inline void WorkerPool::waitWake()   {}
+inline void WorkerPool::signalDone() {}
+inline void WorkerPool::waitDone()   {}
+
+#endif
+
+inline bool WorkerPool::setWorkersCount(unsigned count)
+{
+    if(count == m_threads.size())
+        return true;
+
+    stopWorkers();
+
+#if defined(WORKER_POOL_PTHREAD) || defined(WORKER_POOL_WIN32)
+    for(unsigned i = 0; i < count; ++i)
+    {
+        ThreadHandle t;
+#   if defined(WORKER_POOL_PTHREAD)
+        if(pthread_create(&t, NULL, &WorkerPool::threadEntry, this) != 0)
+            return false;
+#   else
+        t = CreateThread(NULL, 0, &WorkerPool::threadEntry, this, 0, NULL);
+        if(t == NULL)
+            return false;
+#   endif
+        m_threads.push_back(t);
+    }
+    return true;
+#else
+    return count == 0;
+#endif
+}
+
+inline void WorkerPool::stopWorkers()
+{
+    if(m_threads.empty())
+        return;
+
+    lock();
+    m_quit = true;
+    wakeAll();
+    unlock();
+
+    for(size_t i = 0; i < m_threads.size(); ++i)
+    {
+#if defined(WORKER_POOL_PTHREAD)
+        pthread_join(m_threads[i], NULL);
+#elif defined(WORKER_POOL_WIN32)
+        WaitForSingleObject(m_threads[i], INFINITE);
+        CloseHandle(m_threads[i]);
+#endif
+    }
+
+    m_threads.clear();
+    m_quit = false;
+}
+
+inline void WorkerPool::drainJobs()
+{
+    while(m_jobsNext < m_jobsTotal)
+    {
+        size_t job = m_jobsNext++;
+        JobFunc func = m_func;
+        void *userData = m_userData;
+        unlock();
+        func(userData, job);
+        lock();
+        if(++m_jobsDone == m_jobsTotal)
+            signalDone();
+    }
+}
+
+inline void WorkerPool::workerLoop()
+{
+    unsigned long seenGeneration = 0;
+
+    lock();
+    seenGeneration = m_generation;
+    for(;;)
+    {
+        while(!m_quit && seenGeneration == m_generation)
+            waitWake();
+        if(m_quit)
+            break;
+        seenGeneration = m_generation;
+        drainJobs();
+    }
+    unlock();
+}
+
+inline void WorkerPool::run(JobFunc func, void *userData, size_t jobs)
+{
+    if(jobs == 0)
+        return;
+
+    if(m_threads.empty() || jobs == 1)
+    {
+        for(size_t i = 0; i < jobs; ++i)
+            func(userData, i);
+        return;
+    }
+
+    lock();
+    m_func = func;
+    m_userData = userData;
+    m_jobsTotal = jobs;
+    m_jobsNext = 0;
+    m_jobsDone = 0;
+    ++m_generation;
+    wakeAll();
+
+    drainJobs();
+    while(m_jobsDone < m_jobsTotal)
+        waitDone();
+
+    m_func = NULL;
+    m_userData = NULL;
+    unlock();
+}
+
+#endif // WORKER_POOL_HPP
@@ -121,9 +121,13 @@ private:
     void nativeTick(int16_t *frame);
     void setupResampler(uint32_t rate);
     void resetResampler();
-    void resampledGenerate(int32_t *output);
+    void resampledGenerate(int32_t *output, size_t frames);
+    size_t resampleBlock(int32_t *output, size_t frames);
+    // maximum output frames and native frames processed in one block
+    enum { rsm_block = 256, rsm_native = 512 };
 #if defined(OPNMIDI_ENABLE_HQ_RESAMPLER)
     VResampler *m_resampler;
+    double m_resamplerRatio;
 #else
     int32_t m_oldsamples[2];
     int32_t m_samples[2];
@@ -131,6 +135,10 @@ private:
     int32_t m_rateratio;
     enum { rsm_frac = 10 };
 #endif
+protected:
+    // produces a block of native frames; the buffered chips redefine it
+    // to render into the destination directly.
+    void nativeGenerateBlock(int16_t *output, size_t frames);
     // amplitude scale factors in and out of resampler, varying for chips;
     // values are OK to "redefine", the static polymorphism will accept it.
     enum { resamplerPreAmplify = 1, resamplerPostAttenuate = 1 };
@@ -151,6 +159,7 @@ public:
 public:
     void reset() override;
     void nativeGenerate(int16_t *frame) override;
+    void nativeGenerateBlock(int16_t *output, size_t frames);
 protected:
     virtual void nativeGenerateN(int16_t *output, size_t frames) = 0;
 private:
@@ -135,17 +135,20 @@ template <class T>
 void OPNChipBaseT<T>::generate(int16_t *output, size_t frames)
 {
     static_cast<T *>(this)->nativePreGenerate();
-    for(size_t i = 0; i < frames; ++i)
+    while(frames > 0)
     {
-        int32_t frame[2];
-        static_cast<T *>(this)->resampledGenerate(frame);
-        for (unsigned c = 0; c < 2; ++c) {
-            int32_t temp = frame[c];
+        int32_t block[2 * rsm_block];
+        size_t count = (frames < (size_t)rsm_block) ? frames : (size_t)rsm_block;
+        resampledGenerate(block, count);
+        for(size_t i = 0; i < 2 * count; ++i)
+        {
+            int32_t temp = block[i];
             temp = (temp > -32768) ? temp : -32768;
             temp = (temp < 32767) ? temp : 32767;
-            output[c] = (int16_t)temp;
+            output[i] = (int16_t)temp;
         }
-        output += 2;
+        output += 2 * count;
+        frames -= count;
     }
     static_cast<T *>(this)->nativePostGenerate();
 }
@@ -154,17 +157,20 @@ template <class T>
 void OPNChipBaseT<T>::generateAndMix(int16_t *output, size_t frames)
 {
     static_cast<T *>(this)->nativePreGenerate();
-    for(size_t i = 0; i < frames; ++i)
+    while(frames > 0)
     {
-        int32_t frame[2];
-        static_cast<T *>(this)->resampledGenerate(frame);
-        for (unsigned c = 0; c < 2; ++c) {
-            int32_t temp = (int32_t)output[c] + frame[c];
+        int32_t block[2 * rsm_block];
+        size_t count = (frames < (size_t)rsm_block) ? frames : (size_t)rsm_block;
+        resampledGenerate(block, count);
+        for(size_t i = 0; i < 2 * count; ++i)
+        {
+            int32_t temp = (int32_t)output[i] + block[i];
             temp = (temp > -32768) ? temp : -32768;
             temp = (temp < 32767) ? temp : 32767;
-            output[c] = (int16_t)temp;
+            output[i] = (int16_t)temp;
         }
-        output += 2;
+        output += 2 * count;
+        frames -= count;
     }
     static_cast<T *>(this)->nativePostGenerate();
 }
@@ -173,11 +179,7 @@ template <class T>
 void OPNChipBaseT<T>::generate32(int32_t *output, size_t frames)
 {
     static_cast<T *>(this)->nativePreGenerate();
-    for(size_t i = 0; i < frames; ++i)
-    {
-        static_cast<T *>(this)->resampledGenerate(output);
-        output += 2;
-    }
+    resampledGenerate(output, frames);
     static_cast<T *>(this)->nativePostGenerate();
 }
 
@@ -185,13 +187,15 @@ template <class T>
 void OPNChipBaseT<T>::generateAndMix32(int32_t *output, size_t frames)
 {
     static_cast<T *>(this)->nativePreGenerate();
-    for(size_t i = 0; i < frames; ++i)
+    while(frames > 0)
     {
-        int32_t frame[2];
-        static_cast<T *>(this)->resampledGenerate(frame);
-        output[0] += frame[0];
-        output[1] += frame[1];
-        output += 2;
+        int32_t block[2 * rsm_block];
+        size_t count = (frames < (size_t)rsm_block) ? frames : (size_t)rsm_block;
+        resampledGenerate(block, count);
+        for(size_t i = 0; i < 2 * count; ++i)
+            output[i] += block[i];
+        output += 2 * count;
+        frames -= count;
     }
     static_cast<T *>(this)->nativePostGenerate();
 }
@@ -202,7 +206,15 @@ void OPNChipBaseT<T>::nativeTick(int16_t *frame)
 #if defined(OPNMIDI_AUDIO_TICK_HANDLER)
     opn2_audioTickHandler(m_audioTickHandlerInstance, m_id, effectiveRate());
 #endif
-    static_cast<T *>(this)->nativeGenerate(frame);
+    // the chip classes are final, call the generator directly
+    static_cast<T *>(this)->T::nativeGenerate(frame);
+}
+
+template <class T>
+void OPNChipBaseT<T>::nativeGenerateBlock(int16_t *output, size_t frames)
+{
+    for(size_t i = 0; i < frames; ++i)
+        nativeTick(output + 2 * i);
 }
 
 template <class T>
@@ -211,11 +223,15 @@ void OPNChipBaseT<T>::setupResampler(uint32_t rate)
 #if defined(OPNMIDI_ENABLE_HQ_RESAMPLER)
     double ratio = rate * (1.0 / opn2_getNativeRate(m_family));
     m_resampler->setup(ratio, 2, 48);
+    m_resamplerRatio = ratio;
 #else
     m_oldsamples[0] = m_oldsamples[1] = 0;
     m_samples[0] = m_samples[1] = 0;
     m_samplecnt = 0;
     m_rateratio = (int32_t)(uint32_t)((((uint64_t)144 * rate) << rsm_frac) / m_clock);
+    // a zero ratio (below ~52 Hz) would never consume a native frame
+    if(m_rateratio < 1)
+        m_rateratio = 1;
 #endif
 }
 
@@ -231,72 +247,137 @@ void OPNChipBaseT<T>::resetResampler()
 #endif
 }
 
-#if defined(OPNMIDI_ENABLE_HQ_RESAMPLER)
 template <class T>
-void OPNChipBaseT<T>::resampledGenerate(int32_t *output)
+void OPNChipBaseT<T>::resampledGenerate(int32_t *output, size_t frames)
 {
     if(UNLIKELY(m_runningAtPcmRate))
     {
-        int16_t in[2];
-        static_cast<T *>(this)->nativeTick(in);
-        output[0] = (int32_t)in[0] * T::resamplerPreAmplify / T::resamplerPostAttenuate;
-        output[1] = (int32_t)in[1] * T::resamplerPreAmplify / T::resamplerPostAttenuate;
+        while(frames > 0)
+        {
+            int16_t in[2 * rsm_native];
+            size_t count = (frames < (size_t)rsm_native) ? frames : (size_t)rsm_native;
+            static_cast<T *>(this)->nativeGenerateBlock(in, count);
+            for(size_t i = 0; i < 2 * count; ++i)
+                output[i] = (int32_t)in[i] * T::resamplerPreAmplify / T::resamplerPostAttenuate;
+            output += 2 * count;
+            frames -= count;
+        }
         return;
     }
 
+    while(frames > 0)
+    {
+        size_t count = (frames < (size_t)rsm_block) ? frames : (size_t)rsm_block;
+        count = resampleBlock(output, count);
+        output += 2 * count;
+        frames -= count;
+    }
+}
+
+#if defined(OPNMIDI_ENABLE_HQ_RESAMPLER)
+template <class T>
+size_t OPNChipBaseT<T>::resampleBlock(int32_t *output, size_t frames)
+{
     VResampler *rsm = m_resampler;
-    float scale = (float)T::resamplerPreAmplify /
+    const float scale = (float)T::resamplerPreAmplify /
         (float)T::resamplerPostAttenuate;
-    float f_in[2];
-    float f_out[2];
+    int16_t in[2 * rsm_native];
+    float f_in[2 * rsm_native];
+    float f_out[2 * rsm_block];
     rsm->inp_count = 0;
     rsm->inp_data = f_in;
-    rsm->out_count = 1;
+    rsm->out_count = (unsigned int)frames;
     rsm->out_data = f_out;
     while(rsm->process(), rsm->out_count != 0)
     {
-        int16_t in[2];
-        static_cast<T *>(this)->nativeTick(in);
-        f_in[0] = scale * (float)in[0];
-        f_in[1] = scale * (float)in[1];
-        rsm->inp_count = 1;
+        // feed less than the remaining outputs are going to consume,
+        // so the resampler never stops with unused input on hands
+        double wanted = ((double)rsm->out_count - 2.0) / m_resamplerRatio - 1.0;
+        size_t count = (wanted >= 2.0) ? (size_t)wanted : 1;
+        count = (count < (size_t)rsm_native) ? count : (size_t)rsm_native;
+        static_cast<T *>(this)->nativeGenerateBlock(in, count);
+        for(size_t i = 0; i < 2 * count; ++i)
+            f_in[i] = scale * (float)in[i];
+        rsm->inp_count = (unsigned int)count;
         rsm->inp_data = f_in;
-        rsm->out_count = 1;
-        rsm->out_data = f_out;
     }
-    output[0] = static_cast<int32_t>(lround(f_out[0]));
-    output[1] = static_cast<int32_t>(lround(f_out[1]));
+    for(size_t i = 0; i < 2 * frames; ++i)
+        output[i] = static_cast<int32_t>(lround(f_out[i]));
+    return frames;
 }
 #else
 template <class T>
-void OPNChipBaseT<T>::resampledGenerate(int32_t *output)
+size_t OPNChipBaseT<T>::resampleBlock(int32_t *output, size_t frames)
 {
-    if(UNLIKELY(m_runningAtPcmRate))
+    const int32_t rateratio = m_rateratio;
+    int32_t samplecnt = m_samplecnt;
+
+    // at low output rates (below ~104 Hz) the next output frame may be more
+    // than rsm_native native frames away: run the chip up to it first,
+    // keeping the last two native frames for the interpolation
+    while(samplecnt - (int32_t)rsm_native * rateratio >= rateratio)
     {
-        int16_t in[2];
-        static_cast<T *>(this)->nativeTick(in);
-        output[0] = (int32_t)in[0] * T::resamplerPreAmplify / T::resamplerPostAttenuate;
-        output[1] = (int32_t)in[1] * T::resamplerPreAmplify / T::resamplerPostAttenuate;
-        return;
+        int16_t skipped[2 * rsm_native];
+        static_cast<T *>(this)->nativeGenerateBlock(skipped, rsm_native);
+        m_oldsamples[0] = skipped[2 * (rsm_native - 2)] * T::resamplerPreAmplify;
+        m_oldsamples[1] = skipped[2 * (rsm_native - 2) + 1] * T::resamplerPreAmplify;
+        m_samples[0] = skipped[2 * (rsm_native - 1)] * T::resamplerPreAmplify;
+        m_samples[1] = skipped[2 * (rsm_native - 1) + 1] * T::resamplerPreAmplify;
+        samplecnt -= (int32_t)rsm_native * rateratio;
     }
 
-    int32_t samplecnt = m_samplecnt;
-    const int32_t rateratio = m_rateratio;
-    while(samplecnt >= rateratio)
+    // find how many native frames are going to be consumed,
+    // and the interpolation position of every output frame
+    size_t ticks = 0;
+    size_t count = 0;
+    uint16_t position[rsm_block];
+    int32_t phase[rsm_block];
+    while(count < frames)
+    {
+        size_t needed = ticks;
+        int32_t cnt = samplecnt;
+        while(cnt >= rateratio)
+        {
+            cnt -= rateratio;
+            ++needed;
+        }
+        if(needed > (size_t)rsm_native)
+            break;
+        ticks = needed;
+        position[count] = (uint16_t)ticks;
+        phase[count] = cnt;
+        samplecnt = cnt + (1 << rsm_frac);
+        ++count;
+    }
+
+    // the two previous samples go first, followed by the new ones
+    int16_t in[2 * rsm_native];
+    int32_t samples[2 * (rsm_native + 2)];
+    static_cast<T *>(this)->nativeGenerateBlock(in, ticks);
+    samples[0] = m_oldsamples[0];
+    samples[1] = m_oldsamples[1];
+    samples[2] = m_samples[0];
+    samples[3] = m_samples[1];
+    for(size_t i = 0; i < 2 * ticks; ++i)
+        samples[i + 4] = in[i] * T::resamplerPreAmplify;
+
+    for(size_t i = 0; i < count; ++i)
     {
-        m_oldsamples[0] = m_samples[0];
-        m_oldsamples[1] = m_samples[1];
-        int16_t buffer[2];
-        static_cast<T *>(this)->nativeTick(buffer);
-        m_samples[0] = buffer[0] * T::resamplerPreAmplify;
-        m_samples[1] = buffer[1] * T::resamplerPreAmplify;
-        samplecnt -= rateratio;
+        const int32_t *oldsamples = &samples[2 * position[i]];
+        const int32_t *newsamples = oldsamples + 2;
+        const int32_t cnt = phase[i];
+        output[2 * i] = (int32_t)(((oldsamples[0] * (rateratio - cnt)
+                                    + newsamples[0] * cnt) / rateratio)/T::resamplerPostAttenuate);
+        output[2 * i + 1] = (int32_t)(((oldsamples[1] * (rateratio - cnt)
+                                        + newsamples[1] * cnt) / rateratio)/T::resamplerPostAttenuate);
     }
-    output[0] = (int32_t)(((m_oldsamples[0] * (rateratio - samplecnt)
-                            + m_samples[0] * samplecnt) / rateratio)/T::resamplerPostAttenuate);
-    output[1] = (int32_t)(((m_oldsamples[1] * (rateratio - samplecnt)
-                            + m_samples[1] * samplecnt) / rateratio)/T::resamplerPostAttenuate);
-    m_samplecnt = samplecnt + (1 << rsm_frac);
+
+    m_oldsamples[0] = samples[2 * ticks];
+    m_oldsamples[1] = samples[2 * ticks + 1];
+    m_samples[0] = samples[2 * ticks + 2];
+    m_samples[1] = samples[2 * ticks + 3];
+    m_samplecnt = samplecnt;
+    return count;
 }
 #endif
 
@@ -320,3 +401,27 @@ void OPNChipBaseBufferedT<T, Buffer>::nativeGenerate(int16_t *frame)
     bufferIndex = (bufferIndex + 1 < Buffer) ? (bufferIndex + 1) : 0;
     m_bufferIndex = bufferIndex;
 }
+
+template <class T, unsigned Buffer>
+void OPNChipBaseBufferedT<T, Buffer>::nativeGenerateBlock(int16_t *output, size_t frames)
+{
+#if defined(OPNMIDI_AUDIO_TICK_HANDLER)
+    // the tick handler must run on every frame
+    OPNChipBaseT<T>::nativeGenerateBlock(output, frames);
+#else
+    while(frames > 0)
+    {
+        // whole buffers are rendered into the output directly
+        if(m_bufferIndex == 0 && frames >= Buffer)
+        {
+            static_cast<T *>(this)->nativeGenerateN(output, Buffer);
+            output += 2 * Buffer;
+            frames -= Buffer;
+            continue;
+        }
+        OPNChipBaseBufferedT::nativeGenerate(output);
+        output += 2;
+        --frames;
+    }
+#endif
+}
@@ -29,6 +29,15 @@
 #include "midi_sequencer.hpp"
 #endif
 
+#if defined(OPNMIDI_ENABLE_THREADED_RENDER) && !defined(_WIN32)
+#include <unistd.h> // sysconf
+#endif
+
+#if defined(OPNMIDI_ENABLE_THREADED_RENDER) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#include <emmintrin.h>
+#define OPNMIDI_SSE2_MIX
+#endif
+
 /* Unify MIDI player casting and interface between ADLMIDI and OPNMIDI */
 #define GET_MIDI_PLAYER(device) reinterpret_cast<OPNMIDIplay *>((device)->opn2_midiPlayer)
 typedef OPNMIDIplay MidiPlayer;
@@ -121,6 +130,96 @@ OPNMIDI_EXPORT int opn2_getNumChipsObtained(struct OPN2_MIDIPlayer *device)
     return (int)play->m_synth->m_numChips;
 }
 
+#if defined(OPNMIDI_ENABLE_THREADED_RENDER)
+static int opnCpuCoresCount()
+{
+#   if defined(_WIN32)
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return (int)info.dwNumberOfProcessors;
+#   elif defined(_SC_NPROCESSORS_ONLN)
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    return cores > 0 ? (int)cores : 1;
+#   else
+    return 1;
+#   endif
+}
+#endif
+
+OPNMIDI_EXPORT int opn2_setThreadCount(struct OPN2_MIDIPlayer *device, int threads)
+{
+    if(device == NULL)
+        return -2;
+    MidiPlayer *play = GET_MIDI_PLAYER(device);
+    assert(play);
+#if defined(OPNMIDI_ENABLE_THREADED_RENDER)
+    if(threads == 0)
+    {
+        /* More threads than chips would have nothing to do */
+        threads = opnCpuCoresCount();
+        if(threads > OPN_MAX_CHIPS)
+            threads = OPN_MAX_CHIPS;
+    }
+    if(threads < 1 || threads > OPN_MAX_CHIPS)
+    {
+        play->setErrorString("number of threads may only be 0.." OPN_MAX_CHIPS_STR ".\n");
+        return -1;
+    }
+    if(!play->m_renderPool.setWorkersCount(static_cast<unsigned>(threads - 1)))
+    {
+        play->m_renderPool.setWorkersCount(0);
+        play->setErrorString("Failed to start rendering threads.");
+        return -1;
+    }
+    return 0;
+#else
+    if(threads == 1)
+        return 0;
+    play->setErrorString("Threaded rendering is not supported by this build.");
+    return -1;
+#endif
+}
+
+OPNMIDI_EXPORT int opn2_getThreadCount(struct OPN2_MIDIPlayer *device)
+{
+    if(device == NULL)
+        return -2;
+#if defined(OPNMIDI_ENABLE_THREADED_RENDER)
+    MidiPlayer *play = GET_MIDI_PLAYER(device);
+    assert(play);
+    return (int)play->m_renderPool.workersCount() + 1;
+#else
+    return 1;
+#endif
+}
+
+OPNMIDI_EXPORT int opn2_startChipTrace(struct OPN2_MIDIPlayer *device, const char *tracePath)
+{
+    if(device == NULL)
+        return -2;
+    MidiPlayer *play = GET_MIDI_PLAYER(device);
+    assert(play);
+    Synth &synth = *play->m_synth;
+    AdlMIDI_UPtr<ChipTraceWriter> trace(new ChipTraceWriter);
+    if(!tracePath || !trace->open(tracePath))
+    {
+        play->setErrorString("Can't create the chip trace file.");
+        return -1;
+    }
+    synth.m_trace.swap(trace);
+    play->partialReset();
+    return 0;
+}
+
+OPNMIDI_EXPORT void opn2_stopChipTrace(struct OPN2_MIDIPlayer *device)
+{
+    if(device == NULL)
+        return;
+    MidiPlayer *play = GET_MIDI_PLAYER(device);
+    assert(play);
+    play->m_synth->m_trace.reset();
+}
+
 
 OPNMIDI_EXPORT int opn2_reserveBanks(OPN2_MIDIPlayer *device, unsigned banks)
 {
@@ -1134,6 +1233,91 @@ static int SendStereoAudio(int         samples_requested,
 }
 
 
+#if defined(OPNMIDI_ENABLE_THREADED_RENDER)
+struct ChipsRenderJob
+{
+    Synth   *synth;
+    int32_t *firstBuf;
+    int32_t *otherBufs;
+    size_t   frames;
+};
+
+static void RenderChipJob(void *userData, size_t chip)
+{
+    ChipsRenderJob *job = static_cast<ChipsRenderJob *>(userData);
+    int32_t *buf = (chip == 0) ? job->firstBuf : (job->otherBufs + (chip - 1) * 1024);
+    // Every chip also runs its own resampler here
+    job->synth->m_chips[chip]->generate32(buf, job->frames);
+}
+
+static void MixChipBuffer(int32_t *dst, const int32_t *src, size_t count)
+{
+    size_t i = 0;
+#   if defined(OPNMIDI_SSE2_MIX)
+    for(; i + 4 <= count; i += 4)
+    {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(dst + i));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), _mm_add_epi32(a, b));
+    }
+#   endif
+    for(; i < count; ++i)
+        dst[i] += src[i];
+}
+#endif
+
+/**
+ * @brief Generate the mixed output of all emulated chips
+ * @param player MIDI player instance
+ * @param out_buf Output buffer, 1024 samples long
+ * @param frames Count of stereo frames to generate, up to 512
+ */
+static void GenerateChips(MidiPlayer *player, int32_t *out_buf, size_t frames)
+{
+    Synth &synth = *player->m_synth;
+    unsigned int chips = synth.m_numChips;
+
+    if(synth.m_trace.get())
+        synth.m_trace->wait(frames);
+
+    if(chips == 1)
+    {
+        synth.m_chips[0]->generate32(out_buf, frames);
+        return;
+    }
+
+#if defined(OPNMIDI_ENABLE_THREADED_RENDER)
+    bool threaded = player->m_renderPool.workersCount() > 0;
+#   ifdef OPNMIDI_MIDI2VGM
+    // Chips of the VGM dumper are writing into the same file
+    threaded &= (player->m_setup.emulator != OPNMIDI_VGM_DUMPER);
+#   endif
+    if(threaded)
+    {
+        /* Every chip renders into own buffer, then all of them get summed */
+        std::vector<int32_t> &bufs = player->m_chipOutBufs;
+        if(bufs.size() < (chips - 1) * 1024)
+            bufs.resize((chips - 1) * 1024);
+
+        ChipsRenderJob job;
+        job.synth = &synth;
+        job.firstBuf = out_buf;
+        job.otherBufs = &bufs[0];
+        job.frames = frames;
+        player->m_renderPool.run(&RenderChipJob, &job, chips);
+
+        for(size_t card = 1; card < chips; ++card)
+            MixChipBuffer(out_buf, &bufs[(card - 1) * 1024], frames * 2);
+        return;
+    }
+#endif
+
+    /* Generate data from every chip and mix result */
+    std::memset(out_buf, 0, frames * 2 * sizeof(out_buf[0]));
+    for(size_t card = 0; card < chips; ++card)
+        synth.m_chips[card]->generateAndMix32(out_buf, frames);
+}
+
 OPNMIDI_EXPORT int opn2_play(struct OPN2_MIDIPlayer *device, int sampleCount, short *out)
 {
     return opn2_playFormat(device, sampleCount, (OPN2_UInt8 *)out, (OPN2_UInt8 *)(out + 1), &opn2_DefaultAudioFormat);
@@ -1202,20 +1386,8 @@ OPNMIDI_EXPORT int opn2_playFormat(OPN2_MIDIPlayer *device, int sampleCount,
             ssize_t in_generatedStereo = (n_periodCountStereo > 512) ? 512 : n_periodCountStereo;
             //! Total count of samples
             ssize_t in_generatedPhys = in_generatedStereo * 2;
-            //! Unsigned total sample count
-            //fill buffer with zeros
             int32_t *out_buf = player->m_outBuf;
-            std::memset(out_buf, 0, static_cast<size_t>(in_generatedPhys) * sizeof(out_buf[0]));
-            Synth &synth = *player->m_synth;
-            unsigned int chips = synth.m_numChips;
-            if(chips == 1)
-                synth.m_chips[0]->generate32(out_buf, (size_t)in_generatedStereo);
-            else/* if(n_periodCountStereo > 0)*/
-            {
-                /* Generate data from every chip and mix result */
-                for(size_t card = 0; card < chips; ++card)
-                    synth.m_chips[card]->generateAndMix32(out_buf, (size_t)in_generatedStereo);
-            }
+            GenerateChips(player, out_buf, (size_t)in_generatedStereo);
             /* Process it */
             if(SendStereoAudio(sampleCount, in_generatedStereo, out_buf, gotten_len, out_left, out_right, format) == -1)
                 return 0;
@@ -1280,20 +1452,8 @@ OPNMIDI_EXPORT int opn2_generateFormat(struct OPN2_MIDIPlayer *device, int sampl
             ssize_t in_generatedStereo = (n_periodCountStereo > 512) ? 512 : n_periodCountStereo;
             //! Total count of samples
             ssize_t in_generatedPhys = in_generatedStereo * 2;
-            //! Unsigned total sample count
-            //fill buffer with zeros
             int32_t *out_buf = player->m_outBuf;
-            std::memset(out_buf, 0, static_cast<size_t>(in_generatedPhys) * sizeof(out_buf[0]));
-            Synth &synth = *player->m_synth;
-            unsigned int chips = synth.m_numChips;
-            if(chips == 1)
-                synth.m_chips[0]->generate32(out_buf, (size_t)in_generatedStereo);
-            else/* if(n_periodCountStereo > 0)*/
-            {
-                /* Generate data from every chip and mix result */
-                for(size_t card = 0; card < chips; ++card)
-                    synth.m_chips[card]->generateAndMix32(out_buf, (size_t)in_generatedStereo);
-            }
+            GenerateChips(player, out_buf, (size_t)in_generatedStereo);
             /* Process it */
             if(SendStereoAudio(sampleCount, in_generatedStereo, out_buf, gotten_len, out_left, out_right, format) == -1)
                 return 0;
@@ -27,7 +27,10 @@
 #include "opnbank.h"
 #include "opnmidi_private.hpp"
 #include "opnmidi_ptr.hpp"
-#include "structures/pl_list.hpp"
+#include "structures/fixed_list.hpp"
+#if defined(OPNMIDI_ENABLE_THREADED_RENDER)
+#include "chips/common/worker_pool.hpp"
+#endif
 
 /**
  * @brief Hooks of the internal events
@@ -276,13 +279,20 @@ public:
         unsigned extended_note_count;
 
         //! Active notes in the channel
-        pl_list<NoteInfo> activenotes;
-        typedef pl_list<NoteInfo>::iterator notes_iterator;
-        typedef pl_list<NoteInfo>::const_iterator const_notes_iterator;
+        fixed_list<NoteInfo, 128> activenotes;
+        typedef fixed_list<NoteInfo, 128>::iterator notes_iterator;
+        typedef fixed_list<NoteInfo, 128>::const_iterator const_notes_iterator;
+        //! Slot of the active note per every key, valid only when the slot holds the same key
+        uint8_t activenote_slots[128];
 
         notes_iterator find_activenote(unsigned note)
         {
-            return activenotes.find_if(NoteInfo::FindPredicate(note));
+            if(note >= 128)
+                return activenotes.find_if(NoteInfo::FindPredicate(note));
+            notes_iterator it = activenotes.slot(activenote_slots[note]);
+            if(!it.is_end() && it->value.note != note)
+                it = activenotes.end();
+            return it;
         }
 
         notes_iterator ensure_find_activenote(unsigned note)
@@ -302,6 +312,8 @@ public:
                 NoteInfo ni;
                 ni.note = note;
                 it = activenotes.insert(activenotes.end(), ni);
+                if(note < 128)
+                    activenote_slots[note] = static_cast<uint8_t>(it.index());
             }
             return it;
         }
@@ -397,9 +409,9 @@ public:
         MIDIchannel() :
             def_volume(100),
             def_bendsense_lsb(0),
-            def_bendsense_msb(2),
-            activenotes(128)
+            def_bendsense_msb(2)
         {
+            std::memset(activenote_slots, 0, sizeof(activenote_slots));
             gliding_note_count = 0;
             extended_note_count = 0;
             reset();
@@ -455,9 +467,9 @@ public:
         //! Recently passed instrument, improves a goodness of released but busy channel when matching
         MIDIchannel::NoteInfo::Phys recent_ins;
 
-        pl_list<LocationData> users;
-        typedef pl_list<LocationData>::iterator users_iterator;
-        typedef pl_list<LocationData>::const_iterator const_users_iterator;
+        fixed_list<LocationData, 128> users;
+        typedef fixed_list<LocationData, 128>::iterator users_iterator;
+        typedef fixed_list<LocationData, 128>::const_iterator const_users_iterator;
 
         users_iterator find_user(const Location &loc)
         {
@@ -477,7 +489,7 @@ public:
         }
 
         // For channel allocation:
-        OpnChannel(): koff_time_until_neglible_us(0), users(128)
+        OpnChannel(): koff_time_until_neglible_us(0)
         {
             std::memset(&recent_ins, 0, sizeof(MIDIchannel::NoteInfo::Phys));
         }
@@ -620,6 +632,13 @@ public:
     //! Generator output buffer
     int32_t m_outBuf[1024];
 
+#if defined(OPNMIDI_ENABLE_THREADED_RENDER)
+    //! Worker threads to render multiple chips concurrently
+    WorkerPool m_renderPool;
+    //! Output buffers of every chip except the first one, 1024 samples per chip
+    std::vector<int32_t> m_chipOutBufs;
+#endif
+
     //! Synthesizer setup
     Setup m_setup;
 
@@ -259,16 +259,22 @@ bool OPN2::setupLocked()
 
 void OPN2::writeReg(size_t chip, uint8_t port, uint8_t index, uint8_t value)
 {
+    if(m_trace.get())
+        m_trace->writeReg(chip, port, index, value);
     m_chips[chip]->writeReg(port, index, value);
 }
 
 void OPN2::writeRegI(size_t chip, uint8_t port, uint32_t index, uint32_t value)
 {
+    if(m_trace.get())
+        m_trace->writeReg(chip, port, static_cast<uint8_t>(index), static_cast<uint8_t>(value));
     m_chips[chip]->writeReg(port, static_cast<uint8_t>(index), static_cast<uint8_t>(value));
 }
 
 void OPN2::writePan(size_t chip, uint32_t index, uint32_t value)
 {
+    if(m_trace.get())
+        m_trace->writePan(chip, static_cast<uint16_t>(index), static_cast<uint8_t>(value));
     m_chips[chip]->writePan(static_cast<uint16_t>(index), static_cast<uint8_t>(value));
 }
 
@@ -713,6 +719,9 @@ void OPN2::reset(int emulator, unsigned long PCM_RATE, OPNFamily family, void *a
     }
 
     m_chipFamily = family;
+    if(m_trace.get())
+        m_trace->reset(family == OPNChip_OPNA ? ChipTrace_OPNA : ChipTrace_OPN2, m_numChips,
+                       static_cast<uint32_t>(PCM_RATE), opn2_getNativeClockRate(family), m_runAtPcmRate);
     m_numChannels = m_numChips * 6;
     m_insCache.resize(m_numChannels,   m_emptyInstrument.op[0]);
     m_regLFOSens.resize(m_numChannels,    0);
@@ -29,6 +29,7 @@
 #include "opnmidi_private.hpp"
 #include "opnmidi_bankmap.h"
 #include "chips/opn_chip_family.h"
+#include "chips/common/chip_trace.hpp"
 
 /**
  * @brief OPN2 Chip management class
@@ -45,6 +46,8 @@ public:
     char _padding[4];
     //! Running chip emulators
     std::vector<AdlMIDI_SPtr<OPNChipBase > > m_chips;
+    //! Register-write trace being recorded, or NULL
+    AdlMIDI_UPtr<ChipTraceWriter> m_trace;
 #ifdef OPNMIDI_MIDI2VGM
     //! Loop Start hook
     void (*m_loopStartHook)(void*);
@@ -138,6 +138,11 @@ class MIDIplay;
 #define OPN_MAX_CHIPS 100
 #define OPN_MAX_CHIPS_STR "100"
 
+#if defined(OPNMIDI_ENABLE_THREADED_RENDER) && (defined(ADLMIDI_AUDIO_TICK_HANDLER) || defined(OPNMIDI_AUDIO_TICK_HANDLER))
+// Chips are calling back the MIDI player on every tick
+#undef OPNMIDI_ENABLE_THREADED_RENDER
+#endif
+
 extern std::string OPN2MIDI_ErrorString;
 
 /*
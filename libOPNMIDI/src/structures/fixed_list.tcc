@@ -0,0 +1,279 @@
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include "fixed_list.hpp"
+#include <new>
+
+template <class List, class Cell>
+fixed_iterator<List, Cell>::fixed_iterator(List *list, std::size_t index)
+    : list_(list), index_(index)
+{
+}
+
+template <class List, class Cell>
+bool fixed_iterator<List, Cell>::is_end() const
+{
+    return index_ == List::endcell;
+}
+
+template <class List, class Cell>
+std::size_t fixed_iterator<List, Cell>::index() const
+{
+    return index_;
+}
+
+template <class List, class Cell>
+Cell &fixed_iterator<List, Cell>::operator*() const
+{
+    return list_->cells_[index_];
+}
+
+template <class List, class Cell>
+Cell *fixed_iterator<List, Cell>::operator->() const
+{
+    return &list_->cells_[index_];
+}
+
+template <class List, class Cell>
+bool fixed_iterator<List, Cell>::operator==(const fixed_iterator &i) const
+{
+    return list_ == i.list_ && index_ == i.index_;
+}
+
+template <class List, class Cell>
+bool fixed_iterator<List, Cell>::operator!=(const fixed_iterator &i) const
+{
+    return !operator==(i);
+}
+
+template <class List, class Cell>
+fixed_iterator<List, Cell> &fixed_iterator<List, Cell>::operator++()
+{
+    index_ = list_->next_[index_];
+    return *this;
+}
+
+template <class List, class Cell>
+fixed_iterator<List, Cell> fixed_iterator<List, Cell>::operator++(int)
+{
+    fixed_iterator i(*this);
+    index_ = list_->next_[index_];
+    return i;
+}
+
+template <class List, class Cell>
+fixed_iterator<List, Cell> &fixed_iterator<List, Cell>::operator--()
+{
+    index_ = list_->prev_[index_];
+    return *this;
+}
+
+template <class List, class Cell>
+fixed_iterator<List, Cell> fixed_iterator<List, Cell>::operator--(int)
+{
+    fixed_iterator i(*this);
+    index_ = list_->prev_[index_];
+    return i;
+}
+
+template <class T, std::size_t N>
+fixed_list<T, N>::fixed_list()
+{
+    clear();
+}
+
+template <class T, std::size_t N>
+std::size_t fixed_list<T, N>::size() const
+{
+    return size_;
+}
+
+template <class T, std::size_t N>
+std::size_t fixed_list<T, N>::capacity() const
+{
+    return N;
+}
+
+template <class T, std::size_t N>
+bool fixed_list<T, N>::empty() const
+{
+    return size_ == 0;
+}
+
+template <class T, std::size_t N>
+typename fixed_list<T, N>::iterator fixed_list<T, N>::begin()
+{
+    return iterator(this, next_[endcell]);
+}
+
+template <class T, std::size_t N>
+typename fixed_list<T, N>::iterator fixed_list<T, N>::end()
+{
+    return iterator(this, endcell);
+}
+
+template <class T, std::size_t N>
+typename fixed_list<T, N>::const_iterator fixed_list<T, N>::begin() const
+{
+    return const_iterator(this, next_[endcell]);
+}
+
+template <class T, std::size_t N>
+typename fixed_list<T, N>::const_iterator fixed_list<T, N>::end() const
+{
+    return const_iterator(this, endcell);
+}
+
+template <class T, std::size_t N>
+typename fixed_list<T, N>::iterator fixed_list<T, N>::slot(std::size_t index)
+{
+    if(index >= N || prev_[index] == freecell)
+        return end();
+    return iterator(this, index);
+}
+
+template <class T, std::size_t N>
+typename fixed_list<T, N>::const_iterator fixed_list<T, N>::slot(std::size_t index) const
+{
+    if(index >= N || prev_[index] == freecell)
+        return end();
+    return const_iterator(this, index);
+}
+
+template <class T, std::size_t N>
+void fixed_list<T, N>::clear()
+{
+    size_ = 0;
+    free_ = 0;
+    next_[endcell] = endcell;
+    prev_[endcell] = endcell;
+    for(std::size_t i = 0; i < N; ++i)
+    {
+        next_[i] = static_cast<index_type>((i + 1 < N) ? (i + 1) : static_cast<std::size_t>(freecell));
+        prev_[i] = freecell;
+        cells_[i].value = T();
+    }
+}
+
+template <class T, std::size_t N>
+fixed_cell<T> &fixed_list<T, N>::front()
+{
+    return cells_[next_[endcell]];
+}
+
+template <class T, std::size_t N>
+const fixed_cell<T> &fixed_list<T, N>::front() const
+{
+    return cells_[next_[endcell]];
+}
+
+template <class T, std::size_t N>
+fixed_cell<T> &fixed_list<T, N>::back()
+{
+    return cells_[prev_[endcell]];
+}
+
+template <class T, std::size_t N>
+const fixed_cell<T> &fixed_list<T, N>::back() const
+{
+    return cells_[prev_[endcell]];
+}
+
+template <class T, std::size_t N>
+typename fixed_list<T, N>::iterator fixed_list<T, N>::insert(iterator pos, const T &x)
+{
+    // take the most recently freed cell, it's the most likely to be cached
+    index_type cell = free_;
+    if(cell == freecell)
+        throw std::bad_alloc();
+    free_ = next_[cell];
+
+    index_type at = static_cast<index_type>(pos.index());
+    index_type before = prev_[at];
+    next_[cell] = at;
+    prev_[cell] = before;
+    next_[before] = cell;
+    prev_[at] = cell;
+
+    cells_[cell].value = x;
+    ++size_;
+    return iterator(this, cell);
+}
+
+template <class T, std::size_t N>
+typename fixed_list<T, N>::iterator fixed_list<T, N>::erase(iterator pos)
+{
+    index_type cell = static_cast<index_type>(pos.index());
+    index_type after = next_[cell];
+    next_[prev_[cell]] = after;
+    prev_[after] = prev_[cell];
+
+    next_[cell] = free_;
+    prev_[cell] = freecell;
+    free_ = cell;
+    --size_;
+    return iterator(this, after);
+}
+
+template <class T, std::size_t N>
+void fixed_list<T, N>::push_front(const T &x)
+{
+    insert(begin(), x);
+}
+
+template <class T, std::size_t N>
+void fixed_list<T, N>::push_back(const T &x)
+{
+    insert(end(), x);
+}
+
+template <class T, std::size_t N>
+void fixed_list<T, N>::pop_front()
+{
+    erase(begin());
+}
+
+template <class T, std::size_t N>
+void fixed_list<T, N>::pop_back()
+{
+    erase(iterator(this, prev_[endcell]));
+}
+
+template <class T, std::size_t N>
+typename fixed_list<T, N>::iterator fixed_list<T, N>::find(const T &x)
+{
+    const_iterator i = const_cast<const fixed_list *>(this)->find(x);
+    return iterator(this, i.index());
+}
+
+template <class T, std::size_t N>
+typename fixed_list<T, N>::const_iterator fixed_list<T, N>::find(const T &x) const
+{
+    for(std::size_t i = next_[endcell]; i != endcell; i = next_[i])
+    {
+        if(cells_[i].value == x)
+            return const_iterator(this, i);
+    }
+    return end();
+}
+
+template <class T, std::size_t N>
+template <class Pred>
+typename fixed_list<T, N>::iterator fixed_list<T, N>::find_if(const Pred &p)
+{
+    const_iterator i = const_cast<const fixed_list *>(this)->find_if(p);
+    return iterator(this, i.index());
+}
+
+template <class T, std::size_t N>
+template <class Pred>
+typename fixed_list<T, N>::const_iterator fixed_list<T, N>::find_if(const Pred &p) const
+{
+    for(std::size_t i = next_[endcell]; i != endcell; i = next_[i])
+    {
+        if(p(cells_[i].value))
+            return const_iterator(this, i);
+    }
+    return end();
+}
@@ -161,8 +161,8 @@ TEST_CASE("[OPNMIDIplay::OpnChannel] User list: copy constructor")
     for(size_t i = 0; i < 3; ++i) {
         REQUIRE(i1 != i2);
         REQUIRE(i1->value.loc == i2->value.loc);
-        i1 = i1->next;
-        i2 = i2->next;
+        ++i1;
+        ++i2;
     }
 }
 
@@ -191,8 +191,8 @@ TEST_CASE("[OPNMIDIplay::OpnChannel] User list: copy assignment")
     for(size_t i = 0; i < 3; ++i) {
         REQUIRE(i1 != i2);
         REQUIRE(i1->value.loc == i2->value.loc);
-        i1 = i1->next;
-        i2 = i2->next;
+        ++i1;
+        ++i2;
     }
 }
 
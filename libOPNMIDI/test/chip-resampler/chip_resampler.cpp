@@ -0,0 +1,224 @@
+#include <catch.hpp>
+#include <cstring>
+#include <vector>
+
+#include "opnmidi.h"
+#include "opnmidi_private.hpp"
+#include "chips/opn_chip_base.h"
+#ifndef OPNMIDI_DISABLE_MAME_EMULATOR
+#include "chips/mame_opn2.h"
+#endif
+#ifndef OPNMIDI_DISABLE_NUKED_EMULATOR
+#include "chips/nuked_opn2.h"
+#endif
+#ifndef OPNMIDI_DISABLE_GENS_EMULATOR
+#include "chips/gens_opn2.h"
+#endif
+#ifndef OPNMIDI_DISABLE_YMFM_EMULATOR
+#include "chips/ymfm_opn2.h"
+#endif
+#ifndef OPNMIDI_DISABLE_NP2_EMULATOR
+#include "chips/np2_opna.h"
+#endif
+
+struct ChipCase
+{
+    int emulator;
+    const char *name;
+    OPNFamily family;
+    // the resampler scale factors of the chip class
+    int32_t preAmplify;
+    int32_t postAttenuate;
+};
+
+static const ChipCase chipCases[] =
+{
+    {OPNMIDI_EMU_MAME, "MAME", OPNChip_OPN2, 1, 1},
+    {OPNMIDI_EMU_NUKED_YM3438, "Nuked", OPNChip_OPN2, 11, 2},
+    {OPNMIDI_EMU_GENS, "GENS", OPNChip_OPN2, 1, 1},
+    {OPNMIDI_EMU_YMFM_OPN2, "YMFM", OPNChip_OPN2, 1, 1},
+    {OPNMIDI_EMU_NP2, "NP2", OPNChip_OPNA, 1, 2},
+};
+
+static OPNChipBase *createChip(int emulator, OPNFamily family)
+{
+    switch(emulator)
+    {
+#ifndef OPNMIDI_DISABLE_MAME_EMULATOR
+    case OPNMIDI_EMU_MAME:
+        return new MameOPN2(family);
+#endif
+#ifndef OPNMIDI_DISABLE_NUKED_EMULATOR
+    case OPNMIDI_EMU_NUKED_YM3438:
+        return new NukedOPN2(family, true);
+#endif
+#ifndef OPNMIDI_DISABLE_GENS_EMULATOR
+    case OPNMIDI_EMU_GENS:
+        return new GensOPN2(family);
+#endif
+#ifndef OPNMIDI_DISABLE_YMFM_EMULATOR
+    case OPNMIDI_EMU_YMFM_OPN2:
+        return new YmFmOPN2(family);
+#endif
+#ifndef OPNMIDI_DISABLE_NP2_EMULATOR
+    case OPNMIDI_EMU_NP2:
+        return new NP2OPNA<>(family);
+#endif
+    default:
+        return NULL;
+    }
+}
+
+// The linear resampler as it was before the block rendering:
+// one native frame at a time, one output frame at a time
+struct ReferenceResampler
+{
+    OPNChipBase *chip;
+    int32_t preAmplify;
+    int32_t postAttenuate;
+    int32_t oldsamples[2];
+    int32_t samples[2];
+    int32_t samplecnt;
+    int32_t rateratio;
+
+    ReferenceResampler(OPNChipBase *c, const ChipCase &cc, uint32_t rate) :
+        chip(c), preAmplify(cc.preAmplify), postAttenuate(cc.postAttenuate), samplecnt(0)
+    {
+        oldsamples[0] = oldsamples[1] = 0;
+        samples[0] = samples[1] = 0;
+        rateratio = (int32_t)(uint32_t)((((uint64_t)144 * rate) << 10) / c->clockRate());
+    }
+
+    void generate32(int32_t *output, size_t frames)
+    {
+        chip->nativePreGenerate();
+        for(size_t i = 0; i < frames; ++i)
+        {
+            while(samplecnt >= rateratio)
+            {
+                oldsamples[0] = samples[0];
+                oldsamples[1] = samples[1];
+                int16_t buffer[2];
+                chip->nativeGenerate(buffer);
+                samples[0] = buffer[0] * preAmplify;
+                samples[1] = buffer[1] * preAmplify;
+                samplecnt -= rateratio;
+            }
+            output[2 * i] = (int32_t)(((oldsamples[0] * (rateratio - samplecnt)
+                                        + samples[0] * samplecnt) / rateratio) / postAttenuate);
+            output[2 * i + 1] = (int32_t)(((oldsamples[1] * (rateratio - samplecnt)
+                                            + samples[1] * samplecnt) / rateratio) / postAttenuate);
+            samplecnt += 1 << 10;
+        }
+        chip->nativePostGenerate();
+    }
+};
+
+// A patch on three channels of both ports, key on and off between the blocks
+struct RegisterSequence
+{
+    size_t step;
+
+    RegisterSequence() : step(0) {}
+
+    static void setup(OPNChipBase *chip)
+    {
+        chip->writeReg(0, 0x22, 0x0B); // LFO on
+        chip->writeReg(0, 0x27, 0x00);
+        chip->writeReg(0, 0x29, 0x80); // six FM channels on OPNA
+        chip->writeReg(0, 0x2B, 0x00);
+        for(uint32_t port = 0; port < 2; ++port)
+        {
+            for(uint16_t ch = 0; ch < 3; ++ch)
+            {
+                chip->writeReg(port, 0xB0 + ch, static_cast<uint8_t>(4 + ch)); // algorithm, feedback
+                chip->writeReg(port, 0xB4 + ch, static_cast<uint8_t>(0xC0 | (ch << 4) | ch)); // pan, AMS, PMS
+                for(uint16_t op = 0; op < 4; ++op)
+                {
+                    uint16_t o = ch + op * 4;
+                    chip->writeReg(port, 0x30 + o, static_cast<uint8_t>(0x01 + op * 0x12));
+                    chip->writeReg(port, 0x40 + o, static_cast<uint8_t>(0x10 + op * 6));
+                    chip->writeReg(port, 0x50 + o, 0x1C);
+                    chip->writeReg(port, 0x60 + o, static_cast<uint8_t>(0x84 + op));
+                    chip->writeReg(port, 0x70 + o, 0x03);
+                    chip->writeReg(port, 0x80 + o, 0x26);
+                }
+            }
+        }
+    }
+
+    void next(OPNChipBase *chip)
+    {
+        uint32_t port = (step / 3) & 1;
+        uint16_t ch = static_cast<uint16_t>(step % 3);
+        uint8_t key = static_cast<uint8_t>((port << 2) | ch);
+        uint16_t fnum = static_cast<uint16_t>(0x269 + (step * 37) % 0x200);
+        chip->writeReg(port, 0xA4 + ch, static_cast<uint8_t>(((step % 4 + 2) << 3) | (fnum >> 8)));
+        chip->writeReg(port, 0xA0 + ch, static_cast<uint8_t>(fnum & 0xFF));
+        chip->writeReg(0, 0x28, key);
+        chip->writeReg(0, 0x28, static_cast<uint8_t>(0xF0 | key));
+        ++step;
+    }
+};
+
+static void compareRate(const ChipCase &cc, uint32_t rate)
+{
+    AdlMIDI_SPtr<OPNChipBase> chip(createChip(cc.emulator, cc.family));
+    AdlMIDI_SPtr<OPNChipBase> refChip(createChip(cc.emulator, cc.family));
+    REQUIRE(chip.get());
+    REQUIRE(refChip.get());
+    chip->setRate(rate, chip->nativeClockRate());
+    refChip->setRate(rate, refChip->nativeClockRate());
+    ReferenceResampler ref(refChip.get(), cc, rate);
+
+    RegisterSequence::setup(chip.get());
+    RegisterSequence::setup(refChip.get());
+    RegisterSequence seq, refSeq;
+
+    // odd block sizes to cross the 256 frame blocks of the resampler
+    static const size_t blockSizes[] = {1, 7, 255, 256, 300, 1000, 2};
+    const size_t total = (rate < 1000) ? 40 : (rate / 2);
+    std::vector<int32_t> out, refOut;
+    size_t done = 0;
+    bool heard = false;
+    for(size_t b = 0; done < total; ++b)
+    {
+        size_t frames = blockSizes[b % (sizeof(blockSizes) / sizeof(size_t))];
+        if(frames > total - done)
+            frames = total - done;
+        out.assign(2 * frames, 0);
+        refOut.assign(2 * frames, 0);
+
+        seq.next(chip.get());
+        refSeq.next(refChip.get());
+        chip->generate32(out.data(), frames);
+        ref.generate32(refOut.data(), frames);
+
+        INFO(cc.name << " at " << rate << " Hz, frames " << done << " to " << (done + frames));
+        REQUIRE(std::memcmp(out.data(), refOut.data(), out.size() * sizeof(int32_t)) == 0);
+        for(size_t i = 0; i < out.size(); ++i)
+            heard = heard || (out[i] != 0);
+        done += frames;
+    }
+
+    INFO(cc.name << " at " << rate << " Hz");
+    REQUIRE(heard);
+}
+
+TEST_CASE("[OPNChipBase] Block resampler gives the per-frame output at any rate")
+{
+    // below the chip rate down to a few native frames per block, and above it
+    static const uint32_t rates[] = {60, 80, 100, 200, 8000, 22050, 44100, 48000, 96000};
+
+    for(size_t c = 0; c < sizeof(chipCases) / sizeof(ChipCase); ++c)
+    {
+        const ChipCase &cc = chipCases[c];
+        OPNChipBase *probe = createChip(cc.emulator, cc.family);
+        if(!probe)
+            continue;
+        delete probe;
+
+        for(size_t r = 0; r < sizeof(rates) / sizeof(uint32_t); ++r)
+            compareRate(cc, rates[r]);
+    }
+}
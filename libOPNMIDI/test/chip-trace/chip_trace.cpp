@@ -0,0 +1,248 @@
+#include <catch.hpp>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "opnmidi.h"
+#include "opnmidi_private.hpp"
+#include "chips/common/chip_trace.hpp"
+#include "chips/opn_chip_base.h"
+#ifndef OPNMIDI_DISABLE_MAME_EMULATOR
+#include "chips/mame_opn2.h"
+#endif
+#ifndef OPNMIDI_DISABLE_NUKED_EMULATOR
+#include "chips/nuked_opn2.h"
+#endif
+#ifndef OPNMIDI_DISABLE_GENS_EMULATOR
+#include "chips/gens_opn2.h"
+#endif
+#ifndef OPNMIDI_DISABLE_YMFM_EMULATOR
+#include "chips/ymfm_opn2.h"
+#include "chips/ymfm_opna.h"
+#endif
+#ifndef OPNMIDI_DISABLE_NP2_EMULATOR
+#include "chips/np2_opna.h"
+#endif
+#ifndef OPNMIDI_DISABLE_MAME_2608_EMULATOR
+#include "chips/mame_opna.h"
+#endif
+
+static const char *test_bank = "fm_banks/xg.wopn";
+static const char *trace_path = TRACE_OUTPUT_DIR "/notes.trc";
+
+static OPNChipBase *createChip(int emulator, OPNFamily family)
+{
+    switch(emulator)
+    {
+#ifndef OPNMIDI_DISABLE_MAME_EMULATOR
+    case OPNMIDI_EMU_MAME:
+        return new MameOPN2(family);
+#endif
+#ifndef OPNMIDI_DISABLE_NUKED_EMULATOR
+    case OPNMIDI_EMU_NUKED_YM3438:
+        return new NukedOPN2(family, true);
+    case OPNMIDI_EMU_NUKED_YM2612:
+        return new NukedOPN2(family, false);
+#endif
+#ifndef OPNMIDI_DISABLE_GENS_EMULATOR
+    case OPNMIDI_EMU_GENS:
+        return new GensOPN2(family);
+#endif
+#ifndef OPNMIDI_DISABLE_YMFM_EMULATOR
+    case OPNMIDI_EMU_YMFM_OPN2:
+        return new YmFmOPN2(family);
+    case OPNMIDI_EMU_YMFM_OPNA:
+        return new YmFmOPNA(family);
+#endif
+#ifndef OPNMIDI_DISABLE_NP2_EMULATOR
+    case OPNMIDI_EMU_NP2:
+        return new NP2OPNA<>(family);
+#endif
+#ifndef OPNMIDI_DISABLE_MAME_2608_EMULATOR
+    case OPNMIDI_EMU_MAME_2608:
+        return new MameOPNA(family);
+#endif
+    default:
+        return NULL;
+    }
+}
+
+static bool isAvailable(int emulator)
+{
+    OPNChipBase *chip = createChip(emulator, OPNChip_OPN2);
+    delete chip;
+    return chip != NULL;
+}
+
+struct ReplayStats
+{
+    size_t frames;
+    size_t writes;
+};
+
+// Drives the chips by the trace, the output is mixed the same way as the library does
+static bool replay(ChipTraceReader &trace, int emulator, std::vector<int16_t> *out, ReplayStats &stats)
+{
+    std::vector<AdlMIDI_SPtr<OPNChipBase> > chips;
+    int32_t buf[1024];
+    ChipTraceEvent e;
+
+    stats.frames = 0;
+    stats.writes = 0;
+    trace.rewind();
+
+    while(trace.next(e))
+    {
+        switch(e.type)
+        {
+        case ChipTraceEvent::Reset:
+        {
+            if(e.family != ChipTrace_OPN2 && e.family != ChipTrace_OPNA)
+                return false;
+            OPNFamily family = (e.family == ChipTrace_OPNA) ? OPNChip_OPNA : OPNChip_OPN2;
+            chips.clear();
+            for(uint32_t i = 0; i < e.chips; ++i)
+            {
+                OPNChipBase *chip = createChip(emulator, family);
+                if(!chip)
+                    return false;
+                chips.push_back(AdlMIDI_SPtr<OPNChipBase>(chip));
+                chip->setChipId(i);
+                chip->setRate(e.rate, chip->nativeClockRate());
+                if(e.flags & ChipTrace_PcmRate)
+                    chip->setRunningAtPcmRate(true);
+            }
+            break;
+        }
+
+        case ChipTraceEvent::Write:
+            if(e.chip >= chips.size())
+                return false;
+            chips[e.chip]->writeReg(e.port, e.address, e.value);
+            ++stats.writes;
+            break;
+
+        case ChipTraceEvent::Pan:
+            if(e.chip >= chips.size())
+                return false;
+            chips[e.chip]->writePan(e.address, e.value);
+            break;
+
+        case ChipTraceEvent::Wait:
+            for(uint32_t left = e.frames; left > 0;)
+            {
+                size_t frames = (left > 512) ? 512 : left;
+                if(chips.size() == 1)
+                    chips[0]->generate32(buf, frames);
+                else
+                {
+                    std::memset(buf, 0, sizeof(buf));
+                    for(size_t i = 0; i < chips.size(); ++i)
+                        chips[i]->generateAndMix32(buf, frames);
+                }
+                if(out)
+                {
+                    for(size_t i = 0; i < 2 * frames; ++i)
+                        out->push_back(static_cast<int16_t>(opn2_cvtS16(buf[i])));
+                }
+                stats.frames += frames;
+                left -= static_cast<uint32_t>(frames);
+            }
+            break;
+
+        default:
+            break;
+        }
+    }
+
+    return true;
+}
+
+// Plays chords on several channels through the real-time interface
+static std::vector<int16_t> recordNotes(int emulator, int chips, size_t blocks)
+{
+    std::vector<int16_t> output;
+    OPN2_MIDIPlayer *p = opn2_init(44100);
+    REQUIRE(p);
+    REQUIRE(opn2_switchEmulator(p, emulator) == 0);
+    REQUIRE(opn2_openBankFile(p, test_bank) == 0);
+    REQUIRE(opn2_setNumChips(p, chips) == 0);
+    REQUIRE(opn2_startChipTrace(p, trace_path) == 0);
+
+    short buf[1024];
+    for(size_t block = 0; block < blocks; ++block)
+    {
+        uint8_t channel = static_cast<uint8_t>(block % 8);
+        uint8_t note = static_cast<uint8_t>(48 + (block * 7) % 24);
+        if(block % 4 == 0)
+            opn2_rt_patchChange(p, channel, static_cast<uint8_t>((block * 13) % 128));
+        opn2_rt_noteOn(p, channel, note, 100);
+        opn2_rt_noteOn(p, channel, static_cast<uint8_t>(note + 4), 90);
+        opn2_rt_pitchBend(p, channel, static_cast<uint16_t>(8192 + ((block % 5) * 512)));
+        if(block >= 3)
+        {
+            uint8_t offChannel = static_cast<uint8_t>((block - 3) % 8);
+            uint8_t offNote = static_cast<uint8_t>(48 + ((block - 3) * 7) % 24);
+            opn2_rt_noteOff(p, offChannel, offNote);
+            opn2_rt_noteOff(p, offChannel, static_cast<uint8_t>(offNote + 4));
+        }
+        int got = opn2_generate(p, 1024, buf);
+        REQUIRE(got == 1024);
+        output.insert(output.end(), buf, buf + got);
+    }
+
+    opn2_stopChipTrace(p);
+    opn2_close(p);
+    return output;
+}
+
+TEST_CASE("[ChipTrace] Replay of the trace is bit-exact")
+{
+    const int emulator = OPNMIDI_EMU_MAME;
+    if(!isAvailable(emulator))
+        return;
+
+    std::vector<int16_t> recorded = recordNotes(emulator, 2, 400);
+
+    ChipTraceReader trace;
+    REQUIRE(trace.open(trace_path));
+
+    std::vector<int16_t> replayed;
+    ReplayStats stats;
+    REQUIRE(replay(trace, emulator, &replayed, stats));
+    REQUIRE(stats.writes > 0);
+    REQUIRE(replayed.size() == recorded.size());
+    REQUIRE(std::memcmp(replayed.data(), recorded.data(), recorded.size() * sizeof(int16_t)) == 0);
+}
+
+TEST_CASE("[ChipTrace] Chip-only throughput benchmark")
+{
+    if(!isAvailable(OPNMIDI_EMU_MAME))
+        return;
+
+    recordNotes(OPNMIDI_EMU_MAME, 1, 800);
+
+    ChipTraceReader trace;
+    REQUIRE(trace.open(trace_path));
+
+    for(int emulator = 0; emulator < OPNMIDI_EMU_end; ++emulator)
+    {
+        OPNChipBase *probe = createChip(emulator, OPNChip_OPN2);
+        if(!probe)
+            continue;
+        std::string name = probe->emulatorName();
+        delete probe;
+
+        ReplayStats stats;
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        REQUIRE(replay(trace, emulator, NULL, stats));
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        std::printf("%-32s %u frames, %u writes: %.2f ms (%.1fx realtime)\n",
+                    name.c_str(),
+                    static_cast<unsigned>(stats.frames), static_cast<unsigned>(stats.writes),
+                    ms, (stats.frames / 44.1) / (ms > 0.0 ? ms : 1.0));
+    }
+}
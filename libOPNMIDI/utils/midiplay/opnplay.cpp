@@ -370,6 +370,7 @@ int main(int argc, char **argv)
             " --emu-ymfm-opna   Use the YMFM OPNA\n"
             // " --emu-pmdwin      Use PMDWin Emulator\n"
             " --chips <count>   Choose a count of emulated concurrent chips\n"
+            " --threads <count> Render multiple chips on several threads (0 - by count of CPU cores)\n"
             "\n"
         );
         std::fflush(stdout);
@@ -415,6 +416,7 @@ int main(int argc, char **argv)
     size_t soloTrack = ~static_cast<size_t>(0u);
     int songNumLoad = -1;
     int chipsCount = -1;//Auto-choose chips count by emulator (Nuked 3, others 8)
+    int threadsCount = 1;
     std::vector<int> muteChannels;
 
     std::string bankPath;
@@ -515,6 +517,15 @@ int main(int argc, char **argv)
             }
             chipsCount = static_cast<int>(std::strtoul(argv[++arg], NULL, 10));
         }
+        else if(!std::strcmp("--threads", argv[arg]))
+        {
+            if(arg + 1 >= argc)
+            {
+                printError("The option --threads requires an argument!\n");
+                return 1;
+            }
+            threadsCount = static_cast<int>(std::strtoul(argv[++arg], NULL, 10));
+        }
         else if(!std::strcmp("--solo", argv[arg]))
         {
             if(arg + 1 >= argc)
@@ -692,6 +703,12 @@ int main(int argc, char **argv)
         chipsCount = 8;
     opn2_setNumChips(myDevice, chipsCount);
 
+    if(threadsCount != 1 && opn2_setThreadCount(myDevice, threadsCount) != 0)
+    {
+        printError(opn2_errorInfo(myDevice));
+        return 2;
+    }
+
     if(volumeModel != OPNMIDI_VolumeModel_AUTO)
         opn2_setVolumeRangeModel(myDevice, volumeModel);
 
@@ -702,6 +719,8 @@ int main(int argc, char **argv)
     }
 
     std::fprintf(stdout, " - Number of chips %d\n", opn2_getNumChipsObtained(myDevice));
+    if(opn2_getThreadCount(myDevice) > 1)
+        std::fprintf(stdout, " - Rendering threads: %d\n", opn2_getThreadCount(myDevice));
     std::fprintf(stdout, " - Track count: %lu\n", static_cast<unsigned long>(opn2_trackCount(myDevice)));
     std::fprintf(stdout, " - Volume model: %s\n", volume_model_to_str(opn2_getVolumeRangeModel(myDevice)));
     std::fprintf(stdout, " - Channel allocation mode: %s\n", chanalloc_to_str(opn2_getChannelAllocMode(myDevice)));
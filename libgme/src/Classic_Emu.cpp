@@ -101,6 +101,21 @@ blargg_err_t Classic_Emu::start_track_( int track )
 	return 0;
 }
 
+blargg_err_t Classic_Emu::run_frame()
+{
+	if ( buf_changed_count != buf->channels_changed_count() )
+	{
+		buf_changed_count = buf->channels_changed_count();
+		remute_voices();
+	}
+	int msec = buf->length();
+	blip_time_t clocks_emulated = (blargg_long) msec * clock_rate_ / 1000;
+	RETURN_ERR( run_clocks( clocks_emulated, msec ) );
+	assert( clocks_emulated );
+	buf->end_frame( clocks_emulated );
+	return 0;
+}
+
 blargg_err_t Classic_Emu::play_( long count, sample_t* out )
 {
 	long remain = count;
@@ -108,22 +123,37 @@ blargg_err_t Classic_Emu::play_( long count, sample_t* out )
 	{
 		remain -= buf->read_samples( &out [count - remain], remain );
 		if ( remain )
-		{
-			if ( buf_changed_count != buf->channels_changed_count() )
-			{
-				buf_changed_count = buf->channels_changed_count();
-				remute_voices();
-			}
-			int msec = buf->length();
-			blip_time_t clocks_emulated = (blargg_long) msec * clock_rate_ / 1000;
-			RETURN_ERR( run_clocks( clocks_emulated, msec ) );
-			assert( clocks_emulated );
-			buf->end_frame( clocks_emulated );
-		}
+			RETURN_ERR( run_frame() );
 	}
 	return 0;
 }
 
+blargg_err_t Classic_Emu::skip_muted_( long count )
+{
+	// muted voices add nothing to buffer, so drop samples without mixing them
+	while ( count )
+	{
+		long n = buf->samples_avail();
+		if ( n > count )
+			n = count;
+		buf->remove_samples( n );
+		count -= n;
+		if ( count )
+			RETURN_ERR( run_frame() );
+	}
+	return 0;
+}
+
+long Classic_Emu::snapshot_ahead_() const
+{
+	return buf->samples_avail();
+}
+
+void Classic_Emu::snapshot_loaded_()
+{
+	buf->clear();
+}
+
 // Rom_Data
 
 blargg_err_t Rom_Data_::load_rom_data_( Data_Reader& in,
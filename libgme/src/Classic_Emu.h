@@ -33,12 +33,17 @@ protected:
 	void mute_voices_( int ) override;
 	void set_equalizer_( equalizer_t const& ) override;
 	blargg_err_t play_( long, sample_t* ) override;
+	blargg_err_t skip_muted_( long ) override;
+	long snapshot_ahead_() const override;
+	void snapshot_loaded_() override;
 private:
 	Multi_Buffer* buf;
 	Multi_Buffer* stereo_buffer; // NULL if using custom buffer
 	long clock_rate_;
 	unsigned buf_changed_count;
 	int const* voice_types;
+	
+	blargg_err_t run_frame();
 };
 
 inline void Classic_Emu::set_buffer( Multi_Buffer* new_buf )
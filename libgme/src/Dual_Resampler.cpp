@@ -66,6 +66,14 @@ void Dual_Resampler::play_frame_( Blip_Buffer& blip_buf, dsample_t* out )
 	assert( blip_buf.samples_avail() == pair_count );
 	
 	resampler.write( new_count );
+	
+	if ( !out )
+	{
+		// skipping, so neither resample nor mix
+		resampler.skip_output( sample_buf_size );
+		blip_buf.remove_samples( pair_count );
+		return;
+	}
 
 #ifdef	NDEBUG // Avoid warning when asserts are disabled
 	resampler.read( sample_buf.begin(), sample_buf_size );
@@ -110,6 +118,31 @@ void Dual_Resampler::dual_play( long count, dsample_t* out, Blip_Buffer& blip_bu
 	}
 }
 
+void Dual_Resampler::dual_skip( long count, Blip_Buffer& blip_buf )
+{
+	// drop extra buffer
+	long remain = sample_buf_size - buf_pos;
+	if ( remain > count )
+		remain = count;
+	count -= remain;
+	buf_pos += remain;
+	
+	// entire frames
+	while ( count >= (long) sample_buf_size )
+	{
+		play_frame_( blip_buf, 0 );
+		count -= sample_buf_size;
+	}
+	
+	// extra; voices are muted while skipping, so rest of frame is silent
+	if ( count )
+	{
+		play_frame_( blip_buf, 0 );
+		memset( sample_buf.begin(), 0, sample_buf_size * sizeof sample_buf [0] );
+		buf_pos = count;
+	}
+}
+
 void Dual_Resampler::mix_samples( Blip_Buffer& blip_buf, dsample_t* out )
 {
 	Blip_Reader sn;
@@ -21,6 +21,13 @@ public:
 	
 	void dual_play( long count, dsample_t* out, Blip_Buffer& );
 	
+	// Same as dual_play() but output is neither resampled nor mixed. Only valid
+	// while all voices are muted.
+	void dual_skip( long count, Blip_Buffer& );
+	
+	// Number of samples generated but not yet returned by dual_play()
+	int samples_avail() const { return sample_buf_size - buf_pos; }
+	
 protected:
 	virtual int play_frame( blip_time_t, int pcm_count, dsample_t* pcm_out ) = 0;
 private:
@@ -190,6 +190,8 @@ int Fir_Resampler_::skip_input( long count )
 	int max_count = remain - width_ * stereo;
 	if ( count > max_count )
 		count = max_count;
+	if ( count < 0 ) // less than one impulse of input right after clear()
+		count = 0;
 	
 	remain -= count;
 	write_pos = &buf [remain];
@@ -197,3 +199,75 @@ int Fir_Resampler_::skip_input( long count )
 	
 	return count;
 }
+
+int Fir_Resampler_::skip_output( blargg_long count )
+{
+	// same input bookkeeping as read(), without running filter
+	sample_t const* in = buf.begin();
+	sample_t const* end_pos = write_pos;
+	blargg_ulong skip = skip_bits >> imp_phase;
+	int remain = res - imp_phase;
+	int skipped = 0;
+	
+	count >>= 1;
+	
+	const double ratio1 = ratio_ - 1.0;
+	const bool should_resample =
+		( ratio1 >= 0 ? ratio1 : -ratio1 ) >= 0.00001;
+	
+	if ( end_pos - in >= width_ * stereo )
+	{
+		end_pos -= width_ * stereo;
+		do
+		{
+			count--;
+			if ( count < 0 )
+				break;
+			
+			if ( should_resample )
+			{
+				remain--;
+				in += (skip * stereo) & stereo;
+				skip >>= 1;
+				if ( !remain )
+				{
+					skip = skip_bits;
+					remain = res;
+				}
+			}
+			
+			in += step;
+			skipped += 2;
+		}
+		while ( in <= end_pos );
+	}
+	
+	imp_phase = res - remain;
+	
+	int left = write_pos - in;
+	write_pos = &buf [left];
+	memmove( buf.begin(), in, left * sizeof *in );
+	
+	return skipped;
+}
+
+long Fir_Resampler_::snapshot_size() const
+{
+	return 2 * sizeof (int) + buf.size() * sizeof buf [0];
+}
+
+void Fir_Resampler_::save_snapshot( void* out ) const
+{
+	int state [2] = { int (write_pos - buf.begin()), imp_phase };
+	memcpy( out, state, sizeof state );
+	memcpy( (char*) out + sizeof state, buf.begin(), buf.size() * sizeof buf [0] );
+}
+
+void Fir_Resampler_::load_snapshot( void const* in )
+{
+	int state [2];
+	memcpy( state, in, sizeof state );
+	memcpy( buf.begin(), (char const*) in + sizeof state, buf.size() * sizeof buf [0] );
+	write_pos = buf.begin() + state [0];
+	imp_phase = state [1];
+}
@@ -53,6 +53,20 @@ public:
 	// Number of output samples available
 	int avail() const { return avail_( write_pos - &buf [width_ * stereo] ); }
 	
+	// Skip at most 'count' output samples without generating them. Returns number
+	// of samples actually skipped.
+	int skip_output( blargg_long count );
+	
+// Snapshots
+	
+	// Size of snapshot of buffered input and filter phase
+	long snapshot_size() const;
+	
+	// Saves buffered input and filter phase to snapshot_size() bytes at out, or
+	// restores them from a snapshot saved earlier by this same resampler
+	void save_snapshot( void* out ) const;
+	void load_snapshot( void const* in );
+	
 public:
 	~Fir_Resampler_();
 protected:
@@ -130,6 +130,87 @@ void Gb_Apu::reset()
 	memcpy( wave.wave, initial_wave, sizeof initial_wave );
 }
 
+// State save/load
+
+static void save_osc( Gb_Osc const& osc, gb_apu_state_t::osc_t* out )
+{
+	memset( out, 0, sizeof *out );
+	out->output_select = osc.output_select;
+	out->delay         = osc.delay;
+	out->last_amp      = osc.last_amp;
+	out->volume        = osc.volume;
+	out->length        = osc.length;
+	out->enabled       = osc.enabled;
+}
+
+static void load_osc( Gb_Osc& osc, gb_apu_state_t::osc_t const& in )
+{
+	osc.output_select = in.output_select;
+	osc.output        = osc.outputs [in.output_select];
+	osc.delay         = in.delay;
+	osc.last_amp      = in.last_amp;
+	osc.volume        = in.volume;
+	osc.length        = in.length;
+	osc.enabled       = in.enabled;
+}
+
+static void save_square( Gb_Square const& sq, gb_apu_state_t::osc_t* out )
+{
+	save_osc( sq, out );
+	out->env_delay   = sq.env_delay;
+	out->sweep_delay = sq.sweep_delay;
+	out->sweep_freq  = sq.sweep_freq;
+	out->phase       = sq.phase;
+}
+
+static void load_square( Gb_Square& sq, gb_apu_state_t::osc_t const& in )
+{
+	load_osc( sq, in );
+	sq.env_delay   = in.env_delay;
+	sq.sweep_delay = in.sweep_delay;
+	sq.sweep_freq  = in.sweep_freq;
+	sq.phase       = in.phase;
+}
+
+void Gb_Apu::save_state( gb_apu_state_t* out ) const
+{
+	save_square( square1, &out->oscs [0] );
+	save_square( square2, &out->oscs [1] );
+	
+	save_osc( wave, &out->oscs [2] );
+	out->oscs [2].wave_pos = wave.wave_pos;
+	memcpy( out->wave, wave.wave, sizeof out->wave );
+	
+	save_osc( noise, &out->oscs [3] );
+	out->oscs [3].env_delay = noise.env_delay;
+	out->oscs [3].bits      = noise.bits;
+	
+	memcpy( out->regs, regs, sizeof out->regs );
+	out->next_frame_time = next_frame_time;
+	out->last_time       = last_time;
+	out->frame_count     = frame_count;
+}
+
+void Gb_Apu::load_state( gb_apu_state_t const& in )
+{
+	load_square( square1, in.oscs [0] );
+	load_square( square2, in.oscs [1] );
+	
+	load_osc( wave, in.oscs [2] );
+	wave.wave_pos = in.oscs [2].wave_pos;
+	memcpy( wave.wave, in.wave, sizeof wave.wave );
+	
+	load_osc( noise, in.oscs [3] );
+	noise.env_delay = in.oscs [3].env_delay;
+	noise.bits      = in.oscs [3].bits;
+	
+	memcpy( regs, in.regs, sizeof regs );
+	next_frame_time = in.next_frame_time;
+	last_time       = in.last_time;
+	frame_count     = in.frame_count;
+	update_volume();
+}
+
 void Gb_Apu::run_until( blip_time_t end_time )
 {
 	require( end_time >= last_time ); // end_time must not be before previous time
@@ -6,6 +6,8 @@
 
 #include "Gb_Oscs.h"
 
+struct gb_apu_state_t;
+
 class Gb_Apu {
 public:
 	
@@ -50,6 +52,10 @@ public:
 	
 	void set_tempo( double );
 	
+	// Save/load exact emulation state
+	void save_state( gb_apu_state_t* out ) const;
+	void load_state( gb_apu_state_t const& );
+	
 public:
 	Gb_Apu();
 private:
@@ -77,6 +83,32 @@ private:
 	void write_osc( int index, int reg, int data );
 };
 
+// Exact emulation state, as saved by Gb_Apu::save_state()
+struct gb_apu_state_t
+{
+	struct osc_t
+	{
+		int output_select;
+		int delay;
+		int last_amp;
+		int volume;
+		int length;
+		int enabled;
+		int env_delay;   // squares and noise
+		int sweep_delay; // squares
+		int sweep_freq;
+		int phase;
+		unsigned bits;   // noise
+		int wave_pos;    // wave
+	};
+	osc_t oscs [Gb_Apu::osc_count];
+	uint8_t wave [Gb_Wave::wave_size];
+	uint8_t regs [Gb_Apu::register_count];
+	blip_time_t next_frame_time;
+	blip_time_t last_time;
+	int frame_count;
+};
+
 inline void Gb_Apu::output( Blip_Buffer* b ) { output( b, b, b ); }
 	
 inline void Gb_Apu::osc_output( int i, Blip_Buffer* b ) { osc_output( i, b, b, b ); }
@@ -68,6 +68,25 @@ void Gb_Cpu::reset( void* unmapped )
 	blargg_verify_byte_order();
 }
 
+long Gb_Cpu::snapshot_size() const
+{
+	return sizeof r + sizeof state_;
+}
+
+void Gb_Cpu::save_snapshot( void* out ) const
+{
+	check( state == &state_ );
+	memcpy( out, &r, sizeof r );
+	memcpy( (uint8_t*) out + sizeof r, &state_, sizeof state_ );
+}
+
+void Gb_Cpu::load_snapshot( void const* in )
+{
+	check( state == &state_ );
+	memcpy( &r, in, sizeof r );
+	memcpy( &state_, (uint8_t const*) in + sizeof r, sizeof state_ );
+}
+
 void Gb_Cpu::map_code( gb_addr_t start, unsigned size, void* data )
 {
 	// address range must begin and end on page boundaries
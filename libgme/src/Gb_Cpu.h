@@ -60,6 +60,14 @@ public:
 	// Can read this many bytes past end of a page
 	enum { cpu_padding = 8 };
 	
+	// Size of snapshot of registers, memory mapping, and timing
+	long snapshot_size() const;
+	
+	// Saves CPU state to snapshot_size() bytes at out, or restores it from a
+	// snapshot saved earlier by this same CPU. Must not be called during run().
+	void save_snapshot( void* out ) const;
+	void load_snapshot( void const* in );
+	
 public:
 	Gb_Cpu() : rst_base( 0 ) { state = &state_; }
 	enum { page_shift = 13 };
@@ -240,6 +240,27 @@ blargg_err_t Gbs_Emu::start_track_( int track )
 	return 0;
 }
 
+blargg_err_t Gbs_Emu::copy_snapshot_( snapshot_io_t& io )
+{
+	void* p = io.data( cpu::snapshot_size() );
+	if ( p && io.loading() )
+		cpu::load_snapshot( p );
+	else if ( p )
+		cpu::save_snapshot( p );
+	
+	gb_apu_state_t apu_state;
+	if ( !io.loading() )
+		apu.save_state( &apu_state );
+	io.copy( &apu_state, sizeof apu_state );
+	if ( io.loading() )
+		apu.load_state( apu_state );
+	
+	io.copy( ram, sizeof ram );
+	io.copy( &play_period, sizeof play_period );
+	io.copy( &next_play, sizeof next_play );
+	return 0;
+}
+
 blargg_err_t Gbs_Emu::run_clocks( blip_time_t& duration, int )
 {
 	cpu_time = 0;
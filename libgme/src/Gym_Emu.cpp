@@ -378,3 +378,9 @@ blargg_err_t Gym_Emu::play_( long count, sample_t* out )
 	Dual_Resampler::dual_play( count, out, blip_buf );
 	return 0;
 }
+
+blargg_err_t Gym_Emu::skip_muted_( long count )
+{
+	Dual_Resampler::dual_skip( count, blip_buf );
+	return 0;
+}
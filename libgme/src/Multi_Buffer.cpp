@@ -28,6 +28,19 @@ Multi_Buffer::Multi_Buffer( int spf ) : samples_per_frame_( spf )
 
 blargg_err_t Multi_Buffer::set_channel_count( int ) { return 0; }
 
+void Multi_Buffer::remove_samples( long count )
+{
+	const long scratch_size = 1024;
+	blip_sample_t scratch [scratch_size];
+	while ( count > 0 )
+	{
+		long n = read_samples( scratch, (count < scratch_size ? count : scratch_size) );
+		if ( !n )
+			break;
+		count -= n;
+	}
+}
+
 // Silent_Buffer
 
 Silent_Buffer::Silent_Buffer() : Multi_Buffer( 1 ) // 0 channels would probably confuse
@@ -148,6 +161,21 @@ long Stereo_Buffer::read_samples( blip_sample_t* out, long count )
 	return count * 2;
 }
 
+void Stereo_Buffer::remove_samples( long count )
+{
+	require( !(count & 1) ); // count must be even
+	count = (unsigned) count / 2;
+	
+	for ( int i = 0; i < buf_count; i++ )
+		bufs [i].remove_samples( count );
+	
+	if ( !bufs [0].samples_avail() )
+	{
+		was_stereo   = stereo_added;
+		stereo_added = 0;
+	}
+}
+
 void Stereo_Buffer::mix_stereo( blip_sample_t* out_, blargg_long count )
 {
 	blip_sample_t* BLIP_RESTRICT out = out_;
@@ -51,6 +51,10 @@ public:
 	virtual long read_samples( blip_sample_t*, long ) = 0;
 	virtual long samples_avail() const = 0;
 	
+	// Remove 'count' samples without mixing them, for skipping. Default reads
+	// them into a scratch buffer.
+	virtual void remove_samples( long count );
+	
 public:
 	BLARGG_DISABLE_NOTHROW
 protected:
@@ -83,6 +87,7 @@ public:
 	void clear() { buf.clear(); }
 	long samples_avail() const { return buf.samples_avail(); }
 	long read_samples( blip_sample_t* p, long s ) { return buf.read_samples( p, s ); }
+	void remove_samples( long s ) { buf.remove_samples( s ); }
 	channel_t channel( int, int ) { return chan; }
 	void end_frame( blip_time_t t ) { buf.end_frame( t ); }
 };
@@ -108,6 +113,7 @@ public:
 	
 	long samples_avail() const { return bufs [0].samples_avail() * 2; }
 	long read_samples( blip_sample_t*, long );
+	void remove_samples( long );
 	
 private:
 	enum { buf_count = 3 };
@@ -134,6 +140,7 @@ public:
 	void end_frame( blip_time_t ) { }
 	long samples_avail() const { return 0; }
 	long read_samples( blip_sample_t*, long ) { return 0; }
+	void remove_samples( long ) { }
 };
 
 
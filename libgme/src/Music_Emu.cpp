@@ -35,6 +35,7 @@ void Music_Emu::clear_track_vars()
 	current_track_   = -1;
 	out_time         = 0;
 	emu_time         = 0;
+	skip_remain      = 0;
 	emu_track_ended_ = true;
 	track_ended_     = true;
 	fade_start       = INT_MAX / 2 + 1;
@@ -49,6 +50,8 @@ void Music_Emu::unload()
 {
 	voice_count_ = 0;
 	clear_track_vars();
+	clear_snapshots();
+	snapshot_track = -1;
 	Gme_File::unload();
 }
 
@@ -69,6 +72,10 @@ Music_Emu::Music_Emu()
 	equalizer_.bass     = 60;
 	
 	emu_autoload_playback_limit_ = true;
+	
+	snapshot_interval = 0;
+	snapshot_count    = 0;
+	snapshot_size     = 0;
 
 	static const char* const names [] = {
 		"Voice 1", "Voice 2", "Voice 3", "Voice 4",
@@ -151,6 +158,7 @@ void Music_Emu::set_tempo( double t )
 	if ( t > max ) t = max;
 	tempo_ = t;
 	set_tempo_( t );
+	clear_snapshots(); // track timing changed
 }
 
 void Music_Emu::post_load_()
@@ -159,9 +167,22 @@ void Music_Emu::post_load_()
 	remute_voices();
 }
 
+void Music_Emu::ignore_silence( bool b )
+{
+	if ( ignore_silence_ != b )
+		clear_snapshots(); // changes where track time begins
+	ignore_silence_ = b;
+}
+
 blargg_err_t Music_Emu::start_track( int track )
 {
 	clear_track_vars();
+	if ( track != snapshot_track )
+	{
+		clear_snapshots();
+		snapshot_track = track;
+	}
+	next_snapshot = INT_MAX; // none during initial silence, before time is adjusted
 	
 	int remapped = track;
 	RETURN_ERR( remap_track_( &remapped ) );
@@ -186,6 +207,7 @@ blargg_err_t Music_Emu::start_track( int track )
 		silence_time  = 0;
 		silence_count = 0;
 	}
+	update_next_snapshot();
 	return track_ended() ? warning() : 0;
 }
 
@@ -231,7 +253,15 @@ long Music_Emu::tell() const
 
 blargg_err_t Music_Emu::seek_samples( long time )
 {
-	if ( time < out_time )
+	// use latest snapshot at or before time if it's ahead of emulator or
+	// would avoid restarting track
+	int i = snapshot_count;
+	while ( i && snapshot_times [i - 1] > time )
+		i--;
+	
+	if ( i && (time < out_time || snapshot_times [i - 1] > emu_time) )
+		RETURN_ERR( load_snapshot( i - 1 ) );
+	else if ( time < out_time )
 		RETURN_ERR( start_track( current_track_ ) );
 	return skip( time - out_time );
 }
@@ -257,11 +287,21 @@ blargg_err_t Music_Emu::skip( long count )
 		count -= n;
 	}
 		
-	if ( count && !emu_track_ended_ )
+	while ( count && !emu_track_ended_ )
 	{
-		emu_time += count;
-		end_track_if_error( skip_( count ) );
+		// stop at each snapshot along the way
+		long n = count;
+		if ( next_snapshot > emu_time && next_snapshot - emu_time < n )
+			n = next_snapshot - emu_time;
+		count -= n;
+		
+		emu_time += n;
+		skip_remain = count;
+		end_track_if_error( skip_( n ) );
+		if ( emu_time >= next_snapshot && !emu_track_ended_ )
+			save_snapshot();
 	}
+	skip_remain = 0;
 	
 	if ( !(silence_count | buf_remain) ) // caught up to emulator, so update track ended
 		track_ended_ |= emu_track_ended_;
@@ -271,17 +311,21 @@ blargg_err_t Music_Emu::skip( long count )
 
 blargg_err_t Music_Emu::skip_( long count )
 {
-	// for long skip, mute sound
+	// for long skip, mute sound; skip() splits the skip at snapshots, so only
+	// the end of the whole skip is played normally, not the end of every part
 	const long threshold = 30000;
-	if ( count > threshold )
+	if ( count + skip_remain > threshold )
 	{
 		int saved_mute = mute_mask_;
 		mute_voices( ~0 );
 		
-		while ( count > threshold / 2 && !emu_track_ended_ )
+		while ( count > threshold / 2 - skip_remain && count > 0 && !emu_track_ended_ )
 		{
-			RETURN_ERR( play_( buf_size, buf.begin() ) );
-			count -= buf_size;
+			long n = buf_size;
+			if ( n > count )
+				n = count;
+			RETURN_ERR( skip_muted_( n ) );
+			count -= n;
 		}
 		
 		mute_voices( saved_mute );
@@ -298,6 +342,133 @@ blargg_err_t Music_Emu::skip_( long count )
 	return 0;
 }
 
+blargg_err_t Music_Emu::skip_muted_( long count )
+{
+	return play_( count, buf.begin() );
+}
+
+// Seek snapshots
+
+void Music_Emu::snapshot_io_t::copy( void* p, long n )
+{
+	if ( mode == save )
+		memcpy( pos, p, n );
+	else if ( mode == load )
+		memcpy( p, pos, n );
+	data( n );
+}
+
+void* Music_Emu::snapshot_io_t::data( long n )
+{
+	byte* p = pos;
+	if ( pos )
+		pos += n;
+	size += n;
+	return p;
+}
+
+blargg_err_t Music_Emu::copy_snapshot_( snapshot_io_t& )
+{
+	return "Seek snapshots not supported by this emulator";
+}
+
+void Music_Emu::set_seek_snapshots( long msec )
+{
+	require( sample_rate() ); // sample rate must be set first
+	clear_snapshots();
+	snapshot_interval = (msec > 0 ? msec_to_samples( msec ) : 0);
+	update_next_snapshot();
+}
+
+void Music_Emu::clear_snapshots()
+{
+	snapshots.clear();
+	snapshot_times.clear();
+	snapshot_count = 0;
+	snapshot_size  = 0;
+	update_next_snapshot();
+}
+
+void Music_Emu::update_next_snapshot()
+{
+	next_snapshot = INT_MAX;
+	if ( snapshot_interval && snapshot_size >= 0 )
+		next_snapshot = (snapshot_count ? snapshot_times [snapshot_count - 1] : 0) +
+				snapshot_interval;
+}
+
+void Music_Emu::save_snapshot()
+{
+	snapshot_io_t io;
+	io.size = 0;
+	if ( !snapshot_size )
+	{
+		// first snapshot of track, so find size
+		io.mode = snapshot_io_t::measure;
+		io.pos  = 0;
+		snapshot_size = (copy_snapshot_( io ) || !io.size) ? -1 : io.size;
+	}
+	
+	if ( snapshot_size > 0 && (size_t) snapshot_count >= snapshot_times.size() )
+	{
+		size_t n = max( (size_t) 8, snapshot_times.size() * 2 );
+		if ( snapshots.resize( n * snapshot_size ) || snapshot_times.resize( n ) )
+			snapshot_size = -1;
+	}
+	
+	if ( snapshot_size > 0 )
+	{
+		io.mode = snapshot_io_t::save;
+		io.pos  = &snapshots [snapshot_count * snapshot_size];
+		io.size = 0;
+		if ( copy_snapshot_( io ) || io.size != snapshot_size )
+			snapshot_size = -1; // state size shouldn't change during track
+		else
+			snapshot_times [snapshot_count++] = emu_time + snapshot_ahead_();
+	}
+	
+	if ( snapshot_size < 0 )
+	{
+		snapshots.clear();
+		snapshot_times.clear();
+		snapshot_count = 0;
+	}
+	update_next_snapshot();
+}
+
+blargg_err_t Music_Emu::load_snapshot( int index )
+{
+	snapshot_io_t io;
+	io.mode = snapshot_io_t::load;
+	io.pos  = &snapshots [index * snapshot_size];
+	io.size = 0;
+	RETURN_ERR( copy_snapshot_( io ) );
+	snapshot_loaded_();
+	remute_voices();
+	
+	out_time         = snapshot_times [index];
+	emu_time         = out_time;
+	silence_time     = out_time;
+	silence_count    = 0;
+	buf_remain       = 0;
+	emu_track_ended_ = false;
+	track_ended_     = false;
+	return 0;
+}
+
+blargg_err_t Music_Emu::prescan_snapshots( long end_msec )
+{
+	require( current_track() >= 0 ); // start_track() must have been called already
+	if ( !snapshot_interval )
+		return "Seek snapshots not enabled";
+	
+	long pos = out_time;
+	RETURN_ERR( seek_samples( msec_to_samples( end_msec ) ) );
+	if ( snapshot_size < 0 )
+		return "Seek snapshots not supported by this emulator";
+	return seek_samples( pos );
+}
+
 // Fading
 
 void Music_Emu::set_fade( long start_msec, long length_msec )
@@ -341,7 +512,11 @@ void Music_Emu::emu_play( long count, sample_t* out )
 	check( current_track_ >= 0 );
 	emu_time += count;
 	if ( current_track_ >= 0 && !emu_track_ended_ )
+	{
 		end_track_if_error( play_( count, out ) );
+		if ( emu_time >= next_snapshot && !emu_track_ended_ )
+			save_snapshot();
+	}
 	else
 		memset( out, 0, count * sizeof *out );
 }
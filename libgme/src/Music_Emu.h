@@ -60,6 +60,17 @@ public:
 	// Skip n samples
 	blargg_err_t skip( long n );
 	
+	// Save emulator state every interval_msec of track time while playing or
+	// skipping, so that later seeks resume from the nearest earlier snapshot
+	// instead of restarting the track. 0 disables snapshots and frees them.
+	// Snapshots are kept until a different track is started. Only supported by
+	// some emulators; others ignore this and seek as before.
+	void set_seek_snapshots( long interval_msec );
+	
+	// Emulate current track up to end_msec, saving snapshots along the way, then
+	// return to the current position. Snapshots must already be enabled.
+	blargg_err_t prescan_snapshots( long end_msec );
+	
 	// True if a track has reached its end
 	bool track_ended() const;
 	
@@ -155,6 +166,41 @@ protected:
 	virtual blargg_err_t start_track_( int ) = 0; // tempo is set before this
 	virtual blargg_err_t play_( long count, sample_t* out ) = 0;
 	virtual blargg_err_t skip_( long count );
+	
+	// Called by skip_() for the bulk of a long skip, with all voices muted.
+	// Default plays into a scratch buffer; emulators that can run without
+	// generating output override this. It still runs the CPU and sound chips,
+	// only the synthesis, mixing and resampling of the muted output is left
+	// out, so the gain depends on how much of the time these take.
+	virtual blargg_err_t skip_muted_( long count );
+	
+	// Seek snapshot support
+	class snapshot_io_t {
+	public:
+		bool loading() const            { return mode == load; }
+		
+		// Copy n bytes at p to or from snapshot
+		void copy( void* p, long n );
+		
+		// Pointer to next n bytes of snapshot, or NULL if only measuring its size
+		void* data( long n );
+	private:
+		enum mode_t { measure, save, load };
+		mode_t mode;
+		byte* pos;
+		long size;
+		friend struct Music_Emu;
+	};
+	
+	// Save or restore all emulation state through io. Default returns error,
+	// indicating that snapshots aren't supported.
+	virtual blargg_err_t copy_snapshot_( snapshot_io_t& io );
+	
+	// Number of samples already emulated but not yet returned by play_()
+	virtual long snapshot_ahead_() const                { return 0; }
+	
+	// Called after restoring a snapshot, to discard samples still buffered
+	virtual void snapshot_loaded_() { }
 protected:
 	virtual void unload();
 	virtual void pre_load();
@@ -180,6 +226,7 @@ private:
 	int current_track_;
 	blargg_long out_time;  // number of samples played since start of track
 	blargg_long emu_time;  // number of samples emulator has generated since start of track
+	long skip_remain;      // samples skip() still has to skip after current skip_() call
 	bool emu_track_ended_; // emulator has reached end of track
 	bool emu_autoload_playback_limit_; // whether to load and obey track length by default
 	volatile bool track_ended_;
@@ -202,6 +249,19 @@ private:
 	void fill_buf();
 	void emu_play( long count, sample_t* out );
 	
+	// seek snapshots
+	blargg_long snapshot_interval; // samples between snapshots, 0 if disabled
+	blargg_long next_snapshot;     // emu_time at which next snapshot is due
+	long snapshot_size;            // bytes per snapshot, 0 if unknown, -1 if unsupported
+	int snapshot_count;
+	int snapshot_track;            // track snapshots were taken from
+	blargg_vector<byte> snapshots;
+	blargg_vector<blargg_long> snapshot_times;
+	void clear_snapshots();
+	void update_next_snapshot();
+	void save_snapshot();
+	blargg_err_t load_snapshot( int index );
+	
 	Multi_Buffer* effects_buffer;
 	friend Music_Emu* gme_internal_new_emu_( gme_type_t, int, bool );
 	friend void gme_set_stereo_depth( Music_Emu*, double );
@@ -236,7 +296,6 @@ inline const Music_Emu::equalizer_t& Music_Emu::equalizer() const { return equal
 inline void Music_Emu::enable_accuracy( bool b )    { enable_accuracy_( b ); }
 inline void Music_Emu::set_tempo_( double t )       { tempo_ = t; }
 inline void Music_Emu::remute_voices()              { mute_voices( mute_mask_ ); }
-inline void Music_Emu::ignore_silence( bool b )     { ignore_silence_ = b; }
 inline blargg_err_t Music_Emu::start_track_( int )  { return 0; }
 
 inline void Music_Emu::set_voice_names( const char* const* names )
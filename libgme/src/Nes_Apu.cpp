@@ -115,6 +115,130 @@ void Nes_Apu::reset( bool pal_mode, int initial_dmc_dac )
 		dmc.last_amp = initial_dmc_dac; // prevent output transition
 }
 
+// State save/load
+
+static void save_osc( Nes_Osc const& osc, apu_state_t::osc_t* out )
+{
+	for ( int i = 0; i < 4; i++ )
+	{
+		out->regs [i] = osc.regs [i];
+		out->reg_written [i] = osc.reg_written [i];
+	}
+	out->length_counter = osc.length_counter;
+	out->delay          = osc.delay;
+	out->last_amp       = osc.last_amp;
+}
+
+static void load_osc( Nes_Osc& osc, apu_state_t::osc_t const& in )
+{
+	for ( int i = 0; i < 4; i++ )
+	{
+		osc.regs [i] = in.regs [i];
+		osc.reg_written [i] = in.reg_written [i];
+	}
+	osc.length_counter = in.length_counter;
+	osc.delay          = in.delay;
+	osc.last_amp       = in.last_amp;
+}
+
+static void save_square( Nes_Square const& sq, apu_state_t::square_t* out )
+{
+	save_osc( sq, out );
+	out->envelope    = sq.envelope;
+	out->env_delay   = sq.env_delay;
+	out->phase       = sq.phase;
+	out->sweep_delay = sq.sweep_delay;
+}
+
+static void load_square( Nes_Square& sq, apu_state_t::square_t const& in )
+{
+	load_osc( sq, in );
+	sq.envelope    = in.envelope;
+	sq.env_delay   = in.env_delay;
+	sq.phase       = in.phase;
+	sq.sweep_delay = in.sweep_delay;
+}
+
+void Nes_Apu::save_state( apu_state_t* out ) const
+{
+	save_square( square1, &out->square1 );
+	save_square( square2, &out->square2 );
+	
+	save_osc( triangle, &out->triangle );
+	out->triangle.phase          = triangle.phase;
+	out->triangle.linear_counter = triangle.linear_counter;
+	
+	save_osc( noise, &out->noise );
+	out->noise.envelope  = noise.envelope;
+	out->noise.env_delay = noise.env_delay;
+	out->noise.noise     = noise.noise;
+	
+	save_osc( dmc, &out->dmc );
+	out->dmc.address     = dmc.address;
+	out->dmc.period      = dmc.period;
+	out->dmc.buf         = dmc.buf;
+	out->dmc.bits_remain = dmc.bits_remain;
+	out->dmc.bits        = dmc.bits;
+	out->dmc.buf_full    = dmc.buf_full;
+	out->dmc.silence     = dmc.silence;
+	out->dmc.dac         = dmc.dac;
+	out->dmc.next_irq    = dmc.next_irq;
+	out->dmc.irq_enabled = dmc.irq_enabled;
+	out->dmc.irq_flag    = dmc.irq_flag;
+	out->dmc.pal_mode    = dmc.pal_mode;
+	
+	out->last_time     = last_time;
+	out->last_dmc_time = last_dmc_time;
+	out->earliest_irq  = earliest_irq_;
+	out->next_irq      = next_irq;
+	out->frame_period  = frame_period;
+	out->frame_delay   = frame_delay;
+	out->frame         = frame;
+	out->osc_enables   = osc_enables;
+	out->frame_mode    = frame_mode;
+	out->irq_flag      = irq_flag;
+}
+
+void Nes_Apu::load_state( apu_state_t const& in )
+{
+	load_square( square1, in.square1 );
+	load_square( square2, in.square2 );
+	
+	load_osc( triangle, in.triangle );
+	triangle.phase          = in.triangle.phase;
+	triangle.linear_counter = in.triangle.linear_counter;
+	
+	load_osc( noise, in.noise );
+	noise.envelope  = in.noise.envelope;
+	noise.env_delay = in.noise.env_delay;
+	noise.noise     = in.noise.noise;
+	
+	load_osc( dmc, in.dmc );
+	dmc.address     = in.dmc.address;
+	dmc.period      = in.dmc.period;
+	dmc.buf         = in.dmc.buf;
+	dmc.bits_remain = in.dmc.bits_remain;
+	dmc.bits        = in.dmc.bits;
+	dmc.buf_full    = in.dmc.buf_full;
+	dmc.silence     = in.dmc.silence;
+	dmc.dac         = in.dmc.dac;
+	dmc.next_irq    = in.dmc.next_irq;
+	dmc.irq_enabled = in.dmc.irq_enabled;
+	dmc.irq_flag    = in.dmc.irq_flag;
+	dmc.pal_mode    = in.dmc.pal_mode;
+	
+	last_time     = in.last_time;
+	last_dmc_time = in.last_dmc_time;
+	earliest_irq_ = in.earliest_irq;
+	next_irq      = in.next_irq;
+	frame_period  = in.frame_period;
+	frame_delay   = in.frame_delay;
+	frame         = in.frame;
+	osc_enables   = in.osc_enables;
+	frame_mode    = in.frame_mode;
+	irq_flag      = in.irq_flag;
+}
+
 void Nes_Apu::irq_changed()
 {
 	nes_time_t new_irq = dmc.next_irq;
@@ -176,4 +176,71 @@ inline nes_time_t Nes_Dmc::next_read_time() const
 
 inline nes_time_t Nes_Apu::next_dmc_read_time() const { return dmc.next_read_time(); }
 
+// Exact emulation state, as saved by Nes_Apu::save_state()
+struct apu_state_t
+{
+	struct osc_t
+	{
+		unsigned char regs [4];
+		bool reg_written [4];
+		int length_counter;
+		int delay;
+		int last_amp;
+	};
+	
+	struct square_t : osc_t
+	{
+		int envelope;
+		int env_delay;
+		int phase;
+		int sweep_delay;
+	};
+	
+	struct triangle_t : osc_t
+	{
+		int phase;
+		int linear_counter;
+	};
+	
+	struct noise_t : osc_t
+	{
+		int envelope;
+		int env_delay;
+		int noise;
+	};
+	
+	struct dmc_t : osc_t
+	{
+		int address;
+		int period;
+		int buf;
+		int bits_remain;
+		int bits;
+		bool buf_full;
+		bool silence;
+		int dac;
+		nes_time_t next_irq;
+		bool irq_enabled;
+		bool irq_flag;
+		bool pal_mode;
+	};
+	
+	square_t   square1;
+	square_t   square2;
+	triangle_t triangle;
+	noise_t    noise;
+	dmc_t      dmc;
+	
+	nes_time_t last_time;
+	nes_time_t last_dmc_time;
+	nes_time_t earliest_irq;
+	nes_time_t next_irq;
+	int frame_period;
+	int frame_delay;
+	int frame;
+	int osc_enables;
+	int frame_mode;
+	bool irq_flag;
+};
+
 #endif
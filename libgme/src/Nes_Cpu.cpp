@@ -4,6 +4,7 @@
 
 #include "blargg_endian.h"
 #include <limits.h>
+#include <string.h>
 
 #define BLARGG_CPU_X86 1
 
@@ -86,6 +87,36 @@ void Nes_Cpu::reset( void const* unmapped_page )
 	blargg_verify_byte_order();
 }
 
+long Nes_Cpu::snapshot_size() const
+{
+	return sizeof r + sizeof low_mem + sizeof state_ + sizeof irq_time_ +
+			sizeof end_time_ + sizeof error_count_;
+}
+
+void Nes_Cpu::save_snapshot( void* out ) const
+{
+	check( state == &state_ );
+	uint8_t* p = (uint8_t*) out;
+	memcpy( p, &r,            sizeof r            ); p += sizeof r;
+	memcpy( p, low_mem,       sizeof low_mem      ); p += sizeof low_mem;
+	memcpy( p, &state_,       sizeof state_       ); p += sizeof state_;
+	memcpy( p, &irq_time_,    sizeof irq_time_    ); p += sizeof irq_time_;
+	memcpy( p, &end_time_,    sizeof end_time_    ); p += sizeof end_time_;
+	memcpy( p, &error_count_, sizeof error_count_ );
+}
+
+void Nes_Cpu::load_snapshot( void const* in )
+{
+	check( state == &state_ );
+	uint8_t const* p = (uint8_t const*) in;
+	memcpy( &r,            p, sizeof r            ); p += sizeof r;
+	memcpy( low_mem,       p, sizeof low_mem      ); p += sizeof low_mem;
+	memcpy( &state_,       p, sizeof state_       ); p += sizeof state_;
+	memcpy( &irq_time_,    p, sizeof irq_time_    ); p += sizeof irq_time_;
+	memcpy( &end_time_,    p, sizeof end_time_    ); p += sizeof end_time_;
+	memcpy( &error_count_, p, sizeof error_count_ );
+}
+
 void Nes_Cpu::map_code( nes_addr_t start, unsigned size, void const* data, bool mirror )
 {
 	// address range must begin and end on page boundaries
@@ -61,6 +61,14 @@ public:
 	// CPU invokes bad opcode handler if it encounters this
 	enum { bad_opcode = 0xF2 };
 	
+	// Size of snapshot of registers, low memory, memory mapping, and timing
+	long snapshot_size() const;
+	
+	// Saves CPU state to snapshot_size() bytes at out, or restores it from a
+	// snapshot saved earlier by this same CPU. Must not be called during run().
+	void save_snapshot( void* out ) const;
+	void load_snapshot( void const* in );
+	
 public:
 	Nes_Cpu() { state = &state_; }
 	enum { page_bits = 11 };
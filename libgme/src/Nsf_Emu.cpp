@@ -614,6 +614,57 @@ blargg_err_t Nsf_Emu::start_track_( int track )
 	return 0;
 }
 
+blargg_err_t Nsf_Emu::copy_snapshot_( snapshot_io_t& io )
+{
+	#if !NSF_EMU_APU_ONLY
+		if ( namco || fds || mmc5 || vrc7 )
+			return Classic_Emu::copy_snapshot_( io ); // these can't save state
+	#endif
+	
+	void* p = io.data( cpu::snapshot_size() );
+	if ( p && io.loading() )
+		cpu::load_snapshot( p );
+	else if ( p )
+		cpu::save_snapshot( p );
+	
+	apu_state_t apu_state;
+	if ( !io.loading() )
+		apu.save_state( &apu_state );
+	io.copy( &apu_state, sizeof apu_state );
+	if ( io.loading() )
+		apu.load_state( apu_state );
+	
+	#if !NSF_EMU_APU_ONLY
+	if ( vrc6 )
+	{
+		vrc6_apu_state_t vrc6_state;
+		if ( !io.loading() )
+			vrc6->save_state( &vrc6_state );
+		io.copy( &vrc6_state, sizeof vrc6_state );
+		if ( io.loading() )
+			vrc6->load_state( vrc6_state );
+	}
+	
+	if ( fme7 )
+	{
+		fme7_apu_state_t fme7_state;
+		if ( !io.loading() )
+			fme7->save_state( &fme7_state );
+		io.copy( &fme7_state, sizeof fme7_state );
+		if ( io.loading() )
+			fme7->load_state( fme7_state );
+	}
+	#endif
+	
+	io.copy( sram, sizeof sram );
+	io.copy( mmc5_mul, sizeof mmc5_mul );
+	io.copy( &saved_state, sizeof saved_state );
+	io.copy( &next_play, sizeof next_play );
+	io.copy( &play_extra, sizeof play_extra );
+	io.copy( &play_ready, sizeof play_ready );
+	return 0;
+}
+
 blargg_err_t Nsf_Emu::run_clocks( blip_time_t& duration, int )
 {
 	set_time( 0 );
@@ -61,6 +61,7 @@ protected:
 	void set_voice( int, Blip_Buffer*, Blip_Buffer*, Blip_Buffer* );
 	void update_eq( blip_eq_t const& );
 	void unload();
+	blargg_err_t copy_snapshot_( snapshot_io_t& );
 protected:
 	enum { bank_count = 8 };
 	byte initial_banks [bank_count];
@@ -231,6 +231,63 @@ void Sms_Apu::reset( unsigned feedback, int noise_width )
 	noise.reset();
 }
 
+void Sms_Apu::save_state( sms_apu_state_t* out ) const
+{
+	for ( int i = 0; i < osc_count; i++ )
+	{
+		Sms_Osc const& osc = *oscs [i];
+		out->oscs [i].output_select = osc.output_select;
+		out->oscs [i].delay         = osc.delay;
+		out->oscs [i].last_amp      = osc.last_amp;
+		out->oscs [i].volume        = osc.volume;
+	}
+	
+	for ( int i = 0; i < 3; i++ )
+	{
+		out->square_periods [i] = squares [i].period;
+		out->square_phases  [i] = squares [i].phase;
+	}
+	
+	out->noise_period = 3;
+	for ( int i = 0; i < 3; i++ )
+		if ( noise.period == &noise_periods [i] )
+			out->noise_period = i;
+	out->noise_shifter  = noise.shifter;
+	out->noise_feedback = noise.feedback;
+	
+	out->last_time = last_time;
+	out->latch     = latch;
+}
+
+void Sms_Apu::load_state( sms_apu_state_t const& in )
+{
+	for ( int i = 0; i < osc_count; i++ )
+	{
+		Sms_Osc& osc = *oscs [i];
+		osc.output_select = in.oscs [i].output_select;
+		osc.output        = osc.outputs [osc.output_select];
+		osc.delay         = in.oscs [i].delay;
+		osc.last_amp      = in.oscs [i].last_amp;
+		osc.volume        = in.oscs [i].volume;
+	}
+	
+	for ( int i = 0; i < 3; i++ )
+	{
+		squares [i].period = in.square_periods [i];
+		squares [i].phase  = in.square_phases  [i];
+	}
+	
+	if ( in.noise_period < 3 )
+		noise.period = &noise_periods [in.noise_period];
+	else
+		noise.period = &squares [2].period;
+	noise.shifter  = in.noise_shifter;
+	noise.feedback = in.noise_feedback;
+	
+	last_time = in.last_time;
+	latch     = in.latch;
+}
+
 void Sms_Apu::run_until( blip_time_t end_time )
 {
 	require( end_time >= last_time ); // end_time must not be before previous time
@@ -6,6 +6,8 @@
 
 #include "Sms_Oscs.h"
 
+struct sms_apu_state_t;
+
 class Sms_Apu {
 public:
 	// Set overall volume of all oscillators, where 1.0 is full volume
@@ -41,6 +43,10 @@ public:
 	// Run all oscillators up to specified time, end current frame, then
 	// start a new frame at time 0.
 	void end_frame( blip_time_t );
+	
+	// Save/load exact emulation state
+	void save_state( sms_apu_state_t* out ) const;
+	void load_state( sms_apu_state_t const& );
 
 public:
 	Sms_Apu();
@@ -62,10 +68,24 @@ private:
 	void run_until( blip_time_t );
 };
 
+// Exact emulation state, as saved by Sms_Apu::save_state()
 struct sms_apu_state_t
 {
-	unsigned char regs [8] [2];
-	unsigned char latch;
+	struct osc_t
+	{
+		int output_select;
+		int delay;
+		int last_amp;
+		int volume;
+	};
+	osc_t oscs [Sms_Apu::osc_count];
+	int square_periods [3];
+	int square_phases [3];
+	int noise_period; // 0-2 = fixed rates, 3 = square 3's period
+	unsigned noise_shifter;
+	unsigned noise_feedback;
+	blip_time_t last_time;
+	int latch;
 };
 
 inline void Sms_Apu::output( Blip_Buffer* b ) { output( b, b, b ); }
@@ -381,3 +381,16 @@ blargg_err_t Snes_Spc::skip( int count )
 	
 	return play( count, 0 );
 }
+
+void Snes_Spc::save_snapshot( void* out ) const
+{
+	memcpy( out, &m, sizeof m );
+	dsp.save_snapshot( (char*) out + sizeof m );
+}
+
+void Snes_Spc::load_snapshot( void const* in )
+{
+	// output pointers are reset by next play()
+	memcpy( &m, in, sizeof m );
+	dsp.load_snapshot( (char const*) in + sizeof m );
+}
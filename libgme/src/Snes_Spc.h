@@ -86,6 +86,17 @@ public:
 	// Skips count samples. Several times faster than play() when using fast DSP.
 	blargg_err_t skip( int count );
 	
+// Snapshots (used for fast seeking)
+
+	// Size of snapshot of all emulation state
+	long snapshot_size() const;
+	
+	// Saves emulation state to snapshot_size() bytes at out, or restores it from
+	// a snapshot saved earlier by this same emulator. Sound control settings
+	// are left unchanged.
+	void save_snapshot( void* out ) const;
+	void load_snapshot( void const* in );
+	
 // State save/load (only available with accurate DSP)
 
 #if !SPC_NO_COPY_STATE_FUNCS
@@ -274,6 +285,8 @@ inline void Snes_Spc::write_port( time_t t, int port, int data )
 	run_until_( t ) [0x10 + port] = data;
 }
 
+inline long Snes_Spc::snapshot_size() const { return sizeof m + dsp.snapshot_size(); }
+
 inline void Snes_Spc::mute_voices( int mask ) { dsp.mute_voices( mask ); }
 	
 inline void Snes_Spc::disable_surround( bool disable ) { dsp.disable_surround( disable ); }
@@ -722,3 +722,15 @@ void Spc_Dsp::load( uint8_t const regs [register_count] )
 }
 
 void Spc_Dsp::reset() { load( initial_regs ); }
+
+void Spc_Dsp::save_snapshot( void* out ) const
+{
+	// everything before ram is emulation state
+	memcpy( out, &m, snapshot_size() );
+}
+
+void Spc_Dsp::load_snapshot( void const* in )
+{
+	memcpy( &m, in, snapshot_size() );
+	mute_voices( m.mute_mask ); // snapshot's voice volumes reflect its muting
+}
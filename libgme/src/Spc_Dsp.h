@@ -58,6 +58,15 @@ public:
 	enum { register_count = 128 };
 	void load( uint8_t const regs [register_count] );
 
+	// Size of snapshot of all emulation state
+	long snapshot_size() const;
+	
+	// Saves emulation state to snapshot_size() bytes at out, or restores it from
+	// a snapshot saved earlier by this same DSP. Sound control settings and the
+	// output buffer are left unchanged.
+	void save_snapshot( void* out ) const;
+	void load_snapshot( void const* in );
+
 // DSP register addresses
 
 	// Global registers
@@ -159,6 +168,8 @@ private:
 
 inline int Spc_Dsp::sample_count() const { return m.out - m.out_begin; }
 
+inline long Spc_Dsp::snapshot_size() const { return offsetof (state_t,ram); }
+
 inline int Spc_Dsp::read( int addr ) const
 {
 	assert( (unsigned) addr < register_count );
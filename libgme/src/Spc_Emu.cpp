@@ -470,26 +470,55 @@ blargg_err_t Spc_Emu::play_and_filter( long count, sample_t out [] )
 	return 0;
 }
 
+// Doesn't use Music_Emu's muted skip: apu.skip() already leaves out the
+// resampler and filter, and the DSP has to keep generating voice output since
+// the SPC700 reads it back through ENVX/OUTX/ENDX and the echo buffer.
 blargg_err_t Spc_Emu::skip_( long count )
 {
+	// eliminate pop due to resampler by playing last few samples normally
+	const int resampler_latency = 64;
+	long play_count = min( count, (long) resampler_latency );
+	count -= play_count;
+	
 	if ( sample_rate() != native_sample_rate )
 	{
 		count = long (count * resampler.ratio()) & ~1;
 		count -= resampler.skip_input( count );
 	}
 	
-	// TODO: shouldn't skip be adjusted for the 64 samples read afterwards?
-	
 	if ( count > 0 )
 	{
 		RETURN_ERR( apu.skip( count ) );
 		filter.clear();
 	}
 	
-	// eliminate pop due to resampler
-	const int resampler_latency = 64;
 	sample_t buf [resampler_latency];
-	return play_( resampler_latency, buf );
+	return play_( play_count, buf );
+}
+
+blargg_err_t Spc_Emu::copy_snapshot_( snapshot_io_t& io )
+{
+	void* p = io.data( apu.snapshot_size() );
+	if ( p && io.loading() )
+		apu.load_snapshot( p );
+	else if ( p )
+		apu.save_snapshot( p );
+	
+	// resampler input is already past the APU's time, so keep it too
+	if ( sample_rate() != native_sample_rate )
+	{
+		p = io.data( resampler.snapshot_size() );
+		if ( p && io.loading() )
+			resampler.load_snapshot( p );
+		else if ( p )
+			resampler.save_snapshot( p );
+	}
+	return 0;
+}
+
+void Spc_Emu::snapshot_loaded_()
+{
+	filter.clear();
 }
 
 blargg_err_t Spc_Emu::play_( long count, sample_t* out )
@@ -69,6 +69,8 @@ protected:
 	void disable_echo_( bool disable );
 	void set_tempo_( double );
 	void enable_accuracy_( bool );
+	blargg_err_t copy_snapshot_( snapshot_io_t& );
+	void snapshot_loaded_();
 	byte const* file_data;
 	long        file_size;
 private:
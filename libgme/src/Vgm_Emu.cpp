@@ -485,6 +485,59 @@ blargg_err_t Vgm_Emu::start_track_( int track )
 	return 0;
 }
 
+blargg_err_t Vgm_Emu::copy_snapshot_( snapshot_io_t& io )
+{
+	if ( ym2413[0].enabled() )
+		return Classic_Emu::copy_snapshot_( io ); // YM2413 can't save state
+	
+	for ( int i = 0; i < (psg_dual ? 2 : 1); i++ )
+	{
+		sms_apu_state_t psg_state;
+		if ( !io.loading() )
+			psg[i].save_state( &psg_state );
+		io.copy( &psg_state, sizeof psg_state );
+		if ( io.loading() )
+			psg[i].load_state( psg_state );
+	}
+	
+	for ( int i = 0; i < 2; i++ )
+	{
+		if ( !ym2612[i].enabled() )
+			continue;
+		void* p = io.data( ym2612[i].snapshot_size() );
+		if ( p && io.loading() )
+			ym2612[i].load_snapshot( p );
+		else if ( p )
+			ym2612[i].save_snapshot( p );
+	}
+	
+	// stream pointers stay valid since snapshots are cleared when file is unloaded
+	io.copy( &pos, sizeof pos );
+	io.copy( &pcm_pos, sizeof pcm_pos );
+	io.copy( &vgm_time, sizeof vgm_time );
+	io.copy( &dac_amp, sizeof dac_amp );
+	io.copy( &dac_disabled, sizeof dac_disabled );
+	io.copy( &fm_time_offset, sizeof fm_time_offset );
+	return 0;
+}
+
+long Vgm_Emu::snapshot_ahead_() const
+{
+	if ( !uses_fm )
+		return Classic_Emu::snapshot_ahead_();
+	return Dual_Resampler::samples_avail();
+}
+
+void Vgm_Emu::snapshot_loaded_()
+{
+	Classic_Emu::snapshot_loaded_();
+	if ( uses_fm )
+	{
+		blip_buf.clear();
+		Dual_Resampler::clear();
+	}
+}
+
 blargg_err_t Vgm_Emu::run_clocks( blip_time_t& time_io, int msec )
 {
 	time_io = run_commands( msec * vgm_rate / 1000 );
@@ -502,3 +555,12 @@ blargg_err_t Vgm_Emu::play_( long count, sample_t* out )
 	Dual_Resampler::dual_play( count, out, blip_buf );
 	return 0;
 }
+
+blargg_err_t Vgm_Emu::skip_muted_( long count )
+{
+	if ( !uses_fm )
+		return Classic_Emu::skip_muted_( count );
+	
+	Dual_Resampler::dual_skip( count, blip_buf );
+	return 0;
+}
@@ -67,11 +67,15 @@ protected:
 	blargg_err_t set_sample_rate_( long sample_rate ) override;
 	blargg_err_t start_track_( int ) override;
 	blargg_err_t play_( long count, sample_t* ) override;
+	blargg_err_t skip_muted_( long count ) override;
 	blargg_err_t run_clocks( blip_time_t&, int ) override;
 	void set_tempo_( double ) override;
 	void mute_voices_( int mask ) override;
 	void set_voice( int, Blip_Buffer*, Blip_Buffer*, Blip_Buffer* ) override;
 	void update_eq( blip_eq_t const& ) override;
+	blargg_err_t copy_snapshot_( snapshot_io_t& ) override;
+	long snapshot_ahead_() const override;
+	void snapshot_loaded_() override;
 private:
 	// removed; use disable_oversampling() and set_tempo() instead
 	Vgm_Emu( bool oversample, double tempo = 1.0 );
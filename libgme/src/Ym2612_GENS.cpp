@@ -1317,3 +1317,26 @@ void Ym2612_GENS_Impl::run( int pair_count, Ym2612_GENS_Emu::sample_t* out )
 }
 
 void Ym2612_GENS_Emu::run( int pair_count, sample_t* out ) { impl->run( pair_count, out ); }
+
+long Ym2612_GENS_Emu::snapshot_size() const
+{
+	return impl ? (long) (sizeof impl->YM2612 + sizeof impl->g.LFOcnt + sizeof impl->g.LFOinc) : 0;
+}
+
+void Ym2612_GENS_Emu::save_snapshot( void* out ) const
+{
+	if ( !impl ) return;
+	char* p = (char*) out;
+	memcpy( p, &impl->YM2612, sizeof impl->YM2612 ); p += sizeof impl->YM2612;
+	memcpy( p, &impl->g.LFOcnt, sizeof impl->g.LFOcnt ); p += sizeof impl->g.LFOcnt;
+	memcpy( p, &impl->g.LFOinc, sizeof impl->g.LFOinc );
+}
+
+void Ym2612_GENS_Emu::load_snapshot( void const* in )
+{
+	if ( !impl ) return;
+	char const* p = (char const*) in;
+	memcpy( &impl->YM2612, p, sizeof impl->YM2612 ); p += sizeof impl->YM2612;
+	memcpy( &impl->g.LFOcnt, p, sizeof impl->g.LFOcnt ); p += sizeof impl->g.LFOcnt;
+	memcpy( &impl->g.LFOinc, p, sizeof impl->g.LFOinc );
+}
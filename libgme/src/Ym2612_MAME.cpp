@@ -3107,3 +3107,19 @@ void Ym2612_MAME_Emu::run(int pair_count, Ym2612_MAME_Emu::sample_t *out)
 	(void) &Ym2612_MameImpl::TimerBOver; // squelch clang warning, which appears to be from a config choice
 	if ( impl ) Ym2612_MameImpl::ym2612_generate( impl, out, pair_count, 1);
 }
+
+long Ym2612_MAME_Emu::snapshot_size() const
+{
+	return impl ? (long) sizeof (Ym2612_MameImpl::YM2612) : 0;
+}
+
+void Ym2612_MAME_Emu::save_snapshot( void* out ) const
+{
+	// internal pointers refer to the chip itself, so copy is only valid for same chip
+	if ( impl ) memcpy( out, impl, sizeof (Ym2612_MameImpl::YM2612) );
+}
+
+void Ym2612_MAME_Emu::load_snapshot( void const* in )
+{
+	if ( impl ) memcpy( impl, in, sizeof (Ym2612_MameImpl::YM2612) );
+}
@@ -33,6 +33,14 @@ public:
 	typedef short sample_t;
 	enum { out_chan_count = 2 }; // stereo
 	void run( int pair_count, sample_t* out );
+
+	// Size of snapshot of all emulation state
+	long snapshot_size() const;
+	
+	// Saves emulation state to snapshot_size() bytes at out, or restores it from
+	// a snapshot saved earlier by this same emulator. Voice muting is unchanged.
+	void save_snapshot( void* out ) const;
+	void load_snapshot( void const* in );
 };
 
 #endif
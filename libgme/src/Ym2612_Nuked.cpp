@@ -1870,3 +1870,18 @@ void Ym2612_Nuked_Emu::run(int pair_count, Ym2612_Nuked_Emu::sample_t *out)
 	if ( !chip_r ) return;
 	Ym2612_NukedImpl::OPN2_GenerateStreamMix(chip_r, out, pair_count);
 }
+
+long Ym2612_Nuked_Emu::snapshot_size() const
+{
+	return impl ? (long) sizeof (Ym2612_NukedImpl::ym3438_t) : 0;
+}
+
+void Ym2612_Nuked_Emu::save_snapshot( void* out ) const
+{
+	if ( impl ) memcpy( out, impl, sizeof (Ym2612_NukedImpl::ym3438_t) );
+}
+
+void Ym2612_Nuked_Emu::load_snapshot( void const* in )
+{
+	if ( impl ) memcpy( impl, in, sizeof (Ym2612_NukedImpl::ym3438_t) );
+}
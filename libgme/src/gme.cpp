@@ -391,6 +391,8 @@ int       gme_tell           ( Music_Emu const* me )                { return me-
 int       gme_tell_samples   ( Music_Emu const* me )                { return me->tell_samples(); }
 gme_err_t gme_seek           ( Music_Emu* me, int msec )            { return me->seek( msec ); }
 gme_err_t gme_seek_samples   ( Music_Emu* me, int n )               { return me->seek_samples( n ); }
+void      gme_set_seek_snapshots( Music_Emu* me, int msec )         { me->set_seek_snapshots( msec ); }
+gme_err_t gme_prescan_snapshots( Music_Emu* me, int msec )          { return me->prescan_snapshots( msec ); }
 int       gme_voice_count    ( Music_Emu const* me )                { return me->voice_count(); }
 void      gme_ignore_silence ( Music_Emu* me, int disable )         { me->ignore_silence( disable != 0 ); }
 void      gme_set_tempo      ( Music_Emu* me, double t )            { me->set_tempo( t ); }
@@ -97,6 +97,18 @@ BLARGG_EXPORT gme_err_t gme_seek( Music_Emu*, int msec );
 /* Equivalent to restarting track then skipping n samples */
 BLARGG_EXPORT gme_err_t gme_seek_samples( Music_Emu*, int n );
 
+/* Save emulator state every interval_msec while playing, so that later seeks
+resume from the nearest earlier snapshot instead of restarting the track. 0
+disables snapshots. Supported for SPC, NSF/NSFE (without FDS, MMC5, Namco or
+VRC7 sound), GBS and VGM/VGZ (without YM2413); ignored by other types. */
+/* Available since 0.6.4 */
+BLARGG_EXPORT void gme_set_seek_snapshots( Music_Emu*, int interval_msec );
+
+/* Emulate current track up to msec, saving snapshots along the way, then return
+to the current position */
+/* Available since 0.6.4 */
+BLARGG_EXPORT gme_err_t gme_prescan_snapshots( Music_Emu*, int msec );
+
 
 /******** Informational ********/
 
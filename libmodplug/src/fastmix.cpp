@@ -9,6 +9,17 @@
 #include "sndfile.h"
 #include <math.h>
 
+// Vectorised fetch and conversion paths (define MODPLUG_NO_SIMD to use plain C)
+#ifndef MODPLUG_NO_SIMD
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define MODPLUG_SSE2
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define MODPLUG_NEON
+#include <arm_neon.h>
+#endif
+#endif
+
 #if defined(_MSC_VER) && defined(_M_IX86)
 #pragma bss_seg(".modplug")
 #endif
@@ -498,6 +509,252 @@ CzWINDOWEDFIR sfir;
        vol2_r += (CzWINDOWEDFIR::lut[firidx+7]*(int)p[(poshi+8-4)*2+1]);    \
    int vol_r   = ((vol1_r>>1)+(vol2_r>>1)) >> (WFIR_16BITSHIFT-1);
 
+/////////////////////////////////////////////////////////////////////////////
+// Vectorised spline and fir fetches
+//
+// Same integer arithmetic as the macros above (products are summed in 32 bit,
+// 16-bit fir keeps its two half-sums), so the output is bit-identical.
+
+#if defined(MODPLUG_SSE2)
+
+// 8 signed bytes -> 8 shorts
+static inline __m128i SSE2_Load8x8(const signed char *p)
+{
+	__m128i v = _mm_loadl_epi64((const __m128i *)p);
+	return _mm_srai_epi16(_mm_unpacklo_epi8(v, v), 8);
+}
+
+// 4 signed bytes -> 4 shorts (upper half zero)
+static inline __m128i SSE2_Load4x8(const signed char *p)
+{
+	int n;
+	memcpy(&n, p, 4);
+	__m128i v = _mm_cvtsi32_si128(n);
+	return _mm_srai_epi16(_mm_unpacklo_epi8(v, v), 8);
+}
+
+// L0 R0 L1 R1 L2 R2 L3 R3 -> L0 L1 L2 L3 R0 R1 R2 R3
+static inline __m128i SSE2_Deinterleave16(__m128i v)
+{
+	v = _mm_shufflelo_epi16(v, _MM_SHUFFLE(3,1,2,0));
+	v = _mm_shufflehi_epi16(v, _MM_SHUFFLE(3,1,2,0));
+	return _mm_shuffle_epi32(v, _MM_SHUFFLE(3,1,2,0));
+}
+
+// { a0+a1, a2+a3, b0+b1, b2+b3 }
+static inline __m128i SSE2_PairSums(__m128i a, __m128i b)
+{
+	__m128 fa = _mm_castsi128_ps(a), fb = _mm_castsi128_ps(b);
+	return _mm_add_epi32(_mm_castps_si128(_mm_shuffle_ps(fa, fb, _MM_SHUFFLE(2,0,2,0))),
+		_mm_castps_si128(_mm_shuffle_ps(fa, fb, _MM_SHUFFLE(3,1,3,1))));
+}
+
+static inline int SSE2_Spline4(__m128i s, const signed short *lut)
+{
+	__m128i m = _mm_madd_epi16(s, _mm_loadl_epi64((const __m128i *)lut));
+	return _mm_cvtsi128_si32(_mm_add_epi32(m, _mm_srli_si128(m, 4)));
+}
+
+// s = L0 L1 L2 L3 R0 R1 R2 R3
+static inline void SSE2_SplineStereo4(__m128i s, const signed short *lut, int &vol_l, int &vol_r)
+{
+	__m128i c = _mm_loadl_epi64((const __m128i *)lut);
+	__m128i m = _mm_madd_epi16(s, _mm_unpacklo_epi64(c, c));
+	m = _mm_add_epi32(m, _mm_shuffle_epi32(m, _MM_SHUFFLE(2,3,0,1)));
+	vol_l = _mm_cvtsi128_si32(m);
+	vol_r = _mm_cvtsi128_si32(_mm_srli_si128(m, 8));
+}
+
+static inline int SSE2_Fir8(__m128i s, const signed short *lut)
+{
+	__m128i m = _mm_madd_epi16(s, _mm_loadu_si128((const __m128i *)lut));
+	m = _mm_add_epi32(m, _mm_srli_si128(m, 8));
+	return _mm_cvtsi128_si32(_mm_add_epi32(m, _mm_srli_si128(m, 4)));
+}
+
+static inline int SSE2_Fir16(__m128i s, const signed short *lut)
+{
+	__m128i m = _mm_madd_epi16(s, _mm_loadu_si128((const __m128i *)lut));
+	m = _mm_add_epi32(m, _mm_shuffle_epi32(m, _MM_SHUFFLE(2,3,0,1)));
+	int vol1 = _mm_cvtsi128_si32(m);
+	int vol2 = _mm_cvtsi128_si32(_mm_srli_si128(m, 8));
+	return ((vol1>>1)+(vol2>>1)) >> (WFIR_16BITSHIFT-1);
+}
+
+// lo/hi = 4 interleaved stereo frames each, as shorts
+// Returns { vol1_l, vol2_l, vol1_r, vol2_r }
+static inline __m128i SSE2_FirStereo(__m128i lo, __m128i hi, const signed short *lut)
+{
+	__m128i c = _mm_loadu_si128((const __m128i *)lut);
+	lo = SSE2_Deinterleave16(lo);
+	hi = SSE2_Deinterleave16(hi);
+	return SSE2_PairSums(_mm_madd_epi16(_mm_unpacklo_epi64(lo, hi), c),
+		_mm_madd_epi16(_mm_unpackhi_epi64(lo, hi), c));
+}
+
+static inline void SSE2_FirStereo8(const signed char *p, const signed short *lut, int &vol_l, int &vol_r)
+{
+	__m128i v = _mm_loadu_si128((const __m128i *)p);
+	__m128i sums = SSE2_FirStereo(_mm_srai_epi16(_mm_unpacklo_epi8(v, v), 8),
+		_mm_srai_epi16(_mm_unpackhi_epi8(v, v), 8), lut);
+	sums = _mm_add_epi32(sums, _mm_shuffle_epi32(sums, _MM_SHUFFLE(2,3,0,1)));
+	vol_l = _mm_cvtsi128_si32(sums);
+	vol_r = _mm_cvtsi128_si32(_mm_srli_si128(sums, 8));
+}
+
+static inline void SSE2_FirStereo16(const signed short *p, const signed short *lut, int &vol_l, int &vol_r)
+{
+	__m128i sums = SSE2_FirStereo(_mm_loadu_si128((const __m128i *)p),
+		_mm_loadu_si128((const __m128i *)(p + 8)), lut);
+	sums = _mm_srai_epi32(sums, 1);
+	sums = _mm_add_epi32(sums, _mm_shuffle_epi32(sums, _MM_SHUFFLE(2,3,0,1)));
+	sums = _mm_srai_epi32(sums, WFIR_16BITSHIFT-1);
+	vol_l = _mm_cvtsi128_si32(sums);
+	vol_r = _mm_cvtsi128_si32(_mm_srli_si128(sums, 8));
+}
+
+#define SIMD_SPLINE8(p, lut)		SSE2_Spline4(SSE2_Load4x8(p), lut)
+#define SIMD_SPLINE16(p, lut)		SSE2_Spline4(_mm_loadl_epi64((const __m128i *)(p)), lut)
+#define SIMD_SPLINESTEREO8(p, lut, l, r)	SSE2_SplineStereo4(SSE2_Deinterleave16(SSE2_Load8x8(p)), lut, l, r)
+#define SIMD_SPLINESTEREO16(p, lut, l, r)	SSE2_SplineStereo4(SSE2_Deinterleave16(_mm_loadu_si128((const __m128i *)(p))), lut, l, r)
+#define SIMD_FIR8(p, lut)			SSE2_Fir8(SSE2_Load8x8(p), lut)
+#define SIMD_FIR16(p, lut)			SSE2_Fir16(_mm_loadu_si128((const __m128i *)(p)), lut)
+#define SIMD_FIRSTEREO8(p, lut, l, r)	SSE2_FirStereo8(p, lut, l, r)
+#define SIMD_FIRSTEREO16(p, lut, l, r)	SSE2_FirStereo16(p, lut, l, r)
+
+#elif defined(MODPLUG_NEON)
+
+static inline int NEON_HSum(int32x4_t v)
+{
+	int32x2_t t = vadd_s32(vget_low_s32(v), vget_high_s32(v));
+	return vget_lane_s32(vpadd_s32(t, t), 0);
+}
+
+static inline int16x4_t NEON_Load4x8(const signed char *p)
+{
+	int32_t n;
+	memcpy(&n, p, 4);
+	return vget_low_s16(vmovl_s8(vreinterpret_s8_s32(vdup_n_s32(n))));
+}
+
+static inline int NEON_Spline4(int16x4_t s, const signed short *lut)
+{
+	return NEON_HSum(vmull_s16(s, vld1_s16(lut)));
+}
+
+static inline void NEON_SplineStereo4(int16x8_t s, const signed short *lut, int &vol_l, int &vol_r)
+{
+	int16x4x2_t lr = vuzp_s16(vget_low_s16(s), vget_high_s16(s));
+	int16x4_t c = vld1_s16(lut);
+	vol_l = NEON_HSum(vmull_s16(lr.val[0], c));
+	vol_r = NEON_HSum(vmull_s16(lr.val[1], c));
+}
+
+static inline int NEON_Fir8(int16x8_t s, const signed short *lut)
+{
+	int16x8_t c = vld1q_s16(lut);
+	return NEON_HSum(vmlal_s16(vmull_s16(vget_low_s16(s), vget_low_s16(c)), vget_high_s16(s), vget_high_s16(c)));
+}
+
+static inline int NEON_Fir16(int16x8_t s, const signed short *lut)
+{
+	int16x8_t c = vld1q_s16(lut);
+	int vol1 = NEON_HSum(vmull_s16(vget_low_s16(s), vget_low_s16(c)));
+	int vol2 = NEON_HSum(vmull_s16(vget_high_s16(s), vget_high_s16(c)));
+	return ((vol1>>1)+(vol2>>1)) >> (WFIR_16BITSHIFT-1);
+}
+
+static inline void NEON_FirStereo8(const signed char *p, const signed short *lut, int &vol_l, int &vol_r)
+{
+	int8x8x2_t lr = vld2_s8(p);
+	vol_l = NEON_Fir8(vmovl_s8(lr.val[0]), lut);
+	vol_r = NEON_Fir8(vmovl_s8(lr.val[1]), lut);
+}
+
+static inline void NEON_FirStereo16(const signed short *p, const signed short *lut, int &vol_l, int &vol_r)
+{
+	int16x8x2_t lr = vld2q_s16(p);
+	vol_l = NEON_Fir16(lr.val[0], lut);
+	vol_r = NEON_Fir16(lr.val[1], lut);
+}
+
+#define SIMD_SPLINE8(p, lut)		NEON_Spline4(NEON_Load4x8(p), lut)
+#define SIMD_SPLINE16(p, lut)		NEON_Spline4(vld1_s16(p), lut)
+#define SIMD_SPLINESTEREO8(p, lut, l, r)	NEON_SplineStereo4(vmovl_s8(vld1_s8(p)), lut, l, r)
+#define SIMD_SPLINESTEREO16(p, lut, l, r)	NEON_SplineStereo4(vld1q_s16(p), lut, l, r)
+#define SIMD_FIR8(p, lut)			NEON_Fir8(vmovl_s8(vld1_s8(p)), lut)
+#define SIMD_FIR16(p, lut)			NEON_Fir16(vld1q_s16(p), lut)
+#define SIMD_FIRSTEREO8(p, lut, l, r)	NEON_FirStereo8(p, lut, l, r)
+#define SIMD_FIRSTEREO16(p, lut, l, r)	NEON_FirStereo16(p, lut, l, r)
+
+#endif
+
+#if defined(MODPLUG_SSE2) || defined(MODPLUG_NEON)
+
+#undef SNDMIX_GETMONOVOL8SPLINE
+#define SNDMIX_GETMONOVOL8SPLINE \
+	int poshi	= nPos >> 16; \
+	int poslo	= (nPos >> SPLINE_FRACSHIFT) & SPLINE_FRACMASK; \
+	int vol		= SIMD_SPLINE8(p+poshi-1, CzCUBICSPLINE::lut+poslo) >> SPLINE_8SHIFT;
+
+#undef SNDMIX_GETMONOVOL16SPLINE
+#define SNDMIX_GETMONOVOL16SPLINE \
+	int poshi	= nPos >> 16; \
+	int poslo	= (nPos >> SPLINE_FRACSHIFT) & SPLINE_FRACMASK; \
+	int vol		= SIMD_SPLINE16(p+poshi-1, CzCUBICSPLINE::lut+poslo) >> SPLINE_16SHIFT;
+
+#undef SNDMIX_GETMONOVOL8FIRFILTER
+#define SNDMIX_GETMONOVOL8FIRFILTER \
+	int poshi  = nPos >> 16;\
+	int poslo  = (nPos & 0xFFFF);\
+	int firidx = ((poslo+WFIR_FRACHALVE)>>WFIR_FRACSHIFT) & WFIR_FRACMASK; \
+	int vol    = SIMD_FIR8(p+poshi+1-4, CzWINDOWEDFIR::lut+firidx) >> WFIR_8SHIFT;
+
+#undef SNDMIX_GETMONOVOL16FIRFILTER
+#define SNDMIX_GETMONOVOL16FIRFILTER \
+	int poshi  = nPos >> 16;\
+	int poslo  = (nPos & 0xFFFF);\
+	int firidx = ((poslo+WFIR_FRACHALVE)>>WFIR_FRACSHIFT) & WFIR_FRACMASK; \
+	int vol    = SIMD_FIR16(p+poshi+1-4, CzWINDOWEDFIR::lut+firidx);
+
+#undef SNDMIX_GETSTEREOVOL8SPLINE
+#define SNDMIX_GETSTEREOVOL8SPLINE \
+	int poshi	= nPos >> 16; \
+	int poslo	= (nPos >> SPLINE_FRACSHIFT) & SPLINE_FRACMASK; \
+	int vol_l, vol_r; \
+	SIMD_SPLINESTEREO8(p+(poshi-1)*2, CzCUBICSPLINE::lut+poslo, vol_l, vol_r); \
+	vol_l >>= SPLINE_8SHIFT; \
+	vol_r >>= SPLINE_8SHIFT;
+
+#undef SNDMIX_GETSTEREOVOL16SPLINE
+#define SNDMIX_GETSTEREOVOL16SPLINE \
+	int poshi	= nPos >> 16; \
+	int poslo	= (nPos >> SPLINE_FRACSHIFT) & SPLINE_FRACMASK; \
+	int vol_l, vol_r; \
+	SIMD_SPLINESTEREO16(p+(poshi-1)*2, CzCUBICSPLINE::lut+poslo, vol_l, vol_r); \
+	vol_l >>= SPLINE_16SHIFT; \
+	vol_r >>= SPLINE_16SHIFT;
+
+#undef SNDMIX_GETSTEREOVOL8FIRFILTER
+#define SNDMIX_GETSTEREOVOL8FIRFILTER \
+	int poshi   = nPos >> 16;\
+	int poslo   = (nPos & 0xFFFF);\
+	int firidx  = ((poslo+WFIR_FRACHALVE)>>WFIR_FRACSHIFT) & WFIR_FRACMASK; \
+	int vol_l, vol_r; \
+	SIMD_FIRSTEREO8(p+(poshi+1-4)*2, CzWINDOWEDFIR::lut+firidx, vol_l, vol_r); \
+	vol_l >>= WFIR_8SHIFT; \
+	vol_r >>= WFIR_8SHIFT;
+
+#undef SNDMIX_GETSTEREOVOL16FIRFILTER
+#define SNDMIX_GETSTEREOVOL16FIRFILTER \
+	int poshi   = nPos >> 16;\
+	int poslo   = (nPos & 0xFFFF);\
+	int firidx  = ((poslo+WFIR_FRACHALVE)>>WFIR_FRACSHIFT) & WFIR_FRACMASK; \
+	int vol_l, vol_r; \
+	SIMD_FIRSTEREO16(p+(poshi+1-4)*2, CzWINDOWEDFIR::lut+firidx, vol_l, vol_r);
+
+#endif
+
 /////////////////////////////////////////////////////////////////////////////
 
 #define SNDMIX_STOREMONOVOL\
@@ -1616,6 +1873,73 @@ UINT CSoundFile::CreateStereoMix(int count)
 #pragma warning (disable:4100)
 #endif
 
+// Clipping with VU min/max tracking for the X86_Convert32ToXX functions.
+// While vumin > vumax (at the start of a Read() call, until the first sample
+// that is not a new minimum) the else-if skips the maximum. From then on,
+// independent min/max as done by the vectorised loops give the same result.
+static inline int ClipMixSample(int n, int &vumin, int &vumax)
+{
+	if (n < MIXING_CLIPMIN)
+		n = MIXING_CLIPMIN;
+	else if (n > MIXING_CLIPMAX)
+		n = MIXING_CLIPMAX;
+	if (n < vumin)
+		vumin = n;
+	else if (n > vumax)
+		vumax = n;
+	return n;
+}
+
+#if defined(MODPLUG_SSE2)
+static inline __m128i SSE2_Min(__m128i a, __m128i b)
+{
+	__m128i lt = _mm_cmplt_epi32(a, b);
+	return _mm_or_si128(_mm_and_si128(lt, a), _mm_andnot_si128(lt, b));
+}
+
+static inline __m128i SSE2_Max(__m128i a, __m128i b)
+{
+	__m128i gt = _mm_cmpgt_epi32(a, b);
+	return _mm_or_si128(_mm_and_si128(gt, a), _mm_andnot_si128(gt, b));
+}
+
+static inline __m128i SSE2_ClipMix(const int *pBuffer, __m128i &vumin, __m128i &vumax)
+{
+	__m128i n = _mm_loadu_si128((const __m128i *)pBuffer);
+	n = SSE2_Min(SSE2_Max(n, _mm_set1_epi32(MIXING_CLIPMIN)), _mm_set1_epi32(MIXING_CLIPMAX));
+	vumin = SSE2_Min(vumin, n);
+	vumax = SSE2_Max(vumax, n);
+	return n;
+}
+
+static inline void SSE2_StoreVU(__m128i vumin, __m128i vumax, int &vmin, int &vmax)
+{
+	vumin = SSE2_Min(vumin, _mm_shuffle_epi32(vumin, _MM_SHUFFLE(1,0,3,2)));
+	vumin = SSE2_Min(vumin, _mm_shuffle_epi32(vumin, _MM_SHUFFLE(2,3,0,1)));
+	vumax = SSE2_Max(vumax, _mm_shuffle_epi32(vumax, _MM_SHUFFLE(1,0,3,2)));
+	vumax = SSE2_Max(vumax, _mm_shuffle_epi32(vumax, _MM_SHUFFLE(2,3,0,1)));
+	vmin = _mm_cvtsi128_si32(vumin);
+	vmax = _mm_cvtsi128_si32(vumax);
+}
+#elif defined(MODPLUG_NEON)
+static inline int32x4_t NEON_ClipMix(const int *pBuffer, int32x4_t &vumin, int32x4_t &vumax)
+{
+	int32x4_t n = vld1q_s32(pBuffer);
+	n = vminq_s32(vmaxq_s32(n, vdupq_n_s32(MIXING_CLIPMIN)), vdupq_n_s32(MIXING_CLIPMAX));
+	vumin = vminq_s32(vumin, n);
+	vumax = vmaxq_s32(vumax, n);
+	return n;
+}
+
+static inline void NEON_StoreVU(int32x4_t vumin, int32x4_t vumax, int &vmin, int &vmax)
+{
+	int32x2_t lo = vpmin_s32(vget_low_s32(vumin), vget_high_s32(vumin));
+	int32x2_t hi = vpmax_s32(vget_low_s32(vumax), vget_high_s32(vumax));
+	vmin = vget_lane_s32(vpmin_s32(lo, lo), 0);
+	vmax = vget_lane_s32(vpmax_s32(hi, hi), 0);
+}
+#endif
+
 // Clip and convert to 8 bit
 #if defined(_MSC_VER) && defined(_M_IX86)
 __declspec(naked) DWORD MPPASMCALL X86_Convert32To8(LPVOID lp16, int *pBuffer, DWORD lSampleCount, LPLONG lpMin, LPLONG lpMax)
@@ -1687,17 +2011,46 @@ DWORD MPPASMCALL X86_Convert32To8(LPVOID lp8, int *pBuffer, DWORD lSampleCount,
 {
 	int vumin = *lpMin, vumax = *lpMax;
 	unsigned char *p = (unsigned char *)lp8;
-	for (UINT i=0; i<lSampleCount; i++)
+	UINT i = 0;
+#if defined(MODPLUG_SSE2) || defined(MODPLUG_NEON)
+	for (; i<lSampleCount && vumin>vumax; i++)
 	{
-		int n = pBuffer[i];
-		if (n < MIXING_CLIPMIN)
-			n = MIXING_CLIPMIN;
-		else if (n > MIXING_CLIPMAX)
-			n = MIXING_CLIPMAX;
-		if (n < vumin)
-			vumin = n;
-		else if (n > vumax)
-			vumax = n;
+		p[i] = (ClipMixSample(pBuffer[i], vumin, vumax) >> (24-MIXING_ATTENUATION)) ^ 0x80;
+	}
+#endif
+#if defined(MODPLUG_SSE2)
+	if (lSampleCount >= 16)
+	{
+		__m128i vmin = _mm_set1_epi32(vumin), vmax = _mm_set1_epi32(vumax);
+		const __m128i sign = _mm_set1_epi8((char)0x80);
+		for (; i+16<=lSampleCount; i+=16)
+		{
+			__m128i n0 = _mm_srai_epi32(SSE2_ClipMix(pBuffer+i, vmin, vmax), 24-MIXING_ATTENUATION);
+			__m128i n1 = _mm_srai_epi32(SSE2_ClipMix(pBuffer+i+4, vmin, vmax), 24-MIXING_ATTENUATION);
+			__m128i n2 = _mm_srai_epi32(SSE2_ClipMix(pBuffer+i+8, vmin, vmax), 24-MIXING_ATTENUATION);
+			__m128i n3 = _mm_srai_epi32(SSE2_ClipMix(pBuffer+i+12, vmin, vmax), 24-MIXING_ATTENUATION);
+			__m128i n = _mm_packs_epi16(_mm_packs_epi32(n0, n1), _mm_packs_epi32(n2, n3));
+			_mm_storeu_si128((__m128i *)(p+i), _mm_xor_si128(n, sign));
+		}
+		SSE2_StoreVU(vmin, vmax, vumin, vumax);
+	}
+#elif defined(MODPLUG_NEON)
+	if (lSampleCount >= 8)
+	{
+		int32x4_t vmin = vdupq_n_s32(vumin), vmax = vdupq_n_s32(vumax);
+		for (; i+8<=lSampleCount; i+=8)
+		{
+			int32x4_t n0 = vshrq_n_s32(NEON_ClipMix(pBuffer+i, vmin, vmax), 24-MIXING_ATTENUATION);
+			int32x4_t n1 = vshrq_n_s32(NEON_ClipMix(pBuffer+i+4, vmin, vmax), 24-MIXING_ATTENUATION);
+			int8x8_t n = vmovn_s16(vcombine_s16(vmovn_s32(n0), vmovn_s32(n1)));
+			vst1_u8(p+i, veor_u8(vreinterpret_u8_s8(n), vdup_n_u8(0x80)));
+		}
+		NEON_StoreVU(vmin, vmax, vumin, vumax);
+	}
+#endif
+	for (; i<lSampleCount; i++)
+	{
+		int n = ClipMixSample(pBuffer[i], vumin, vumax);
 		p[i] = (n >> (24-MIXING_ATTENUATION)) ^ 0x80;	// 8-bit unsigned
 	}
 	*lpMin = vumin;
@@ -1781,17 +2134,41 @@ DWORD MPPASMCALL X86_Convert32To16(LPVOID lp16, int *pBuffer, DWORD lSampleCount
 {
 	int vumin = *lpMin, vumax = *lpMax;
 	signed short *p = (signed short *)lp16;
-	for (UINT i=0; i<lSampleCount; i++)
+	UINT i = 0;
+#if defined(MODPLUG_SSE2) || defined(MODPLUG_NEON)
+	for (; i<lSampleCount && vumin>vumax; i++)
 	{
-		int n = pBuffer[i];
-		if (n < MIXING_CLIPMIN)
-			n = MIXING_CLIPMIN;
-		else if (n > MIXING_CLIPMAX)
-			n = MIXING_CLIPMAX;
-		if (n < vumin)
-			vumin = n;
-		else if (n > vumax)
-			vumax = n;
+		p[i] = ClipMixSample(pBuffer[i], vumin, vumax) >> (16-MIXING_ATTENUATION);
+	}
+#endif
+#if defined(MODPLUG_SSE2)
+	if (lSampleCount >= 8)
+	{
+		__m128i vmin = _mm_set1_epi32(vumin), vmax = _mm_set1_epi32(vumax);
+		for (; i+8<=lSampleCount; i+=8)
+		{
+			__m128i n0 = _mm_srai_epi32(SSE2_ClipMix(pBuffer+i, vmin, vmax), 16-MIXING_ATTENUATION);
+			__m128i n1 = _mm_srai_epi32(SSE2_ClipMix(pBuffer+i+4, vmin, vmax), 16-MIXING_ATTENUATION);
+			_mm_storeu_si128((__m128i *)(p+i), _mm_packs_epi32(n0, n1));
+		}
+		SSE2_StoreVU(vmin, vmax, vumin, vumax);
+	}
+#elif defined(MODPLUG_NEON)
+	if (lSampleCount >= 8)
+	{
+		int32x4_t vmin = vdupq_n_s32(vumin), vmax = vdupq_n_s32(vumax);
+		for (; i+8<=lSampleCount; i+=8)
+		{
+			int32x4_t n0 = vshrq_n_s32(NEON_ClipMix(pBuffer+i, vmin, vmax), 16-MIXING_ATTENUATION);
+			int32x4_t n1 = vshrq_n_s32(NEON_ClipMix(pBuffer+i+4, vmin, vmax), 16-MIXING_ATTENUATION);
+			vst1q_s16(p+i, vcombine_s16(vmovn_s32(n0), vmovn_s32(n1)));
+		}
+		NEON_StoreVU(vmin, vmax, vumin, vumax);
+	}
+#endif
+	for (; i<lSampleCount; i++)
+	{
+		int n = ClipMixSample(pBuffer[i], vumin, vumax);
 		p[i] = n >> (16-MIXING_ATTENUATION);	// 16-bit signed
 	}
 	*lpMin = vumin;
@@ -1974,21 +2351,42 @@ cliphigh:
 //---GCCFIX: Asm replaced with C function
 DWORD MPPASMCALL X86_Convert32To32(LPVOID lp16, int *pBuffer, DWORD lSampleCount, LPLONG lpMin, LPLONG lpMax)
 {
-	UINT i ;
+	UINT i = 0;
 	int vumin = *lpMin, vumax = *lpMax;
 	int32_t *p = (int32_t *)lp16;
 
-	for ( i=0; i<lSampleCount; i++)
+#if defined(MODPLUG_SSE2) || defined(MODPLUG_NEON)
+	for (; i<lSampleCount && vumin>vumax; i++)
 	{
-		int n = pBuffer[i];
-		if (n < MIXING_CLIPMIN)
-			n = MIXING_CLIPMIN;
-		else if (n > MIXING_CLIPMAX)
-			n = MIXING_CLIPMAX;
-		if (n < vumin)
-			vumin = n;
-		else if (n > vumax)
-			vumax = n;
+		p[i] = ClipMixSample(pBuffer[i], vumin, vumax) << MIXING_ATTENUATION;
+	}
+#endif
+#if defined(MODPLUG_SSE2)
+	if (lSampleCount >= 4)
+	{
+		__m128i vmin = _mm_set1_epi32(vumin), vmax = _mm_set1_epi32(vumax);
+		for (; i+4<=lSampleCount; i+=4)
+		{
+			__m128i n = SSE2_ClipMix(pBuffer+i, vmin, vmax);
+			_mm_storeu_si128((__m128i *)(p+i), _mm_slli_epi32(n, MIXING_ATTENUATION));
+		}
+		SSE2_StoreVU(vmin, vmax, vumin, vumax);
+	}
+#elif defined(MODPLUG_NEON)
+	if (lSampleCount >= 4)
+	{
+		int32x4_t vmin = vdupq_n_s32(vumin), vmax = vdupq_n_s32(vumax);
+		for (; i+4<=lSampleCount; i+=4)
+		{
+			int32x4_t n = NEON_ClipMix(pBuffer+i, vmin, vmax);
+			vst1q_s32(p+i, vshlq_n_s32(n, MIXING_ATTENUATION));
+		}
+		NEON_StoreVU(vmin, vmax, vumin, vumax);
+	}
+#endif
+	for ( ; i<lSampleCount; i++)
+	{
+		int n = ClipMixSample(pBuffer[i], vumin, vumax);
 		p[i] = n << MIXING_ATTENUATION;	// 32-bit signed
 	}
 	*lpMin = vumin;
@@ -2109,8 +2507,26 @@ stloop:
 //---GCCFIX: Asm replaced with C function
 VOID MPPASMCALL X86_MonoFromStereo(int *pMixBuf, UINT nSamples)
 {
-	UINT j;
-	for(UINT i = 0; i < nSamples; i++)
+	UINT i = 0, j;
+	// In place: each block is loaded before it is written, and the
+	// output never overtakes the input.
+#if defined(MODPLUG_SSE2)
+	for (; i+4<=nSamples; i+=4)
+	{
+		__m128 a = _mm_castsi128_ps(_mm_loadu_si128((const __m128i *)(pMixBuf+i*2)));
+		__m128 b = _mm_castsi128_ps(_mm_loadu_si128((const __m128i *)(pMixBuf+i*2+4)));
+		__m128i l = _mm_castps_si128(_mm_shuffle_ps(a, b, _MM_SHUFFLE(2,0,2,0)));
+		__m128i r = _mm_castps_si128(_mm_shuffle_ps(a, b, _MM_SHUFFLE(3,1,3,1)));
+		_mm_storeu_si128((__m128i *)(pMixBuf+i), _mm_srai_epi32(_mm_add_epi32(l, r), 1));
+	}
+#elif defined(MODPLUG_NEON)
+	for (; i+4<=nSamples; i+=4)
+	{
+		int32x4x2_t lr = vld2q_s32(pMixBuf+i*2);
+		vst1q_s32(pMixBuf+i, vshrq_n_s32(vaddq_s32(lr.val[0], lr.val[1]), 1));
+	}
+#endif
+	for(; i < nSamples; i++)
 	{
 		j = i << 1;
 		pMixBuf[i] = (pMixBuf[j] + pMixBuf[j + 1]) >> 1;
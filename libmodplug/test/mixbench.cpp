@@ -0,0 +1,135 @@
+/*
+ * mixbench.cpp
+ * ------------
+ * Benchmark of the vectorised and plain C mixing paths in fastmix.cpp.
+ *
+ * Renders a module with every resampling mode, output format and channel
+ * count, with and without AGC, using its own samples and synthetic 8-bit and
+ * 16-bit stereo samples (stereo samples take separate fetch paths). Prints a
+ * checksum of the output and the render time of every combination.
+ *
+ * The build creates modplug_mixbench and modplug_mixbench_c, the latter being
+ * linked against a library built with MODPLUG_NO_SIMD. Both must print the
+ * same checksums.
+ *
+ * Usage: modplug_mixbench <module> [seconds per combination]
+ */
+
+#include "stdafx.h"
+#include "sndfile.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <vector>
+
+static bool ReadFile(const char *filename, std::vector<unsigned char> &data)
+{
+	FILE *f = fopen(filename, "rb");
+	if (!f) return false;
+	unsigned char buf[4096];
+	size_t n;
+	while ((n = fread(buf, 1, sizeof(buf), f)) > 0)
+		data.insert(data.end(), buf, buf + n);
+	fclose(f);
+	return !data.empty();
+}
+
+// FNV-1a
+static unsigned long long Checksum(const unsigned char *p, size_t n, unsigned long long h)
+{
+	for (size_t i = 0; i < n; i++)
+	{
+		h ^= p[i];
+		h *= 1099511628211ULL;
+	}
+	return h;
+}
+
+// Replace all sample data with interleaved stereo noise of the same length
+static void MakeStereoSamples(CSoundFile &sndFile, bool is16Bit)
+{
+	for (UINT smp = 1; smp <= sndFile.GetNumSamples(); smp++)
+	{
+		MODINSTRUMENT &ins = sndFile.Ins[smp];
+		if (!ins.pSample || !ins.nLength) continue;
+		UINT count = ins.nLength * 2;
+		signed char *p = CSoundFile::AllocateSample(count * (is16Bit ? 2 : 1) + 64);
+		if (!p) continue;
+		for (UINT i = 0; i < count; i++)
+		{
+			int v = (int)((i * 2654435761u) >> 16);
+			if (is16Bit)
+				((signed short *)p)[i] = (signed short)v;
+			else
+				p[i] = (signed char)(v >> 8);
+		}
+		CSoundFile::FreeSample(ins.pSample);
+		ins.pSample = p;
+		ins.uFlags = (ins.uFlags & ~CHN_16BIT) | CHN_STEREO | (is16Bit ? CHN_16BIT : 0);
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	if (argc < 2)
+	{
+		fprintf(stderr, "Usage: %s <module> [seconds per combination]\n", argv[0]);
+		return 1;
+	}
+	std::vector<unsigned char> data;
+	if (!ReadFile(argv[1], data))
+	{
+		fprintf(stderr, "Cannot read %s\n", argv[1]);
+		return 1;
+	}
+	const int seconds = (argc > 2) ? atoi(argv[2]) : 60;
+
+	static const char * const sampleNames[] = { "module", "stereo8", "stereo16" };
+	static const UINT modes[] = { SRCMODE_LINEAR, SRCMODE_SPLINE, SRCMODE_POLYPHASE };
+	static const char * const modeNames[] = { "linear", "spline", "fir" };
+	static const UINT bits[] = { 8, 16, 32 };
+
+	unsigned long long total = 14695981039346656037ULL;
+	double totalTime = 0.0;
+	for (int samples = 0; samples < 3; samples++)
+	{
+		for (int mode = 0; mode < 3; mode++)
+		{
+			double time = 0.0;
+			for (int agc = 0; agc < 2; agc++)
+			for (int b = 0; b < 3; b++)
+			for (UINT channels = 1; channels <= 2; channels++)
+			{
+				CSoundFile::SetWaveConfig(44100, bits[b], channels);
+				CSoundFile::SetResamplingMode(modes[mode]);
+				CSoundFile::SetAGC(agc ? TRUE : FALSE);
+				CSoundFile sndFile;
+				if (!sndFile.Create(&data[0], (DWORD)data.size()))
+				{
+					fprintf(stderr, "Cannot load %s\n", argv[1]);
+					return 1;
+				}
+				if (samples) MakeStereoSamples(sndFile, samples == 2);
+
+				const UINT frameSize = channels * bits[b] / 8;
+				std::vector<unsigned char> buffer(44100 * frameSize);
+				unsigned long long sum = 14695981039346656037ULL;
+				clock_t start = clock();
+				for (int s = 0; s < seconds; s++)
+				{
+					UINT frames = sndFile.Read(&buffer[0], (UINT)buffer.size());
+					sum = Checksum(&buffer[0], frames * frameSize, sum);
+					if (frames * frameSize < buffer.size()) sndFile.SetCurrentPos(0);
+				}
+				time += (double)(clock() - start) / CLOCKS_PER_SEC;
+				printf("%-8s %-6s %2u bit %u ch agc %d  %016llx\n", sampleNames[samples], modeNames[mode], bits[b], channels, agc, sum);
+				total = Checksum((const unsigned char *)&sum, sizeof(sum), total);
+			}
+			printf("%-8s %-6s %.3f s\n", sampleNames[samples], modeNames[mode], time);
+			totalTime += time;
+		}
+	}
+	printf("total %016llx %.3f s\n", total, totalTime);
+	return 0;
+}
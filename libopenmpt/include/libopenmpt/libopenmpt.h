@@ -928,6 +928,7 @@ LIBOPENMPT_API const char * openmpt_module_highlight_pattern_row_channel( openmp
  *          - load.skip_patterns: Set to "1" to avoid loading patterns into memory
  *          - load.skip_plugins: Set to "1" to avoid loading plugins
  *          - load.skip_subsongs_init: Set to "1" to avoid pre-initializing sub-songs. Skipping results in faster module loading but slower seeking.
+ *          - load.defer_samples: Set to "1" to only decode the sample data once it is needed for rendering (the first call to openmpt_module_read or a seek with seek.sync_samples enabled). This makes loading faster if only the module metadata is needed. Setting it to "0" after loading decodes the sample data immediately. The first call to openmpt_module_read decodes all sample data at once and may block for as long as loading it would have taken.
  *          - seek.sync_samples: Set to "1" to sync sample playback when using openmpt_module_set_position_seconds or openmpt_module_set_position_order_row.
  *          - subsong: The current subsong. Setting it has identical semantics as openmpt_module_select_subsong(), getting it returns the currently selected subsong.
  *          - play.tempo_factor: Set a floating point tempo factor. "1.0" is the default tempo.
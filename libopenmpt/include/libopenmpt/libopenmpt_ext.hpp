@@ -55,6 +55,34 @@
 namespace openmpt {
 
 class module_ext_impl;
+class module_template_impl;
+
+//! A module that is loaded once and then instantiated many times
+/*!
+  A module_template parses a module file and decodes its sample data once.
+  Any number of openmpt::module_ext objects can then be created from it. They share the template's (immutable) sample data and only keep their own pattern data and playback state, which makes creating an instance much cheaper in terms of both time and memory than loading the module again.
+
+  The shared data is reference-counted. The module_template object may be destroyed while modules created from it are still in use.
+  Modules created from the same template can be used concurrently from different threads.
+*/
+class LIBOPENMPT_CXX_API module_template {
+
+	friend class module_ext;
+
+private:
+	module_template_impl * impl;
+private:
+	// non-copyable
+	module_template( const module_template & );
+	void operator = ( const module_template & );
+public:
+	module_template( std::istream & stream, std::ostream & log = std::clog, const std::map< std::string, std::string > & ctls = detail::initial_ctls_map() );
+	module_template( const std::vector<char> & data, std::ostream & log = std::clog, const std::map< std::string, std::string > & ctls = detail::initial_ctls_map() );
+	module_template( const char * data, std::size_t size, std::ostream & log = std::clog, const std::map< std::string, std::string > & ctls = detail::initial_ctls_map() );
+	module_template( const void * data, std::size_t size, std::ostream & log = std::clog, const std::map< std::string, std::string > & ctls = detail::initial_ctls_map() );
+	~module_template();
+
+}; // class module_template
 
 class LIBOPENMPT_CXX_API module_ext : public module {
 	
@@ -69,6 +97,14 @@ public:
 	module_ext( const std::vector<char> & data, std::ostream & log = std::clog, const std::map< std::string, std::string > & ctls = detail::initial_ctls_map() );
 	module_ext( const char * data, std::size_t size, std::ostream & log = std::clog, const std::map< std::string, std::string > & ctls = detail::initial_ctls_map() );
 	module_ext( const void * data, std::size_t size, std::ostream & log = std::clog, const std::map< std::string, std::string > & ctls = detail::initial_ctls_map() );
+	//! Create a new playback instance of a module template
+	/*!
+	  \param tmpl The module template. The new module uses the sample data of the template instead of loading its own copy.
+	  \param log Log where any warnings or errors are printed to. The lifetime of the reference has to be as long as the lifetime of the module instance.
+	  \param ctls A map of initial ctl values, see openmpt::module::get_ctls.
+	  \throws openmpt::exception Throws an exception derived from openmpt::exception in case the provided file cannot be opened.
+	*/
+	module_ext( const module_template & tmpl, std::ostream & log = std::clog, const std::map< std::string, std::string > & ctls = detail::initial_ctls_map() );
 	virtual ~module_ext();
 
 public:
@@ -298,6 +334,84 @@ class interactive {
 }; // class interactive
 
 
+#define LIBOPENMPT_EXT_INTERFACE_STEMS
+
+LIBOPENMPT_DECLARE_EXT_INTERFACE(stems)
+
+class stems {
+
+	LIBOPENMPT_EXT_INTERFACE(stems)
+
+	//! Set the channel groups rendered by openmpt::ext::stems::read_channels
+	/*!
+	  \param groups The group of every pattern channel, with openmpt::module::get_num_channels() entries. Each entry is a group index in range [0, openmpt::module::get_num_channels()[ or -1 to leave the channel out. An empty vector restores the default of one group per channel.
+	  \throws openmpt::exception Throws an exception derived from openmpt::exception if the number of entries or a group index is invalid.
+	  \remarks Notes that keep playing after a new note has been triggered (new note actions) stay in the group of the channel that started them.
+	  \sa openmpt::ext::stems::get_num_channel_groups
+	*/
+	virtual void set_channel_groups( const std::vector<std::int32_t> & groups ) = 0;
+
+	//! Get the number of channel groups rendered by openmpt::ext::stems::read_channels
+	/*!
+	  \return The highest group index passed to openmpt::ext::stems::set_channel_groups plus one. By default, this is the number of pattern channels.
+	  \sa openmpt::ext::stems::set_channel_groups
+	*/
+	virtual std::int32_t get_num_channel_groups( ) const = 0;
+
+	//! Render audio data into one stereo buffer pair per channel group
+	/*!
+	  \param samplerate Sample rate to render output. Should be in [8000,192000], but this is not enforced.
+	  \param count Number of audio frames to render per group.
+	  \param left Array of openmpt::ext::stems::get_num_channel_groups() pointers to buffers for the left channel of every group. Each buffer must be able to hold count samples.
+	  \param right Array of openmpt::ext::stems::get_num_channel_groups() pointers to buffers for the right channel of every group. Each buffer must be able to hold count samples.
+	  \return The number of frames actually rendered. Returns 0 at the end of the song, just like openmpt::module::read.
+	  \throws openmpt::exception Throws an exception derived from openmpt::exception if any of the buffer pointers is a nullptr.
+	  \remarks All groups are rendered in a single pass, so this costs about as much as openmpt::module::read. Adding up all groups gives the output of openmpt::module::read, apart from rounding, dithering and clipping.
+	  \remarks The output of mix plugins cannot be split by channel and is added to group 0.
+	  \sa openmpt::module::read
+	*/
+	virtual std::size_t read_channels( std::int32_t samplerate, std::size_t count, std::int16_t * const * left, std::int16_t * const * right ) = 0;
+
+	//! Render audio data into one stereo buffer pair per channel group
+	/*!
+	  \param samplerate Sample rate to render output. Should be in [8000,192000], but this is not enforced.
+	  \param count Number of audio frames to render per group.
+	  \param left Array of openmpt::ext::stems::get_num_channel_groups() pointers to buffers for the left channel of every group. Each buffer must be able to hold count samples.
+	  \param right Array of openmpt::ext::stems::get_num_channel_groups() pointers to buffers for the right channel of every group. Each buffer must be able to hold count samples.
+	  \return The number of frames actually rendered. Returns 0 at the end of the song, just like openmpt::module::read.
+	  \throws openmpt::exception Throws an exception derived from openmpt::exception if any of the buffer pointers is a nullptr.
+	  \remarks Floating point samples are in the [-1.0..1.0] nominal range. They are not clipped to that range though and thus might overshoot.
+	  \remarks The output of mix plugins cannot be split by channel and is added to group 0.
+	  \sa openmpt::module::read
+	*/
+	virtual std::size_t read_channels( std::int32_t samplerate, std::size_t count, float * const * left, float * const * right ) = 0;
+
+}; // class stems
+
+
+
+#define LIBOPENMPT_EXT_INTERFACE_SAMPLE_PREFETCH
+
+LIBOPENMPT_DECLARE_EXT_INTERFACE(sample_prefetch)
+
+class sample_prefetch {
+
+	LIBOPENMPT_EXT_INTERFACE(sample_prefetch)
+
+	//! Decode sample data that has been deferred with the ctl load.defer_samples
+	/*!
+	  With load.defer_samples enabled, the first call to openmpt::module::read (or a seek with seek.sync_samples enabled) has to decode all sample data before rendering and blocks for about as long as loading the samples would have taken.
+	  Calling this function beforehand moves that work to the calling thread, so that rendering only has to attach the already decoded sample data.
+	  \return true if the sample data has been decoded successfully or if no sample data has been deferred, false if decoding failed.
+	  \remarks Unlike any other function of openmpt::module_ext, this function may be called from a different thread than the thread that is using the module, also concurrently with it. Calls that need the sample data wait until a concurrently running prefetch has finished.
+	  \remarks Calling this function more than once has no further effect.
+	  \sa openmpt::module::ctl_set
+	*/
+	virtual bool prefetch_samples() = 0;
+
+}; // class sample_prefetch
+
+
 /* add stuff here */
 
 
@@ -202,6 +202,9 @@
 // Use inline assembly
 #define ENABLE_ASM
 
+// Use architecture-specific intrinsics (only used when the CPU supports them)
+#define MPT_ENABLE_ARCH_INTRINSICS
+
 // Disable unarchiving support
 //#define NO_ARCHIVE_SUPPORT
 
@@ -273,6 +276,8 @@
 #endif
 // Do not use inline asm in library builds. There is just about no codepath which would use it anyway.
 //#define ENABLE_ASM
+// Intrinsics are portable across compilers and only used when the CPU supports them.
+#define MPT_ENABLE_ARCH_INTRINSICS
 #if defined(MPT_BUILD_HACK_ARCHIVE_SUPPORT)
 //#define NO_ARCHIVE_SUPPORT
 #else
@@ -456,6 +461,27 @@
 #endif // arch
 #endif // ENABLE_ASM
 
+#if defined(MPT_DISABLE_ARCH_INTRINSICS)
+#undef MPT_ENABLE_ARCH_INTRINSICS
+#endif
+
+#if defined(MPT_ENABLE_ARCH_INTRINSICS)
+#if (MPT_COMPILER_MSVC && (defined(_M_IX86) || defined(_M_X64))) || ((MPT_COMPILER_GCC || MPT_COMPILER_CLANG) && (defined(__i386__) || defined(__x86_64__)))
+
+// Generate general x86 / x64 intrinsics, including CPU feature detection.
+#define MPT_ENABLE_ARCH_X86
+// Generate SSE2 intrinsics (only used when the CPU supports it).
+#define MPT_ENABLE_ARCH_INTRINSICS_SSE2
+#if MPT_MSVC_AT_LEAST(2013,0) || MPT_GCC_AT_LEAST(4,9,0) || MPT_CLANG_AT_LEAST(3,8,0)
+// Generate AVX2 intrinsics (only used when the CPU supports it).
+#define MPT_ENABLE_ARCH_INTRINSICS_AVX2
+#endif
+
+#else
+#undef MPT_ENABLE_ARCH_INTRINSICS // no intrinsics for this architecture
+#endif // arch
+#endif // MPT_ENABLE_ARCH_INTRINSICS
+
 #if !defined(ENABLE_MMX) && !defined(NO_REVERB)
 #define NO_REVERB // reverb requires mmx
 #endif
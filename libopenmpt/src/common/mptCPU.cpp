@@ -11,11 +11,24 @@
 #include "stdafx.h"
 #include "mptCPU.h"
 
+#if defined(ENABLE_ASM) || defined(MPT_ENABLE_ARCH_INTRINSICS)
+#if (MPT_COMPILER_MSVC && (defined(ENABLE_X86) || defined(ENABLE_X64))) || defined(MPT_ENABLE_ARCH_X86)
+#if MPT_COMPILER_MSVC
+#include <intrin.h>
+#if MPT_MSVC_AT_LEAST(2010,1)
+#include <immintrin.h>
+#endif
+#else
+#include <cpuid.h>
+#endif
+#endif
+#endif
+
 
 OPENMPT_NAMESPACE_BEGIN
 
 
-#if defined(ENABLE_ASM)
+#if defined(ENABLE_ASM) || defined(MPT_ENABLE_ARCH_INTRINSICS)
 
 
 uint32 RealProcSupport = 0;
@@ -26,10 +39,7 @@ uint8 ProcModel = 0;
 uint8 ProcStepping = 0;
 
 
-#if MPT_COMPILER_MSVC && (defined(ENABLE_X86) || defined(ENABLE_X64))
-
-
-#include <intrin.h>
+#if (MPT_COMPILER_MSVC && (defined(ENABLE_X86) || defined(ENABLE_X64))) || defined(MPT_ENABLE_ARCH_X86)
 
 
 typedef char cpuid_result_string[12];
@@ -60,6 +70,9 @@ struct cpuid_result {
 };
 
 
+#if MPT_COMPILER_MSVC
+
+
 static cpuid_result cpuid(uint32 function)
 //----------------------------------------
 {
@@ -111,6 +124,61 @@ static MPT_NOINLINE bool has_cpuid()
 }
 
 
+static uint64 xgetbv(uint32 index)
+//--------------------------------
+{
+	#if MPT_MSVC_AT_LEAST(2010,1)
+		return _xgetbv(index);
+	#else
+		// no AVX support without the intrinsic
+		MPT_UNREFERENCED_PARAMETER(index);
+		return 0;
+	#endif
+}
+
+
+#else // !MPT_COMPILER_MSVC
+
+
+static cpuid_result cpuid(uint32 function)
+//----------------------------------------
+{
+	cpuid_result result;
+	__cpuid(function, result.a, result.b, result.c, result.d);
+	return result;
+}
+
+
+static cpuid_result cpuidex(uint32 function_a, uint32 function_c)
+//---------------------------------------------------------------
+{
+	cpuid_result result;
+	__cpuid_count(function_a, function_c, result.a, result.b, result.c, result.d);
+	return result;
+}
+
+
+static MPT_NOINLINE bool has_cpuid()
+//----------------------------------
+{
+	// Does the EFLAGS test on 32bit x86, always true on amd64.
+	return __get_cpuid_max(0, nullptr) != 0;
+}
+
+
+static uint64 xgetbv(uint32 index)
+//--------------------------------
+{
+	uint32 a, d;
+	// xgetbv, encoded as bytes for old assemblers
+	__asm__ __volatile__ (".byte 0x0f, 0x01, 0xd0" : "=a" (a), "=d" (d) : "c" (index));
+	return (static_cast<uint64>(d) << 32) | a;
+}
+
+
+#endif // MPT_COMPILER_MSVC
+
+
 void InitProcSupport()
 //--------------------
 {
@@ -161,6 +229,18 @@ void InitProcSupport()
 			if(StandardFeatureFlags.c & (1<< 9)) ProcSupport |= PROCSUPPORT_SSSE3;
 			if(StandardFeatureFlags.c & (1<<19)) ProcSupport |= PROCSUPPORT_SSE4_1;
 			if(StandardFeatureFlags.c & (1<<20)) ProcSupport |= PROCSUPPORT_SSE4_2;
+			if((StandardFeatureFlags.c & (1<<27)) && (StandardFeatureFlags.c & (1<<28)))
+			{ // OSXSAVE and AVX: The OS also has to save the upper halves of the ymm registers.
+				if((xgetbv(0) & 0x6) == 0x6)
+				{
+					ProcSupport |= PROCSUPPORT_AVX;
+					if(VendorString.a >= 0x00000007u)
+					{
+						cpuid_result ExtendedFeatureFlags7 = cpuidex(0x00000007u, 0x00000000u);
+						if(ExtendedFeatureFlags7.b & (1<< 5)) ProcSupport |= PROCSUPPORT_AVX2;
+					}
+				}
+			}
 		}
 
 		// 3DNow! manual recommends to just execute 0x80000000u.
@@ -273,7 +353,7 @@ void InitProcSupport()
 }
 
 
-#else // !( MPT_COMPILER_MSVC && ENABLE_X86 )
+#else // !( (MPT_COMPILER_MSVC && ENABLE_X86) || MPT_ENABLE_ARCH_X86 )
 
 
 void InitProcSupport()
@@ -283,9 +363,9 @@ void InitProcSupport()
 }
 
 
-#endif // MPT_COMPILER_MSVC && ENABLE_X86
+#endif // (MPT_COMPILER_MSVC && ENABLE_X86) || MPT_ENABLE_ARCH_X86
 
-#endif // ENABLE_ASM
+#endif // ENABLE_ASM || MPT_ENABLE_ARCH_INTRINSICS
 
 
 #ifdef MODPLUG_TRACKER
@@ -332,7 +412,7 @@ int GetMinimumAVXVersion()
 #endif
 
 
-#if !defined(MODPLUG_TRACKER) && !defined(ENABLE_ASM)
+#if !defined(MODPLUG_TRACKER) && !defined(ENABLE_ASM) && !defined(MPT_ENABLE_ARCH_INTRINSICS)
 
 MPT_MSVC_WORKAROUND_LNK4221(mptCPU)
 
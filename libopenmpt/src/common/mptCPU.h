@@ -14,7 +14,7 @@
 OPENMPT_NAMESPACE_BEGIN
 
 
-#ifdef ENABLE_ASM
+#if defined(ENABLE_ASM) || defined(MPT_ENABLE_ARCH_INTRINSICS)
 #define PROCSUPPORT_CPUID        0x00001 // Processor supports CPUID instruction (i586)
 #define PROCSUPPORT_TSC          0x00002 // Processor supports RDTSC instruction (i586)
 #define PROCSUPPORT_CMOV         0x00004 // Processor supports conditional move instructions (i686)
@@ -29,6 +29,8 @@ OPENMPT_NAMESPACE_BEGIN
 #define PROCSUPPORT_SSSE3        0x00800 // Processor supports SSSE3 instructions
 #define PROCSUPPORT_SSE4_1       0x01000 // Processor supports SSE4.1 instructions
 #define PROCSUPPORT_SSE4_2       0x02000 // Processor supports SSE4.2 instructions
+#define PROCSUPPORT_AVX          0x04000 // Processor and OS support AVX instructions
+#define PROCSUPPORT_AVX2         0x08000 // Processor and OS support AVX2 instructions
 extern uint32 RealProcSupport;
 extern uint32 ProcSupport;
 extern char ProcVendorID[16+1];
@@ -47,7 +49,7 @@ static inline uint32 GetRealProcSupport()
 	return RealProcSupport;
 }
 
-#endif // ENABLE_ASM
+#endif // ENABLE_ASM || MPT_ENABLE_ARCH_INTRINSICS
 
 
 #ifdef MODPLUG_TRACKER
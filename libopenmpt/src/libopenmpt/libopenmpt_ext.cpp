@@ -7,6 +7,7 @@
 #include "libopenmpt_ext.hpp"
 #include "libopenmpt_impl.hpp"
 
+#include <algorithm>
 #include <stdexcept>
 
 #include "soundlib/Sndfile.h"
@@ -21,10 +22,36 @@ using namespace OpenMPT;
 
 namespace openmpt {
 
+class module_template_impl {
+public:
+#ifdef LIBOPENMPT_ANCIENT_COMPILER_SHARED_PTR
+	LIBOPENMPT_SHARED_PTR<const module_template_data> data;
+#else
+	std::shared_ptr<const module_template_data> data;
+#endif
+public:
+#ifdef LIBOPENMPT_ANCIENT_COMPILER
+	module_template_impl( std::istream & stream, std::ostream & log, const std::map< std::string, std::string > & ctls ) : data( new module_template_data( stream, std::tr1::shared_ptr<std_ostream_log>( new std_ostream_log( log ) ), ctls ) ) {
+#else
+	module_template_impl( std::istream & stream, std::ostream & log, const std::map< std::string, std::string > & ctls ) : data( std::make_shared<module_template_data>( stream, std::make_shared<std_ostream_log>( log ), ctls ) ) {
+#endif
+		return;
+	}
+#ifdef LIBOPENMPT_ANCIENT_COMPILER
+	module_template_impl( const std::vector<char> & file_data, std::ostream & log, const std::map< std::string, std::string > & ctls ) : data( new module_template_data( file_data, std::tr1::shared_ptr<std_ostream_log>( new std_ostream_log( log ) ), ctls ) ) {
+#else
+	module_template_impl( const std::vector<char> & file_data, std::ostream & log, const std::map< std::string, std::string > & ctls ) : data( std::make_shared<module_template_data>( file_data, std::make_shared<std_ostream_log>( log ), ctls ) ) {
+#endif
+		return;
+	}
+}; // class module_template_impl
+
 class module_ext_impl
 	: public module_impl
 	, public ext::pattern_vis
 	, public ext::interactive
+	, public ext::stems
+	, public ext::sample_prefetch
 
 
 
@@ -62,6 +89,13 @@ public:
 #endif
 		ctor();
 	}
+#ifdef LIBOPENMPT_ANCIENT_COMPILER
+	module_ext_impl( const module_template_impl & tmpl, std::ostream & log, const std::map< std::string, std::string > & ctls ) : module_impl( tmpl.data, std::tr1::shared_ptr<std_ostream_log>( new std_ostream_log( log ) ), ctls ) {
+#else
+	module_ext_impl( const module_template_impl & tmpl, std::ostream & log, const std::map< std::string, std::string > & ctls ) : module_impl( tmpl.data, std::make_shared<std_ostream_log>( log ), ctls ) {
+#endif
+		ctor();
+	}
 
 private:
 
@@ -75,7 +109,7 @@ private:
 
 	void ctor() {
 
-
+		set_channel_groups( std::vector<std::int32_t>() );
 
 		/* add stuff here */
 
@@ -104,6 +138,10 @@ public:
 			return dynamic_cast< ext::pattern_vis * >( this );
 		} else if ( interface_id == ext::interactive_id ) {
 			return dynamic_cast< ext::interactive * >( this );
+		} else if ( interface_id == ext::stems_id ) {
+			return dynamic_cast< ext::stems * >( this );
+		} else if ( interface_id == ext::sample_prefetch_id ) {
+			return dynamic_cast< ext::sample_prefetch * >( this );
 
 
 
@@ -314,6 +352,69 @@ public:
 		chn.pCurrentSample = nullptr;
 	}
 
+	// stems
+
+	virtual void set_channel_groups( const std::vector<std::int32_t> & groups ) {
+		const std::int32_t num_channels = get_num_channels();
+		std::vector<OpenMPT::uint32> channel_stems( num_channels, CSoundFile::STEM_NONE );
+		OpenMPT::uint32 num_stems = 0;
+		if ( groups.empty() ) {
+			for ( std::int32_t channel = 0; channel < num_channels; ++channel ) {
+				channel_stems[channel] = channel;
+			}
+			num_stems = num_channels;
+		} else {
+			if ( groups.size() != static_cast<std::size_t>( num_channels ) ) {
+				throw openmpt::exception("invalid number of channel groups");
+			}
+			for ( std::int32_t channel = 0; channel < num_channels; ++channel ) {
+				if ( groups[channel] < -1 || groups[channel] >= num_channels ) {
+					throw openmpt::exception("invalid channel group");
+				}
+				if ( groups[channel] >= 0 ) {
+					channel_stems[channel] = groups[channel];
+					num_stems = std::max<OpenMPT::uint32>( num_stems, groups[channel] + 1 );
+				}
+			}
+		}
+		m_sndFile->SetStems( channel_stems, num_stems );
+	}
+
+	virtual std::int32_t get_num_channel_groups( ) const {
+		return m_sndFile->GetNumStems();
+	}
+
+	template < typename Tsample >
+	std::size_t read_channels_impl( std::int32_t samplerate, std::size_t count, Tsample * const * left, Tsample * const * right ) {
+		const std::size_t num_groups = get_num_channel_groups();
+		if ( num_groups > 0 && ( !left || !right ) ) {
+			throw openmpt::exception("null pointer");
+		}
+		for ( std::size_t group = 0; group < num_groups; ++group ) {
+			if ( !left[group] || !right[group] ) {
+				throw openmpt::exception("null pointer");
+			}
+		}
+		apply_mixer_settings( samplerate, 2 );
+		count = read_stems_wrapper( count, num_groups, left, right );
+		m_currentPositionSeconds += static_cast<double>( count ) / static_cast<double>( samplerate );
+		return count;
+	}
+
+	virtual std::size_t read_channels( std::int32_t samplerate, std::size_t count, std::int16_t * const * left, std::int16_t * const * right ) {
+		return read_channels_impl( samplerate, count, left, right );
+	}
+
+	virtual std::size_t read_channels( std::int32_t samplerate, std::size_t count, float * const * left, float * const * right ) {
+		return read_channels_impl( samplerate, count, left, right );
+	}
+
+	// sample_prefetch
+
+	virtual bool prefetch_samples() {
+		return prefetch_deferred_samples();
+	}
+
 
 	/* add stuff here */
 
@@ -337,6 +438,10 @@ module_ext::module_ext( const void * data, std::size_t size, std::ostream & log,
 	ext_impl = new module_ext_impl( data, size, log, ctls );
 	set_impl( ext_impl );
 }
+module_ext::module_ext( const module_template & tmpl, std::ostream & log, const std::map< std::string, std::string > & ctls ) : ext_impl(0) {
+	ext_impl = new module_ext_impl( *tmpl.impl, log, ctls );
+	set_impl( ext_impl );
+}
 module_ext::~module_ext() {
 	set_impl( 0 );
 	delete ext_impl;
@@ -353,6 +458,29 @@ void * module_ext::get_interface( const std::string & interface_id ) {
 	return ext_impl->get_interface( interface_id );
 }
 
+module_template::module_template( std::istream & stream, std::ostream & log, const std::map< std::string, std::string > & ctls ) : impl(0) {
+	impl = new module_template_impl( stream, log, ctls );
+}
+module_template::module_template( const std::vector<char> & data, std::ostream & log, const std::map< std::string, std::string > & ctls ) : impl(0) {
+	impl = new module_template_impl( data, log, ctls );
+}
+module_template::module_template( const char * data, std::size_t size, std::ostream & log, const std::map< std::string, std::string > & ctls ) : impl(0) {
+	impl = new module_template_impl( std::vector<char>( data, data + size ), log, ctls );
+}
+module_template::module_template( const void * data, std::size_t size, std::ostream & log, const std::map< std::string, std::string > & ctls ) : impl(0) {
+	impl = new module_template_impl( std::vector<char>( static_cast<const char *>( data ), static_cast<const char *>( data ) + size ), log, ctls );
+}
+module_template::~module_template() {
+	delete impl;
+	impl = 0;
+}
+module_template::module_template( const module_template & ) {
+	throw std::runtime_error("openmpt::module_template is non-copyable");
+}
+void module_template::operator = ( const module_template & ) {
+	throw std::runtime_error("openmpt::module_template is non-copyable");
+}
+
 } // namespace openmpt
 
 #endif // NO_LIBOPENMPT_CXX
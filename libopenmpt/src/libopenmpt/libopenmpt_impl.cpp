@@ -277,6 +277,45 @@ void loader_log::AddToLog( LogLevel level, const mpt::ustring & text ) const {
 	m_Messages.push_back( std::make_pair( level, mpt::ToCharset( mpt::CharsetUTF8, text ) ) );
 }
 
+// Decoding only touches this struct, so it can run on a different thread than rendering (see prefetch_deferred_samples).
+struct module_impl::deferred_samples {
+	mpt::mutex mutex;
+	std::vector<char> file_data;
+#ifdef LIBOPENMPT_ANCIENT_COMPILER_SHARED_PTR
+	LIBOPENMPT_SHARED_PTR<CSoundFile> sndFile;
+#else
+	std::unique_ptr<CSoundFile> sndFile;
+#endif
+	std::vector<std::pair<LogLevel,std::string> > messages;
+	bool decoded; // protected by mutex
+	bool attached; // only accessed by the thread that renders the module
+	deferred_samples() : decoded(false), attached(false) {
+		return;
+	}
+	// Call with mutex held
+	void decode() {
+		if ( decoded ) {
+			return;
+		}
+		decoded = true;
+		std::vector<char> data;
+		data.swap( file_data );
+		loader_log log;
+#ifdef LIBOPENMPT_ANCIENT_COMPILER_SHARED_PTR
+		sndFile = LIBOPENMPT_SHARED_PTR<CSoundFile>(new CSoundFile());
+#else
+		sndFile = std::unique_ptr<CSoundFile>(new CSoundFile());
+#endif
+		sndFile->SetCustomLog( &log );
+		const bool loaded = sndFile->Create( FileReader( mpt::byte_cast< mpt::span< const mpt::byte > >( mpt::as_span( data ) ) ), CSoundFile::loadNoPatternOrPluginData );
+		sndFile->SetCustomLog( nullptr );
+		if ( !loaded ) {
+			sndFile.reset();
+		}
+		messages = log.GetMessages();
+	}
+}; // struct module_impl::deferred_samples
+
 void module_impl::PushToCSoundFileLog( const std::string & text ) const {
 	m_sndFile->AddToLog( LogError, mpt::ToUnicode( mpt::CharsetUTF8, text ) );
 }
@@ -353,6 +392,13 @@ static void mixersettings_to_ramping( int & ramping, const MixerSettings & setti
 		ramping = ( ramp_us + 500 ) / 1000;
 	}
 }
+#ifdef MPT_ENABLE_ARCH_INTRINSICS
+static void init_proc_support() {
+	// CPU features are detected once per process, even if modules get constructed concurrently.
+	static const bool initialized = ( InitProcSupport(), true );
+	static_cast<void>( initialized );
+}
+#endif // MPT_ENABLE_ARCH_INTRINSICS
 
 std::string module_impl::mod_string_to_utf8( const std::string & encoded ) const {
 	return mpt::ToCharset( mpt::CharsetUTF8, m_sndFile->GetCharset(), encoded );
@@ -399,6 +445,9 @@ bool module_impl::has_subsongs_inited() const {
 	return !m_subsongs.empty();
 }
 void module_impl::ctor( const std::map< std::string, std::string > & ctls ) {
+#ifdef MPT_ENABLE_ARCH_INTRINSICS
+	init_proc_support();
+#endif // MPT_ENABLE_ARCH_INTRINSICS
 #ifdef LIBOPENMPT_ANCIENT_COMPILER_SHARED_PTR
 	m_sndFile = LIBOPENMPT_SHARED_PTR<CSoundFile>(new CSoundFile());
 #else
@@ -423,6 +472,7 @@ void module_impl::ctor( const std::map< std::string, std::string > & ctls ) {
 	m_ctl_load_skip_patterns = false;
 	m_ctl_load_skip_plugins = false;
 	m_ctl_load_skip_subsongs_init = false;
+	m_ctl_load_defer_samples = false;
 	m_ctl_seek_sync_samples = false;
 	// init member variables that correspond to ctls
 	for ( std::map< std::string, std::string >::const_iterator i = ctls.begin(); i != ctls.end(); ++i ) {
@@ -434,7 +484,9 @@ void module_impl::load( const FileReader & file, const std::map< std::string, st
 	m_sndFile->SetCustomLog( &loaderlog );
 	{
 		int load_flags = CSoundFile::loadCompleteModule;
-		if ( m_ctl_load_skip_samples ) {
+		const bool borrow_samples = m_template && !m_ctl_load_skip_samples;
+		const bool defer_samples = m_ctl_load_defer_samples && !m_ctl_load_skip_samples && !borrow_samples;
+		if ( m_ctl_load_skip_samples || borrow_samples || defer_samples ) {
 			load_flags &= ~CSoundFile::loadSampleData;
 		}
 		if ( m_ctl_load_skip_patterns ) {
@@ -446,8 +498,27 @@ void module_impl::load( const FileReader & file, const std::map< std::string, st
 		if ( !m_sndFile->Create( file, static_cast<CSoundFile::ModLoadingFlags>( load_flags ) ) ) {
 			throw openmpt::exception("error loading file");
 		}
+		if ( borrow_samples && !m_sndFile->BorrowSampleData( *m_template->m_module->m_sndFile ) ) {
+			throw openmpt::exception("error loading file");
+		}
+		if ( defer_samples ) {
+			// Keep a copy of the file (the caller's data is not valid after loading), the samples are decoded from it once they are needed.
+			FileReader file_data = file;
+			file_data.Rewind();
+			FileReader::PinnedRawDataView view = file_data.GetPinnedRawDataView();
+#ifdef LIBOPENMPT_ANCIENT_COMPILER_SHARED_PTR
+			m_deferred_samples = LIBOPENMPT_SHARED_PTR<deferred_samples>(new deferred_samples());
+#else
+			m_deferred_samples = std::unique_ptr<deferred_samples>(new deferred_samples());
+#endif
+			m_deferred_samples->file_data.assign( reinterpret_cast<const char *>( view.data() ), reinterpret_cast<const char *>( view.data() ) + view.size() );
+		}
 		if ( !m_ctl_load_skip_subsongs_init ) {
-			init_subsongs( m_subsongs );
+			if ( m_template && m_template->m_module->has_subsongs_inited() ) {
+				m_subsongs = m_template->m_module->m_subsongs;
+			} else {
+				init_subsongs( m_subsongs );
+			}
 		}
 		m_loaded = true;
 	}
@@ -465,7 +536,31 @@ void module_impl::load( const FileReader & file, const std::map< std::string, st
 bool module_impl::is_loaded() const {
 	return m_loaded;
 }
+void module_impl::load_deferred_samples() {
+	if ( !m_deferred_samples || m_deferred_samples->attached ) {
+		return;
+	}
+	MPT_LOCK_GUARD<mpt::mutex> guard( m_deferred_samples->mutex );
+	m_deferred_samples->decode();
+	m_deferred_samples->attached = true;
+	for ( std::vector<std::pair<LogLevel,std::string> >::iterator i = m_deferred_samples->messages.begin(); i != m_deferred_samples->messages.end(); ++i ) {
+		PushToCSoundFileLog( i->first, i->second );
+	}
+	m_deferred_samples->messages.clear();
+	if ( !m_deferred_samples->sndFile || !m_sndFile->BorrowSampleData( *m_deferred_samples->sndFile ) ) {
+		PushToCSoundFileLog( LogWarning, "error loading deferred sample data" );
+	}
+}
+bool module_impl::prefetch_deferred_samples() {
+	if ( !m_deferred_samples ) {
+		return true;
+	}
+	MPT_LOCK_GUARD<mpt::mutex> guard( m_deferred_samples->mutex );
+	m_deferred_samples->decode();
+	return m_deferred_samples->sndFile ? true : false;
+}
 std::size_t module_impl::read_wrapper( std::size_t count, std::int16_t * left, std::int16_t * right, std::int16_t * rear_left, std::int16_t * rear_right ) {
+	load_deferred_samples();
 	m_sndFile->ResetMixStat();
 	std::size_t count_read = 0;
 	while ( count > 0 ) {
@@ -484,6 +579,7 @@ std::size_t module_impl::read_wrapper( std::size_t count, std::int16_t * left, s
 	return count_read;
 }
 std::size_t module_impl::read_wrapper( std::size_t count, float * left, float * right, float * rear_left, float * rear_right ) {
+	load_deferred_samples();
 	m_sndFile->ResetMixStat();
 	std::size_t count_read = 0;
 	while ( count > 0 ) {
@@ -502,6 +598,7 @@ std::size_t module_impl::read_wrapper( std::size_t count, float * left, float *
 	return count_read;
 }
 std::size_t module_impl::read_interleaved_wrapper( std::size_t count, std::size_t channels, std::int16_t * interleaved ) {
+	load_deferred_samples();
 	m_sndFile->ResetMixStat();
 	std::size_t count_read = 0;
 	while ( count > 0 ) {
@@ -519,6 +616,7 @@ std::size_t module_impl::read_interleaved_wrapper( std::size_t count, std::size_
 	return count_read;
 }
 std::size_t module_impl::read_interleaved_wrapper( std::size_t count, std::size_t channels, float * interleaved ) {
+	load_deferred_samples();
 	m_sndFile->ResetMixStat();
 	std::size_t count_read = 0;
 	while ( count > 0 ) {
@@ -535,6 +633,43 @@ std::size_t module_impl::read_interleaved_wrapper( std::size_t count, std::size_
 	}
 	return count_read;
 }
+template < typename Tsample >
+static std::size_t read_stems_chunked( CSoundFile & sndFile, Dither & dither, float gain, std::size_t count, std::size_t stems, Tsample * const * left, Tsample * const * right ) {
+	std::size_t count_read = 0;
+	std::vector< AudioReadTargetGainBuffer<Tsample> > targets;
+	std::vector< IAudioReadTarget * > target_pointers( stems );
+	std::vector< Tsample * > buffers( stems * 2 );
+	targets.reserve( stems );
+	while ( count > 0 ) {
+		targets.clear();
+		for ( std::size_t stem = 0; stem < stems; ++stem ) {
+			buffers[stem * 2 + 0] = left[stem] + count_read;
+			buffers[stem * 2 + 1] = right[stem] + count_read;
+			targets.push_back( AudioReadTargetGainBuffer<Tsample>( dither, 0, &buffers[stem * 2], gain ) );
+			target_pointers[stem] = &targets[stem];
+		}
+		std::size_t count_chunk = sndFile.ReadStems(
+			static_cast<CSoundFile::samplecount_t>( std::min<std::uint64_t>( count, std::numeric_limits<CSoundFile::samplecount_t>::max() / 2 / 4 / 4 ) ), // safety margin / samplesize / channels
+			target_pointers.empty() ? 0 : &target_pointers[0]
+			);
+		if ( count_chunk == 0 ) {
+			break;
+		}
+		count -= count_chunk;
+		count_read += count_chunk;
+	}
+	return count_read;
+}
+std::size_t module_impl::read_stems_wrapper( std::size_t count, std::size_t stems, std::int16_t * const * left, std::int16_t * const * right ) {
+	load_deferred_samples();
+	m_sndFile->ResetMixStat();
+	return read_stems_chunked( *m_sndFile, *m_Dither, m_Gain, count, stems, left, right );
+}
+std::size_t module_impl::read_stems_wrapper( std::size_t count, std::size_t stems, float * const * left, float * const * right ) {
+	load_deferred_samples();
+	m_sndFile->ResetMixStat();
+	return read_stems_chunked( *m_sndFile, *m_Dither, m_Gain, count, stems, left, right );
+}
 
 std::vector<std::string> module_impl::get_supported_extensions() {
 	std::vector<std::string> retval;
@@ -682,10 +817,50 @@ module_impl::module_impl( const void * data, std::size_t size, std::shared_ptr<l
 	load( FileReader( mpt::as_span( mpt::void_cast< const mpt::byte * >( data ), size ) ), ctls );
 	apply_libopenmpt_defaults();
 }
+#ifdef LIBOPENMPT_ANCIENT_COMPILER_SHARED_PTR
+module_impl::module_impl( LIBOPENMPT_SHARED_PTR<const module_template_data> tmpl, LIBOPENMPT_SHARED_PTR<log_interface> log, const std::map< std::string, std::string > & ctls ) : m_Log(log), m_template(tmpl) {
+#else
+module_impl::module_impl( std::shared_ptr<const module_template_data> tmpl, std::shared_ptr<log_interface> log, const std::map< std::string, std::string > & ctls ) : m_Log(log), m_template(tmpl) {
+#endif
+	ctor( ctls );
+	load( FileReader( mpt::byte_cast< mpt::span< const mpt::byte > >( mpt::as_span( m_template->m_data ) ) ), ctls );
+	apply_libopenmpt_defaults();
+}
 module_impl::~module_impl() {
 	m_sndFile->Destroy();
 }
 
+#ifdef LIBOPENMPT_ANCIENT_COMPILER_SHARED_PTR
+module_template_data::module_template_data( std::istream & stream, LIBOPENMPT_SHARED_PTR<log_interface> log, const std::map< std::string, std::string > & ctls ) {
+#else
+module_template_data::module_template_data( std::istream & stream, std::shared_ptr<log_interface> log, const std::map< std::string, std::string > & ctls ) {
+#endif
+	m_data.assign( std::istreambuf_iterator<char>( stream ), std::istreambuf_iterator<char>() );
+#ifdef LIBOPENMPT_ANCIENT_COMPILER_SHARED_PTR
+	m_module = LIBOPENMPT_SHARED_PTR<module_impl>( new module_impl( m_data, log, ctls ) );
+#else
+	m_module = std::unique_ptr<module_impl>( new module_impl( m_data, log, ctls ) );
+#endif
+	// Instances borrow the template's samples, so they must be available even with load.defer_samples.
+	m_module->load_deferred_samples();
+}
+#ifdef LIBOPENMPT_ANCIENT_COMPILER_SHARED_PTR
+module_template_data::module_template_data( const std::vector<char> & data, LIBOPENMPT_SHARED_PTR<log_interface> log, const std::map< std::string, std::string > & ctls ) : m_data(data) {
+#else
+module_template_data::module_template_data( const std::vector<char> & data, std::shared_ptr<log_interface> log, const std::map< std::string, std::string > & ctls ) : m_data(data) {
+#endif
+#ifdef LIBOPENMPT_ANCIENT_COMPILER_SHARED_PTR
+	m_module = LIBOPENMPT_SHARED_PTR<module_impl>( new module_impl( m_data, log, ctls ) );
+#else
+	m_module = std::unique_ptr<module_impl>( new module_impl( m_data, log, ctls ) );
+#endif
+	// Instances borrow the template's samples, so they must be available even with load.defer_samples.
+	m_module->load_deferred_samples();
+}
+module_template_data::~module_template_data() {
+	return;
+}
+
 std::int32_t module_impl::get_render_param( int param ) const {
 	std::int32_t result = 0;
 	switch ( param ) {
@@ -902,6 +1077,9 @@ double module_impl::set_position_seconds( double seconds ) {
 	m_sndFile->m_PlayState.m_nCurrentOrder = t.lastOrder;
 	m_sndFile->SetCurrentOrder( t.lastOrder );
 	m_sndFile->m_PlayState.m_nNextRow = t.lastRow;
+	if ( m_ctl_seek_sync_samples ) {
+		load_deferred_samples();
+	}
 	m_currentPositionSeconds = base_seconds + m_sndFile->GetLength( m_ctl_seek_sync_samples ? eAdjustSamplePositions : eAdjust, GetLengthTarget( t.lastOrder, t.lastRow ).StartPos( static_cast<SEQUENCEINDEX>( subsong->sequence ), static_cast<ORDERINDEX>( subsong->start_order ), static_cast<ROWINDEX>( subsong->start_row ) ) ).back().duration;
 	return m_currentPositionSeconds;
 }
@@ -920,6 +1098,9 @@ double module_impl::set_position_order_row( std::int32_t order, std::int32_t row
 	m_sndFile->m_PlayState.m_nCurrentOrder = static_cast<ORDERINDEX>( order );
 	m_sndFile->SetCurrentOrder( static_cast<ORDERINDEX>( order ) );
 	m_sndFile->m_PlayState.m_nNextRow = static_cast<ROWINDEX>( row );
+	if ( m_ctl_seek_sync_samples ) {
+		load_deferred_samples();
+	}
 	m_currentPositionSeconds = m_sndFile->GetLength( m_ctl_seek_sync_samples ? eAdjustSamplePositions : eAdjust, GetLengthTarget( static_cast<ORDERINDEX>( order ), static_cast<ROWINDEX>( row ) ) ).back().duration;
 	return m_currentPositionSeconds;
 }
@@ -1339,6 +1520,7 @@ std::vector<std::string> module_impl::get_ctls() const {
 	retval.push_back( "load.skip_patterns" );
 	retval.push_back( "load.skip_plugins" );
 	retval.push_back( "load.skip_subsongs_init" );
+	retval.push_back( "load.defer_samples" );
 	retval.push_back( "seek.sync_samples" );
 	retval.push_back( "subsong" );
 	retval.push_back( "play.tempo_factor" );
@@ -1368,6 +1550,8 @@ std::string module_impl::ctl_get( std::string ctl, bool throw_if_unknown ) const
 		return mpt::ToString( m_ctl_load_skip_plugins );
 	} else if ( ctl == "load.skip_subsongs_init" ) {
 		return mpt::ToString( m_ctl_load_skip_subsongs_init );
+	} else if ( ctl == "load.defer_samples" ) {
+		return mpt::ToString( m_ctl_load_defer_samples );
 	} else if ( ctl == "seek.sync_samples" ) {
 		return mpt::ToString( m_ctl_seek_sync_samples );
 	} else if ( ctl == "subsong" ) {
@@ -1414,6 +1598,11 @@ void module_impl::ctl_set( std::string ctl, const std::string & value, bool thro
 		m_ctl_load_skip_plugins = ConvertStrTo<bool>( value );
 	} else if ( ctl == "load.skip_subsongs_init" ) {
 		m_ctl_load_skip_subsongs_init = ConvertStrTo<bool>( value );
+	} else if ( ctl == "load.defer_samples" ) {
+		m_ctl_load_defer_samples = ConvertStrTo<bool>( value );
+		if ( !m_ctl_load_defer_samples ) {
+			load_deferred_samples();
+		}
 	} else if ( ctl == "seek.sync_samples" ) {
 		m_ctl_seek_sync_samples = ConvertStrTo<bool>( value );
 	} else if ( ctl == "subsong" ) {
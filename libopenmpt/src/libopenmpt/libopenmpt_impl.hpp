@@ -62,6 +62,8 @@ public:
 
 class log_forwarder;
 
+class module_template_data;
+
 struct callback_stream_wrapper {
 	void * stream;
 	std::size_t (*read)( void * stream, void * dst, std::size_t bytes );
@@ -70,6 +72,7 @@ struct callback_stream_wrapper {
 }; // struct callback_stream_wrapper
 
 class module_impl {
+	friend class module_template_data;
 protected:
 	struct subsong_data {
 		double duration;
@@ -92,6 +95,19 @@ protected:
 #endif
 	std::int32_t m_current_subsong;
 	double m_currentPositionSeconds;
+	// File data and decoded samples when load.defer_samples is enabled. Declared before m_sndFile so that it outlives it.
+	struct deferred_samples;
+#ifdef LIBOPENMPT_ANCIENT_COMPILER_SHARED_PTR
+	LIBOPENMPT_SHARED_PTR<deferred_samples> m_deferred_samples;
+#else
+	std::unique_ptr<deferred_samples> m_deferred_samples;
+#endif
+	// The template whose sample data this module uses (if any). Declared before m_sndFile so that it outlives it.
+#ifdef LIBOPENMPT_ANCIENT_COMPILER_SHARED_PTR
+	LIBOPENMPT_SHARED_PTR<const module_template_data> m_template;
+#else
+	std::shared_ptr<const module_template_data> m_template;
+#endif
 #ifdef LIBOPENMPT_ANCIENT_COMPILER_SHARED_PTR
 	LIBOPENMPT_SHARED_PTR<OpenMPT::CSoundFile> m_sndFile;
 #else
@@ -109,6 +125,7 @@ protected:
 	bool m_ctl_load_skip_patterns;
 	bool m_ctl_load_skip_plugins;
 	bool m_ctl_load_skip_subsongs_init;
+	bool m_ctl_load_defer_samples;
 	bool m_ctl_seek_sync_samples;
 	std::vector<std::string> m_loaderMessages;
 public:
@@ -124,10 +141,14 @@ protected:
 	void ctor( const std::map< std::string, std::string > & ctls );
 	void load( const OpenMPT::FileReader & file, const std::map< std::string, std::string > & ctls );
 	bool is_loaded() const;
+	void load_deferred_samples();
+	bool prefetch_deferred_samples();
 	std::size_t read_wrapper( std::size_t count, std::int16_t * left, std::int16_t * right, std::int16_t * rear_left, std::int16_t * rear_right );
 	std::size_t read_wrapper( std::size_t count, float * left, float * right, float * rear_left, float * rear_right );
 	std::size_t read_interleaved_wrapper( std::size_t count, std::size_t channels, std::int16_t * interleaved );
 	std::size_t read_interleaved_wrapper( std::size_t count, std::size_t channels, float * interleaved );
+	std::size_t read_stems_wrapper( std::size_t count, std::size_t stems, std::int16_t * const * left, std::int16_t * const * right );
+	std::size_t read_stems_wrapper( std::size_t count, std::size_t stems, float * const * left, float * const * right );
 	std::pair< std::string, std::string > format_and_highlight_pattern_row_channel_command( std::int32_t p, std::int32_t r, std::int32_t c, int command ) const;
 	std::pair< std::string, std::string > format_and_highlight_pattern_row_channel( std::int32_t p, std::int32_t r, std::int32_t c, std::size_t width, bool pad ) const;
 #ifdef LIBOPENMPT_ANCIENT_COMPILER_SHARED_PTR
@@ -182,6 +203,11 @@ public:
 	module_impl( const void * data, std::size_t size, LIBOPENMPT_SHARED_PTR<log_interface> log, const std::map< std::string, std::string > & ctls );
 #else
 	module_impl( const void * data, std::size_t size, std::shared_ptr<log_interface> log, const std::map< std::string, std::string > & ctls );
+#endif
+#ifdef LIBOPENMPT_ANCIENT_COMPILER_SHARED_PTR
+	module_impl( LIBOPENMPT_SHARED_PTR<const module_template_data> tmpl, LIBOPENMPT_SHARED_PTR<log_interface> log, const std::map< std::string, std::string > & ctls );
+#else
+	module_impl( std::shared_ptr<const module_template_data> tmpl, std::shared_ptr<log_interface> log, const std::map< std::string, std::string > & ctls );
 #endif
 	~module_impl();
 public:
@@ -241,6 +267,34 @@ public:
 	void ctl_set( std::string ctl, const std::string & value, bool throw_if_unknown = true );
 }; // class module_impl
 
+// A module that has been loaded once and whose sample data is shared by all modules created from it.
+class module_template_data {
+	friend class module_impl;
+private:
+	std::vector<char> m_data;
+#ifdef LIBOPENMPT_ANCIENT_COMPILER_SHARED_PTR
+	LIBOPENMPT_SHARED_PTR<module_impl> m_module;
+#else
+	std::unique_ptr<module_impl> m_module;
+#endif
+private:
+	// non-copyable
+	module_template_data( const module_template_data & );
+	void operator = ( const module_template_data & );
+public:
+#ifdef LIBOPENMPT_ANCIENT_COMPILER_SHARED_PTR
+	module_template_data( std::istream & stream, LIBOPENMPT_SHARED_PTR<log_interface> log, const std::map< std::string, std::string > & ctls );
+#else
+	module_template_data( std::istream & stream, std::shared_ptr<log_interface> log, const std::map< std::string, std::string > & ctls );
+#endif
+#ifdef LIBOPENMPT_ANCIENT_COMPILER_SHARED_PTR
+	module_template_data( const std::vector<char> & data, LIBOPENMPT_SHARED_PTR<log_interface> log, const std::map< std::string, std::string > & ctls );
+#else
+	module_template_data( const std::vector<char> & data, std::shared_ptr<log_interface> log, const std::map< std::string, std::string > & ctls );
+#endif
+	~module_template_data();
+}; // class module_template_data
+
 } // namespace openmpt
 
 #if defined(_MSC_VER)
@@ -214,11 +214,19 @@ void CSoundFile::CreateStereoMix(int count)
 	// Resetting sound buffer
 	StereoFill(MixSoundBuffer, count, gnDryROfsVol, gnDryLOfsVol);
 	if(m_MixerSettings.gnChannels > 2) InitMixBuffer(MixRearBuffer, count*2);
+	if(m_bMixToStems)
+	{
+		for(uint32 stem = 0; stem < m_nStems; stem++)
+		{
+			StereoFill(GetStemMixBuffer(stem), count, m_StemDryOfsVol[stem * 2], m_StemDryOfsVol[stem * 2 + 1]);
+		}
+	}
 
 	CHANNELINDEX nchmixed = 0;
 
 	const bool ITPingPongMode = m_playBehaviour[kITPingPongMode];
 	const bool realtimeMix = !IsRenderingToDisc();
+	const MixFuncInterface *mixFunctions = MixFuncTable::GetFunctions();
 
 	for(uint32 nChn = 0; nChn < m_nMixChannels; nChn++)
 	{
@@ -252,6 +260,22 @@ void CSoundFile::CreateStereoMix(int count)
 		if(chn.dwFlags[CHN_SURROUND] && m_MixerSettings.gnChannels > 2)
 			pbuffer = MixRearBuffer;
 
+		// Channels that are not part of any stem still have to advance, but are not heard
+		bool silenceChannel = false;
+		if(m_bMixToStems)
+		{
+			const uint32 stem = GetChannelStem(m_PlayState.ChnMix[nChn]);
+			if(stem < m_nStems)
+			{
+				pbuffer = GetStemMixBuffer(stem);
+				pOfsR = &m_StemDryOfsVol[stem * 2];
+				pOfsL = &m_StemDryOfsVol[stem * 2 + 1];
+			} else
+			{
+				silenceChannel = true;
+			}
+		}
+
 		//Look for plugins associated with this implicit tracker channel.
 #ifndef NO_PLUGINS
 		PLUGINDEX nMixPlugin = GetBestPlugin(m_PlayState.ChnMix[nChn], PrioritiseInstrument, RespectMutes);
@@ -311,7 +335,8 @@ void CSoundFile::CreateStereoMix(int count)
 
 			// Should we mix this channel ?
 			if((nchmixed >= m_MixerSettings.m_nMaxMixChannels && realtimeMix)	// Too many channels
-				|| (!chn.nRampLength && !(chn.leftVol | chn.rightVol)))			// Channel is completely silent
+				|| (!chn.nRampLength && !(chn.leftVol | chn.rightVol))			// Channel is completely silent
+				|| silenceChannel)												// Channel is not part of any stem
 			{
 				int32 delta = BufferLengthToSamples(nSmpCount, chn);
 				chn.nPosLo = delta & 0xFFFF;
@@ -356,7 +381,7 @@ void CSoundFile::CreateStereoMix(int count)
 				chn.nLOfs = - *(pbufmax-1);
 
 				uint32 targetpos = chn.nPos + (BufferLengthToSamples(nSmpCount, chn) >> 16);
-				MixFuncTable::Functions[functionNdx | (chn.nRampLength ? MixFuncTable::ndxRamp : 0)](chn, m_Resampler, pbuffer, nSmpCount);
+				mixFunctions[functionNdx | (chn.nRampLength ? MixFuncTable::ndxRamp : 0)](chn, m_Resampler, pbuffer, nSmpCount);
 				MPT_ASSERT(chn.nPos == targetpos); MPT_UNUSED_VARIABLE(targetpos);
 
 				chn.nROfs += *(pbufmax-2);
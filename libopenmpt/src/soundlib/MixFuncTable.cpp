@@ -72,6 +72,42 @@ const MixFuncInterface Functions[5 * 16] =
 #undef BuildMixFuncTable
 
 
+#if defined(MPT_INTMIXER) && defined(MPT_ENABLE_ARCH_INTRINSICS_SSE2)
+
+static MixFuncInterface BestFunctions[5 * 16];
+
+static const MixFuncInterface *InitBestFunctions()
+//------------------------------------------------
+{
+	const uint32 procSupport = GetProcSupport();
+	for(std::size_t i = 0; i < CountOf(Functions); i++)
+	{
+		BestFunctions[i] = Functions[i];
+		if((procSupport & PROCSUPPORT_SSE2) && FunctionsSSE2[i] != nullptr)
+			BestFunctions[i] = FunctionsSSE2[i];
+#if defined(MPT_ENABLE_ARCH_INTRINSICS_AVX2)
+		if((procSupport & PROCSUPPORT_AVX2) && FunctionsAVX2[i] != nullptr)
+			BestFunctions[i] = FunctionsAVX2[i];
+#endif
+	}
+	return BestFunctions;
+}
+
+#endif // MPT_INTMIXER && MPT_ENABLE_ARCH_INTRINSICS_SSE2
+
+
+const MixFuncInterface *GetFunctions()
+//------------------------------------
+{
+#if defined(MPT_INTMIXER) && defined(MPT_ENABLE_ARCH_INTRINSICS_SSE2)
+	static const MixFuncInterface *functions = InitBestFunctions();
+	return functions;
+#else
+	return Functions;
+#endif
+}
+
+
 ResamplingIndex ResamplingModeToMixFlags(ResamplingMode resamplingMode)
 //---------------------------------------------------------------------
 {
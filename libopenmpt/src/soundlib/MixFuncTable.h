@@ -10,6 +10,7 @@
 
 #pragma once
 
+#include "Mixer.h"
 #include "MixerInterface.h"
 
 OPENMPT_NAMESPACE_BEGIN
@@ -43,6 +44,19 @@ namespace MixFuncTable
 
 	extern const MixFuncInterface Functions[5 * 16];
 
+#if defined(MPT_INTMIXER) && defined(MPT_ENABLE_ARCH_INTRINSICS_SSE2)
+	// Vectorized versions of the table above, with identical output.
+	// Entries without a vectorized implementation (no SRC, resonant filter) are nullptr.
+	extern const MixFuncInterface FunctionsSSE2[5 * 16];
+#if defined(MPT_ENABLE_ARCH_INTRINSICS_AVX2)
+	extern const MixFuncInterface FunctionsAVX2[5 * 16];
+#endif
+#endif
+
+	// Table with the fastest implementation of each mix function that is supported by the CPU.
+	// The choice is made on the first call, so InitProcSupport() needs to have been called before.
+	const MixFuncInterface *GetFunctions();
+
 	ResamplingIndex ResamplingModeToMixFlags(ResamplingMode resamplingMode);
 }
 
@@ -0,0 +1,732 @@
+/*
+ * MixFuncTableSIMD.cpp
+ * --------------------
+ * Purpose: SSE2 and AVX2 versions of the most common integer mixer functions.
+ * Notes  : The vectorized kernels compute several output sampling points at once and produce
+ *          exactly the same output as the scalar functions in IntMixer.h: All input samples are
+ *          converted to 16 bits, so the products fit into pmaddwd, and all sums wrap around
+ *          in 32 bits just like in the scalar code.
+ *          Functions are compiled for their instruction set using target attributes, so this file
+ *          needs no special compiler flags. MixFuncTable::GetFunctions() picks them at runtime.
+ * Authors: OpenMPT Devs
+ * The OpenMPT source code is released under the BSD license. Read LICENSE for more details.
+ */
+
+
+#include "stdafx.h"
+
+#include "Mixer.h"
+#include "Snd_defs.h"
+#include "ModChannel.h"
+#include "MixFuncTable.h"
+
+#if defined(MPT_INTMIXER) && defined(MPT_ENABLE_ARCH_INTRINSICS_SSE2)
+#include "IntMixer.h"
+#include <emmintrin.h>
+#if defined(MPT_ENABLE_ARCH_INTRINSICS_AVX2)
+#include <immintrin.h>
+#endif
+#endif
+
+OPENMPT_NAMESPACE_BEGIN
+
+#if defined(MPT_INTMIXER) && defined(MPT_ENABLE_ARCH_INTRINSICS_SSE2)
+
+#if MPT_COMPILER_GCC || MPT_COMPILER_CLANG
+#define MPT_TARGET_SSE2 __attribute__((target("sse2")))
+#define MPT_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define MPT_TARGET_SSE2
+#define MPT_TARGET_AVX2
+#endif
+
+
+//////////////////////////////////////////////////////////////////////////
+// Sample loading helpers (shared by the SSE2 and AVX2 kernels)
+
+// Load count sampling points (count = 2, 4, 8 or 16 channel values) as 16-bit values, like Traits::Convert().
+// The first eight values end up in x0, the next eight in x1.
+template<typename input_t, int count>
+struct LoadInt16SSE2;
+
+template<>
+struct LoadInt16SSE2<int16, 2>
+{
+	MPT_TARGET_SSE2 static forceinline void Load(const int16 *p, __m128i &x0, __m128i &x1)
+	{
+		int32 v;
+		std::memcpy(&v, p, sizeof(v));
+		x0 = _mm_cvtsi32_si128(v);
+		x1 = _mm_setzero_si128();
+	}
+};
+
+template<>
+struct LoadInt16SSE2<int16, 4>
+{
+	MPT_TARGET_SSE2 static forceinline void Load(const int16 *p, __m128i &x0, __m128i &x1)
+	{
+		x0 = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(p));
+		x1 = _mm_setzero_si128();
+	}
+};
+
+template<>
+struct LoadInt16SSE2<int16, 8>
+{
+	MPT_TARGET_SSE2 static forceinline void Load(const int16 *p, __m128i &x0, __m128i &x1)
+	{
+		x0 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+		x1 = _mm_setzero_si128();
+	}
+};
+
+template<>
+struct LoadInt16SSE2<int16, 16>
+{
+	MPT_TARGET_SSE2 static forceinline void Load(const int16 *p, __m128i &x0, __m128i &x1)
+	{
+		x0 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+		x1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + 8));
+	}
+};
+
+template<>
+struct LoadInt16SSE2<int8, 2>
+{
+	MPT_TARGET_SSE2 static forceinline void Load(const int8 *p, __m128i &x0, __m128i &x1)
+	{
+		int16 v;
+		std::memcpy(&v, p, sizeof(v));
+		x0 = _mm_unpacklo_epi8(_mm_setzero_si128(), _mm_cvtsi32_si128(static_cast<uint16>(v)));
+		x1 = _mm_setzero_si128();
+	}
+};
+
+template<>
+struct LoadInt16SSE2<int8, 4>
+{
+	MPT_TARGET_SSE2 static forceinline void Load(const int8 *p, __m128i &x0, __m128i &x1)
+	{
+		int32 v;
+		std::memcpy(&v, p, sizeof(v));
+		x0 = _mm_unpacklo_epi8(_mm_setzero_si128(), _mm_cvtsi32_si128(v));
+		x1 = _mm_setzero_si128();
+	}
+};
+
+template<>
+struct LoadInt16SSE2<int8, 8>
+{
+	MPT_TARGET_SSE2 static forceinline void Load(const int8 *p, __m128i &x0, __m128i &x1)
+	{
+		x0 = _mm_unpacklo_epi8(_mm_setzero_si128(), _mm_loadl_epi64(reinterpret_cast<const __m128i *>(p)));
+		x1 = _mm_setzero_si128();
+	}
+};
+
+template<>
+struct LoadInt16SSE2<int8, 16>
+{
+	MPT_TARGET_SSE2 static forceinline void Load(const int8 *p, __m128i &x0, __m128i &x1)
+	{
+		const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+		x0 = _mm_unpacklo_epi8(_mm_setzero_si128(), x);
+		x1 = _mm_unpackhi_epi8(_mm_setzero_si128(), x);
+	}
+};
+
+
+// L0 R0 L1 R1 L2 R2 L3 R3 => L0 L1 L2 L3 R0 R1 R2 R3
+MPT_TARGET_SSE2 static forceinline __m128i DeinterleaveSSE2(const __m128i x)
+{
+	const __m128i y = _mm_shufflehi_epi16(_mm_shufflelo_epi16(x, _MM_SHUFFLE(3, 1, 2, 0)), _MM_SHUFFLE(3, 1, 2, 0));
+	return _mm_shuffle_epi32(y, _MM_SHUFFLE(3, 1, 2, 0));
+}
+
+
+// Load numTaps consecutive sampling points starting at inBuffer.
+// The 16-bit values of the left (or only) channel end up in the lowest lanes of l, those of the right channel in r.
+template<typename input_t, int numChannels, int numTaps>
+MPT_TARGET_SSE2 static forceinline void LoadTapsSSE2(const input_t * const MPT_RESTRICT inBuffer, __m128i &l, __m128i &r)
+{
+	__m128i x0, x1;
+	LoadInt16SSE2<input_t, numChannels * numTaps>::Load(inBuffer, x0, x1);
+	if(numChannels == 1)
+	{
+		l = r = x0;
+	} else if(numTaps <= 4)
+	{
+		x0 = DeinterleaveSSE2(x0);
+		l = x0;
+		r = _mm_unpackhi_epi64(x0, x0);
+	} else
+	{
+		x0 = DeinterleaveSSE2(x0);
+		x1 = DeinterleaveSSE2(x1);
+		l = _mm_unpacklo_epi64(x0, x1);
+		r = _mm_unpackhi_epi64(x0, x1);
+	}
+}
+
+
+// Concatenate the lowest 32 bits of four vectors
+MPT_TARGET_SSE2 static forceinline __m128i Combine32SSE2(const __m128i *v)
+{
+	return _mm_unpacklo_epi64(_mm_unpacklo_epi32(v[0], v[1]), _mm_unpacklo_epi32(v[2], v[3]));
+}
+
+
+// Transpose the 4x4 matrix formed by m[0] ... m[3]
+MPT_TARGET_SSE2 static forceinline void Transpose4x4SSE2(__m128i *m)
+{
+	const __m128i a = _mm_unpacklo_epi32(m[0], m[1]);
+	const __m128i b = _mm_unpacklo_epi32(m[2], m[3]);
+	const __m128i c = _mm_unpackhi_epi32(m[0], m[1]);
+	const __m128i d = _mm_unpackhi_epi32(m[2], m[3]);
+	m[0] = _mm_unpacklo_epi64(a, b);
+	m[1] = _mm_unpackhi_epi64(a, b);
+	m[2] = _mm_unpacklo_epi64(c, d);
+	m[3] = _mm_unpackhi_epi64(c, d);
+}
+
+
+// Lower 32 bits of the product of each 32-bit lane (SSE2 has no pmulld)
+MPT_TARGET_SSE2 static forceinline __m128i MulLo32SSE2(const __m128i a, const __m128i b)
+{
+	const __m128i even = _mm_mul_epu32(a, b);
+	const __m128i odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+	return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)), _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+}
+
+
+//////////////////////////////////////////////////////////////////////////
+// SSE2 interpolation templates
+// The functors compute four consecutive output sampling points per channel and advance smpPos accordingly.
+// For mono samples, outR is identical to outL.
+
+template<class Traits>
+struct LinearInterpolationSSE2
+{
+	typedef LinearInterpolation<Traits> scalar_t;
+
+	forceinline void Start(const ModChannel &, const CResampler &) { }
+
+	MPT_TARGET_SSE2 forceinline void operator() (__m128i &outL, __m128i &outR, const typename Traits::input_t * const MPT_RESTRICT inBuffer, int32 &smpPos, const int32 inc)
+	{
+		const __m128i c = Coefficients(_mm_add_epi32(_mm_set1_epi32(smpPos), _mm_set_epi32(3 * inc, 2 * inc, inc, 0)));
+		__m128i l[4], r[4];
+		for(int i = 0; i < 4; i++)
+		{
+			LoadTapsSSE2<typename Traits::input_t, Traits::numChannelsIn, 2>(inBuffer + (smpPos >> 16) * Traits::numChannelsIn, l[i], r[i]);
+			smpPos += inc;
+		}
+		outL = Interpolate(Combine32SSE2(l), c);
+		outR = (Traits::numChannelsIn == 1) ? outL : Interpolate(Combine32SSE2(r), c);
+	}
+
+	// Coefficients to be multiplied with (srcVol, destVol) pairs: (-fract, fract)
+	MPT_TARGET_SSE2 static forceinline __m128i Coefficients(const __m128i smpPos)
+	{
+		const __m128i fract = _mm_and_si128(_mm_srli_epi32(smpPos, 8), _mm_set1_epi32(0xFF));
+		return _mm_or_si128(_mm_slli_epi32(fract, 16), _mm_and_si128(_mm_sub_epi32(_mm_setzero_si128(), fract), _mm_set1_epi32(0xFFFF)));
+	}
+
+	// srcVol + ((fract * (destVol - srcVol)) >> 8)
+	MPT_TARGET_SSE2 static forceinline __m128i Interpolate(const __m128i taps, const __m128i coeffs)
+	{
+		const __m128i srcVol = _mm_srai_epi32(_mm_slli_epi32(taps, 16), 16);
+		return _mm_add_epi32(srcVol, _mm_srai_epi32(_mm_madd_epi16(taps, coeffs), 8));
+	}
+};
+
+
+template<class Traits>
+struct FastSincInterpolationSSE2
+{
+	typedef FastSincInterpolation<Traits> scalar_t;
+
+	forceinline void Start(const ModChannel &, const CResampler &) { }
+
+	MPT_TARGET_SSE2 forceinline void operator() (__m128i &outL, __m128i &outR, const typename Traits::input_t * const MPT_RESTRICT inBuffer, int32 &smpPos, const int32 inc)
+	{
+		__m128i l[4], r[4], coeffs[4];
+		for(int i = 0; i < 4; i++)
+		{
+			LoadTapsSSE2<typename Traits::input_t, Traits::numChannelsIn, 4>(inBuffer + ((smpPos >> 16) - 1) * Traits::numChannelsIn, l[i], r[i]);
+			coeffs[i] = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(CResampler::FastSincTable + (((smpPos & 0xFFFF) >> 6) & 0x3FC)));
+			smpPos += inc;
+		}
+		outL = Interpolate(l, coeffs);
+		outR = (Traits::numChannelsIn == 1) ? outL : Interpolate(r, coeffs);
+	}
+
+	MPT_TARGET_SSE2 static forceinline __m128i Interpolate(const __m128i *taps, const __m128i *coeffs)
+	{
+		// Two sampling points per multiplication
+		const __m128i a = _mm_madd_epi16(_mm_unpacklo_epi64(taps[0], taps[1]), _mm_unpacklo_epi64(coeffs[0], coeffs[1]));
+		const __m128i b = _mm_madd_epi16(_mm_unpacklo_epi64(taps[2], taps[3]), _mm_unpacklo_epi64(coeffs[2], coeffs[3]));
+		const __m128i even = _mm_castps_si128(_mm_shuffle_ps(_mm_castsi128_ps(a), _mm_castsi128_ps(b), _MM_SHUFFLE(2, 0, 2, 0)));
+		const __m128i odd = _mm_castps_si128(_mm_shuffle_ps(_mm_castsi128_ps(a), _mm_castsi128_ps(b), _MM_SHUFFLE(3, 1, 3, 1)));
+		return _mm_srai_epi32(_mm_add_epi32(even, odd), 14);
+	}
+};
+
+
+// 8-tap interpolation, common to the polyphase and FIR filters
+// Returns the transposed partial sums: sums[k] contains taps 2k and 2k+1 of all four sampling points.
+template<class Traits, class InterpolationFunc>
+MPT_TARGET_SSE2 static forceinline void Interpolate8TapsSSE2(__m128i *sumsL, __m128i *sumsR, const typename Traits::input_t * const MPT_RESTRICT inBuffer, int32 &smpPos, const int32 inc, const InterpolationFunc &interpolate)
+{
+	for(int i = 0; i < 4; i++)
+	{
+		__m128i l, r;
+		LoadTapsSSE2<typename Traits::input_t, Traits::numChannelsIn, 8>(inBuffer + ((smpPos >> 16) - 3) * Traits::numChannelsIn, l, r);
+		const __m128i coeffs = _mm_loadu_si128(reinterpret_cast<const __m128i *>(interpolate.GetLut(smpPos & 0xFFFF)));
+		sumsL[i] = _mm_madd_epi16(l, coeffs);
+		if(Traits::numChannelsIn > 1)
+			sumsR[i] = _mm_madd_epi16(r, coeffs);
+		smpPos += inc;
+	}
+	Transpose4x4SSE2(sumsL);
+	if(Traits::numChannelsIn > 1)
+		Transpose4x4SSE2(sumsR);
+}
+
+
+template<class Traits>
+struct PolyphaseInterpolationSSE2 : public PolyphaseInterpolation<Traits>
+{
+	typedef PolyphaseInterpolation<Traits> scalar_t;
+
+	forceinline const SINC_TYPE *GetLut(const int32 posLo) const
+	{
+		return this->sinc + ((posLo >> (16 - SINC_PHASES_BITS)) & SINC_MASK) * SINC_WIDTH;
+	}
+
+	MPT_TARGET_SSE2 forceinline void operator() (__m128i &outL, __m128i &outR, const typename Traits::input_t * const MPT_RESTRICT inBuffer, int32 &smpPos, const int32 inc)
+	{
+		__m128i sumsL[4], sumsR[4];
+		Interpolate8TapsSSE2<Traits>(sumsL, sumsR, inBuffer, smpPos, inc, *this);
+		outL = Finish(sumsL);
+		outR = (Traits::numChannelsIn == 1) ? outL : Finish(sumsR);
+	}
+
+	MPT_TARGET_SSE2 static forceinline __m128i Finish(const __m128i *sums)
+	{
+		const __m128i sum = _mm_add_epi32(_mm_add_epi32(sums[0], sums[1]), _mm_add_epi32(sums[2], sums[3]));
+		return _mm_srai_epi32(sum, SINC_QUANTSHIFT);
+	}
+};
+
+
+template<class Traits>
+struct FIRFilterInterpolationSSE2 : public FIRFilterInterpolation<Traits>
+{
+	typedef FIRFilterInterpolation<Traits> scalar_t;
+
+	forceinline const int16 *GetLut(const int32 posLo) const
+	{
+		return this->WFIRlut + (((posLo + WFIR_FRACHALVE) >> WFIR_FRACSHIFT) & WFIR_FRACMASK);
+	}
+
+	MPT_TARGET_SSE2 forceinline void operator() (__m128i &outL, __m128i &outR, const typename Traits::input_t * const MPT_RESTRICT inBuffer, int32 &smpPos, const int32 inc)
+	{
+		__m128i sumsL[4], sumsR[4];
+		Interpolate8TapsSSE2<Traits>(sumsL, sumsR, inBuffer, smpPos, inc, *this);
+		outL = Finish(sumsL);
+		outR = (Traits::numChannelsIn == 1) ? outL : Finish(sumsR);
+	}
+
+	// ((vol1 >> 1) + (vol2 >> 1)) >> (WFIR_16BITSHIFT - 1)
+	MPT_TARGET_SSE2 static forceinline __m128i Finish(const __m128i *sums)
+	{
+		const __m128i vol1 = _mm_add_epi32(sums[0], sums[1]);
+		const __m128i vol2 = _mm_add_epi32(sums[2], sums[3]);
+		return _mm_srai_epi32(_mm_add_epi32(_mm_srai_epi32(vol1, 1), _mm_srai_epi32(vol2, 1)), WFIR_16BITSHIFT - 1);
+	}
+};
+
+
+//////////////////////////////////////////////////////////////////////////
+// SSE2 mixing templates (add four stereo sampling points to the mix)
+
+// Add four sampling points per channel to an interleaved stereo buffer
+MPT_TARGET_SSE2 static forceinline void MixStereoSSE2(const __m128i l, const __m128i r, mixsample_t * const MPT_RESTRICT outBuffer)
+{
+	__m128i * const out = reinterpret_cast<__m128i *>(outBuffer);
+	_mm_storeu_si128(out + 0, _mm_add_epi32(_mm_loadu_si128(out + 0), _mm_unpacklo_epi32(l, r)));
+	_mm_storeu_si128(out + 1, _mm_add_epi32(_mm_loadu_si128(out + 1), _mm_unpackhi_epi32(l, r)));
+}
+
+
+// ScalarMix is the matching mixing functor from IntMixer.h, MixMonoNoRamp or MixStereoNoRamp
+template<class ScalarMix>
+struct MixNoRampSSE2 : public ScalarMix
+{
+	typedef ScalarMix scalar_t;
+
+	MPT_TARGET_SSE2 forceinline void operator() (const __m128i l, const __m128i r, const ModChannel &, mixsample_t * const MPT_RESTRICT outBuffer)
+	{
+		MixStereoSSE2(MulLo32SSE2(l, _mm_set1_epi32(this->lVol)), MulLo32SSE2(r, _mm_set1_epi32(this->rVol)), outBuffer);
+	}
+};
+
+
+// ScalarMix is the matching mixing functor from IntMixer.h, MixMonoRamp or MixStereoRamp
+template<class ScalarMix>
+struct MixRampSSE2 : public ScalarMix
+{
+	typedef ScalarMix scalar_t;
+
+	MPT_TARGET_SSE2 forceinline void operator() (const __m128i l, const __m128i r, const ModChannel &chn, mixsample_t * const MPT_RESTRICT outBuffer)
+	{
+		// The ramp is advanced before each sampling point
+		const __m128i steps = _mm_set_epi32(4, 3, 2, 1);
+		const __m128i lRampVol = _mm_add_epi32(_mm_set1_epi32(this->lRamp), MulLo32SSE2(steps, _mm_set1_epi32(chn.leftRamp)));
+		const __m128i rRampVol = _mm_add_epi32(_mm_set1_epi32(this->rRamp), MulLo32SSE2(steps, _mm_set1_epi32(chn.rightRamp)));
+		this->lRamp += 4 * chn.leftRamp;
+		this->rRamp += 4 * chn.rightRamp;
+		MixStereoSSE2(MulLo32SSE2(l, _mm_srai_epi32(lRampVol, VOLUMERAMPPRECISION)), MulLo32SSE2(r, _mm_srai_epi32(rRampVol, VOLUMERAMPPRECISION)), outBuffer);
+	}
+};
+
+
+//////////////////////////////////////////////////////////////////////////
+// SSE2 sample render loop, equivalent to SampleLoop without filter
+
+template<class Traits, class InterpolationFunc, class MixFunc>
+MPT_TARGET_SSE2 static void SampleLoopSSE2(ModChannel &chn, const CResampler &resampler, mixsample_t * MPT_RESTRICT outBuffer, int numSamples)
+{
+	ModChannel &c = chn;
+	const typename Traits::input_t * MPT_RESTRICT inSample = static_cast<const typename Traits::input_t *>(c.pCurrentSample) + c.nPos * Traits::numChannelsIn;
+
+	int32 smpPos = c.nPosLo;	// 16.16 sample position relative to c.nPos
+	const int32 inc = c.nInc;
+
+	InterpolationFunc interpolate;
+	MixFunc mix;
+
+	interpolate.Start(c, resampler);
+	mix.Start(c);
+
+	for(int blocks = numSamples / 4; blocks > 0; blocks--)
+	{
+		__m128i outL, outR;
+		interpolate(outL, outR, inSample, smpPos, inc);
+		mix(outL, outR, c, outBuffer);
+		outBuffer += 4 * Traits::numChannelsOut;
+	}
+
+	mix.End(c);
+
+	c.nPos += smpPos >> 16;
+	c.nPosLo = smpPos & 0xFFFF;
+
+	// Remaining sampling points are rendered by the scalar code
+	if(numSamples % 4)
+	{
+		SampleLoop<Traits, typename InterpolationFunc::scalar_t, NoFilter<Traits>, typename MixFunc::scalar_t>(c, resampler, outBuffer, numSamples % 4);
+	}
+}
+
+
+#if defined(MPT_ENABLE_ARCH_INTRINSICS_AVX2)
+
+//////////////////////////////////////////////////////////////////////////
+// AVX2 versions, computing eight output sampling points at once.
+// Sample data is still gathered with the SSE2 helpers above, two sampling points are processed per 256-bit register.
+
+MPT_TARGET_AVX2 static forceinline __m256i Combine128AVX2(const __m128i lo, const __m128i hi)
+{
+	return _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1);
+}
+
+
+// In-lane transpose of the two 4x4 matrices formed by m[0] ... m[3]
+MPT_TARGET_AVX2 static forceinline void Transpose4x4AVX2(__m256i *m)
+{
+	const __m256i a = _mm256_unpacklo_epi32(m[0], m[1]);
+	const __m256i b = _mm256_unpacklo_epi32(m[2], m[3]);
+	const __m256i c = _mm256_unpackhi_epi32(m[0], m[1]);
+	const __m256i d = _mm256_unpackhi_epi32(m[2], m[3]);
+	m[0] = _mm256_unpacklo_epi64(a, b);
+	m[1] = _mm256_unpackhi_epi64(a, b);
+	m[2] = _mm256_unpacklo_epi64(c, d);
+	m[3] = _mm256_unpackhi_epi64(c, d);
+}
+
+
+template<class Traits>
+struct LinearInterpolationAVX2
+{
+	typedef LinearInterpolation<Traits> scalar_t;
+
+	forceinline void Start(const ModChannel &, const CResampler &) { }
+
+	MPT_TARGET_AVX2 forceinline void operator() (__m256i &outL, __m256i &outR, const typename Traits::input_t * const MPT_RESTRICT inBuffer, int32 &smpPos, const int32 inc)
+	{
+		const __m256i c = Coefficients(_mm256_add_epi32(_mm256_set1_epi32(smpPos), _mm256_set_epi32(7 * inc, 6 * inc, 5 * inc, 4 * inc, 3 * inc, 2 * inc, inc, 0)));
+		__m128i l[8], r[8];
+		for(int i = 0; i < 8; i++)
+		{
+			LoadTapsSSE2<typename Traits::input_t, Traits::numChannelsIn, 2>(inBuffer + (smpPos >> 16) * Traits::numChannelsIn, l[i], r[i]);
+			smpPos += inc;
+		}
+		outL = Interpolate(Combine128AVX2(Combine32SSE2(l), Combine32SSE2(l + 4)), c);
+		outR = (Traits::numChannelsIn == 1) ? outL : Interpolate(Combine128AVX2(Combine32SSE2(r), Combine32SSE2(r + 4)), c);
+	}
+
+	MPT_TARGET_AVX2 static forceinline __m256i Coefficients(const __m256i smpPos)
+	{
+		const __m256i fract = _mm256_and_si256(_mm256_srli_epi32(smpPos, 8), _mm256_set1_epi32(0xFF));
+		return _mm256_or_si256(_mm256_slli_epi32(fract, 16), _mm256_and_si256(_mm256_sub_epi32(_mm256_setzero_si256(), fract), _mm256_set1_epi32(0xFFFF)));
+	}
+
+	MPT_TARGET_AVX2 static forceinline __m256i Interpolate(const __m256i taps, const __m256i coeffs)
+	{
+		const __m256i srcVol = _mm256_srai_epi32(_mm256_slli_epi32(taps, 16), 16);
+		return _mm256_add_epi32(srcVol, _mm256_srai_epi32(_mm256_madd_epi16(taps, coeffs), 8));
+	}
+};
+
+
+template<class Traits>
+struct FastSincInterpolationAVX2
+{
+	typedef FastSincInterpolation<Traits> scalar_t;
+
+	forceinline void Start(const ModChannel &, const CResampler &) { }
+
+	MPT_TARGET_AVX2 forceinline void operator() (__m256i &outL, __m256i &outR, const typename Traits::input_t * const MPT_RESTRICT inBuffer, int32 &smpPos, const int32 inc)
+	{
+		__m128i l[8], r[8], coeffs[8];
+		for(int i = 0; i < 8; i++)
+		{
+			LoadTapsSSE2<typename Traits::input_t, Traits::numChannelsIn, 4>(inBuffer + ((smpPos >> 16) - 1) * Traits::numChannelsIn, l[i], r[i]);
+			coeffs[i] = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(CResampler::FastSincTable + (((smpPos & 0xFFFF) >> 6) & 0x3FC)));
+			smpPos += inc;
+		}
+		outL = Interpolate(l, coeffs);
+		outR = (Traits::numChannelsIn == 1) ? outL : Interpolate(r, coeffs);
+	}
+
+	// Register a holds sampling points 0, 1 | 4, 5, register b holds 2, 3 | 6, 7
+	MPT_TARGET_AVX2 static forceinline __m256i Interpolate(const __m128i *taps, const __m128i *coeffs)
+	{
+		const __m256i a = _mm256_madd_epi16(
+			Combine128AVX2(_mm_unpacklo_epi64(taps[0], taps[1]), _mm_unpacklo_epi64(taps[4], taps[5])),
+			Combine128AVX2(_mm_unpacklo_epi64(coeffs[0], coeffs[1]), _mm_unpacklo_epi64(coeffs[4], coeffs[5])));
+		const __m256i b = _mm256_madd_epi16(
+			Combine128AVX2(_mm_unpacklo_epi64(taps[2], taps[3]), _mm_unpacklo_epi64(taps[6], taps[7])),
+			Combine128AVX2(_mm_unpacklo_epi64(coeffs[2], coeffs[3]), _mm_unpacklo_epi64(coeffs[6], coeffs[7])));
+		const __m256i even = _mm256_castps_si256(_mm256_shuffle_ps(_mm256_castsi256_ps(a), _mm256_castsi256_ps(b), _MM_SHUFFLE(2, 0, 2, 0)));
+		const __m256i odd = _mm256_castps_si256(_mm256_shuffle_ps(_mm256_castsi256_ps(a), _mm256_castsi256_ps(b), _MM_SHUFFLE(3, 1, 3, 1)));
+		return _mm256_srai_epi32(_mm256_add_epi32(even, odd), 14);
+	}
+};
+
+
+// Register i holds sampling points i | i + 4, so that the in-lane transpose yields them in order
+template<class Traits, class InterpolationFunc>
+MPT_TARGET_AVX2 static forceinline void Interpolate8TapsAVX2(__m256i *sumsL, __m256i *sumsR, const typename Traits::input_t * const MPT_RESTRICT inBuffer, int32 &smpPos, const int32 inc, const InterpolationFunc &interpolate)
+{
+	__m128i l[8], r[8], coeffs[8];
+	for(int i = 0; i < 8; i++)
+	{
+		LoadTapsSSE2<typename Traits::input_t, Traits::numChannelsIn, 8>(inBuffer + ((smpPos >> 16) - 3) * Traits::numChannelsIn, l[i], r[i]);
+		coeffs[i] = _mm_loadu_si128(reinterpret_cast<const __m128i *>(interpolate.GetLut(smpPos & 0xFFFF)));
+		smpPos += inc;
+	}
+	for(int i = 0; i < 4; i++)
+	{
+		const __m256i c = Combine128AVX2(coeffs[i], coeffs[i + 4]);
+		sumsL[i] = _mm256_madd_epi16(Combine128AVX2(l[i], l[i + 4]), c);
+		if(Traits::numChannelsIn > 1)
+			sumsR[i] = _mm256_madd_epi16(Combine128AVX2(r[i], r[i + 4]), c);
+	}
+	Transpose4x4AVX2(sumsL);
+	if(Traits::numChannelsIn > 1)
+		Transpose4x4AVX2(sumsR);
+}
+
+
+template<class Traits>
+struct PolyphaseInterpolationAVX2 : public PolyphaseInterpolationSSE2<Traits>
+{
+	MPT_TARGET_AVX2 forceinline void operator() (__m256i &outL, __m256i &outR, const typename Traits::input_t * const MPT_RESTRICT inBuffer, int32 &smpPos, const int32 inc)
+	{
+		__m256i sumsL[4], sumsR[4];
+		Interpolate8TapsAVX2<Traits>(sumsL, sumsR, inBuffer, smpPos, inc, *this);
+		outL = Finish(sumsL);
+		outR = (Traits::numChannelsIn == 1) ? outL : Finish(sumsR);
+	}
+
+	MPT_TARGET_AVX2 static forceinline __m256i Finish(const __m256i *sums)
+	{
+		const __m256i sum = _mm256_add_epi32(_mm256_add_epi32(sums[0], sums[1]), _mm256_add_epi32(sums[2], sums[3]));
+		return _mm256_srai_epi32(sum, SINC_QUANTSHIFT);
+	}
+};
+
+
+template<class Traits>
+struct FIRFilterInterpolationAVX2 : public FIRFilterInterpolationSSE2<Traits>
+{
+	MPT_TARGET_AVX2 forceinline void operator() (__m256i &outL, __m256i &outR, const typename Traits::input_t * const MPT_RESTRICT inBuffer, int32 &smpPos, const int32 inc)
+	{
+		__m256i sumsL[4], sumsR[4];
+		Interpolate8TapsAVX2<Traits>(sumsL, sumsR, inBuffer, smpPos, inc, *this);
+		outL = Finish(sumsL);
+		outR = (Traits::numChannelsIn == 1) ? outL : Finish(sumsR);
+	}
+
+	MPT_TARGET_AVX2 static forceinline __m256i Finish(const __m256i *sums)
+	{
+		const __m256i vol1 = _mm256_add_epi32(sums[0], sums[1]);
+		const __m256i vol2 = _mm256_add_epi32(sums[2], sums[3]);
+		return _mm256_srai_epi32(_mm256_add_epi32(_mm256_srai_epi32(vol1, 1), _mm256_srai_epi32(vol2, 1)), WFIR_16BITSHIFT - 1);
+	}
+};
+
+
+// Add eight sampling points per channel to an interleaved stereo buffer
+MPT_TARGET_AVX2 static forceinline void MixStereoAVX2(const __m256i l, const __m256i r, mixsample_t * const MPT_RESTRICT outBuffer)
+{
+	__m256i * const out = reinterpret_cast<__m256i *>(outBuffer);
+	const __m256i lo = _mm256_unpacklo_epi32(l, r);	// 0, 1 | 4, 5
+	const __m256i hi = _mm256_unpackhi_epi32(l, r);	// 2, 3 | 6, 7
+	_mm256_storeu_si256(out + 0, _mm256_add_epi32(_mm256_loadu_si256(out + 0), _mm256_permute2x128_si256(lo, hi, 0x20)));
+	_mm256_storeu_si256(out + 1, _mm256_add_epi32(_mm256_loadu_si256(out + 1), _mm256_permute2x128_si256(lo, hi, 0x31)));
+}
+
+
+template<class ScalarMix>
+struct MixNoRampAVX2 : public ScalarMix
+{
+	typedef ScalarMix scalar_t;
+
+	MPT_TARGET_AVX2 forceinline void operator() (const __m256i l, const __m256i r, const ModChannel &, mixsample_t * const MPT_RESTRICT outBuffer)
+	{
+		MixStereoAVX2(_mm256_mullo_epi32(l, _mm256_set1_epi32(this->lVol)), _mm256_mullo_epi32(r, _mm256_set1_epi32(this->rVol)), outBuffer);
+	}
+};
+
+
+template<class ScalarMix>
+struct MixRampAVX2 : public ScalarMix
+{
+	typedef ScalarMix scalar_t;
+
+	MPT_TARGET_AVX2 forceinline void operator() (const __m256i l, const __m256i r, const ModChannel &chn, mixsample_t * const MPT_RESTRICT outBuffer)
+	{
+		const __m256i steps = _mm256_set_epi32(8, 7, 6, 5, 4, 3, 2, 1);
+		const __m256i lRampVol = _mm256_add_epi32(_mm256_set1_epi32(this->lRamp), _mm256_mullo_epi32(steps, _mm256_set1_epi32(chn.leftRamp)));
+		const __m256i rRampVol = _mm256_add_epi32(_mm256_set1_epi32(this->rRamp), _mm256_mullo_epi32(steps, _mm256_set1_epi32(chn.rightRamp)));
+		this->lRamp += 8 * chn.leftRamp;
+		this->rRamp += 8 * chn.rightRamp;
+		MixStereoAVX2(_mm256_mullo_epi32(l, _mm256_srai_epi32(lRampVol, VOLUMERAMPPRECISION)), _mm256_mullo_epi32(r, _mm256_srai_epi32(rRampVol, VOLUMERAMPPRECISION)), outBuffer);
+	}
+};
+
+
+template<class Traits, class InterpolationFunc, class MixFunc>
+MPT_TARGET_AVX2 static void SampleLoopAVX2(ModChannel &chn, const CResampler &resampler, mixsample_t * MPT_RESTRICT outBuffer, int numSamples)
+{
+	ModChannel &c = chn;
+	const typename Traits::input_t * MPT_RESTRICT inSample = static_cast<const typename Traits::input_t *>(c.pCurrentSample) + c.nPos * Traits::numChannelsIn;
+
+	int32 smpPos = c.nPosLo;	// 16.16 sample position relative to c.nPos
+	const int32 inc = c.nInc;
+
+	InterpolationFunc interpolate;
+	MixFunc mix;
+
+	interpolate.Start(c, resampler);
+	mix.Start(c);
+
+	for(int blocks = numSamples / 8; blocks > 0; blocks--)
+	{
+		__m256i outL, outR;
+		interpolate(outL, outR, inSample, smpPos, inc);
+		mix(outL, outR, c, outBuffer);
+		outBuffer += 8 * Traits::numChannelsOut;
+	}
+
+	mix.End(c);
+
+	c.nPos += smpPos >> 16;
+	c.nPosLo = smpPos & 0xFFFF;
+
+	// Remaining sampling points are rendered by the scalar code
+	if(numSamples % 8)
+	{
+		SampleLoop<Traits, typename InterpolationFunc::scalar_t, NoFilter<Traits>, typename MixFunc::scalar_t>(c, resampler, outBuffer, numSamples % 8);
+	}
+}
+
+#endif // MPT_ENABLE_ARCH_INTRINSICS_AVX2
+
+
+namespace MixFuncTable
+{
+	typedef Int8MToIntS I8M;
+	typedef Int16MToIntS I16M;
+	typedef Int8SToIntS I8S;
+	typedef Int16SToIntS I16S;
+
+// Build mix function table for given instruction set, resampling and ramping settings: One function each for 8-Bit / 16-Bit Mono / Stereo
+#define BuildMixFuncTableRamp(isa, resampling, ramp) \
+	SampleLoop ## isa<I8M, resampling ## isa<I8M>, Mix ## ramp ## isa<MixMono ## ramp<I8M> > >, \
+	SampleLoop ## isa<I16M, resampling ## isa<I16M>, Mix ## ramp ## isa<MixMono ## ramp<I16M> > >, \
+	SampleLoop ## isa<I8S, resampling ## isa<I8S>, Mix ## ramp ## isa<MixStereo ## ramp<I8S> > >, \
+	SampleLoop ## isa<I16S, resampling ## isa<I16S>, Mix ## ramp ## isa<MixStereo ## ramp<I16S> > >
+
+// Build mix function table for given instruction set and resampling settings. The resonant filter is not vectorized.
+#define BuildMixFuncTable(isa, resampling) \
+	BuildMixFuncTableRamp(isa, resampling, NoRamp), \
+	BuildMixFuncTableRamp(isa, resampling, Ramp), \
+	NoMixFuncTable
+
+// Eight entries without vectorized implementation
+#define NoMixFuncTable \
+	nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr
+
+const MixFuncInterface FunctionsSSE2[5 * 16] =
+{
+	NoMixFuncTable, NoMixFuncTable,				// No SRC
+	BuildMixFuncTable(SSE2, LinearInterpolation),		// Linear SRC
+	BuildMixFuncTable(SSE2, FastSincInterpolation),	// Fast Sinc (Cubic Spline) SRC
+	BuildMixFuncTable(SSE2, PolyphaseInterpolation),	// Kaiser SRC
+	BuildMixFuncTable(SSE2, FIRFilterInterpolation),	// FIR SRC
+};
+
+#if defined(MPT_ENABLE_ARCH_INTRINSICS_AVX2)
+
+const MixFuncInterface FunctionsAVX2[5 * 16] =
+{
+	NoMixFuncTable, NoMixFuncTable,				// No SRC
+	BuildMixFuncTable(AVX2, LinearInterpolation),		// Linear SRC
+	BuildMixFuncTable(AVX2, FastSincInterpolation),	// Fast Sinc (Cubic Spline) SRC
+	BuildMixFuncTable(AVX2, PolyphaseInterpolation),	// Kaiser SRC
+	BuildMixFuncTable(AVX2, FIRFilterInterpolation),	// FIR SRC
+};
+
+#endif // MPT_ENABLE_ARCH_INTRINSICS_AVX2
+
+#undef BuildMixFuncTableRamp
+#undef BuildMixFuncTable
+#undef NoMixFuncTable
+
+} // namespace MixFuncTable
+
+#undef MPT_TARGET_SSE2
+#undef MPT_TARGET_AVX2
+
+#else // !(MPT_INTMIXER && MPT_ENABLE_ARCH_INTRINSICS_SSE2)
+
+MPT_MSVC_WORKAROUND_LNK4221(MixFuncTableSIMD)
+
+#endif // MPT_INTMIXER && MPT_ENABLE_ARCH_INTRINSICS_SSE2
+
+OPENMPT_NAMESPACE_END
@@ -47,6 +47,10 @@ static uint32 GetFineLinearSlideUpTable  (const CSoundFile *sndFile, uint32 i) {
 // Length
 
 
+#ifndef MODPLUG_TRACKER
+struct GetLengthCheckpoint;
+#endif // MODPLUG_TRACKER
+
 // Memory class for GetLength() code
 class GetLengthMemory
 {
@@ -79,6 +83,7 @@ public:
 #endif
 	std::vector<ChnSettings> chnSettings;
 	double elapsedTime;
+	bool tempoMemoryUsed;	// T00 was encountered, which is only recalled in eAdjust mode, so from here on the timing depends on the adjust mode
 	static const uint32 IGNORE_CHANNEL = uint32_max;
 
 	GetLengthMemory(const CSoundFile &sf)
@@ -93,6 +98,7 @@ public:
 	{
 		plugParams.clear();
 		elapsedTime = 0.0;
+		tempoMemoryUsed = false;
 		state.m_lTotalSampleCount = 0;
 		state.m_nMusicSpeed = sndFile.m_nDefaultSpeed;
 		state.m_nMusicTempo = sndFile.m_nDefaultTempo;
@@ -103,6 +109,7 @@ public:
 			state.Chn[chn].Reset(ModChannel::resetTotal, sndFile, chn);
 			state.Chn[chn].nOldGlobalVolSlide = 0;
 			state.Chn[chn].nOldChnVolSlide = 0;
+			state.Chn[chn].nOldTempo = 0;
 			state.Chn[chn].nNote = state.Chn[chn].nNewNote = state.Chn[chn].nLastNote = NOTE_NONE;
 		}
 	}
@@ -211,8 +218,144 @@ public:
 		}
 		chnSettings[channel].ticksToRender = 0;
 	}
+
+#ifndef MODPLUG_TRACKER
+	void SaveCheckpoint(GetLengthCheckpoint &checkpoint) const;
+	void RestoreCheckpoint(const GetLengthCheckpoint &checkpoint);
+#endif // MODPLUG_TRACKER
+};
+
+
+#ifndef MODPLUG_TRACKER
+
+// State of GetLength() at the start of a row, from which a later seek with the same start position can resume.
+struct GetLengthCheckpoint
+{
+	RowVisitor visitedRows;
+	// Only the parts of the play state that are modified by GetLength() are stored,
+	// everything else is taken from the current play state, just like when starting from the beginning.
+	std::vector<ModChannel> chn;
+	std::vector<GetLengthMemory::ChnSettings> chnSettings;
+#ifndef NO_PLUGINS
+	GetLengthMemory::PlugParamMap plugParams;
+#endif // NO_PLUGINS
+	double elapsedTime;
+	double bufferDiff;
+	CSoundFile::samplecount_t totalSampleCount;
+	TEMPO::store_t musicTempo;	// Raw value, TEMPO has no copy assignment
+	uint32 musicSpeed;
+	int32 globalVolume;
+	ROWINDEX row, nextRow, nextPatStartRow, rowsPerBeat;
+	PATTERNINDEX pattern;
+	ORDERINDEX currentOrder, nextOrder;
+	ROWINDEX endRow;
+	ORDERINDEX endOrder;
+	bool adjustTiming;		// Recorded in eAdjust mode
+	bool tempoMemoryUsed;	// If set, only runs with the same adjust mode may resume from here
+
+	GetLengthCheckpoint(const RowVisitor &visited) : visitedRows(visited) { }
+};
+
+
+void GetLengthMemory::SaveCheckpoint(GetLengthCheckpoint &checkpoint) const
+//-------------------------------------------------------------------------
+{
+	checkpoint.chn.assign(state.Chn, state.Chn + sndFile.GetNumChannels());
+	checkpoint.chnSettings = chnSettings;
+#ifndef NO_PLUGINS
+	checkpoint.plugParams = plugParams;
+#endif // NO_PLUGINS
+	checkpoint.elapsedTime = elapsedTime;
+	checkpoint.bufferDiff = state.m_dBufferDiff;
+	checkpoint.totalSampleCount = state.m_lTotalSampleCount;
+	checkpoint.musicTempo = state.m_nMusicTempo.GetRaw();
+	checkpoint.musicSpeed = state.m_nMusicSpeed;
+	checkpoint.globalVolume = state.m_nGlobalVolume;
+	checkpoint.row = state.m_nRow;
+	checkpoint.nextRow = state.m_nNextRow;
+	checkpoint.nextPatStartRow = state.m_nNextPatStartRow;
+	checkpoint.rowsPerBeat = state.m_nCurrentRowsPerBeat;
+	checkpoint.pattern = state.m_nPattern;
+	checkpoint.currentOrder = state.m_nCurrentOrder;
+	checkpoint.nextOrder = state.m_nNextOrder;
+	checkpoint.tempoMemoryUsed = tempoMemoryUsed;
+}
+
+
+void GetLengthMemory::RestoreCheckpoint(const GetLengthCheckpoint &checkpoint)
+//----------------------------------------------------------------------------
+{
+	std::copy(checkpoint.chn.begin(), checkpoint.chn.end(), state.Chn);
+	chnSettings = checkpoint.chnSettings;
+#ifndef NO_PLUGINS
+	plugParams = checkpoint.plugParams;
+#endif // NO_PLUGINS
+	elapsedTime = checkpoint.elapsedTime;
+	state.m_dBufferDiff = checkpoint.bufferDiff;
+	state.m_lTotalSampleCount = checkpoint.totalSampleCount;
+	state.m_nMusicTempo.SetRaw(checkpoint.musicTempo);
+	state.m_nMusicSpeed = checkpoint.musicSpeed;
+	state.m_nGlobalVolume = checkpoint.globalVolume;
+	state.m_nRow = checkpoint.row;
+	state.m_nNextRow = checkpoint.nextRow;
+	state.m_nNextPatStartRow = checkpoint.nextPatStartRow;
+	state.m_nCurrentRowsPerBeat = checkpoint.rowsPerBeat;
+	state.m_nPattern = checkpoint.pattern;
+	state.m_nCurrentOrder = checkpoint.currentOrder;
+	state.m_nNextOrder = checkpoint.nextOrder;
+	tempoMemoryUsed = checkpoint.tempoMemoryUsed;
+}
+
+
+// Checkpoints recorded by GetLength() for every start position it has been called with.
+// Patterns cannot be edited in libopenmpt, so they only have to be discarded if a setting that affects the timing changes.
+class GetLengthCache
+{
+public:
+	typedef std::vector<GetLengthCheckpoint> Checkpoints;
+
+	// Song time between two checkpoints, in seconds
+	static double Interval() { return 5.0; }
+
+	GetLengthCache(const CSoundFile &sndFile)
+		: mixingFreq(sndFile.m_MixerSettings.gdwMixingFreq)
+		, tempoFactor(sndFile.m_nTempoFactor)
+		, mutedChannels(GetMutedChannels(sndFile))
+	{ }
+
+	// Were the checkpoints recorded with the current settings?
+	bool IsValid(const CSoundFile &sndFile) const
+	{
+		return mixingFreq == sndFile.m_MixerSettings.gdwMixingFreq
+			&& tempoFactor == sndFile.m_nTempoFactor
+			&& mutedChannels == GetMutedChannels(sndFile);
+	}
+
+	Checkpoints &GetCheckpoints(SEQUENCEINDEX seq, ORDERINDEX order, ROWINDEX row)
+	{
+		return checkpoints[(static_cast<uint64>(seq) << 48) | (static_cast<uint64>(order) << 32) | row];
+	}
+
+protected:
+	// Muted S3M channels do not process any effects
+	static std::vector<bool> GetMutedChannels(const CSoundFile &sndFile)
+	{
+		std::vector<bool> muted(sndFile.GetNumChannels());
+		for(CHANNELINDEX chn = 0; chn < sndFile.GetNumChannels(); chn++)
+		{
+			muted[chn] = sndFile.ChnSettings[chn].dwFlags[CHN_MUTE];
+		}
+		return muted;
+	}
+
+	std::map<uint64, Checkpoints> checkpoints;
+	uint32 mixingFreq;
+	uint32 tempoFactor;	// Affects the tick duration and thus the elapsed time of every checkpoint
+	std::vector<bool> mutedChannels;
 };
 
+#endif // MODPLUG_TRACKER
+
 
 // Get mod length in various cases. Parameters:
 // [in]  adjustMode: See enmGetLengthResetMode for possible adjust modes.
@@ -241,6 +384,24 @@ std::vector<GetLengthType> CSoundFile::GetLength(enmGetLengthResetMode adjustMod
 	memory.state.m_nNextRow = memory.state.m_nRow = target.startRow;
 	memory.state.m_nNextOrder = memory.state.m_nCurrentOrder = target.startOrder;
 
+#ifndef MODPLUG_TRACKER
+	// Record checkpoints along the way and resume from the latest usable one.
+	// Sample position adjustment depends on the seek target, so it cannot make use of them.
+	GetLengthCache::Checkpoints *checkpoints = nullptr;
+	if(!adjustSamplePos)
+	{
+		if(!m_lengthCache || !m_lengthCache->IsValid(*this))
+		{
+			m_lengthCache = mpt::make_shared<GetLengthCache>(*this);
+		}
+		checkpoints = &m_lengthCache->GetCheckpoints(sequence, target.startOrder, target.startRow);
+	}
+	// Checkpoints must be usable for eAdjust seeks, so the full play state has to be tracked even if we only want to know the length.
+	const bool adjustState = (adjustMode & eAdjust) || checkpoints != nullptr;
+#else
+	const bool adjustState = (adjustMode & eAdjust) != 0;
+#endif // MODPLUG_TRACKER
+
 	// Fast LUTs for commands that are too weird / complicated / whatever to emulate in sample position adjust mode.
 	std::bitset<MAX_EFFECTS> forbiddenCommands;
 	std::bitset<MAX_VOLCMDS> forbiddenVolCommands;
@@ -282,6 +443,32 @@ std::vector<GetLengthType> CSoundFile::GetLength(enmGetLengthResetMode adjustMod
 	// If samples are being synced, force them to resync if tick duration changes
 	uint32 oldTickDuration = 0;
 
+#ifndef MODPLUG_TRACKER
+	double nextCheckpoint = GetLengthCache::Interval();
+	if(checkpoints != nullptr && !checkpoints->empty())
+	{
+		nextCheckpoint = checkpoints->back().elapsedTime + GetLengthCache::Interval();
+		// A +++ or --- target order is detected before any row is visited, so the visited rows cannot tell us if we have already passed it.
+		if(target.mode == GetLengthTarget::SeekSeconds
+			|| (target.mode == GetLengthTarget::SeekPosition && target.pos.order < orderList.size() && Patterns.IsValidPat(orderList[target.pos.order])))
+		{
+			// Find the latest checkpoint before the target is reached
+			for(GetLengthCache::Checkpoints::reverse_iterator cp = checkpoints->rbegin(); cp != checkpoints->rend(); cp++)
+			{
+				if(cp->tempoMemoryUsed && cp->adjustTiming != ((adjustMode & eAdjust) != 0))
+					continue;
+				if(target.mode == GetLengthTarget::SeekSeconds ? (cp->elapsedTime >= target.time) : cp->visitedRows.IsVisited(target.pos.order, target.pos.row, false))
+					continue;
+				memory.RestoreCheckpoint(*cp);
+				visitedRows.Set(cp->visitedRows);
+				retval.endOrder = cp->endOrder;
+				retval.endRow = cp->endRow;
+				break;
+			}
+		}
+	}
+#endif // MODPLUG_TRACKER
+
 	for (;;)
 	{
 		// Time target reached.
@@ -291,6 +478,20 @@ std::vector<GetLengthType> CSoundFile::GetLength(enmGetLengthResetMode adjustMod
 			break;
 		}
 
+#ifndef MODPLUG_TRACKER
+		// Only the first sub song starts from the requested position with no other rows visited
+		if(checkpoints != nullptr && results.empty() && memory.elapsedTime >= nextCheckpoint)
+		{
+			checkpoints->push_back(GetLengthCheckpoint(visitedRows));
+			GetLengthCheckpoint &checkpoint = checkpoints->back();
+			memory.SaveCheckpoint(checkpoint);
+			checkpoint.endOrder = retval.endOrder;
+			checkpoint.endRow = retval.endRow;
+			checkpoint.adjustTiming = (adjustMode & eAdjust) != 0;
+			nextCheckpoint = memory.elapsedTime + GetLengthCache::Interval();
+		}
+#endif // MODPLUG_TRACKER
+
 		uint32 rowDelay = 0, tickDelay = 0;
 		memory.state.m_nRow = memory.state.m_nNextRow;
 		memory.state.m_nCurrentOrder = memory.state.m_nNextOrder;
@@ -441,7 +642,7 @@ std::vector<GetLengthType> CSoundFile::GetLength(enmGetLengthResetMode adjustMod
 			if(p->IsPcNote())
 			{
 #ifndef NO_PLUGINS
-				if((adjustMode & eAdjust) && p->instr > 0 && p->instr <= MAX_MIXPLUGINS)
+				if(adjustState && p->instr > 0 && p->instr <= MAX_MIXPLUGINS)
 				{
 					memory.plugParams[std::make_pair(p->instr, p->GetValueVolCol())] = p->GetValueEffectCol();
 				}
@@ -556,7 +757,7 @@ std::vector<GetLengthType> CSoundFile::GetLength(enmGetLengthResetMode adjustMod
 				if(!patternBreakOnThisRow || (GetType() & (MOD_TYPE_MOD | MOD_TYPE_XM)))
 					memory.state.m_nNextRow = 0;
 
-				if (adjustMode & eAdjust)
+				if (adjustState)
 				{
 					pChn->nPatternLoopCount = 0;
 					pChn->nPatternLoop = 0;
@@ -575,7 +776,7 @@ std::vector<GetLengthType> CSoundFile::GetLength(enmGetLengthResetMode adjustMod
 						{
 							memory.state.m_nNextOrder = memory.state.m_nCurrentOrder + 1;
 						}
-						if(adjustMode & eAdjust)
+						if(adjustState)
 						{
 							pChn->nPatternLoopCount = 0;
 							pChn->nPatternLoop = 0;
@@ -588,9 +789,16 @@ std::vector<GetLengthType> CSoundFile::GetLength(enmGetLengthResetMode adjustMod
 				if(!m_playBehaviour[kMODVBlankTiming])
 				{
 					TEMPO tempo(CalculateXParam(memory.state.m_nPattern, memory.state.m_nRow, nChn), 0);
-					if ((adjustMode & eAdjust) && (GetType() & (MOD_TYPE_S3M | MOD_TYPE_IT | MOD_TYPE_MPT)))
+					if (adjustState && (GetType() & (MOD_TYPE_S3M | MOD_TYPE_IT | MOD_TYPE_MPT)))
 					{
-						if (tempo.GetInt()) pChn->nOldTempo = static_cast<uint8>(tempo.GetInt()); else tempo.Set(pChn->nOldTempo);
+						if (tempo.GetInt())
+						{
+							pChn->nOldTempo = static_cast<uint8>(tempo.GetInt());
+						} else
+						{
+							memory.tempoMemoryUsed = true;
+							if (adjustMode & eAdjust) tempo.Set(pChn->nOldTempo);
+						}
 					}
 
 					if (tempo.GetInt() >= 0x20) memory.state.m_nMusicTempo = tempo;
@@ -685,7 +893,7 @@ std::vector<GetLengthType> CSoundFile::GetLength(enmGetLengthResetMode adjustMod
 			}
 
 			// The following calculations are not interesting if we just want to get the song length.
-			if (!(adjustMode & eAdjust)) continue;
+			if (!adjustState) continue;
 			switch(command)
 			{
 			// Portamento Up/Down
@@ -4570,6 +4778,11 @@ void CSoundFile::InvertLoop(ModChannel *pChn)
 	if((pChn->nEFxDelay & 0x80) == 0) return; // only applied if the "delay" reaches 128
 	pChn->nEFxDelay = 0;
 
+#ifndef MODPLUG_TRACKER
+	// Other module instances may be playing the same sample data
+	if(!UnshareSampleData(static_cast<SAMPLEINDEX>(pModSample - Samples))) return;
+#endif // MODPLUG_TRACKER
+
 	if (++pChn->nEFxOffset >= pModSample->nLoopEnd - pModSample->nLoopStart)
 		pChn->nEFxOffset = 0;
 
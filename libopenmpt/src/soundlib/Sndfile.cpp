@@ -93,6 +93,11 @@ CSoundFile::CSoundFile() :
 	MemsetZero(MixFloatBuffer);
 	gnDryLOfsVol = 0;
 	gnDryROfsVol = 0;
+	m_nStems = 0;
+	m_bMixToStems = false;
+#ifndef MODPLUG_TRACKER
+	m_sampleDataSource = nullptr;
+#endif // MODPLUG_TRACKER
 	m_nType = MOD_TYPE_NONE;
 	m_ContainerType = MOD_CONTAINERTYPE_NONE;
 	m_nMixChannels = 0;
@@ -580,6 +585,9 @@ bool CSoundFile::Destroy()
 	}
 
 	Patterns.DestroyPatterns();
+#ifndef MODPLUG_TRACKER
+	m_lengthCache.reset();
+#endif // MODPLUG_TRACKER
 
 	m_songName.clear();
 	m_songArtist.clear();
@@ -589,8 +597,18 @@ bool CSoundFile::Destroy()
 
 	for(SAMPLEINDEX i = 1; i < MAX_SAMPLES; i++)
 	{
+#ifndef MODPLUG_TRACKER
+		if(IsSampleDataBorrowed(i))
+		{
+			Samples[i].pSample = nullptr;
+			continue;
+		}
+#endif // MODPLUG_TRACKER
 		Samples[i].FreeSample();
 	}
+#ifndef MODPLUG_TRACKER
+	m_sampleDataSource = nullptr;
+#endif // MODPLUG_TRACKER
 	for(INSTRUMENTINDEX i = 0; i < MAX_INSTRUMENTS; i++)
 	{
 		delete Instruments[i];
@@ -1291,7 +1309,15 @@ bool CSoundFile::DestroySample(SAMPLEINDEX nSample)
 		}
 	}
 
-	sample.FreeSample();
+#ifndef MODPLUG_TRACKER
+	if(IsSampleDataBorrowed(nSample))
+	{
+		sample.pSample = nullptr;
+	} else
+#endif // MODPLUG_TRACKER
+	{
+		sample.FreeSample();
+	}
 	sample.nLength = 0;
 	sample.uFlags.reset(CHN_16BIT | CHN_STEREO);
 
@@ -1310,6 +1336,79 @@ bool CSoundFile::DestroySampleThreadsafe(SAMPLEINDEX nSample)
 }
 
 
+#ifndef MODPLUG_TRACKER
+
+bool CSoundFile::BorrowSampleData(const CSoundFile &source)
+//---------------------------------------------------------
+{
+	if(&source == this || source.GetType() != GetType() || source.GetNumSamples() != GetNumSamples())
+	{
+		return false;
+	}
+
+	// Stop any sample data that is about to be replaced. Sample assignments are kept, so that playback can continue after seeking.
+	for(CHANNELINDEX i = 0; i < MAX_CHANNELS; i++)
+	{
+		m_PlayState.Chn[i].pCurrentSample = nullptr;
+		m_PlayState.Chn[i].nLength = 0;
+	}
+
+	// Take over the complete sample headers as well, as the loaders may have adjusted them while reading the sample data.
+	for(SAMPLEINDEX smp = 1; smp <= GetNumSamples(); smp++)
+	{
+		if(!IsSampleDataBorrowed(smp))
+		{
+			Samples[smp].FreeSample();
+		}
+		Samples[smp] = source.Samples[smp];
+	}
+	m_sampleDataSource = &source;
+	return true;
+}
+
+
+bool CSoundFile::IsSampleDataBorrowed(SAMPLEINDEX smp) const
+//----------------------------------------------------------
+{
+	return m_sampleDataSource != nullptr
+		&& smp < MAX_SAMPLES
+		&& Samples[smp].pSample != nullptr
+		&& Samples[smp].pSample == m_sampleDataSource->Samples[smp].pSample;
+}
+
+
+bool CSoundFile::UnshareSampleData(SAMPLEINDEX smp)
+//-------------------------------------------------
+{
+	if(!IsSampleDataBorrowed(smp))
+	{
+		return true;
+	}
+
+	ModSample &sample = Samples[smp];
+	const void *sharedData = sample.pSample;
+	void *ownData = ModSample::AllocateSample(sample.nLength, sample.GetBytesPerSample());
+	if(ownData == nullptr)
+	{
+		return false;
+	}
+	memcpy(ownData, sharedData, sample.GetSampleSizeInBytes());
+	sample.pSample = ownData;
+	sample.PrecomputeLoops(*this, false);
+
+	for(CHANNELINDEX i = 0; i < MAX_CHANNELS; i++)
+	{
+		if(m_PlayState.Chn[i].pModSample == &sample && m_PlayState.Chn[i].pCurrentSample == sharedData)
+		{
+			m_PlayState.Chn[i].pCurrentSample = ownData;
+		}
+	}
+	return true;
+}
+
+#endif // MODPLUG_TRACKER
+
+
 #ifdef MODPLUG_TRACKER
 void CSoundFile::DeleteStaticdata()
 //---------------------------------
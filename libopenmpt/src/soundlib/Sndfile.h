@@ -260,6 +260,9 @@ public:
 };
 
 
+class GetLengthCache;
+
+
 //==============
 class CSoundFile
 //==============
@@ -328,6 +331,12 @@ private:
 	float MixFloatBuffer[2][MIXBUFFERSIZE];
 	mixsample_t gnDryLOfsVol;
 	mixsample_t gnDryROfsVol;
+	// Stem rendering (see SetStems() and ReadStems())
+	std::vector<uint32> m_ChannelStems;		// Stem of every pattern channel, or STEM_NONE
+	std::vector<mixsample_t> m_StemMixBuffer;	// Interleaved stereo mix buffer with MIXBUFFERSIZE frames for every stem
+	std::vector<mixsample_t> m_StemDryOfsVol;	// Right and left DC offset of every stem
+	uint32 m_nStems;
+	bool m_bMixToStems;						// Set while ReadStems() is mixing
 
 public:
 	MixerSettings m_MixerSettings;
@@ -425,6 +434,7 @@ public:
 	struct PlayState
 	{
 		friend class CSoundFile;
+		friend class GetLengthMemory;
 	protected:
 		samplecount_t m_nBufferCount;
 		double m_dBufferDiff;
@@ -476,6 +486,12 @@ public:
 protected:
 	// For handling backwards jumps and stuff to prevent infinite loops when counting the mod length or rendering to wav.
 	RowVisitor visitedSongRows;
+#ifndef MODPLUG_TRACKER
+	// Playback state checkpoints recorded by GetLength(), so that seeking does not have to simulate the whole song every time.
+	MPT_SHARED_PTR<GetLengthCache> m_lengthCache;
+	// Module whose sample data is used by this module instead of its own copy (see BorrowSampleData()).
+	const CSoundFile *m_sampleDataSource;
+#endif // MODPLUG_TRACKER
 
 public:
 #ifdef MODPLUG_TRACKER
@@ -561,6 +577,12 @@ public:
 #endif // MODPLUG_TRACKER
 
 	bool Destroy();
+#ifndef MODPLUG_TRACKER
+	// Use the sample data of another instance of the same module, so that several playback instances can share one copy of it.
+	// This module should have been loaded without sample data, and the source module must outlive it.
+	bool BorrowSampleData(const CSoundFile &source);
+	bool IsSampleDataBorrowed(SAMPLEINDEX smp) const;
+#endif // MODPLUG_TRACKER
 	Enum<MODTYPE> GetType() const { return m_nType; }
 
 	MODCONTAINERTYPE GetContainerType() const { return m_ContainerType; }
@@ -729,8 +751,20 @@ public:
 	void RecalculateGainForAllPlugs();
 	void ResetChannels();
 	samplecount_t Read(samplecount_t count, IAudioReadTarget &target);
+
+	static const uint32 STEM_NONE = uint32_max;
+	// Assign every pattern channel to a stem in [0, numStems[ or to STEM_NONE to leave it out. NNA channels follow their master channel.
+	void SetStems(const std::vector<uint32> &channelStems, uint32 numStems);
+	uint32 GetNumStems() const { return m_nStems; }
+	// Like Read(), but every stem is mixed separately and handed to its own target (one per stem, stereo only).
+	// Output of mix plugins cannot be attributed to individual channels and goes to the first stem. DSP effects are not applied.
+	samplecount_t ReadStems(samplecount_t count, IAudioReadTarget * const *targets);
 private:
+	samplecount_t Render(samplecount_t count, IAudioReadTarget *target, IAudioReadTarget * const *stemTargets);
 	void CreateStereoMix(int count);
+	mixsample_t *GetStemMixBuffer(uint32 stem) { return &m_StemMixBuffer[stem * MIXBUFFERSIZE * 2]; }
+	uint32 GetChannelStem(CHANNELINDEX chn) const;
+	void ProcessStems(std::size_t countChunk, IAudioReadTarget * const *targets);
 public:
 	bool FadeSong(uint32 msec);
 private:
@@ -868,6 +902,10 @@ public:
 
 	bool DestroySample(SAMPLEINDEX nSample);
 	bool DestroySampleThreadsafe(SAMPLEINDEX nSample);
+#ifndef MODPLUG_TRACKER
+	// Give a sample its own copy of borrowed sample data before modifying it.
+	bool UnshareSampleData(SAMPLEINDEX smp);
+#endif // MODPLUG_TRACKER
 
 	// Find an unused sample slot. If it is going to be assigned to an instrument, targetInstrument should be specified.
 	// SAMPLEINDEX_INVLAID is returned if no free sample slot could be found.
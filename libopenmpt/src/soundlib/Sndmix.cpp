@@ -90,6 +90,7 @@ void CSoundFile::InitPlayer(bool bReset)
 		ResetMixStat();
 		gnDryLOfsVol = 0;
 		gnDryROfsVol = 0;
+		std::fill(m_StemDryOfsVol.begin(), m_StemDryOfsVol.end(), 0);
 	}
 	m_Resampler.UpdateTables();
 #ifndef NO_REVERB
@@ -190,6 +191,51 @@ static void ApplyStereoSeparation(mixsample_t *SoundFrontBuffer, mixsample_t *So
 
 CSoundFile::samplecount_t CSoundFile::Read(samplecount_t count, IAudioReadTarget &target)
 //---------------------------------------------------------------------------------------
+{
+	return Render(count, &target, nullptr);
+}
+
+
+void CSoundFile::SetStems(const std::vector<uint32> &channelStems, uint32 numStems)
+//---------------------------------------------------------------------------------
+{
+	m_ChannelStems = channelStems;
+	m_nStems = numStems;
+	m_StemMixBuffer.assign(numStems * MIXBUFFERSIZE * 2, 0);
+	m_StemDryOfsVol.assign(numStems * 2, 0);
+}
+
+
+// Stem that a mix channel is rendered into. NNA channels are mixed into the stem of their master channel.
+uint32 CSoundFile::GetChannelStem(CHANNELINDEX chn) const
+//-------------------------------------------------------
+{
+	if(chn >= GetNumChannels())
+	{
+		const CHANNELINDEX master = m_PlayState.Chn[chn].nMasterChn;
+		if(master == 0)
+		{
+			return STEM_NONE;
+		}
+		chn = master - 1;
+	}
+	return chn < m_ChannelStems.size() ? m_ChannelStems[chn] : STEM_NONE;
+}
+
+
+CSoundFile::samplecount_t CSoundFile::ReadStems(samplecount_t count, IAudioReadTarget * const *targets)
+//-----------------------------------------------------------------------------------------------------
+{
+	MPT_ASSERT_ALWAYS(m_MixerSettings.gnChannels == 2);
+	m_bMixToStems = true;
+	const samplecount_t countRendered = Render(count, nullptr, targets);
+	m_bMixToStems = false;
+	return countRendered;
+}
+
+
+CSoundFile::samplecount_t CSoundFile::Render(samplecount_t count, IAudioReadTarget *target, IAudioReadTarget * const *stemTargets)
+//-------------------------------------------------------------------------------------------------------------------------------
 {
 	MPT_ASSERT_ALWAYS(m_MixerSettings.IsValid());
 
@@ -269,41 +315,51 @@ CSoundFile::samplecount_t CSoundFile::Read(samplecount_t count, IAudioReadTarget
 
 		CreateStereoMix(countChunk);
 
-		#ifndef NO_REVERB
-			m_Reverb.Process(MixSoundBuffer, countChunk);
-		#endif // NO_REVERB
-
-		if(mixPlugins)
+		if(m_bMixToStems)
 		{
-			ProcessPlugins(countChunk);
-		}
-
-		if(m_MixerSettings.gnChannels == 1)
+			if(mixPlugins)
+			{
+				ProcessPlugins(countChunk);
+			}
+			ProcessStems(countChunk, stemTargets);
+		} else
 		{
-			MonoFromStereo(MixSoundBuffer, countChunk);
-		}
+			#ifndef NO_REVERB
+				m_Reverb.Process(MixSoundBuffer, countChunk);
+			#endif // NO_REVERB
 
-		if(m_PlayConfig.getGlobalVolumeAppliesToMaster())
-		{
-			ProcessGlobalVolume(countChunk);
-		}
+			if(mixPlugins)
+			{
+				ProcessPlugins(countChunk);
+			}
 
-		if(m_MixerSettings.m_nStereoSeparation != MixerSettings::StereoSeparationScale)
-		{
-			ProcessStereoSeparation(countChunk);
-		}
+			if(m_MixerSettings.gnChannels == 1)
+			{
+				MonoFromStereo(MixSoundBuffer, countChunk);
+			}
 
-		if(m_MixerSettings.DSPMask)
-		{
-			ProcessDSP(countChunk);
-		}
+			if(m_PlayConfig.getGlobalVolumeAppliesToMaster())
+			{
+				ProcessGlobalVolume(countChunk);
+			}
 
-		if(m_MixerSettings.gnChannels == 4)
-		{
-			InterleaveFrontRear(MixSoundBuffer, MixRearBuffer, countChunk);
-		}
+			if(m_MixerSettings.m_nStereoSeparation != MixerSettings::StereoSeparationScale)
+			{
+				ProcessStereoSeparation(countChunk);
+			}
 
-		target.DataCallback(MixSoundBuffer, m_MixerSettings.gnChannels, countChunk);
+			if(m_MixerSettings.DSPMask)
+			{
+				ProcessDSP(countChunk);
+			}
+
+			if(m_MixerSettings.gnChannels == 4)
+			{
+				InterleaveFrontRear(MixSoundBuffer, MixRearBuffer, countChunk);
+			}
+
+			target->DataCallback(MixSoundBuffer, m_MixerSettings.gnChannels, countChunk);
+		}
 
 		// Buffer ready
 		countRendered += countChunk;
@@ -335,6 +391,39 @@ CSoundFile::samplecount_t CSoundFile::Read(samplecount_t count, IAudioReadTarget
 }
 
 
+// Post-process the stem mix buffers filled by CreateStereoMix() and pass them on to their targets.
+void CSoundFile::ProcessStems(std::size_t countChunk, IAudioReadTarget * const *targets)
+//--------------------------------------------------------------------------------------
+{
+	if(m_nStems == 0)
+	{
+		return;
+	}
+
+	// Anything that ended up in the master mix buffer has been produced by plugins
+	mixsample_t *firstStem = GetStemMixBuffer(0);
+	for(std::size_t i = 0; i < countChunk * 2; i++)
+	{
+		firstStem[i] += MixSoundBuffer[i];
+	}
+
+	if(m_PlayConfig.getGlobalVolumeAppliesToMaster())
+	{
+		ProcessGlobalVolume(countChunk);
+	}
+
+	for(uint32 stem = 0; stem < m_nStems; stem++)
+	{
+		mixsample_t *buffer = GetStemMixBuffer(stem);
+		if(m_MixerSettings.m_nStereoSeparation != MixerSettings::StereoSeparationScale)
+		{
+			ApplyStereoSeparation(buffer, nullptr, 2, countChunk, m_MixerSettings.m_nStereoSeparation);
+		}
+		targets[stem]->DataCallback(buffer, 2, countChunk);
+	}
+}
+
+
 void CSoundFile::ProcessDSP(std::size_t countChunk)
 //-------------------------------------------------
 {
@@ -2526,7 +2615,19 @@ void CSoundFile::ProcessGlobalVolume(long lCount)
 	}
 
 	// apply volume and ramping
-	if(m_MixerSettings.gnChannels == 1)
+	if(m_bMixToStems)
+	{
+		// All stems get the same volume ramp
+		int32 samplesToRampDest = m_PlayState.m_nSamplesToGlobalVolRampDest, highResRampingVolume = m_PlayState.m_lHighResRampingGlobalVolume;
+		for(uint32 stem = 0; stem < m_nStems; stem++)
+		{
+			samplesToRampDest = m_PlayState.m_nSamplesToGlobalVolRampDest;
+			highResRampingVolume = m_PlayState.m_lHighResRampingGlobalVolume;
+			ApplyGlobalVolumeWithRamping<2>(GetStemMixBuffer(stem), nullptr, lCount, m_PlayState.m_nGlobalVolume, step, samplesToRampDest, highResRampingVolume);
+		}
+		m_PlayState.m_nSamplesToGlobalVolRampDest = samplesToRampDest;
+		m_PlayState.m_lHighResRampingGlobalVolume = highResRampingVolume;
+	} else if(m_MixerSettings.gnChannels == 1)
 	{
 		ApplyGlobalVolumeWithRamping<1>(MixSoundBuffer, MixRearBuffer, lCount, m_PlayState.m_nGlobalVolume, step, m_PlayState.m_nSamplesToGlobalVolRampDest, m_PlayState.m_lHighResRampingGlobalVolume);
 	} else if(m_MixerSettings.gnChannels == 2)
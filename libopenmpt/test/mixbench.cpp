@@ -0,0 +1,137 @@
+/*
+ * mixbench.cpp
+ * ------------
+ * Purpose: Benchmark of the scalar and vectorized mixer functions.
+ * Notes  : Renders MIXBUFFERSIZE sampling points per call with every mix function that has
+ *          a vectorized implementation and prints the time per output sampling point.
+ *          Usage: openmpt_mixbench [iterations]
+ * Authors: OpenMPT Devs
+ * The OpenMPT source code is released under the BSD license. Read LICENSE for more details.
+ */
+
+
+#include "stdafx.h"
+
+#include "../soundlib/Snd_defs.h"
+#include "../soundlib/Resampler.h"
+#include "../soundlib/ModChannel.h"
+#include "../soundlib/MixFuncTable.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+
+OPENMPT_NAMESPACE_BEGIN
+
+
+#if defined(MPT_INTMIXER) && defined(MPT_ENABLE_ARCH_INTRINSICS_SSE2)
+
+
+static const char * const ResamplingNames[] = { "none", "linear", "cubic", "kaiser", "fir" };
+
+
+// Nanoseconds per output sampling point
+static double Benchmark(MixFuncInterface func, uint32 ndx, const CResampler &resampler, const std::vector<int16> &sampleData, int iterations)
+//--------------------------------------------------------------------------------------------------------------------------------------------
+{
+	std::vector<mixsample_t> mixBuffer(MIXBUFFERSIZE * 2);
+	const std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+	for(int i = 0; i < iterations; i++)
+	{
+		ModChannel chn;
+		chn.pCurrentSample = &sampleData[0];
+		chn.nPos = 8;
+		chn.nInc = 0x11C2F;	// somewhat above the mix rate, so the polyphase filter uses its upsampling table
+		chn.leftVol = 3000;
+		chn.rightVol = 1000;
+		chn.rampLeftVol = chn.leftVol << VOLUMERAMPPRECISION;
+		chn.rampRightVol = chn.rightVol << VOLUMERAMPPRECISION;
+		chn.leftRamp = (ndx & MixFuncTable::ndxRamp) ? -3 : 0;
+		chn.rightRamp = (ndx & MixFuncTable::ndxRamp) ? 5 : 0;
+		func(chn, resampler, &mixBuffer[0], MIXBUFFERSIZE);
+	}
+	const std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - start;
+	return elapsed.count() * 1e9 / (static_cast<double>(iterations) * MIXBUFFERSIZE);
+}
+
+
+static int Run(int iterations)
+//----------------------------
+{
+	InitProcSupport();
+	CResampler resampler;
+
+	// Enough 16-bit stereo data for MIXBUFFERSIZE sampling points at the chosen increment
+	std::vector<int16> sampleData(MIXBUFFERSIZE * 2 * 2 + 64);
+	uint32 noise = 1;
+	for(std::size_t i = 0; i < sampleData.size(); i++)
+	{
+		noise = noise * 1664525u + 1013904223u;
+		sampleData[i] = static_cast<int16>(noise >> 16);
+	}
+
+	const bool haveSSE2 = (GetProcSupport() & PROCSUPPORT_SSE2) != 0;
+#if defined(MPT_ENABLE_ARCH_INTRINSICS_AVX2)
+	const bool haveAVX2 = (GetProcSupport() & PROCSUPPORT_AVX2) != 0;
+#else
+	const bool haveAVX2 = false;
+#endif
+
+	std::printf("%-8s %-6s %-5s %-7s %10s %10s %10s\n", "src", "format", "chns", "ramp", "scalar ns", "sse2 ns", "avx2 ns");
+	for(uint32 ndx = 0; ndx < CountOf(MixFuncTable::Functions); ndx++)
+	{
+		if(MixFuncTable::FunctionsSSE2[ndx] == nullptr)
+		{
+			continue;
+		}
+		const double scalarTime = Benchmark(MixFuncTable::Functions[ndx], ndx, resampler, sampleData, iterations);
+		std::printf("%-8s %-6s %-5s %-7s %10.3f", ResamplingNames[ndx >> 4], (ndx & MixFuncTable::ndx16Bit) ? "16bit" : "8bit", (ndx & MixFuncTable::ndxStereo) ? "2" : "1", (ndx & MixFuncTable::ndxRamp) ? "ramp" : "noramp", scalarTime);
+		if(haveSSE2)
+		{
+			const double time = Benchmark(MixFuncTable::FunctionsSSE2[ndx], ndx, resampler, sampleData, iterations);
+			std::printf(" %10.3f", time);
+		} else
+		{
+			std::printf(" %10s", "-");
+		}
+#if defined(MPT_ENABLE_ARCH_INTRINSICS_AVX2)
+		if(haveAVX2 && MixFuncTable::FunctionsAVX2[ndx] != nullptr)
+		{
+			const double time = Benchmark(MixFuncTable::FunctionsAVX2[ndx], ndx, resampler, sampleData, iterations);
+			std::printf(" %10.3f", time);
+		} else
+#endif
+		{
+			std::printf(" %10s", "-");
+		}
+		std::printf("\n");
+	}
+	MPT_UNUSED_VARIABLE(haveAVX2);
+	return 0;
+}
+
+
+#else // !(MPT_INTMIXER && MPT_ENABLE_ARCH_INTRINSICS_SSE2)
+
+
+static int Run(int)
+//-----------------
+{
+	std::printf("No vectorized mixer functions in this build.\n");
+	return 0;
+}
+
+
+#endif // MPT_INTMIXER && MPT_ENABLE_ARCH_INTRINSICS_SSE2
+
+
+OPENMPT_NAMESPACE_END
+
+
+int main(int argc, char *argv[])
+{
+	const int iterations = (argc > 1) ? std::atoi(argv[1]) : 20000;
+	return OPENMPT_NAMESPACE::Run(iterations > 0 ? iterations : 1);
+}
@@ -27,6 +27,7 @@
 #include "../soundlib/MIDIMacros.h"
 #include "../soundlib/SampleFormatConverters.h"
 #include "../soundlib/ITCompression.h"
+#include "../soundlib/MixFuncTable.h"
 #include "../soundlib/tuningcollection.h"
 #include "../soundlib/tuning.h"
 #ifdef MODPLUG_TRACKER
@@ -42,6 +43,10 @@
 #include "../soundlib/plugins/PlugInterface.h"
 #endif
 #include "../common/mptBufferIO.h"
+#ifdef LIBOPENMPT_BUILD
+#define LIBOPENMPT_EXT_IS_EXPERIMENTAL
+#include "libopenmpt/libopenmpt_ext.hpp"
+#endif // LIBOPENMPT_BUILD
 #include <limits>
 #include <istream>
 #include <ostream>
@@ -91,10 +96,15 @@ static MPT_NOINLINE void TestSettings();
 static MPT_NOINLINE void TestStringIO();
 static MPT_NOINLINE void TestMIDIEvents();
 static MPT_NOINLINE void TestSampleConversion();
+static MPT_NOINLINE void TestMixerKernels();
 static MPT_NOINLINE void TestITCompression();
 static MPT_NOINLINE void TestTunings();
 static MPT_NOINLINE void TestPCnoteSerialization();
+static MPT_NOINLINE void TestGetLengthCache();
 static MPT_NOINLINE void TestLoadSaveFile();
+static MPT_NOINLINE void TestStemRendering();
+static MPT_NOINLINE void TestSharedSampleData();
+static MPT_NOINLINE void TestDeferredSamples();
 
 
 
@@ -168,12 +178,17 @@ void DoTests()
 	DO_TEST(TestStringIO);
 	DO_TEST(TestMIDIEvents);
 	DO_TEST(TestSampleConversion);
+	DO_TEST(TestMixerKernels);
 	DO_TEST(TestITCompression);
 	DO_TEST(TestTunings);
 
 	// slower tests, require opening a CModDoc
 	DO_TEST(TestPCnoteSerialization);
+	DO_TEST(TestGetLengthCache);
 	DO_TEST(TestLoadSaveFile);
+	DO_TEST(TestStemRendering);
+	DO_TEST(TestSharedSampleData);
+	DO_TEST(TestDeferredSamples);
 
 	delete s_PRNG;
 	s_PRNG = nullptr;
@@ -2676,6 +2691,267 @@ static MPT_NOINLINE void TestLoadSaveFile()
 }
 
 
+#ifndef MODPLUG_TRACKER
+
+// Collects the mix buffers passed to it
+class MixBufferCollector : public IAudioReadTarget
+{
+public:
+	std::vector<mixsample_t> samples;
+	virtual void DataCallback(int *MixSoundBuffer, std::size_t channels, std::size_t countChunk)
+	{
+		samples.insert(samples.end(), MixSoundBuffer, MixSoundBuffer + channels * countChunk);
+	}
+};
+
+
+// Render the whole file, either normally (if no stems are given) or into stems
+static void RenderSoundFile(CSoundFile &sndFile, const std::vector<uint32> &channelStems, uint32 numStems, std::vector<MixBufferCollector> &stems)
+//--------------------------------------------------------------------------------------------------------------------------------------------
+{
+	MixerSettings mixerSettings = sndFile.m_MixerSettings;
+	mixerSettings.gdwMixingFreq = 44100;
+	mixerSettings.gnChannels = 2;
+	sndFile.SetMixerSettings(mixerSettings);
+	sndFile.SetRepeatCount(0);
+	stems.assign(std::max<uint32>(numStems, 1), MixBufferCollector());
+	if(channelStems.empty())
+	{
+		while(sndFile.Read(MIXBUFFERSIZE * 3 + 17, stems[0]) != 0) { }
+	} else
+	{
+		sndFile.SetStems(channelStems, numStems);
+		std::vector<IAudioReadTarget *> targets;
+		for(uint32 stem = 0; stem < numStems; stem++)
+		{
+			targets.push_back(&stems[stem]);
+		}
+		while(sndFile.ReadStems(MIXBUFFERSIZE * 3 + 17, &targets[0]) != 0) { }
+	}
+}
+
+
+static void RenderTestFile(const mpt::PathString &filename, const std::vector<uint32> &channelStems, uint32 numStems, std::vector<MixBufferCollector> &stems)
+//---------------------------------------------------------------------------------------------------------------------------------------------------------
+{
+	TSoundFileContainer sndFileContainer = CreateSoundFileContainer(filename);
+	RenderSoundFile(GetrSoundFile(sndFileContainer), channelStems, numStems, stems);
+	DestroySoundFileContainer(sndFileContainer);
+}
+
+#endif // MODPLUG_TRACKER
+
+
+// Rendering every channel separately must give the same result as mixing everything together
+static MPT_NOINLINE void TestStemRendering()
+//------------------------------------------
+{
+#ifndef MODPLUG_TRACKER
+	const mpt::PathString filenameBaseSrc = GetTestFilenameBase();
+	const mpt::PathString extensions[] = { MPT_PATHSTRING("xm"), MPT_PATHSTRING("s3m"), MPT_PATHSTRING("mptm") };
+	for(std::size_t ext = 0; ext < CountOf(extensions); ext++)
+	{
+		const mpt::PathString filename = filenameBaseSrc + extensions[ext];
+		TSoundFileContainer sndFileContainer = CreateSoundFileContainer(filename);
+		const CHANNELINDEX numChannels = GetrSoundFile(sndFileContainer).GetNumChannels();
+		DestroySoundFileContainer(sndFileContainer);
+
+		std::vector<MixBufferCollector> mixed, oneStem, perChannel, withoutFirst;
+		RenderTestFile(filename, std::vector<uint32>(), 0, mixed);
+		VERIFY_EQUAL_NONCONT(mixed[0].samples.empty(), false);
+
+		// A single stem containing all channels is identical to the normal mix
+		RenderTestFile(filename, std::vector<uint32>(numChannels, 0), 1, oneStem);
+		VERIFY_EQUAL_NONCONT(oneStem[0].samples.size(), mixed[0].samples.size());
+		VERIFY_EQUAL(oneStem[0].samples == mixed[0].samples, true);
+
+		// The channel stems add up to the normal mix, apart from rounding in the global volume
+		std::vector<uint32> channelStems(numChannels);
+		for(CHANNELINDEX chn = 0; chn < numChannels; chn++)
+		{
+			channelStems[chn] = chn;
+		}
+		RenderTestFile(filename, channelStems, numChannels, perChannel);
+		for(CHANNELINDEX chn = 0; chn < numChannels; chn++)
+		{
+			VERIFY_EQUAL_NONCONT(perChannel[chn].samples.size(), mixed[0].samples.size());
+		}
+		mixsample_t maxDiff = 0;
+		for(std::size_t i = 0; i < mixed[0].samples.size(); i++)
+		{
+			mixsample_t sum = 0;
+			for(CHANNELINDEX chn = 0; chn < numChannels; chn++)
+			{
+				sum += perChannel[chn].samples[i];
+			}
+			maxDiff = std::max(maxDiff, mpt::abs(sum - mixed[0].samples[i]));
+		}
+		VERIFY_EQUAL_NONCONT(maxDiff <= static_cast<mixsample_t>(numChannels), true);
+
+		// Leaving out a channel does not change the other stems
+		channelStems[0] = CSoundFile::STEM_NONE;
+		RenderTestFile(filename, channelStems, numChannels, withoutFirst);
+		VERIFY_EQUAL(withoutFirst[0].samples == std::vector<mixsample_t>(mixed[0].samples.size(), 0), true);
+		for(CHANNELINDEX chn = 1; chn < numChannels; chn++)
+		{
+			VERIFY_EQUAL(withoutFirst[chn].samples == perChannel[chn].samples, true);
+		}
+	}
+#endif // MODPLUG_TRACKER
+}
+
+
+// Modules that borrow the sample data of another instance must sound exactly like a normally loaded module
+static MPT_NOINLINE void TestSharedSampleData()
+//---------------------------------------------
+{
+#ifndef MODPLUG_TRACKER
+	const mpt::PathString filenameBaseSrc = GetTestFilenameBase();
+	const mpt::PathString extensions[] = { MPT_PATHSTRING("xm"), MPT_PATHSTRING("s3m"), MPT_PATHSTRING("mptm") };
+	for(std::size_t ext = 0; ext < CountOf(extensions); ext++)
+	{
+		const mpt::PathString filename = filenameBaseSrc + extensions[ext];
+		std::vector<MixBufferCollector> reference;
+		RenderTestFile(filename, std::vector<uint32>(), 0, reference);
+
+		TSoundFileContainer sourceContainer = CreateSoundFileContainer(filename);
+		const CSoundFile &source = GetrSoundFile(sourceContainer);
+		SAMPLEINDEX firstSample = 0;
+		for(SAMPLEINDEX smp = source.GetNumSamples(); smp >= 1; smp--)
+		{
+			if(source.GetSample(smp).HasSampleData()) firstSample = smp;
+		}
+		VERIFY_EQUAL_NONCONT(firstSample != 0, true);
+		const std::vector<char> sourceData(static_cast<const char *>(source.GetSample(firstSample).pSample), static_cast<const char *>(source.GetSample(firstSample).pSample) + source.GetSample(firstSample).GetSampleSizeInBytes());
+
+		for(int instance = 0; instance < 2; instance++)
+		{
+			mpt::ifstream stream(filename, std::ios::binary);
+			FileReader file(&stream);
+			MPT_SHARED_PTR<CSoundFile> sndFile = mpt::make_shared<CSoundFile>();
+			sndFile->Create(file, static_cast<CSoundFile::ModLoadingFlags>(CSoundFile::loadCompleteModule & ~CSoundFile::loadSampleData));
+			VERIFY_EQUAL_NONCONT(sndFile->GetSample(firstSample).pSample == nullptr, true);
+			VERIFY_EQUAL(sndFile->BorrowSampleData(source), true);
+			for(SAMPLEINDEX smp = 1; smp <= source.GetNumSamples(); smp++)
+			{
+				VERIFY_EQUAL_NONCONT(sndFile->GetSample(smp).pSample == source.GetSample(smp).pSample, true);
+				VERIFY_EQUAL_NONCONT(sndFile->GetSample(smp).nLength, source.GetSample(smp).nLength);
+			}
+			VERIFY_EQUAL(sndFile->IsSampleDataBorrowed(firstSample), true);
+
+			std::vector<MixBufferCollector> output;
+			RenderSoundFile(*sndFile, std::vector<uint32>(), 0, output);
+			VERIFY_EQUAL(output[0].samples == reference[0].samples, true);
+
+			if(instance == 1)
+			{
+				// Modifying a sample must not affect the other instances
+				VERIFY_EQUAL(sndFile->UnshareSampleData(firstSample), true);
+				VERIFY_EQUAL(sndFile->IsSampleDataBorrowed(firstSample), false);
+				VERIFY_EQUAL_NONCONT(sndFile->GetSample(firstSample).pSample != source.GetSample(firstSample).pSample, true);
+				VERIFY_EQUAL(memcmp(sndFile->GetSample(firstSample).pSample, &sourceData[0], sourceData.size()), 0);
+				static_cast<char *>(sndFile->GetSample(firstSample).pSample)[0] ^= 0x55;
+			}
+		}
+
+		// The source still owns intact sample data after the instances have been destroyed
+		VERIFY_EQUAL_NONCONT(source.GetSample(firstSample).pSample != nullptr, true);
+		VERIFY_EQUAL(memcmp(source.GetSample(firstSample).pSample, &sourceData[0], sourceData.size()), 0);
+		DestroySoundFileContainer(sourceContainer);
+	}
+#endif // MODPLUG_TRACKER
+}
+
+
+#ifdef LIBOPENMPT_BUILD
+static std::vector<float> RenderModule(openmpt::module &mod)
+//---------------------------------------------------------
+{
+	std::vector<float> output;
+	std::vector<float> buffer(1024 * 2);
+	while(output.size() < 44100 * 2 * 10)
+	{
+		std::size_t count = mod.read_interleaved_stereo(44100, 1024, &buffer[0]);
+		if(count == 0)
+		{
+			break;
+		}
+		output.insert(output.end(), buffer.begin(), buffer.begin() + count * 2);
+	}
+	return output;
+}
+#endif // LIBOPENMPT_BUILD
+
+
+// Modules loaded with load.defer_samples must sound exactly like normally loaded modules
+static MPT_NOINLINE void TestDeferredSamples()
+//--------------------------------------------
+{
+#ifdef LIBOPENMPT_BUILD
+	const mpt::PathString filenameBaseSrc = GetTestFilenameBase();
+	const mpt::PathString extensions[] = { MPT_PATHSTRING("xm"), MPT_PATHSTRING("s3m"), MPT_PATHSTRING("mptm") };
+	for(std::size_t ext = 0; ext < CountOf(extensions); ext++)
+	{
+		const mpt::PathString filename = filenameBaseSrc + extensions[ext];
+		std::ostringstream log;
+		std::map<std::string, std::string> ctls;
+		ctls["seek.sync_samples"] = "1";
+
+		std::vector<float> reference, referenceSeek;
+		double duration, seekPosition;
+		{
+			mpt::ifstream stream(filename, std::ios::binary);
+			openmpt::module_ext eager(stream, log, ctls);
+			duration = eager.get_duration_seconds();
+			reference = RenderModule(eager);
+		}
+		{
+			mpt::ifstream stream(filename, std::ios::binary);
+			openmpt::module_ext eager(stream, log, ctls);
+			seekPosition = std::min(duration, 10.0) / 2.0;
+			eager.set_position_seconds(seekPosition);
+			referenceSeek = RenderModule(eager);
+		}
+		VERIFY_EQUAL_NONCONT(reference.empty(), false);
+
+		ctls["load.defer_samples"] = "1";
+		{
+			mpt::ifstream stream(filename, std::ios::binary);
+			openmpt::module_ext deferred(stream, log, ctls);
+			VERIFY_EQUAL(deferred.get_duration_seconds(), duration);
+			VERIFY_EQUAL(RenderModule(deferred) == reference, true);
+		}
+
+		// Seeking before the first read has to decode the samples to sync sample positions
+		{
+			mpt::ifstream stream(filename, std::ios::binary);
+			openmpt::module_ext deferred(stream, log, ctls);
+			deferred.set_position_seconds(seekPosition);
+			VERIFY_EQUAL(RenderModule(deferred) == referenceSeek, true);
+		}
+
+		// Prefetching only decodes, the samples are attached by the next read
+		{
+			mpt::ifstream stream(filename, std::ios::binary);
+			openmpt::module_ext deferred(stream, log, ctls);
+			openmpt::ext::sample_prefetch *prefetch = static_cast<openmpt::ext::sample_prefetch *>(deferred.get_interface(openmpt::ext::sample_prefetch_id));
+			VERIFY_EQUAL_NONCONT(prefetch != nullptr, true);
+			VERIFY_EQUAL(prefetch->prefetch_samples(), true);
+			VERIFY_EQUAL(prefetch->prefetch_samples(), true);
+			VERIFY_EQUAL(RenderModule(deferred) == reference, true);
+		}
+
+		// Templates ignore the ctl, their instances borrow the sample data
+		{
+			mpt::ifstream stream(filename, std::ios::binary);
+			openmpt::module_template tmpl(stream, log, ctls);
+			openmpt::module_ext instance(tmpl, log);
+			VERIFY_EQUAL(RenderModule(instance) == reference, true);
+		}
+	}
+#endif // LIBOPENMPT_BUILD
+}
+
 static void RunITCompressionTest(const std::vector<int8> &sampleData, FlagSet<ChannelFlags> smpFormat, bool it215)
 //----------------------------------------------------------------------------------------------------------------
 {
@@ -2935,6 +3211,132 @@ static MPT_NOINLINE void TestPCnoteSerialization()
 }
 
 
+#ifndef MODPLUG_TRACKER
+
+// Build a long IT module with tempo, speed and global volume changes, tempo memory and pattern loops
+static MPT_SHARED_PTR<CSoundFile> CreateLengthTestModule()
+//--------------------------------------------------------
+{
+	MPT_SHARED_PTR<CSoundFile> pSndFile = mpt::make_shared<CSoundFile>();
+	CSoundFile &sndFile = *pSndFile.get();
+	sndFile.m_nType = MOD_TYPE_IT;
+	sndFile.SetDefaultPlaybackBehaviour(MOD_TYPE_IT);
+	sndFile.Patterns.DestroyPatterns();
+	sndFile.m_nChannels = 4;
+	sndFile.m_nDefaultSpeed = 4;
+	sndFile.m_nDefaultTempo.Set(125);
+	sndFile.m_nDefaultGlobalVolume = MAX_GLOBAL_VOLUME;
+
+	const PATTERNINDEX numPatterns = 8;
+	for(PATTERNINDEX pat = 0; pat < numPatterns; pat++)
+	{
+		sndFile.Patterns.Insert(pat, 64);
+		for(ROWINDEX row = 0; row < 64; row++)
+		{
+			if(row % 16 == 0)
+			{
+				ModCommand &m = *sndFile.Patterns[pat].GetpModCommand(row, 0);
+				m.command = CMD_SPEED;
+				m.param = static_cast<ModCommand::PARAM>(3 + (pat + row / 16) % 4);
+			}
+		}
+		ModCommand &tempo = *sndFile.Patterns[pat].GetpModCommand(32, 1);
+		tempo.command = CMD_TEMPO;
+		// T00 recalls the previous tempo parameter, T0x slides the tempo down
+		tempo.param = static_cast<ModCommand::PARAM>((pat % 3 == 0) ? 0x00 : ((pat % 3 == 1) ? 0x02 : (0x60 + pat * 0x10)));
+		ModCommand &globalVol = *sndFile.Patterns[pat].GetpModCommand(4, 3);
+		globalVol.command = CMD_GLOBALVOLUME;
+		globalVol.param = static_cast<ModCommand::PARAM>(pat * 16);
+		if(pat % 4 == 2)
+		{
+			sndFile.Patterns[pat].GetpModCommand(8, 2)->command = CMD_S3MCMDEX;
+			sndFile.Patterns[pat].GetpModCommand(8, 2)->param = 0xB0;
+			sndFile.Patterns[pat].GetpModCommand(15, 2)->command = CMD_S3MCMDEX;
+			sndFile.Patterns[pat].GetpModCommand(15, 2)->param = 0xB2;
+		}
+	}
+
+	sndFile.Order.resize(3 * numPatterns);
+	for(ORDERINDEX ord = 0; ord < sndFile.Order.GetLength(); ord++)
+	{
+		sndFile.Order[ord] = static_cast<PATTERNINDEX>(ord % numPatterns);
+	}
+	return pSndFile;
+}
+
+
+static void CompareSeekResults(CSoundFile &cached, GetLengthTarget target)
+//------------------------------------------------------------------------
+{
+	MPT_SHARED_PTR<CSoundFile> fresh = CreateLengthTestModule();
+	fresh->m_nTempoFactor = cached.m_nTempoFactor;
+	const GetLengthType expected = fresh->GetLength(eNoAdjust, target).back();
+	const GetLengthType actual = cached.GetLength(eNoAdjust, target).back();
+	VERIFY_EQUAL_NONCONT(actual.targetReached, expected.targetReached);
+	VERIFY_EQUAL_NONCONT(actual.lastOrder, expected.lastOrder);
+	VERIFY_EQUAL_NONCONT(actual.lastRow, expected.lastRow);
+	VERIFY_EQUAL_EPS(actual.duration, expected.duration, 0.000001);
+
+	// Now adjust the playback state to the found position, as set_position_seconds does
+	GetLengthTarget posTarget(expected.lastOrder, expected.lastRow);
+	posTarget.StartPos(target.sequence, target.startOrder, target.startRow);
+	fresh = CreateLengthTestModule();
+	fresh->m_nTempoFactor = cached.m_nTempoFactor;
+	const double expectedAdjusted = fresh->GetLength(eAdjust, posTarget).back().duration;
+	VERIFY_EQUAL_EPS(cached.GetLength(eAdjust, posTarget).back().duration, expectedAdjusted, 0.000001);
+	VERIFY_EQUAL_NONCONT(cached.GetMusicSpeed(), fresh->GetMusicSpeed());
+	VERIFY_EQUAL_NONCONT(cached.GetMusicTempo(), fresh->GetMusicTempo());
+	VERIFY_EQUAL_NONCONT(cached.m_PlayState.m_nGlobalVolume, fresh->m_PlayState.m_nGlobalVolume);
+	VERIFY_EQUAL_NONCONT(cached.GetCurrentOrder(), fresh->GetCurrentOrder());
+	VERIFY_EQUAL_NONCONT(cached.m_PlayState.m_nNextRow, fresh->m_PlayState.m_nNextRow);
+	for(CHANNELINDEX chn = 0; chn < cached.GetNumChannels(); chn++)
+	{
+		VERIFY_EQUAL_NONCONT(cached.m_PlayState.Chn[chn].nOldTempo, fresh->m_PlayState.Chn[chn].nOldTempo);
+		VERIFY_EQUAL_NONCONT(cached.m_PlayState.Chn[chn].nPatternLoopCount, fresh->m_PlayState.Chn[chn].nPatternLoopCount);
+	}
+}
+
+#endif // MODPLUG_TRACKER
+
+
+// Seeking must give the same results whether it resumes from a GetLength() checkpoint or not
+static MPT_NOINLINE void TestGetLengthCache()
+//-------------------------------------------
+{
+#ifndef MODPLUG_TRACKER
+	MPT_SHARED_PTR<CSoundFile> pSndFile = CreateLengthTestModule();
+	CSoundFile &sndFile = *pSndFile.get();
+
+	// Record the checkpoints like libopenmpt does when enumerating the sub songs
+	const double length = sndFile.GetLength(eNoAdjust, GetLengthTarget(true)).front().duration;
+	VERIFY_EQUAL_NONCONT(length > 30.0, true);
+	VERIFY_EQUAL_EPS(sndFile.GetLength(eNoAdjust).back().duration, length, 0.000001);
+
+	const double times[] = { 0.0, 4.99, 5.0, 12.345, length * 0.5, length - 0.001, length + 10.0, 7.5 };
+	for(std::size_t i = 0; i < CountOf(times); i++)
+	{
+		CompareSeekResults(sndFile, GetLengthTarget(times[i]));
+	}
+	for(ORDERINDEX ord = 0; ord < sndFile.Order.GetLength(); ord += 5)
+	{
+		CompareSeekResults(sndFile, GetLengthTarget(ord, 20));
+	}
+	// Different start position
+	CompareSeekResults(sndFile, GetLengthTarget(length * 0.75).StartPos(0, 9, 0));
+	CompareSeekResults(sndFile, GetLengthTarget(length * 0.25).StartPos(0, 9, 0));
+
+	// Checkpoints recorded with a different tempo factor have different timestamps
+	sndFile.m_nTempoFactor = 65536 / 2;
+	for(std::size_t i = 0; i < CountOf(times); i++)
+	{
+		CompareSeekResults(sndFile, GetLengthTarget(times[i]));
+	}
+	sndFile.m_nTempoFactor = 65536;
+	CompareSeekResults(sndFile, GetLengthTarget(30.0));
+#endif // MODPLUG_TRACKER
+}
+
+
 // Test String I/O functionality
 static MPT_NOINLINE void TestStringIO()
 //-------------------------------------
@@ -3335,6 +3737,81 @@ static MPT_NOINLINE void TestSampleConversion()
 }
 
 
+static MPT_NOINLINE void TestMixerKernels()
+//-----------------------------------------
+{
+#if defined(MPT_INTMIXER) && defined(MPT_ENABLE_ARCH_INTRINSICS_SSE2)
+	// The vectorized mix functions must produce exactly the same output as the scalar ones.
+	#ifndef MODPLUG_TRACKER
+		InitProcSupport();
+	#endif
+
+	mpt::prng & prng = *s_PRNG;
+	CResampler resampler;
+
+	// Random 16-bit stereo sample data, also used as 8-bit / mono data. Include some full-scale values.
+	std::vector<int16> sampleData(4096);
+	for(size_t i = 0; i < sampleData.size(); i++)
+	{
+		sampleData[i] = mpt::random<int16>(prng);
+	}
+	for(size_t i = 0; i < 64; i++)
+	{
+		sampleData[mpt::random<uint32>(prng) % sampleData.size()] = (i & 1) ? int16_max : int16_min;
+	}
+
+	std::vector<std::pair<const MixFuncInterface *, uint32> > tables;
+	tables.push_back(std::make_pair(MixFuncTable::FunctionsSSE2, uint32(PROCSUPPORT_SSE2)));
+#if defined(MPT_ENABLE_ARCH_INTRINSICS_AVX2)
+	tables.push_back(std::make_pair(MixFuncTable::FunctionsAVX2, uint32(PROCSUPPORT_AVX2)));
+#endif
+
+	for(size_t table = 0; table < tables.size(); table++)
+	{
+		if(!(GetRealProcSupport() & tables[table].second))
+		{
+			continue;
+		}
+		for(size_t ndx = 0; ndx < CountOf(MixFuncTable::Functions); ndx++)
+		{
+			if(tables[table].first[ndx] == nullptr)
+			{
+				continue;
+			}
+			for(int iteration = 0; iteration < 16; iteration++)
+			{
+				ModChannel chn;
+				chn.pCurrentSample = &sampleData[0];
+				chn.nPos = 1024 + mpt::random<uint32>(prng) % 64;
+				chn.nPosLo = mpt::random<uint32, 16>(prng);
+				chn.nInc = static_cast<int32>(mpt::random<uint32>(prng) % 0x40000u) - 0x20000;	// Also play backwards
+				chn.leftVol = mpt::random<uint32>(prng) % 8192;
+				chn.rightVol = mpt::random<uint32>(prng) % 8192;
+				chn.rampLeftVol = chn.leftVol << VOLUMERAMPPRECISION;
+				chn.rampRightVol = chn.rightVol << VOLUMERAMPPRECISION;
+				chn.leftRamp = static_cast<int32>(mpt::random<uint32>(prng) % 4096u) - 2048;
+				chn.rightRamp = static_cast<int32>(mpt::random<uint32>(prng) % 4096u) - 2048;
+				const int numSamples = 1 + mpt::random<uint32>(prng) % 100;
+
+				ModChannel chnSIMD = chn;
+				std::vector<mixsample_t> mix(numSamples * 2), mixSIMD(numSamples * 2);
+				MixFuncTable::Functions[ndx](chn, resampler, &mix[0], numSamples);
+				tables[table].first[ndx](chnSIMD, resampler, &mixSIMD[0], numSamples);
+
+				VERIFY_EQUAL_QUIET_NONCONT(mix == mixSIMD, true);
+				VERIFY_EQUAL_QUIET_NONCONT(chn.nPos, chnSIMD.nPos);
+				VERIFY_EQUAL_QUIET_NONCONT(chn.nPosLo, chnSIMD.nPosLo);
+				VERIFY_EQUAL_QUIET_NONCONT(chn.rampLeftVol, chnSIMD.rampLeftVol);
+				VERIFY_EQUAL_QUIET_NONCONT(chn.rampRightVol, chnSIMD.rampRightVol);
+				VERIFY_EQUAL_QUIET_NONCONT(chn.leftVol, chnSIMD.leftVol);
+				VERIFY_EQUAL_QUIET_NONCONT(chn.rightVol, chnSIMD.rightVol);
+			}
+		}
+	}
+#endif // MPT_INTMIXER && MPT_ENABLE_ARCH_INTRINSICS_SSE2
+}
+
+
 } // namespace Test
 
 OPENMPT_NAMESPACE_END
@@ -3,6 +3,18 @@
 
 #include "../vgmstream.h"
 
+/* Vectorised nibble unpacking and clamping in the ADPCM decoders (define
+ * VGM_NO_SIMD to use plain C) */
+#ifndef VGM_NO_SIMD
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define VGM_SSE2
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define VGM_NEON
+#include <arm_neon.h>
+#endif
+#endif
+
 void decode_adx(VGMSTREAMCHANNEL * stream, sample * outbuf, int channelspacing, int32_t first_sample, int32_t samples_to_do);
 void decode_adx_enc(VGMSTREAMCHANNEL * stream, sample * outbuf, int channelspacing, int32_t first_sample, int32_t samples_to_do);
 
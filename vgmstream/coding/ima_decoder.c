@@ -113,6 +113,7 @@ void decode_ms_ima(VGMSTREAM * vgmstream,VGMSTREAMCHANNEL * stream, sample * out
     int32_t hist1=stream->adpcm_history1_32;
     int step_index = stream->adpcm_step_index;
 	off_t offset=stream->offset;
+    int nibbles[8];
 
     first_sample = first_sample % block_samples;
 
@@ -128,9 +129,21 @@ void decode_ms_ima(VGMSTREAM * vgmstream,VGMSTREAMCHANNEL * stream, sample * out
     for (i=first_sample,sample_count=0; i<first_sample+samples_to_do; i++,sample_count+=channelspacing) {
         int step = ADPCMTable[step_index];
 
-        offset = stream->offset + 4*vgmstream->channels + (i/8*4*vgmstream->channels) + (i%8)/2 + 4*channel;
-
-        sample_nibble = (read_8bit(offset,stream->streamfile) >> (i&1?4:0))&0xf;
+        /* the channel's 8 nibbles are in 4 bytes, unpack them at once */
+        if (i == first_sample || i%8 == 0) {
+            uint8_t bytes[4];
+            size_t length_read;
+            int j;
+
+            offset = stream->offset + 4*vgmstream->channels + (i/8*4*vgmstream->channels) + 4*channel;
+            length_read = read_streamfile(bytes,offset,4,stream->streamfile);
+            if (length_read < 4)
+                memset(bytes+length_read,0xff,4-length_read);
+
+            for (j=0;j<8;j++)
+                nibbles[j] = (bytes[j/2] >> (j&1?4:0))&0xf;
+        }
+        sample_nibble = nibbles[i%8];
 
 		sample_decoded=hist1;
 
@@ -31,6 +31,8 @@ void decode_msadpcm_stereo(VGMSTREAM * vgmstream, sample * outbuf, int32_t first
     int framesin;
     STREAMFILE *streamfile;
     off_t offset;
+    uint8_t bytes[0x100];
+    int8_t nibbles[2][0x100];
 
     framesin = first_sample/get_vgmstream_samples_per_frame(vgmstream);
     first_sample = first_sample%get_vgmstream_samples_per_frame(vgmstream);
@@ -71,14 +73,45 @@ void decode_msadpcm_stereo(VGMSTREAM * vgmstream, sample * outbuf, int32_t first
     for (i=first_sample; i<first_sample+samples_to_do; i++) {
         int j;
 
+        /* one byte is one sample of both channels, read them in chunks */
+        if (i == first_sample || (i-first_sample)%sizeof(bytes) == 0) {
+            size_t length_to_read = first_sample+samples_to_do-i;
+            size_t length_read;
+            if (length_to_read > sizeof(bytes))
+                length_to_read = sizeof(bytes);
+            length_read = read_streamfile(bytes,offset+14+i-2,length_to_read,streamfile);
+            if (length_read < length_to_read)
+                memset(bytes+length_read,0xff,length_to_read-length_read);
+
+            /* split in signed nibbles, high for the first channel */
+            j = 0;
+#if defined(VGM_SSE2)
+            for (; j+16<=(int)length_to_read; j+=16) {
+                __m128i b = _mm_loadu_si128((const __m128i *)(bytes+j));
+                __m128i mask = _mm_set1_epi8(0x0f);
+                __m128i sign = _mm_set1_epi8(0x08);
+                __m128i high = _mm_and_si128(_mm_srli_epi16(b,4),mask);
+                __m128i low = _mm_and_si128(b,mask);
+                _mm_storeu_si128((__m128i *)(nibbles[0]+j),_mm_sub_epi8(_mm_xor_si128(high,sign),sign));
+                _mm_storeu_si128((__m128i *)(nibbles[1]+j),_mm_sub_epi8(_mm_xor_si128(low,sign),sign));
+            }
+#elif defined(VGM_NEON)
+            for (; j+16<=(int)length_to_read; j+=16) {
+                int8x16_t b = vreinterpretq_s8_u8(vld1q_u8(bytes+j));
+                vst1q_s8(nibbles[0]+j,vshrq_n_s8(b,4));
+                vst1q_s8(nibbles[1]+j,vshrq_n_s8(vshlq_n_s8(b,4),4));
+            }
+#endif
+            for (; j<(int)length_to_read; j++) {
+                nibbles[0][j] = get_high_nibble_signed(bytes[j]);
+                nibbles[1][j] = get_low_nibble_signed(bytes[j]);
+            }
+        }
+
         for (j=0;j<2;j++)
         {
             VGMSTREAMCHANNEL *ch = &vgmstream->ch[j];
-            int sample_nibble =
-                (j == 0 ?
-                 get_high_nibble_signed(read_8bit(offset+14+i-2,streamfile)) :
-                 get_low_nibble_signed(read_8bit(offset+14+i-2,streamfile))
-                );
+            int sample_nibble = nibbles[j][(i-first_sample)%sizeof(bytes)];
             int32_t hist1,hist2;
             int32_t predicted;
 
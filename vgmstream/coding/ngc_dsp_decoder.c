@@ -1,85 +1,96 @@
 #include "coding.h"
 #include "../util.h"
 
-void decode_ngc_dsp(VGMSTREAMCHANNEL * stream, sample * outbuf, int channelspacing, int32_t first_sample, int32_t samples_to_do) {
-    int i=first_sample;
+/* Decode samples of one 8-byte frame. The nibbles of the whole frame are
+ * unpacked and scaled first; only the prediction depends on the previous
+ * samples. */
+static void decode_ngc_dsp_frame(VGMSTREAMCHANNEL * stream, sample * outbuf, int channelspacing, int first_sample, int samples_to_do, const uint8_t * frame) {
+    int i;
     int32_t sample_count;
+    int32_t deltas[16];
 
-    int framesin = first_sample/14;
-
-    int8_t header = read_8bit(framesin*8+stream->offset,stream->streamfile);
-    int32_t scale = 1 << (header & 0xf);
+    int8_t header = frame[0];
     int coef_index = (header >> 4) & 0xf;
     int32_t hist1 = stream->adpcm_history1_16;
     int32_t hist2 = stream->adpcm_history2_16;
     int coef1 = stream->adpcm_coef[coef_index*2];
     int coef2 = stream->adpcm_coef[coef_index*2+1];
 
-    first_sample = first_sample%14;
-
-    for (i=first_sample,sample_count=0; i<first_sample+samples_to_do; i++,sample_count+=channelspacing) {
-        int sample_byte = read_8bit(framesin*8+stream->offset+1+i/2,stream->streamfile);
-
-#ifdef DEBUG
-        if (hist1==stream->loop_history1 && hist2==stream->loop_history2) fprintf(stderr,"yo! %#x (start %#x) %d\n",stream->offset+framesin*8+i/2,stream->channel_start_offset,stream->samples_done);
-        stream->samples_done++;
+#if defined(VGM_SSE2)
+    {
+        /* bytes 1..7 in 16-bit lanes, high nibble first, each nibble at the
+         * top of a 32-bit lane: an arithmetic shift gives (nibble*scale)<<11 */
+        __m128i zero = _mm_setzero_si128();
+        __m128i words = _mm_unpacklo_epi8(_mm_srli_si128(_mm_loadl_epi64((const __m128i *)frame),1),zero);
+        __m128i high = _mm_and_si128(_mm_slli_epi16(words,8),_mm_set1_epi16((short)0xf000));
+        __m128i low = _mm_slli_epi16(words,12);
+        __m128i nibbles0 = _mm_unpacklo_epi16(high,low);
+        __m128i nibbles1 = _mm_unpackhi_epi16(high,low);
+        __m128i shift = _mm_cvtsi32_si128(28-11-(header & 0xf));
+        __m128i round = _mm_set1_epi32(1024);
+
+        _mm_storeu_si128((__m128i *)(deltas+0),_mm_add_epi32(_mm_sra_epi32(_mm_unpacklo_epi16(zero,nibbles0),shift),round));
+        _mm_storeu_si128((__m128i *)(deltas+4),_mm_add_epi32(_mm_sra_epi32(_mm_unpackhi_epi16(zero,nibbles0),shift),round));
+        _mm_storeu_si128((__m128i *)(deltas+8),_mm_add_epi32(_mm_sra_epi32(_mm_unpacklo_epi16(zero,nibbles1),shift),round));
+        _mm_storeu_si128((__m128i *)(deltas+12),_mm_add_epi32(_mm_sra_epi32(_mm_unpackhi_epi16(zero,nibbles1),shift),round));
+    }
+#elif defined(VGM_NEON)
+    {
+        /* bytes 1..7 split in signed nibbles, interleaved high first */
+        int8x8_t bytes = vreinterpret_s8_u8(vext_u8(vld1_u8(frame),vdup_n_u8(0),1));
+        int8x8x2_t nibbles = vzip_s8(vshr_n_s8(bytes,4),vshr_n_s8(vshl_n_s8(bytes,4),4));
+        int16x8_t nibbles0 = vmovl_s8(nibbles.val[0]);
+        int16x8_t nibbles1 = vmovl_s8(nibbles.val[1]);
+        int32x4_t shift = vdupq_n_s32(11+(header & 0xf));
+        int32x4_t round = vdupq_n_s32(1024);
+
+        vst1q_s32(deltas+0,vaddq_s32(vshlq_s32(vmovl_s16(vget_low_s16(nibbles0)),shift),round));
+        vst1q_s32(deltas+4,vaddq_s32(vshlq_s32(vmovl_s16(vget_high_s16(nibbles0)),shift),round));
+        vst1q_s32(deltas+8,vaddq_s32(vshlq_s32(vmovl_s16(vget_low_s16(nibbles1)),shift),round));
+        vst1q_s32(deltas+12,vaddq_s32(vshlq_s32(vmovl_s16(vget_high_s16(nibbles1)),shift),round));
+    }
+#else
+    {
+        int32_t scale = 1 << (header & 0xf);
+
+        for (i=0;i<14;i++) {
+            int nibble = i&1 ?
+                get_low_nibble_signed(frame[1+i/2]) :
+                get_high_nibble_signed(frame[1+i/2]);
+            deltas[i] = ((nibble * scale)<<11) + 1024;
+        }
+    }
 #endif
 
-        outbuf[sample_count] = clamp16((
-                 (((i&1?
-                    get_low_nibble_signed(sample_byte):
-                    get_high_nibble_signed(sample_byte)
-                   ) * scale)<<11) + 1024 +
-                 (coef1 * hist1 + coef2 * hist2))>>11
-                );
+    for (i=first_sample,sample_count=0; i<first_sample+samples_to_do; i++,sample_count+=channelspacing) {
+        int32_t sample = clamp16((deltas[i] + (coef1 * hist1 + coef2 * hist2))>>11);
 
+        outbuf[sample_count] = sample;
         hist2 = hist1;
-        hist1 = outbuf[sample_count];
+        hist1 = sample;
     }
 
     stream->adpcm_history1_16 = hist1;
     stream->adpcm_history2_16 = hist2;
 }
 
-/* read from memory rather than a file */
-void decode_ngc_dsp_mem(VGMSTREAMCHANNEL * stream, sample * outbuf, int channelspacing, int32_t first_sample, int32_t samples_to_do, uint8_t * mem) {
-    int i=first_sample;
-    int32_t sample_count;
-
+void decode_ngc_dsp(VGMSTREAMCHANNEL * stream, sample * outbuf, int channelspacing, int32_t first_sample, int32_t samples_to_do) {
+    uint8_t frame[8];
     int framesin = first_sample/14;
+    size_t length_read = read_streamfile(frame,framesin*8+stream->offset,8,stream->streamfile);
 
-    int8_t header = mem[framesin*8];
-    int32_t scale = 1 << (header & 0xf);
-    int coef_index = (header >> 4) & 0xf;
-    int32_t hist1 = stream->adpcm_history1_16;
-    int32_t hist2 = stream->adpcm_history2_16;
-    int coef1 = stream->adpcm_coef[coef_index*2];
-    int coef2 = stream->adpcm_coef[coef_index*2+1];
-
-    first_sample = first_sample%14;
-
-    for (i=first_sample,sample_count=0; i<first_sample+samples_to_do; i++,sample_count+=channelspacing) {
-        int sample_byte = mem[framesin*8+1+i/2];
-
-#ifdef DEBUG
-        if (hist1==stream->loop_history1 && hist2==stream->loop_history2) fprintf(stderr,"yo! %#x (start %#x) %d\n",stream->offset+framesin*8+i/2,stream->channel_start_offset,stream->samples_done);
-        stream->samples_done++;
-#endif
+    /* read_8bit gives -1 past the end, keep that */
+    if (length_read < 8)
+        memset(frame+length_read,0xff,8-length_read);
 
-        outbuf[sample_count] = clamp16((
-                 (((i&1?
-                    get_low_nibble_signed(sample_byte):
-                    get_high_nibble_signed(sample_byte)
-                   ) * scale)<<11) + 1024 +
-                 (coef1 * hist1 + coef2 * hist2))>>11
-                );
+    decode_ngc_dsp_frame(stream,outbuf,channelspacing,first_sample%14,samples_to_do,frame);
+}
 
-        hist2 = hist1;
-        hist1 = outbuf[sample_count];
-    }
+/* read from memory rather than a file */
+void decode_ngc_dsp_mem(VGMSTREAMCHANNEL * stream, sample * outbuf, int channelspacing, int32_t first_sample, int32_t samples_to_do, uint8_t * mem) {
+    int framesin = first_sample/14;
 
-    stream->adpcm_history1_16 = hist1;
-    stream->adpcm_history2_16 = hist2;
+    decode_ngc_dsp_frame(stream,outbuf,channelspacing,first_sample%14,samples_to_do,mem+framesin*8);
 }
 
 /*
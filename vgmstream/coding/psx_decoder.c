@@ -19,38 +19,113 @@ void decode_psx(VGMSTREAMCHANNEL * stream, sample * outbuf, int channelspacing,
 	int32_t hist1=stream->adpcm_history1_32;
 	int32_t hist2=stream->adpcm_history2_32;
 
-	short scale;
 	int i;
 	int32_t sample_count;
 	uint8_t flag;
+	uint8_t frame[16];
+	int32_t samples[28];
+	int16_t clamped[28];
+	size_t length_read;
 
 	int framesin = first_sample/28;
 
-	predict_nr = read_8bit(stream->offset+framesin*16,stream->streamfile) >> 4;
-	shift_factor = read_8bit(stream->offset+framesin*16,stream->streamfile) & 0xf;
-	flag = read_8bit(stream->offset+framesin*16+1,stream->streamfile);
+	/* the whole frame is read at once, read_8bit gives -1 past the end */
+	length_read = read_streamfile(frame,stream->offset+framesin*16,16,stream->streamfile);
+	if (length_read < 16)
+		memset(frame+length_read,0xff,16-length_read);
 
-	first_sample = first_sample % 28;
-	
-	for (i=first_sample,sample_count=0; i<first_sample+samples_to_do; i++,sample_count+=channelspacing) {
+	predict_nr = (int8_t)frame[0] >> 4;
+	shift_factor = (int8_t)frame[0] & 0xf;
+	flag = frame[1];
 
-		sample=0;
-
-		if(flag<0x07) {
-		
-			short sample_byte = (short)read_8bit(stream->offset+(framesin*16)+2+i/2,stream->streamfile);
+	first_sample = first_sample % 28;
 
-			scale = ((i&1 ?
+	if(flag<0x07) {
+		int16_t scaled[32];
+		int64_t coef1, coef2;
+
+		/* unpack the nibbles of the frame first, only the prediction
+		 * depends on the previous samples */
+#if defined(VGM_SSE2)
+		{
+			/* bytes 2..15 in 16-bit lanes, low nibble first, each nibble
+			 * in the top bits as (short)(nibble<<12) */
+			__m128i zero = _mm_setzero_si128();
+			__m128i bytes = _mm_srli_si128(_mm_loadu_si128((const __m128i *)frame),2);
+			__m128i shift = _mm_cvtsi32_si128(shift_factor);
+			__m128i mask = _mm_set1_epi16((short)0xf000);
+			int j;
+
+			for (j=0;j<2;j++) {
+				__m128i words = j ? _mm_unpackhi_epi8(bytes,zero) : _mm_unpacklo_epi8(bytes,zero);
+				__m128i low = _mm_slli_epi16(words,12);
+				__m128i high = _mm_and_si128(_mm_slli_epi16(words,8),mask);
+				_mm_storeu_si128((__m128i *)(scaled+j*16),_mm_sra_epi16(_mm_unpacklo_epi16(low,high),shift));
+				_mm_storeu_si128((__m128i *)(scaled+j*16+8),_mm_sra_epi16(_mm_unpackhi_epi16(low,high),shift));
+			}
+		}
+#elif defined(VGM_NEON)
+		{
+			/* bytes 2..15 split in nibbles at the top of each byte, low
+			 * nibble first, widened to (short)(nibble<<12) */
+			int8x16_t bytes = vreinterpretq_s8_u8(vextq_u8(vld1q_u8(frame),vdupq_n_u8(0),2));
+			int8x16x2_t nibbles = vzipq_s8(vshlq_n_s8(bytes,4),vandq_s8(bytes,vdupq_n_s8((int8_t)0xf0)));
+			int16x8_t shift = vdupq_n_s16(-shift_factor);
+			int j;
+
+			for (j=0;j<2;j++) {
+				vst1q_s16(scaled+j*16,vshlq_s16(vshll_n_s8(vget_low_s8(nibbles.val[j]),8),shift));
+				vst1q_s16(scaled+j*16+8,vshlq_s16(vshll_n_s8(vget_high_s8(nibbles.val[j]),8),shift));
+			}
+		}
+#else
+		for (i=0;i<28;i++) {
+			short sample_byte = (short)(int8_t)frame[2+i/2];
+			short scale = ((i&1 ?
 				     sample_byte >> 4 :
 					 sample_byte & 0x0f)<<12);
+			scaled[i] = scale >> shift_factor;
+		}
+#endif
 
-			sample=(int)((scale >> shift_factor)+hist1*VAG_f[predict_nr][0]+hist2*VAG_f[predict_nr][1]);
+		/* VAG_f are n/64, so the double sum is exact and truncated toward
+		 * zero: the same as this integer division, without the doubles */
+		coef1 = VAG_coefs[predict_nr][0];
+		coef2 = VAG_coefs[predict_nr][1];
+
+		for (i=first_sample; i<first_sample+samples_to_do; i++) {
+			sample=(int)((scaled[i]*(int64_t)64+hist1*coef1+hist2*coef2)/64);
+			samples[i]=sample;
+			hist2=hist1;
+			hist1=sample;
+		}
+	}
+	else {
+		for (i=first_sample; i<first_sample+samples_to_do; i++)
+			samples[i]=0;
+		if (samples_to_do > 0) {
+			hist2 = samples_to_do > 1 ? 0 : hist1;
+			hist1 = 0;
 		}
+	}
 
-		outbuf[sample_count] = clamp16(sample);
-		hist2=hist1;
-		hist1=sample;
+	/* the history is not clamped, only the output */
+	i=first_sample;
+#if defined(VGM_SSE2)
+	for (; i+8<=first_sample+samples_to_do; i+=8) {
+		__m128i clamp = _mm_packs_epi32(_mm_loadu_si128((const __m128i *)(samples+i)),_mm_loadu_si128((const __m128i *)(samples+i+4)));
+		_mm_storeu_si128((__m128i *)(clamped+i),clamp);
 	}
+#elif defined(VGM_NEON)
+	for (; i+8<=first_sample+samples_to_do; i+=8)
+		vst1q_s16(clamped+i,vcombine_s16(vqmovn_s32(vld1q_s32(samples+i)),vqmovn_s32(vld1q_s32(samples+i+4))));
+#endif
+	for (; i<first_sample+samples_to_do; i++)
+		clamped[i] = clamp16(samples[i]);
+
+	for (i=first_sample,sample_count=0; i<first_sample+samples_to_do; i++,sample_count+=channelspacing)
+		outbuf[sample_count] = clamped[i];
+
 	stream->adpcm_history1_32=hist1;
 	stream->adpcm_history2_32=hist2;
 }
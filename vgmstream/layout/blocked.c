@@ -38,9 +38,16 @@ void render_vgmstream_blocked(sample * buffer, int32_t sample_count, VGMSTREAM *
         else {
             int i;
             /* we've run off the end! */
-            for (i=samples_written*vgmstream->channels;
-                    i<(samples_written+samples_to_do)*vgmstream->channels;i++)
-                    buffer[i]=0;
+            if (vgmstream->planar_buffers) {
+                int chan;
+                for (chan=0;chan<vgmstream->channels;chan++)
+                    for (i=samples_written;i<samples_written+samples_to_do;i++)
+                        vgmstream->planar_buffers[chan][i]=0;
+            } else {
+                for (i=samples_written*vgmstream->channels;
+                        i<(samples_written+samples_to_do)*vgmstream->channels;i++)
+                        buffer[i]=0;
+            }
         }
 
         samples_written += samples_to_do;
@@ -6,18 +6,19 @@
 #include "music_vgmstream.h"
 
 #include "vgmstream/vgmstream.h"
-#include "resample/my_resample.h"
 
 #include <stdio.h>
 
-/*
- * Initialize the Game Music Emulators player, with the given mixer settings
- * This function returns 0, or -1 if there was an error.
- */
+/* Count of frames rendered by vgmstream at once */
+#define VGMSTREAM_BUFFER_FRAMES 2048
 
 /* This is the format of the audio mixer data */
 static SDL_AudioSpec mixer;
 
+/*
+ * Initialize the vgmstream player, with the given mixer settings
+ * This function returns 0, or -1 if there was an error.
+ */
 int VGMSTREAM_init(SDL_AudioSpec *mixerfmt)
 {
     mixer = *mixerfmt;
@@ -27,7 +28,7 @@ int VGMSTREAM_init(SDL_AudioSpec *mixerfmt)
 /* Uninitialize the music players */
 void VGMSTREAM_exit(void) {}
 
-/* Set the volume for a MOD stream */
+/* Set the volume for a vgmstream stream */
 void VGMSTREAM_setvolume(struct MUSIC_VGMSTREAM *music, int volume)
 {
     if(music)
@@ -36,108 +37,278 @@ void VGMSTREAM_setvolume(struct MUSIC_VGMSTREAM *music, int volume)
     }
 }
 
-struct MUSIC_VGMSTREAM *VGMSTREAM_LoadSongRW(SDL_RWops *src, int trackNum)
+
+/*
+ * STREAMFILE on the file loaded into the memory. vgmstream opens one more
+ * STREAMFILE of the same name for every channel, all of them share the data.
+ */
+typedef struct
 {
-    if(src != NULL) {
+    int refcount;
+    Uint8 *data;
+    size_t size;
+    char *name;
+} VGMSTREAM_MemData;
 
-        char *fileName=0;
-        long spcsize;
+typedef struct
+{
+    STREAMFILE sf;
+    VGMSTREAM_MemData *mem;
+} VGMSTREAM_MemFile;
 
-        Sint64 length=0;
-        length = SDL_RWseek(src, 0, RW_SEEK_END);
-        if (length < 0)
-        {
-            Mix_SetError("VGMSTREAM: wrong file\n");
-            return NULL;
-        }
+static STREAMFILE *VGMSTREAM_MemFile_new(VGMSTREAM_MemData *mem);
 
-        SDL_RWseek(src, 0, RW_SEEK_SET);
-        fileName = malloc(length);
+static size_t VGMSTREAM_MemFile_read(VGMSTREAM_MemFile *file, uint8_t *dest, off_t offset, size_t length)
+{
+    if(offset < 0 || (size_t)offset >= file->mem->size)
+        return 0;
+    if(length > file->mem->size - (size_t)offset)
+        length = file->mem->size - (size_t)offset;
+    SDL_memcpy(dest, file->mem->data + offset, length);
+    return length;
+}
 
-        long bytes_l;
-        unsigned char byte[1];
-        spcsize=0;
-        while( (bytes_l = SDL_RWread(src, &byte, sizeof(unsigned char), 1)) != 0 )
-        {
-            ((unsigned char*)fileName)[spcsize] = byte[0];
-            spcsize++;
-        }
+static size_t VGMSTREAM_MemFile_get_size(VGMSTREAM_MemFile *file)
+{
+    return file->mem->size;
+}
 
-        if (spcsize == 0)
-        {
-            Mix_SetError("VGMSTREAM: wrong file\n");
-            return NULL;
-        }
+static off_t VGMSTREAM_MemFile_get_offset(VGMSTREAM_MemFile *file)
+{
+    (void)file;
+    return 0;
+}
 
-        VGMSTREAM* stream;
+static void VGMSTREAM_MemFile_get_name(VGMSTREAM_MemFile *file, char *name, size_t length)
+{
+    SDL_strlcpy(name, file->mem->name, length);
+}
 
-        //open_stdio_streamfile()
+static STREAMFILE *VGMSTREAM_MemFile_open(VGMSTREAM_MemFile *file, const char * const filename, size_t buffersize)
+{
+    (void)buffersize;
+    /* Only the file itself is there, the companion files can't be opened */
+    if(!filename || SDL_strcmp(filename, file->mem->name) != 0)
+        return NULL;
+    return VGMSTREAM_MemFile_new(file->mem);
+}
 
-        char *err = (char*)gme_open_data( fileName, spcsize, &stream, mixer.freq );
-        //spc_load_spc( snes_spc, bytes, spcsize );
-        free(fileName);
-        if(err!=0)
-        {
-            Mix_SetError("VGMSTREAM: %s", err);
-            return NULL;
-        }
+static void VGMSTREAM_MemFile_close(VGMSTREAM_MemFile *file)
+{
+    VGMSTREAM_MemData *mem = file->mem;
+    if(--mem->refcount == 0)
+    {
+        SDL_free(mem->data);
+        SDL_free(mem->name);
+        SDL_free(mem);
+    }
+    SDL_free(file);
+}
 
-        if((trackNum<0)||(trackNum >= gme_track_count(stream)))
-            trackNum = gme_track_count(stream)-1;
+static STREAMFILE *VGMSTREAM_MemFile_new(VGMSTREAM_MemData *mem)
+{
+    VGMSTREAM_MemFile *file = (VGMSTREAM_MemFile*)SDL_calloc(1, sizeof(VGMSTREAM_MemFile));
+    if(!file)
+        return NULL;
 
-        err = (char*)gme_start_track( stream, trackNum );
-        if(err!=0)
-        {
-            Mix_SetError("VGMSTREAM: %s", err);
-            return NULL;
-        }
+    file->sf.read = (void*)VGMSTREAM_MemFile_read;
+    file->sf.get_size = (void*)VGMSTREAM_MemFile_get_size;
+    file->sf.get_offset = (void*)VGMSTREAM_MemFile_get_offset;
+    file->sf.get_name = (void*)VGMSTREAM_MemFile_get_name;
+    file->sf.get_realname = (void*)VGMSTREAM_MemFile_get_name;
+    file->sf.open = (void*)VGMSTREAM_MemFile_open;
+    file->sf.close = (void*)VGMSTREAM_MemFile_close;
+    file->mem = mem;
+    mem->refcount++;
+
+    return &file->sf;
+}
+
+
+/* Channels passed to the audio stream, more than two are folded into stereo */
+static int VGMSTREAM_outChannels(struct MUSIC_VGMSTREAM *music)
+{
+    return music->stream->channels > 2 ? 2 : music->stream->channels;
+}
+
+/* Bytes of the device buffer, the mixer asks for that much at a time */
+static int VGMSTREAM_mixBufferSize(void)
+{
+    Uint16 samples = mixer.samples ? mixer.samples : 4096;
+    if(mixer.size > 0)
+        return (int)mixer.size;
+    return (int)samples * mixer.channels * (SDL_AUDIO_BITSIZE(mixer.format) / 8);
+}
+
+/* Frames of the whole stream at the mixer rate, for the non-looped streams */
+static Sint32 VGMSTREAM_outFrames(struct MUSIC_VGMSTREAM *music, Sint32 samples)
+{
+    return (Sint32)((Sint64)samples * music->out_rate / music->stream->sample_rate);
+}
+
+/*
+ * Render the next block into the audio stream. vgmstream resamples it to
+ * the mixer rate itself, the audio stream only changes the format.
+ * Returns the count of the rendered frames, 0 at the end, or -1 on error
+ */
+static int VGMSTREAM_renderBlock(struct MUSIC_VGMSTREAM *music)
+{
+    VGMSTREAM *vgm = music->stream;
+    int frames = music->buffer_frames;
+    int channels = vgm->channels;
+    int out_channels = VGMSTREAM_outChannels(music);
 
-        struct MUSIC_VGMSTREAM *spcSpec = (struct MUSIC_VGMSTREAM*)malloc(sizeof(struct MUSIC_VGMSTREAM));
-        spcSpec->stream = stream;
-        spcSpec->playing = 0;
-        spcSpec->sample_rate=mixer.freq;
-        spcSpec->volume=MIX_MAX_VOLUME;
-        spcSpec->mus_title=NULL;
-        spcSpec->mus_artist=NULL;
-        spcSpec->mus_album=NULL;
-        spcSpec->mus_copyright=NULL;
-        gme_info_t *musInfo;
-        err = (char*)gme_track_info(spcSpec->stream, &musInfo, trackNum);
-        if( err != 0 )
+    if(!vgm->loop_flag)
+    {
+        Sint32 left = VGMSTREAM_outFrames(music, vgm->num_samples) - music->position;
+        if(left <= 0)
+            return 0;
+        if(frames > left)
+            frames = (int)left;
+    }
+
+    render_vgmstream_float(music->buffer, frames, music->out_rate, vgm);
+    music->position += frames;
+
+    if(channels > out_channels)
+    {
+        /* Even channels go to the left, odd ones to the right */
+        const float left_gain = 1.0f / (float)((channels + 1) / 2);
+        const float right_gain = 1.0f / (float)(channels / 2);
+        int i, c;
+        for(i = 0; i < frames; ++i)
         {
-            gme_delete(spcSpec->stream);
-            free(spcSpec);
-            Mix_SetError("VGMSTREAM: %s", err);
-            return NULL;
+            const float *in = music->buffer + i * channels;
+            float left = 0, right = 0;
+            for(c = 0; c < channels; c += 2)
+                left += in[c];
+            for(c = 1; c < channels; c += 2)
+                right += in[c];
+            music->buffer[i * 2 + 0] = left * left_gain;
+            music->buffer[i * 2 + 1] = right * right_gain;
         }
-        spcSpec->mus_title = (char *)SDL_malloc(sizeof(char)*strlen(musInfo->song)+1);
-        strcpy(spcSpec->mus_title, musInfo->song);
-        spcSpec->mus_artist = (char *)SDL_malloc(sizeof(char)*strlen(musInfo->author)+1);
-        strcpy(spcSpec->mus_artist, musInfo->author);
-        spcSpec->mus_album = (char *)SDL_malloc(sizeof(char)*strlen(musInfo->game)+1);
-        strcpy(spcSpec->mus_album, musInfo->game);
-        spcSpec->mus_copyright = (char *)SDL_malloc(sizeof(char)*strlen(musInfo->copyright)+1);
-        strcpy(spcSpec->mus_copyright, musInfo->copyright);
-        gme_free_info( musInfo );
+    }
+
+    if(SDL_AudioStreamPut(music->audio_stream, music->buffer, frames * out_channels * (int)sizeof(float)) < 0)
+        return -1;
+
+    return frames;
+}
+
+/* Load a vgmstream stream from an SDL_RWops object */
+struct MUSIC_VGMSTREAM *VGMSTREAM_LoadSongRW(SDL_RWops *src, const char *name)
+{
+    VGMSTREAM_MemData *mem;
+    STREAMFILE *file;
+    VGMSTREAM *stream;
+    struct MUSIC_VGMSTREAM *music;
+    Sint64 length;
+    size_t got = 0;
+
+    if(src == NULL)
+        return NULL;
 
-        SDL_BuildAudioCVT(&spcSpec->cvt, AUDIO_S16, 2,
-                          mixer.freq,
-                          mixer.format,
-                          mixer.channels,
-                          mixer.freq);
+    length = SDL_RWsize(src);
+    if(length <= 0)
+    {
+        Mix_SetError("VGMSTREAM: wrong file\n");
+        return NULL;
+    }
 
-        return spcSpec;
+    mem = (VGMSTREAM_MemData*)SDL_calloc(1, sizeof(VGMSTREAM_MemData));
+    if(!mem)
+    {
+        SDL_OutOfMemory();
+        return NULL;
+    }
+    mem->size = (size_t)length;
+    mem->data = (Uint8*)SDL_malloc(mem->size);
+    mem->name = SDL_strdup(name ? name : "stream");
+    if(!mem->data || !mem->name)
+    {
+        SDL_free(mem->data);
+        SDL_free(mem->name);
+        SDL_free(mem);
+        SDL_OutOfMemory();
+        return NULL;
     }
-    return NULL;
+
+    SDL_RWseek(src, 0, RW_SEEK_SET);
+    while(got < mem->size)
+    {
+        size_t bytes = SDL_RWread(src, mem->data + got, 1, mem->size - got);
+        if(bytes == 0)
+            break;
+        got += bytes;
+    }
+    mem->size = got;
+
+    /* vgmstream opens own STREAMFILEs for the channels, the data stays
+       in the memory while any of them is open */
+    file = VGMSTREAM_MemFile_new(mem);
+    if(!file)
+    {
+        SDL_free(mem->data);
+        SDL_free(mem->name);
+        SDL_free(mem);
+        SDL_OutOfMemory();
+        return NULL;
+    }
+    stream = init_vgmstream_from_STREAMFILE(file);
+    close_streamfile(file);
+
+    if(!stream)
+    {
+        Mix_SetError("VGMSTREAM: unsupported format\n");
+        return NULL;
+    }
+
+    music = (struct MUSIC_VGMSTREAM*)SDL_calloc(1, sizeof(struct MUSIC_VGMSTREAM));
+    if(!music)
+    {
+        close_vgmstream(stream);
+        SDL_OutOfMemory();
+        return NULL;
+    }
+    music->stream = stream;
+    music->playing = 0;
+    music->sample_rate = stream->sample_rate;
+    music->volume = MIX_MAX_VOLUME;
+    music->position = 0;
+    /* vgmstream doesn't read any tags */
+    music->mus_title = NULL;
+    music->mus_artist = NULL;
+    music->mus_album = NULL;
+    music->mus_copyright = NULL;
+
+    music->buffer_frames = VGMSTREAM_BUFFER_FRAMES;
+    music->out_rate = mixer.freq;
+    music->buffer = (float*)SDL_malloc(sizeof(float) * music->buffer_frames * stream->channels);
+    music->mix_buffer_size = VGMSTREAM_mixBufferSize();
+    music->mix_buffer = (Uint8*)SDL_malloc((size_t)music->mix_buffer_size);
+    music->audio_stream = SDL_NewAudioStream(AUDIO_F32SYS, (Uint8)VGMSTREAM_outChannels(music),
+                                             mixer.freq,
+                                             mixer.format, mixer.channels, mixer.freq);
+    if(!music->buffer || !music->mix_buffer || !music->audio_stream)
+    {
+        if(music->buffer && music->mix_buffer)
+            Mix_SetError("VGMSTREAM: %s", SDL_GetError());
+        else
+            SDL_OutOfMemory();
+        VGMSTREAM_delete(music);
+        return NULL;
+    }
+
+    return music;
 }
 
-/* Load a Game Music Emulators stream from an SDL_RWops object */
-struct MUSIC_VGMSTREAM *VGMSTREAM_new_RW(struct SDL_RWops *src, int freesrc, int trackNum)
+/* Load a vgmstream stream from an SDL_RWops object */
+struct MUSIC_VGMSTREAM *VGMSTREAM_new_RW_named(struct SDL_RWops *src, int freesrc, const char *name)
 {
-    struct MUSIC_VGMSTREAM *gmeMusic;
+    struct MUSIC_VGMSTREAM *vgmMusic;
 
-    gmeMusic = VGMSTREAM_LoadSongRW(src, trackNum);
-    if (!gmeMusic)
+    vgmMusic = VGMSTREAM_LoadSongRW(src, name);
+    if (!vgmMusic)
     {
         Mix_SetError("VGMSTREAM: Can't load file");
         return NULL;
@@ -145,10 +316,17 @@ struct MUSIC_VGMSTREAM *VGMSTREAM_new_RW(struct SDL_RWops *src, int freesrc, int
     if ( freesrc ) {
         SDL_RWclose(src);
     }
-    return gmeMusic;
+    return vgmMusic;
+}
+
+struct MUSIC_VGMSTREAM *VGMSTREAM_new_RW(struct SDL_RWops *src, int freesrc, int trackNum)
+{
+    /* Streams of this vgmstream version don't have sub-songs */
+    (void)trackNum;
+    return VGMSTREAM_new_RW_named(src, freesrc, NULL);
 }
 
-/* Start playback of a given Game Music Emulators stream */
+/* Start playback of a given vgmstream stream */
 void VGMSTREAM_play(struct MUSIC_VGMSTREAM *music)
 {
     if(music)
@@ -167,36 +345,62 @@ int VGMSTREAM_playing(struct MUSIC_VGMSTREAM *music)
 /* Play some of a stream previously started with VGMSTREAM_play() */
 int VGMSTREAM_playAudio(struct MUSIC_VGMSTREAM *music, Uint8 *stream, int len)
 {
+    int got;
+
     if(music==NULL) return 1;
     if(music->stream==NULL) return 1;
     if(music->playing==-1) return 1;
     if( len<0 ) return 0;
-    int srgArraySize = len/music->cvt.len_ratio;
-    short buf[srgArraySize];
-    int srcLen = (int)((double)(len/2)/music->cvt.len_ratio);
 
-    char *err = (char*)gme_play( music->stream, srcLen, buf );
-    if( err != NULL)
+    while(SDL_AudioStreamAvailable(music->audio_stream) < len)
     {
-        Mix_SetError("VGMSTREAM: %s", err);
-        return 0;
-    }
-    int dest_len = srcLen*2;
-
-    if( music->cvt.needed ) {
-        music->cvt.len = dest_len;
-        music->cvt.buf = (Uint8*)buf;
-        SDL_ConvertAudio(&music->cvt);
-        dest_len = music->cvt.len_cvt;
+        int frames = VGMSTREAM_renderBlock(music);
+        if(frames < 0)
+        {
+            Mix_SetError("VGMSTREAM: %s", SDL_GetError());
+            return 0;
+        }
+        if(frames == 0)
+        {
+            /* End of the stream, take the rest of the converted data */
+            SDL_AudioStreamFlush(music->audio_stream);
+            break;
+        }
     }
 
     if ( music->volume == MIX_MAX_VOLUME )
     {
-        SDL_memcpy(stream, (Uint8*)buf, dest_len);
+        got = SDL_AudioStreamGet(music->audio_stream, stream, len);
     } else {
-        SDL_MixAudioFormat(stream, (Uint8*)buf, mixer.format, dest_len, music->volume);
+        /* Requests larger than the device buffer get mixed by parts */
+        got = 0;
+        while(got < len)
+        {
+            int part = len - got;
+            int n;
+            if(part > music->mix_buffer_size)
+                part = music->mix_buffer_size;
+            n = SDL_AudioStreamGet(music->audio_stream, music->mix_buffer, part);
+            if(n < 0)
+            {
+                got = n;
+                break;
+            }
+            if(n > 0)
+                SDL_MixAudioFormat(stream + got, music->mix_buffer, mixer.format, (Uint32)n, music->volume);
+            got += n;
+            if(n < part)
+                break;
+        }
+    }
+
+    if(got < 0)
+    {
+        Mix_SetError("VGMSTREAM: %s", SDL_GetError());
+        return 0;
     }
-    return len-dest_len;
+
+    return len-got;
 }
 
 /* Stop playback of a stream previously started with VGMSTREAM_play() */
@@ -206,7 +410,7 @@ void VGMSTREAM_stop(struct MUSIC_VGMSTREAM *music)
         music->playing=-1;
 }
 
-/* Close the given Game Music Emulators stream */
+/* Close the given vgmstream stream */
 void VGMSTREAM_delete(struct MUSIC_VGMSTREAM *music)
 {
     if(music)
@@ -227,23 +431,36 @@ void VGMSTREAM_delete(struct MUSIC_VGMSTREAM *music)
         {
             SDL_free(music->mus_copyright);
         }
+        if (music->audio_stream)
+        {
+            SDL_FreeAudioStream(music->audio_stream);
+            music->audio_stream=NULL;
+        }
         if (music->stream)
         {
-            gme_delete( music->stream );
+            close_vgmstream( music->stream );
             music->stream=NULL;
         }
+        SDL_free(music->buffer);
+        SDL_free(music->mix_buffer);
         music->playing=-1;
-        free(music);
+        SDL_free(music);
     }
 }
 
 /* Jump (seek) to a given position (time is in seconds) */
 void VGMSTREAM_jump_to_time(struct MUSIC_VGMSTREAM *music, double time)
 {
-    if(music)
-    {
-        gme_seek(music->stream, (int)round(time*1000));
-    }
+    VGMSTREAM *vgm;
+
+    if(!music || !music->stream)
+        return;
+
+    vgm = music->stream;
+    seek_vgmstream(vgm, (Sint32)(time * vgm->sample_rate));
+
+    music->position = VGMSTREAM_outFrames(music, vgm->current_sample);
+    SDL_AudioStreamClear(music->audio_stream);
 }
 
 #endif
@@ -26,10 +26,10 @@
 
 #ifdef VGMSTREAM_MUSIC
 
-/* First parameter of most gme_ functions is a pointer to the Music_Emu */
-typedef struct VGMSTREAM VGMSTREAM;
+/* VGMSTREAM is an unnamed struct, it can't be declared forward */
+#include "vgmstream/vgmstream.h"
 
-/* This file supports Game Music Emulator music streams */
+/* This file supports vgmstream library music streams */
 struct MUSIC_VGMSTREAM
 {
     VGMSTREAM* stream;
@@ -40,7 +40,19 @@ struct MUSIC_VGMSTREAM
     char *mus_artist;
     char *mus_album;
     char *mus_copyright;
-    SDL_AudioCVT cvt;
+    /* Rendered frames are converted to the mixer format by this stream */
+    SDL_AudioStream *audio_stream;
+    /* Rate vgmstream resamples to, the mixer rate */
+    int out_rate;
+    /* Render buffer, allocated once when the file is opened */
+    float *buffer;
+    int buffer_frames;
+    /* Destination of the converted audio when it must be mixed with volume,
+       allocated once for the size of the device buffer */
+    Uint8 *mix_buffer;
+    int mix_buffer_size;
+    /* Frames rendered since the start at out_rate, for the non-looped streams */
+    Sint32 position;
 };
 
 /* Initialize the Ogg Vorbis player, with the given mixer settings
@@ -54,9 +66,14 @@ extern void VGMSTREAM_exit(void);
 /* Set the volume for a Game Music Emulators stream */
 extern void VGMSTREAM_setvolume(struct MUSIC_VGMSTREAM *music, int volume);
 
-/* Load a Game Music Emulators stream from an SDL_RWops object */
+/* Load a vgmstream stream from an SDL_RWops object, the format can't be
+   detected by the file extension so only the formats with an id are found */
 extern struct MUSIC_VGMSTREAM *VGMSTREAM_new_RW(SDL_RWops *rw, int freerw, int trackNum);
 
+/* Load a vgmstream stream from an SDL_RWops object, the name (or just its
+   extension) is used to detect the format of the data */
+extern struct MUSIC_VGMSTREAM *VGMSTREAM_new_RW_named(SDL_RWops *rw, int freerw, const char *name);
+
 /* Start playback of a given Game Music Emulators stream */
 extern void VGMSTREAM_play(struct MUSIC_VGMSTREAM *music);
 
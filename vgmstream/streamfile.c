@@ -213,6 +213,590 @@ STREAMFILE * open_stdio_streamfile_buffer(const char * const filename, size_t bu
     return streamFile;
 }
 
+/*
+ * STREAMFILE reading through the page cache shared by the whole process.
+ *
+ * All STREAMFILEs opened from one file (one for every channel, usually)
+ * share its pages, so the channels of an interleaved stream read the file
+ * once instead of each seeking over it with its own small buffer. When a
+ * STREAMFILE reads on from where it stopped, a few pages are read at once.
+ */
+
+#define CACHE_PAGE_SIZE 0x8000
+#define CACHE_READAHEAD_PAGES 4
+#define CACHE_DEFAULT_SIZE 0x400000
+#define CACHE_HASH_SIZE 256
+
+#ifdef _WIN32
+#include <windows.h>
+static SRWLOCK cache_mutex = SRWLOCK_INIT;
+#define cache_lock() AcquireSRWLockExclusive(&cache_mutex)
+#define cache_unlock() ReleaseSRWLockExclusive(&cache_mutex)
+#else
+#include <pthread.h>
+static pthread_mutex_t cache_mutex = PTHREAD_MUTEX_INITIALIZER;
+#define cache_lock() pthread_mutex_lock(&cache_mutex)
+#define cache_unlock() pthread_mutex_unlock(&cache_mutex)
+#endif
+
+/* a file opened through the cache, shared by all its STREAMFILEs */
+typedef struct {
+    int refcount;
+    FILE * infile;
+    size_t size;
+    char * name;
+} CACHEDFILE;
+
+typedef struct _CACHEPAGE {
+    CACHEDFILE * file;
+    off_t index;
+    size_t validsize;
+    int pins;                       /* STREAMFILEs reading this page now */
+    struct _CACHEPAGE * prev;       /* LRU list, the most recent first */
+    struct _CACHEPAGE * next;
+    struct _CACHEPAGE * hash_next;
+    uint8_t data[CACHE_PAGE_SIZE];
+} CACHEPAGE;
+
+static struct {
+    size_t max_pages;
+    size_t page_count;
+    CACHEPAGE * first;
+    CACHEPAGE * last;
+    CACHEPAGE * hash[CACHE_HASH_SIZE];
+    uint8_t * readahead;
+} page_cache = { CACHE_DEFAULT_SIZE / CACHE_PAGE_SIZE, 0, NULL, NULL, { NULL }, NULL };
+
+typedef struct {
+    STREAMFILE sf;
+    CACHEDFILE * file;
+    CACHEPAGE * page;               /* pinned page of the last read */
+    off_t offset;                   /* start of the last read */
+    off_t next_offset;              /* end of the last read */
+#ifdef PROFILE_STREAMFILE
+    size_t bytes_read;
+    int error_count;
+#endif
+} CACHEDSTREAMFILE;
+
+static unsigned cache_hash(CACHEDFILE * file, off_t index) {
+    return (unsigned)(((size_t)file >> 4) ^ ((size_t)index * 2654435761u)) % CACHE_HASH_SIZE;
+}
+
+static void cache_unlink(CACHEPAGE * page) {
+    CACHEPAGE ** link = &page_cache.hash[cache_hash(page->file,page->index)];
+
+    while (*link != page)
+        link = &(*link)->hash_next;
+    *link = page->hash_next;
+
+    if (page->prev) page->prev->next = page->next;
+    else page_cache.first = page->next;
+    if (page->next) page->next->prev = page->prev;
+    else page_cache.last = page->prev;
+}
+
+static void cache_link(CACHEPAGE * page) {
+    unsigned hash = cache_hash(page->file,page->index);
+
+    page->hash_next = page_cache.hash[hash];
+    page_cache.hash[hash] = page;
+
+    page->prev = NULL;
+    page->next = page_cache.first;
+    if (page_cache.first) page_cache.first->prev = page;
+    else page_cache.last = page;
+    page_cache.first = page;
+}
+
+static CACHEPAGE * cache_find(CACHEDFILE * file, off_t index) {
+    CACHEPAGE * page = page_cache.hash[cache_hash(file,index)];
+
+    while (page && (page->file != file || page->index != index))
+        page = page->hash_next;
+
+    return page;
+}
+
+/* a free page, the least recently used one if the cache is full; the
+ * pinned pages are in use and can't be taken */
+static CACHEPAGE * cache_take_page(void) {
+    CACHEPAGE * page = NULL;
+
+    if (page_cache.page_count >= page_cache.max_pages) {
+        page = page_cache.last;
+        while (page && page->pins)
+            page = page->prev;
+    }
+
+    if (!page) {
+        page = malloc(sizeof(CACHEPAGE));
+        if (page) page_cache.page_count++;
+        return page;
+    }
+
+    cache_unlink(page);
+    return page;
+}
+
+static void cache_free_page(CACHEPAGE * page) {
+    cache_unlink(page);
+    free(page);
+    page_cache.page_count--;
+}
+
+/* read the page and the next count-1 ones not in the cache yet */
+static CACHEPAGE * cache_load(CACHEDFILE * file, off_t index, int count) {
+    off_t file_pages = (file->size + CACHE_PAGE_SIZE - 1) / CACHE_PAGE_SIZE;
+    uint8_t * buffer;
+    size_t length_read;
+    CACHEPAGE * page = NULL;
+    int i;
+
+    if (index >= file_pages) return NULL;
+    if (count > file_pages - index) count = (int)(file_pages - index);
+    for (i=1;i<count;i++) {
+        if (cache_find(file,index+i)) {
+            count = i;
+            break;
+        }
+    }
+
+    if (count > 1 && !page_cache.readahead) {
+        page_cache.readahead = malloc(CACHE_PAGE_SIZE*CACHE_READAHEAD_PAGES);
+        if (!page_cache.readahead) count = 1;
+    }
+
+    if (count == 1) {
+        page = cache_take_page();
+        if (!page) return NULL;
+        buffer = page->data;
+    }
+    else {
+        buffer = page_cache.readahead;
+    }
+
+    length_read = 0;
+    if (!fseeko(file->infile,index*CACHE_PAGE_SIZE,SEEK_SET))
+        length_read = fread(buffer,1,CACHE_PAGE_SIZE*count,file->infile);
+
+    if (count == 1) {
+        page->file = file;
+        page->index = index;
+        page->validsize = length_read;
+        page->pins = 0;
+        cache_link(page);
+        return page;
+    }
+
+    /* the last one goes in first so the requested one ends up the most recent */
+    for (i=count-1;i>=0;i--) {
+        size_t page_offset = (size_t)i*CACHE_PAGE_SIZE;
+        if (page_offset >= length_read && i > 0) continue;
+        page = cache_take_page();
+        if (!page) return NULL;
+        page->file = file;
+        page->index = index+i;
+        page->pins = 0;
+        page->validsize = length_read > page_offset ? length_read - page_offset : 0;
+        if (page->validsize > CACHE_PAGE_SIZE) page->validsize = CACHE_PAGE_SIZE;
+        memcpy(page->data,buffer+page_offset,page->validsize);
+        cache_link(page);
+    }
+
+    return page;
+}
+
+static size_t read_cached(CACHEDSTREAMFILE *streamfile, uint8_t * dest, off_t offset, size_t length) {
+    size_t length_read_total=0;
+    CACHEPAGE * page;
+    int readahead;
+
+    if (!streamfile || !dest || length<=0 || offset<0) return 0;
+
+    streamfile->offset = offset;
+
+    /* the pinned page can't change, it's read without the lock */
+    page = streamfile->page;
+    if (page && offset / CACHE_PAGE_SIZE == page->index &&
+            offset % CACHE_PAGE_SIZE + length <= page->validsize) {
+        memcpy(dest,page->data+offset%CACHE_PAGE_SIZE,length);
+        streamfile->next_offset = offset+length;
+        return length;
+    }
+
+    readahead = (offset == streamfile->next_offset) ? CACHE_READAHEAD_PAGES : 1;
+
+    cache_lock();
+    while (length>0) {
+        off_t index = offset / CACHE_PAGE_SIZE;
+        size_t offset_into_page = offset % CACHE_PAGE_SIZE;
+        size_t length_to_copy;
+
+        page = cache_find(streamfile->file,index);
+        if (page) {
+            /* move to the front of the LRU list */
+            cache_unlink(page);
+            cache_link(page);
+        }
+        else {
+            page = cache_load(streamfile->file,index,readahead);
+#ifdef PROFILE_STREAMFILE
+            if (page) streamfile->bytes_read += page->validsize;
+#endif
+        }
+        if (!page || offset_into_page >= page->validsize) break;
+
+        if (page != streamfile->page) {
+            if (streamfile->page) streamfile->page->pins--;
+            page->pins++;
+            streamfile->page = page;
+        }
+
+        length_to_copy = page->validsize - offset_into_page;
+        if (length_to_copy > length) length_to_copy = length;
+        memcpy(dest,page->data+offset_into_page,length_to_copy);
+        length_read_total += length_to_copy;
+        length -= length_to_copy;
+        offset += length_to_copy;
+        dest += length_to_copy;
+    }
+    cache_unlock();
+
+#ifdef PROFILE_STREAMFILE
+    if (length > 0)
+        streamfile->error_count++;
+#endif
+    streamfile->next_offset = offset;
+    return length_read_total;
+}
+
+static STREAMFILE * open_cached_streamfile_by_file(CACHEDFILE * file);
+
+static STREAMFILE * open_cached(CACHEDSTREAMFILE *streamFile,const char * const filename,size_t buffersize) {
+    (void)buffersize;
+    if (!filename)
+        return NULL;
+    // if same name, share the file and its pages
+    if (!strcmp(streamFile->file->name,filename))
+        return open_cached_streamfile_by_file(streamFile->file);
+    return open_cached_streamfile(filename);
+}
+
+static void close_cached(CACHEDSTREAMFILE * streamfile) {
+    CACHEDFILE * file = streamfile->file;
+    int last;
+
+    cache_lock();
+    if (streamfile->page) streamfile->page->pins--;
+    last = (--file->refcount == 0);
+    if (last) {
+        CACHEPAGE * page = page_cache.first;
+        while (page) {
+            CACHEPAGE * next = page->next;
+            if (page->file == file)
+                cache_free_page(page);
+            page = next;
+        }
+    }
+    cache_unlock();
+
+    if (last) {
+        fclose(file->infile);
+        free(file->name);
+        free(file);
+    }
+    free(streamfile);
+}
+
+static size_t get_size_cached(CACHEDSTREAMFILE * streamfile) {
+    return streamfile->file->size;
+}
+
+static off_t get_offset_cached(CACHEDSTREAMFILE *streamFile) {
+    return streamFile->offset;
+}
+
+static void get_name_cached(CACHEDSTREAMFILE *streamfile,char *buffer,size_t length) {
+    strncpy(buffer,streamfile->file->name,length);
+    buffer[length-1]='\0';
+}
+
+#ifdef PROFILE_STREAMFILE
+static size_t get_bytes_read_cached(CACHEDSTREAMFILE *streamFile) {
+    return streamFile->bytes_read;
+}
+static size_t get_error_count_cached(CACHEDSTREAMFILE *streamFile) {
+    return streamFile->error_count;
+}
+#endif
+
+static STREAMFILE * open_cached_streamfile_by_file(CACHEDFILE * file) {
+    CACHEDSTREAMFILE * streamfile;
+
+    streamfile = calloc(1,sizeof(CACHEDSTREAMFILE));
+    if (!streamfile) {
+        return NULL;
+    }
+
+    streamfile->sf.read = (void*)read_cached;
+    streamfile->sf.get_size = (void*)get_size_cached;
+    streamfile->sf.get_offset = (void*)get_offset_cached;
+    streamfile->sf.get_name = (void*)get_name_cached;
+    streamfile->sf.get_realname = (void*)get_name_cached;
+    streamfile->sf.open = (void*)open_cached;
+    streamfile->sf.close = (void*)close_cached;
+#ifdef PROFILE_STREAMFILE
+    streamfile->sf.get_bytes_read = (void*)get_bytes_read_cached;
+    streamfile->sf.get_error_count = (void*)get_error_count_cached;
+#endif
+
+    streamfile->file = file;
+    streamfile->next_offset = -1;
+
+    cache_lock();
+    file->refcount++;
+    cache_unlock();
+
+    return &streamfile->sf;
+}
+
+STREAMFILE * open_cached_streamfile(const char * const filename) {
+    FILE * infile;
+    CACHEDFILE * file;
+    STREAMFILE * streamFile;
+
+    infile = fopen(filename,"rb");
+    if (!infile) return NULL;
+    /* the pages are the buffer, stdio's one would only be copied through */
+    setvbuf(infile,NULL,_IONBF,0);
+
+    file = calloc(1,sizeof(CACHEDFILE));
+    if (file) file->name = malloc(strlen(filename)+1);
+    if (!file || !file->name) {
+        free(file);
+        fclose(infile);
+        return NULL;
+    }
+    strcpy(file->name,filename);
+    file->infile = infile;
+    fseeko(infile,0,SEEK_END);
+    file->size = ftello(infile);
+
+    streamFile = open_cached_streamfile_by_file(file);
+    if (!streamFile) {
+        fclose(infile);
+        free(file->name);
+        free(file);
+    }
+
+    return streamFile;
+}
+
+void set_streamfile_cache_size(size_t size) {
+    size_t max_pages = size / CACHE_PAGE_SIZE;
+
+    /* a read-ahead must not push out its own pages */
+    if (max_pages < CACHE_READAHEAD_PAGES)
+        max_pages = CACHE_READAHEAD_PAGES;
+
+    cache_lock();
+    page_cache.max_pages = max_pages;
+    {
+        CACHEPAGE * page = page_cache.last;
+        while (page && page_cache.page_count > page_cache.max_pages) {
+            CACHEPAGE * prev = page->prev;
+            if (!page->pins)
+                cache_free_page(page);
+            page = prev;
+        }
+    }
+    cache_unlock();
+}
+
+
+/*
+ * STREAMFILE on the file mapped into memory, reading is just copying.
+ * The mapping is shared by all STREAMFILEs opened from the same one.
+ */
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#endif
+
+typedef struct {
+    int refcount;
+    uint8_t * data;
+    size_t size;
+    char * name;
+#ifdef _WIN32
+    HANDLE handle;
+    HANDLE mapping;
+#endif
+} MAPPEDFILE;
+
+typedef struct {
+    STREAMFILE sf;
+    MAPPEDFILE * file;
+    off_t offset;
+} MMAPSTREAMFILE;
+
+static size_t read_mmap(MMAPSTREAMFILE *streamfile, uint8_t * dest, off_t offset, size_t length) {
+    if (!streamfile || !dest || length<=0 || offset<0) return 0;
+
+    streamfile->offset = offset;
+    if ((size_t)offset >= streamfile->file->size) return 0;
+    if (length > streamfile->file->size - offset)
+        length = streamfile->file->size - offset;
+
+    memcpy(dest,streamfile->file->data+offset,length);
+    return length;
+}
+
+static STREAMFILE * open_mmap_streamfile_by_file(MAPPEDFILE * file);
+
+static STREAMFILE * open_mmap(MMAPSTREAMFILE *streamFile,const char * const filename,size_t buffersize) {
+    (void)buffersize;
+    if (!filename)
+        return NULL;
+    // if same name, share the mapping
+    if (!strcmp(streamFile->file->name,filename))
+        return open_mmap_streamfile_by_file(streamFile->file);
+    return open_mmap_streamfile(filename);
+}
+
+static void unmap_file(MAPPEDFILE * file) {
+#ifdef _WIN32
+    UnmapViewOfFile(file->data);
+    CloseHandle(file->mapping);
+    CloseHandle(file->handle);
+#else
+    munmap(file->data,file->size);
+#endif
+    free(file->name);
+    free(file);
+}
+
+static void close_mmap(MMAPSTREAMFILE * streamfile) {
+    MAPPEDFILE * file = streamfile->file;
+    int last;
+
+    cache_lock();
+    last = (--file->refcount == 0);
+    cache_unlock();
+
+    if (last)
+        unmap_file(file);
+    free(streamfile);
+}
+
+static size_t get_size_mmap(MMAPSTREAMFILE * streamfile) {
+    return streamfile->file->size;
+}
+
+static off_t get_offset_mmap(MMAPSTREAMFILE *streamFile) {
+    return streamFile->offset;
+}
+
+static void get_name_mmap(MMAPSTREAMFILE *streamfile,char *buffer,size_t length) {
+    strncpy(buffer,streamfile->file->name,length);
+    buffer[length-1]='\0';
+}
+
+static STREAMFILE * open_mmap_streamfile_by_file(MAPPEDFILE * file) {
+    MMAPSTREAMFILE * streamfile;
+
+    streamfile = calloc(1,sizeof(MMAPSTREAMFILE));
+    if (!streamfile) {
+        return NULL;
+    }
+
+    streamfile->sf.read = (void*)read_mmap;
+    streamfile->sf.get_size = (void*)get_size_mmap;
+    streamfile->sf.get_offset = (void*)get_offset_mmap;
+    streamfile->sf.get_name = (void*)get_name_mmap;
+    streamfile->sf.get_realname = (void*)get_name_mmap;
+    streamfile->sf.open = (void*)open_mmap;
+    streamfile->sf.close = (void*)close_mmap;
+
+    streamfile->file = file;
+
+    cache_lock();
+    file->refcount++;
+    cache_unlock();
+
+    return &streamfile->sf;
+}
+
+STREAMFILE * open_mmap_streamfile(const char * const filename) {
+    MAPPEDFILE * file;
+    STREAMFILE * streamFile;
+
+    file = calloc(1,sizeof(MAPPEDFILE));
+    if (file) file->name = malloc(strlen(filename)+1);
+    if (!file || !file->name) {
+        free(file);
+        return NULL;
+    }
+    strcpy(file->name,filename);
+
+#ifdef _WIN32
+    {
+        LARGE_INTEGER size;
+        file->handle = CreateFileA(filename,GENERIC_READ,FILE_SHARE_READ,NULL,OPEN_EXISTING,FILE_ATTRIBUTE_NORMAL,NULL);
+        if (file->handle == INVALID_HANDLE_VALUE) goto fail;
+        if (!GetFileSizeEx(file->handle,&size) || size.QuadPart == 0 || (size_t)size.QuadPart != size.QuadPart) {
+            CloseHandle(file->handle);
+            goto fallback;
+        }
+        file->size = (size_t)size.QuadPart;
+        file->mapping = CreateFileMappingA(file->handle,NULL,PAGE_READONLY,0,0,NULL);
+        if (file->mapping)
+            file->data = MapViewOfFile(file->mapping,FILE_MAP_READ,0,0,0);
+        if (!file->data) {
+            if (file->mapping) CloseHandle(file->mapping);
+            CloseHandle(file->handle);
+            goto fallback;
+        }
+    }
+#else
+    {
+        struct stat st;
+        void * data;
+        int fd = open(filename,O_RDONLY);
+        if (fd < 0) goto fail;
+        if (fstat(fd,&st) || st.st_size == 0 || (off_t)(size_t)st.st_size != (off_t)st.st_size) {
+            close(fd);
+            goto fallback;
+        }
+        file->size = (size_t)st.st_size;
+        data = mmap(NULL,file->size,PROT_READ,MAP_PRIVATE,fd,0);
+        close(fd);
+        if (data == MAP_FAILED) goto fallback;
+        file->data = data;
+    }
+#endif
+
+    streamFile = open_mmap_streamfile_by_file(file);
+    if (!streamFile) {
+        unmap_file(file);
+    }
+    return streamFile;
+
+fallback:
+    /* empty files and the ones that can't be mapped are read normally */
+    free(file->name);
+    free(file);
+    return open_cached_streamfile(filename);
+
+fail:
+    free(file->name);
+    free(file);
+    return NULL;
+}
+
 /* Read a line into dst. The source files are MS-DOS style,
  * separated (not terminated) by CRLF. Return 1 if the full line was
  * retrieved (if it could fit in dst), 0 otherwise. In any case the result
@@ -144,6 +144,22 @@ static inline STREAMFILE * open_stdio_streamfile(const char * const filename) {
     return open_stdio_streamfile_buffer(filename,STREAMFILE_DEFAULT_BUFFER_SIZE);
 }
 
+/* open file reading through the page cache shared by all such STREAMFILEs
+*
+* Returns pointer to new STREAMFILE or NULL if open failed
+*/
+STREAMFILE * open_cached_streamfile(const char * const filename);
+
+/* set the size of the page cache in bytes (4MB by default) */
+void set_streamfile_cache_size(size_t size);
+
+/* open file mapped into memory, files that can't be mapped are opened
+* with open_cached_streamfile
+*
+* Returns pointer to new STREAMFILE or NULL if open failed
+*/
+STREAMFILE * open_mmap_streamfile(const char * const filename);
+
 size_t get_streamfile_dos_line(int dst_length, char * dst, off_t offset,
                 STREAMFILE * infile, int *line_done_ptr);
 
@@ -0,0 +1,603 @@
+/*
+ * adpcmcheck: checks the frame-based DSP, PSX, MS-IMA and MSADPCM decoders
+ * against the original sample-by-sample ones, and times both
+ *
+ * The reference decoders below are the versions that read every nibble with
+ * read_8bit. Random frames are decoded from random start positions, sample
+ * counts and channel spacings, including frames cut by the end of the file,
+ * and the output and the channel state must be identical.
+ *
+ * There is no build system for vgmstream in this tree; build with e.g.
+ *   cc -O2 -DVAR_ARRAYS -I.. adpcmcheck.c <the .c files in .., ../coding, ../layout
+ *      and ../meta> -lm
+ * and again with -DVGM_NO_SIMD added to check the plain C paths.
+ *
+ * Usage: adpcmcheck [trials]
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "../vgmstream.h"
+#include "../util.h"
+#include "../coding/coding.h"
+
+extern double VAG_f[5][2];
+extern const int32_t ADPCMTable[89];
+extern const int IMA_IndexTable[16];
+
+#define DATA_SIZE 0x10000
+#define MAX_SAMPLES 0x200
+#define MAX_CHANNELS 4
+
+/* reference decoders */
+
+static void ref_decode_ngc_dsp(VGMSTREAMCHANNEL * stream, sample * outbuf, int channelspacing, int32_t first_sample, int32_t samples_to_do) {
+    int i=first_sample;
+    int32_t sample_count;
+
+    int framesin = first_sample/14;
+
+    int8_t header = read_8bit(framesin*8+stream->offset,stream->streamfile);
+    int32_t scale = 1 << (header & 0xf);
+    int coef_index = (header >> 4) & 0xf;
+    int32_t hist1 = stream->adpcm_history1_16;
+    int32_t hist2 = stream->adpcm_history2_16;
+    int coef1 = stream->adpcm_coef[coef_index*2];
+    int coef2 = stream->adpcm_coef[coef_index*2+1];
+
+    first_sample = first_sample%14;
+
+    for (i=first_sample,sample_count=0; i<first_sample+samples_to_do; i++,sample_count+=channelspacing) {
+        int sample_byte = read_8bit(framesin*8+stream->offset+1+i/2,stream->streamfile);
+
+        outbuf[sample_count] = clamp16((
+                 (((i&1?
+                    get_low_nibble_signed(sample_byte):
+                    get_high_nibble_signed(sample_byte)
+                   ) * scale)<<11) + 1024 +
+                 (coef1 * hist1 + coef2 * hist2))>>11
+                );
+
+        hist2 = hist1;
+        hist1 = outbuf[sample_count];
+    }
+
+    stream->adpcm_history1_16 = hist1;
+    stream->adpcm_history2_16 = hist2;
+}
+
+static void ref_decode_psx(VGMSTREAMCHANNEL * stream, sample * outbuf, int channelspacing, int32_t first_sample, int32_t samples_to_do) {
+    int predict_nr, shift_factor, sample;
+    int32_t hist1=stream->adpcm_history1_32;
+    int32_t hist2=stream->adpcm_history2_32;
+
+    short scale;
+    int i;
+    int32_t sample_count;
+    uint8_t flag;
+
+    int framesin = first_sample/28;
+
+    predict_nr = read_8bit(stream->offset+framesin*16,stream->streamfile) >> 4;
+    shift_factor = read_8bit(stream->offset+framesin*16,stream->streamfile) & 0xf;
+    flag = read_8bit(stream->offset+framesin*16+1,stream->streamfile);
+
+    first_sample = first_sample % 28;
+
+    for (i=first_sample,sample_count=0; i<first_sample+samples_to_do; i++,sample_count+=channelspacing) {
+        sample=0;
+
+        if(flag<0x07) {
+            short sample_byte = (short)read_8bit(stream->offset+(framesin*16)+2+i/2,stream->streamfile);
+
+            scale = ((i&1 ?
+                     sample_byte >> 4 :
+                     sample_byte & 0x0f)<<12);
+
+            sample=(int)((scale >> shift_factor)+hist1*VAG_f[predict_nr][0]+hist2*VAG_f[predict_nr][1]);
+        }
+
+        outbuf[sample_count] = clamp16(sample);
+        hist2=hist1;
+        hist1=sample;
+    }
+    stream->adpcm_history1_32=hist1;
+    stream->adpcm_history2_32=hist2;
+}
+
+static void ref_decode_ms_ima(VGMSTREAM * vgmstream,VGMSTREAMCHANNEL * stream, sample * outbuf, int channelspacing, int32_t first_sample, int32_t samples_to_do,int channel) {
+    int i=first_sample;
+    int sample_nibble;
+    int sample_decoded;
+    int delta;
+    int block_samples = (vgmstream->interleave_block_size - vgmstream->channels * 4) * 2 / vgmstream->channels;
+
+    int32_t sample_count=0;
+    int32_t hist1=stream->adpcm_history1_32;
+    int step_index = stream->adpcm_step_index;
+    off_t offset=stream->offset;
+
+    first_sample = first_sample % block_samples;
+
+    if (first_sample == 0) {
+        hist1 = read_16bitLE(offset+channel*4,stream->streamfile);
+        step_index = read_16bitLE(offset+channel*4+2,stream->streamfile);
+
+        if (step_index < 0) step_index=0;
+        if (step_index > 88) step_index=88;
+    }
+
+    for (i=first_sample,sample_count=0; i<first_sample+samples_to_do; i++,sample_count+=channelspacing) {
+        int step = ADPCMTable[step_index];
+
+        offset = stream->offset + 4*vgmstream->channels + (i/8*4*vgmstream->channels) + (i%8)/2 + 4*channel;
+
+        sample_nibble = (read_8bit(offset,stream->streamfile) >> (i&1?4:0))&0xf;
+
+        sample_decoded=hist1;
+
+        delta = step >> 3;
+        if (sample_nibble & 1) delta += step >> 2;
+        if (sample_nibble & 2) delta += step >> 1;
+        if (sample_nibble & 4) delta += step;
+        if (sample_nibble & 8)
+            sample_decoded -= delta;
+        else
+            sample_decoded += delta;
+
+        hist1=clamp16(sample_decoded);
+
+        step_index += IMA_IndexTable[sample_nibble];
+        if (step_index < 0) step_index=0;
+        if (step_index > 88) step_index=88;
+
+        outbuf[sample_count]=(short)(hist1);
+    }
+
+    if (i == block_samples) stream->offset += vgmstream->interleave_block_size;
+
+    stream->adpcm_history1_32=hist1;
+    stream->adpcm_step_index=step_index;
+}
+
+static const int ref_msadpcm_table[16] = {
+    230, 230, 230, 230,
+    307, 409, 512, 614,
+    768, 614, 512, 409,
+    307, 230, 230, 230
+};
+
+static const int ref_msadpcm_coeffs[7][2] = {
+    { 256,    0 },
+    { 512, -256 },
+    {   0,    0 },
+    { 192,   64 },
+    { 240,    0 },
+    { 460, -208 },
+    { 392, -232 }
+};
+
+static void ref_decode_msadpcm_stereo(VGMSTREAM * vgmstream, sample * outbuf, int32_t first_sample, int32_t samples_to_do) {
+    VGMSTREAMCHANNEL *ch1,*ch2;
+    int i;
+    int framesin;
+    STREAMFILE *streamfile;
+    off_t offset;
+
+    framesin = first_sample/get_vgmstream_samples_per_frame(vgmstream);
+    first_sample = first_sample%get_vgmstream_samples_per_frame(vgmstream);
+
+    ch1 = &vgmstream->ch[0];
+    ch2 = &vgmstream->ch[1];
+    streamfile = ch1->streamfile;
+    offset = ch1->offset+framesin*get_vgmstream_frame_size(vgmstream);
+
+    if (first_sample==0) {
+        ch1->adpcm_coef[0] = ref_msadpcm_coeffs[read_8bit(offset,streamfile)][0];
+        ch1->adpcm_coef[1] = ref_msadpcm_coeffs[read_8bit(offset,streamfile)][1];
+        ch2->adpcm_coef[0] = ref_msadpcm_coeffs[read_8bit(offset+1,streamfile)][0];
+        ch2->adpcm_coef[1] = ref_msadpcm_coeffs[read_8bit(offset+1,streamfile)][1];
+        ch1->adpcm_scale = read_16bitLE(offset+2,streamfile);
+        ch2->adpcm_scale = read_16bitLE(offset+4,streamfile);
+        ch1->adpcm_history1_16 = read_16bitLE(offset+6,streamfile);
+        ch2->adpcm_history1_16 = read_16bitLE(offset+8,streamfile);
+        ch1->adpcm_history2_16 = read_16bitLE(offset+10,streamfile);
+        ch2->adpcm_history2_16 = read_16bitLE(offset+12,streamfile);
+
+        outbuf[0] = ch1->adpcm_history2_16;
+        outbuf[1] = ch2->adpcm_history2_16;
+
+        outbuf+=2;
+        first_sample++;
+        samples_to_do--;
+    }
+    if (first_sample==1 && samples_to_do > 0) {
+        outbuf[0] = ch1->adpcm_history1_16;
+        outbuf[1] = ch2->adpcm_history1_16;
+
+        outbuf+=2;
+        first_sample++;
+        samples_to_do--;
+    }
+
+    for (i=first_sample; i<first_sample+samples_to_do; i++) {
+        int j;
+
+        for (j=0;j<2;j++)
+        {
+            VGMSTREAMCHANNEL *ch = &vgmstream->ch[j];
+            int sample_nibble =
+                (j == 0 ?
+                 get_high_nibble_signed(read_8bit(offset+14+i-2,streamfile)) :
+                 get_low_nibble_signed(read_8bit(offset+14+i-2,streamfile))
+                );
+            int32_t hist1,hist2;
+            int32_t predicted;
+
+            hist1 = ch->adpcm_history1_16;
+            hist2 = ch->adpcm_history2_16;
+            predicted = hist1 * ch->adpcm_coef[0] + hist2 * ch->adpcm_coef[1];
+            predicted /= 256;
+            predicted += sample_nibble*ch->adpcm_scale;
+            outbuf[0] = clamp16(predicted);
+            ch->adpcm_history2_16 = ch->adpcm_history1_16;
+            ch->adpcm_history1_16 = outbuf[0];
+            ch->adpcm_scale = (ref_msadpcm_table[sample_nibble&0xf] *
+                    ch->adpcm_scale) / 256;
+            if (ch->adpcm_scale < 0x10) ch->adpcm_scale = 0x10;
+
+            outbuf++;
+        }
+    }
+}
+
+/* memory STREAMFILE, reads past the end are short like with a file */
+
+typedef struct {
+    STREAMFILE sf;
+    const uint8_t * data;
+    size_t size;
+} MEMSTREAMFILE;
+
+static size_t mem_read(STREAMFILE * streamfile, uint8_t * dest, off_t offset, size_t length) {
+    MEMSTREAMFILE * mem = (MEMSTREAMFILE *)streamfile;
+    if (offset < 0 || (size_t)offset >= mem->size)
+        return 0;
+    if (length > mem->size - offset)
+        length = mem->size - offset;
+    memcpy(dest,mem->data+offset,length);
+    return length;
+}
+
+static size_t mem_get_size(STREAMFILE * streamfile) {
+    return ((MEMSTREAMFILE *)streamfile)->size;
+}
+
+static void init_mem_streamfile(MEMSTREAMFILE * mem, const uint8_t * data, size_t size) {
+    memset(mem,0,sizeof(MEMSTREAMFILE));
+    mem->sf.read = mem_read;
+    mem->sf.get_size = mem_get_size;
+    mem->data = data;
+    mem->size = size;
+}
+
+/* test data */
+
+static uint32_t rng_state = 0x12345678;
+
+static uint32_t rng(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+static int rng_range(int min, int max) {
+    return min + (int)(rng() % (uint32_t)(max - min + 1));
+}
+
+static uint8_t data[DATA_SIZE];
+static MEMSTREAMFILE memsf;
+
+/* random bytes, with a plausible header every frame_size bytes */
+static void fill_data(int frame_size, int header_mask) {
+    int i;
+    for (i=0;i<DATA_SIZE;i++)
+        data[i] = rng();
+    if (header_mask)
+        for (i=0;i<DATA_SIZE;i+=frame_size)
+            data[i] &= header_mask;
+    init_mem_streamfile(&memsf,data,DATA_SIZE);
+}
+
+static int failures;
+
+static void compare(const char * name, int trial, const sample * a, const sample * b, int size, int state_equal) {
+    if (memcmp(a,b,size*sizeof(sample)) || !state_equal) {
+        if (failures++ < 10)
+            printf("%s: mismatch in trial %d\n",name,trial);
+    }
+}
+
+static void init_channel(VGMSTREAMCHANNEL * ch, off_t offset) {
+    int i;
+    memset(ch,0,sizeof(VGMSTREAMCHANNEL));
+    ch->streamfile = &memsf.sf;
+    ch->offset = offset;
+    for (i=0;i<16;i++)
+        ch->adpcm_coef[i] = (int16_t)rng();
+    ch->adpcm_history1_16 = (int16_t)rng();
+    ch->adpcm_history2_16 = (int16_t)rng();
+    ch->adpcm_history1_32 = rng_range(-40000,40000);
+    ch->adpcm_history2_32 = rng_range(-40000,40000);
+    ch->adpcm_step_index = rng_range(0,88);
+    ch->adpcm_scale = rng_range(0x10,0x7fff);
+}
+
+static int same_channel(const VGMSTREAMCHANNEL * a, const VGMSTREAMCHANNEL * b) {
+    return !memcmp(a->adpcm_coef,b->adpcm_coef,sizeof(a->adpcm_coef)) &&
+        a->adpcm_history1_16 == b->adpcm_history1_16 &&
+        a->adpcm_history2_16 == b->adpcm_history2_16 &&
+        a->adpcm_history1_32 == b->adpcm_history1_32 &&
+        a->adpcm_history2_32 == b->adpcm_history2_32 &&
+        a->adpcm_step_index == b->adpcm_step_index &&
+        a->adpcm_scale == b->adpcm_scale &&
+        a->offset == b->offset;
+}
+
+/* trials: frames are picked up to a few past the end of the data */
+
+static void check_dsp(int trials) {
+    int t;
+    fill_data(8,0x7f);
+    for (t=0;t<trials;t++) {
+        VGMSTREAMCHANNEL a, b;
+        sample outa[14*MAX_CHANNELS], outb[14*MAX_CHANNELS];
+        int frames = DATA_SIZE/8;
+        int framesin = rng_range(0,frames+1);
+        int first_sample = framesin*14 + rng_range(0,13);
+        int samples_to_do = rng_range(1,14-first_sample%14);
+        int channelspacing = rng_range(1,MAX_CHANNELS);
+        int mem = framesin < frames && rng()%4 == 0;
+
+        init_channel(&a,0);
+        b = a;
+        memset(outa,0x55,sizeof(outa));
+        memset(outb,0x55,sizeof(outb));
+        ref_decode_ngc_dsp(&a,outa,channelspacing,first_sample,samples_to_do);
+        if (mem)
+            decode_ngc_dsp_mem(&b,outb,channelspacing,first_sample,samples_to_do,data);
+        else
+            decode_ngc_dsp(&b,outb,channelspacing,first_sample,samples_to_do);
+        compare("DSP",t,outa,outb,14*MAX_CHANNELS,same_channel(&a,&b));
+    }
+}
+
+static void check_psx(int trials) {
+    int t;
+    fill_data(16,0x4f);
+    for (t=0;t<trials;t++) {
+        VGMSTREAMCHANNEL a, b;
+        sample outa[28*MAX_CHANNELS], outb[28*MAX_CHANNELS];
+        int frames = DATA_SIZE/16;
+        int framesin = rng_range(0,frames+1);
+        int first_sample = framesin*28 + rng_range(0,27);
+        int samples_to_do = rng_range(1,28-first_sample%28);
+        int channelspacing = rng_range(1,MAX_CHANNELS);
+
+        /* mostly frames that are not silent */
+        if (framesin < frames)
+            data[framesin*16+1] = rng()%8 ? (uint32_t)rng_range(0,6) : rng();
+
+        init_channel(&a,0);
+        b = a;
+        memset(outa,0x55,sizeof(outa));
+        memset(outb,0x55,sizeof(outb));
+        ref_decode_psx(&a,outa,channelspacing,first_sample,samples_to_do);
+        decode_psx(&b,outb,channelspacing,first_sample,samples_to_do);
+        compare("PSX",t,outa,outb,28*MAX_CHANNELS,same_channel(&a,&b));
+    }
+}
+
+static void check_ms_ima(int trials) {
+    int t;
+    fill_data(1,0);
+    for (t=0;t<trials;t++) {
+        VGMSTREAM vgmstream;
+        VGMSTREAMCHANNEL a, b;
+        sample outa[MAX_SAMPLES*MAX_CHANNELS], outb[MAX_SAMPLES*MAX_CHANNELS];
+        int channels = rng_range(1,MAX_CHANNELS);
+        int block_size = channels*4*rng_range(2,MAX_SAMPLES/8+1);
+        int block_samples = (block_size - channels*4)*2/channels;
+        int blocks = DATA_SIZE/block_size;
+        int block = rng_range(0,blocks);
+        int first_sample = rng_range(0,block_samples-1);
+        int samples_to_do = rng_range(1,block_samples-first_sample);
+        int channel = rng_range(0,channels-1);
+        int channelspacing = rng_range(1,MAX_CHANNELS);
+
+        memset(&vgmstream,0,sizeof(vgmstream));
+        vgmstream.channels = channels;
+        vgmstream.interleave_block_size = block_size;
+
+        init_channel(&a,(off_t)block*block_size);
+        b = a;
+        memset(outa,0x55,sizeof(outa));
+        memset(outb,0x55,sizeof(outb));
+        ref_decode_ms_ima(&vgmstream,&a,outa,channelspacing,first_sample,samples_to_do,channel);
+        decode_ms_ima(&vgmstream,&b,outb,channelspacing,first_sample,samples_to_do,channel);
+        compare("MS-IMA",t,outa,outb,MAX_SAMPLES*MAX_CHANNELS,same_channel(&a,&b));
+    }
+}
+
+static void check_msadpcm(int trials) {
+    int t;
+    for (t=0;t<trials;t++) {
+        VGMSTREAM vgmstream;
+        VGMSTREAMCHANNEL cha[2], chb[2];
+        sample outa[MAX_SAMPLES*2], outb[MAX_SAMPLES*2];
+        int block_size = rng_range(15,MAX_SAMPLES+12);
+        int block_samples = block_size-12;
+        int blocks = DATA_SIZE/block_size;
+        int framesin = rng_range(0,blocks);
+        int first_sample = rng_range(0,block_samples-1);
+        int samples_to_do;
+        int j;
+
+        if (t%1000 == 0)
+            fill_data(1,0);
+        /* valid coefficient indexes, or no header read past the end */
+        if ((framesin+1)*block_size <= DATA_SIZE) {
+            for (j=0;j<2;j++)
+                data[framesin*block_size+j] = rng_range(0,6);
+        }
+        else if (first_sample < 2) {
+            first_sample = 2;
+        }
+        samples_to_do = rng_range(1,block_samples-first_sample);
+
+        memset(&vgmstream,0,sizeof(vgmstream));
+        vgmstream.channels = 2;
+        vgmstream.coding_type = coding_MSADPCM;
+        vgmstream.interleave_block_size = block_size;
+
+        for (j=0;j<2;j++) {
+            init_channel(&cha[j],0);
+            cha[j].adpcm_coef[0] = ref_msadpcm_coeffs[rng_range(0,6)][0];
+            cha[j].adpcm_coef[1] = ref_msadpcm_coeffs[rng_range(0,6)][1];
+            chb[j] = cha[j];
+        }
+        memset(outa,0x55,sizeof(outa));
+        memset(outb,0x55,sizeof(outb));
+        vgmstream.ch = cha;
+        ref_decode_msadpcm_stereo(&vgmstream,outa,framesin*block_samples+first_sample,samples_to_do);
+        vgmstream.ch = chb;
+        decode_msadpcm_stereo(&vgmstream,outb,framesin*block_samples+first_sample,samples_to_do);
+        compare("MSADPCM",t,outa,outb,MAX_SAMPLES*2,same_channel(&cha[0],&chb[0]) && same_channel(&cha[1],&chb[1]));
+    }
+}
+
+/* timing: the whole data as one stereo stream, frame by frame */
+
+#define PASSES 100
+
+static double time_dsp(int ref) {
+    VGMSTREAMCHANNEL ch[2];
+    sample out[14*2];
+    int pass, frame, j;
+    clock_t start;
+
+    fill_data(8,0x7f);
+    start = clock();
+    for (pass=0;pass<PASSES;pass++) {
+        for (j=0;j<2;j++)
+            init_channel(&ch[j],j*DATA_SIZE/2);
+        for (frame=0;frame<DATA_SIZE/16;frame++)
+            for (j=0;j<2;j++) {
+                if (ref)
+                    ref_decode_ngc_dsp(&ch[j],out+j,2,frame*14,14);
+                else
+                    decode_ngc_dsp(&ch[j],out+j,2,frame*14,14);
+            }
+    }
+    return (double)(clock() - start) * 1000.0 / CLOCKS_PER_SEC;
+}
+
+static double time_psx(int ref) {
+    VGMSTREAMCHANNEL ch[2];
+    sample out[28*2];
+    int pass, frame, j;
+    clock_t start;
+
+    fill_data(16,0x4f);
+    for (frame=0;frame<DATA_SIZE/16;frame++)
+        data[frame*16+1] = rng_range(0,6);
+    start = clock();
+    for (pass=0;pass<PASSES;pass++) {
+        for (j=0;j<2;j++)
+            init_channel(&ch[j],j*DATA_SIZE/2);
+        for (frame=0;frame<DATA_SIZE/32;frame++)
+            for (j=0;j<2;j++) {
+                if (ref)
+                    ref_decode_psx(&ch[j],out+j,2,frame*28,28);
+                else
+                    decode_psx(&ch[j],out+j,2,frame*28,28);
+            }
+    }
+    return (double)(clock() - start) * 1000.0 / CLOCKS_PER_SEC;
+}
+
+static double time_ms_ima(int ref) {
+    VGMSTREAM vgmstream;
+    VGMSTREAMCHANNEL ch[2];
+    sample out[0x7f8*2];
+    int pass, block, j;
+    clock_t start;
+
+    fill_data(1,0);
+    memset(&vgmstream,0,sizeof(vgmstream));
+    vgmstream.channels = 2;
+    vgmstream.interleave_block_size = 0x800;
+    start = clock();
+    for (pass=0;pass<PASSES;pass++) {
+        for (j=0;j<2;j++)
+            init_channel(&ch[j],0);
+        for (block=0;block<DATA_SIZE/0x800;block++)
+            for (j=0;j<2;j++) {
+                if (ref)
+                    ref_decode_ms_ima(&vgmstream,&ch[j],out+j,2,0,0x7f8,j);
+                else
+                    decode_ms_ima(&vgmstream,&ch[j],out+j,2,0,0x7f8,j);
+            }
+    }
+    return (double)(clock() - start) * 1000.0 / CLOCKS_PER_SEC;
+}
+
+static double time_msadpcm(int ref) {
+    VGMSTREAM vgmstream;
+    VGMSTREAMCHANNEL ch[2];
+    sample out[0x800*2];
+    int pass, block;
+    clock_t start;
+
+    fill_data(0x800,0);
+    for (block=0;block<DATA_SIZE/0x800;block++) {
+        data[block*0x800] = rng_range(0,6);
+        data[block*0x800+1] = rng_range(0,6);
+    }
+    memset(&vgmstream,0,sizeof(vgmstream));
+    vgmstream.channels = 2;
+    vgmstream.coding_type = coding_MSADPCM;
+    vgmstream.interleave_block_size = 0x800;
+    vgmstream.ch = ch;
+    start = clock();
+    for (pass=0;pass<PASSES;pass++) {
+        init_channel(&ch[0],0);
+        init_channel(&ch[1],0);
+        for (block=0;block<DATA_SIZE/0x800;block++) {
+            if (ref)
+                ref_decode_msadpcm_stereo(&vgmstream,out,block*(0x800-12),0x800-12);
+            else
+                decode_msadpcm_stereo(&vgmstream,out,block*(0x800-12),0x800-12);
+        }
+    }
+    return (double)(clock() - start) * 1000.0 / CLOCKS_PER_SEC;
+}
+
+int main(int argc, char ** argv) {
+    int trials = argc > 1 ? atoi(argv[1]) : 200000;
+
+    check_dsp(trials);
+    check_psx(trials);
+    check_ms_ima(trials);
+    check_msadpcm(trials);
+    printf("%d trials per codec, %d mismatches\n",trials,failures);
+
+    printf("DSP      %6.1f ms -> %6.1f ms\n",time_dsp(1),time_dsp(0));
+    printf("PSX      %6.1f ms -> %6.1f ms\n",time_psx(1),time_psx(0));
+    printf("MS-IMA   %6.1f ms -> %6.1f ms\n",time_ms_ima(1),time_ms_ima(0));
+    printf("MSADPCM  %6.1f ms -> %6.1f ms\n",time_msadpcm(1),time_msadpcm(0));
+
+    return failures != 0;
+}
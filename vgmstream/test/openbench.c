@@ -0,0 +1,60 @@
+/*
+ * openbench: measures how long init_vgmstream takes to open (or reject) files
+ *
+ * Every file is opened and closed repeatedly through the stdio STREAMFILE,
+ * and the average time per open is printed along with the detected format,
+ * so a corpus with files near the start and the end of init_vgmstream_fcns,
+ * and files that nothing accepts, shows the cost of the format detection.
+ *
+ * There is no build system for vgmstream in this tree; build with e.g.
+ *   cc -O2 -DVAR_ARRAYS -I.. openbench.c <the .c files in .., ../coding, ../layout
+ *      and ../meta> -lm
+ *
+ * Usage: openbench [-n iterations] file...
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "../vgmstream.h"
+
+int main(int argc, char ** argv) {
+    int iterations = 200;
+    int first = 1;
+    int i, n;
+    double total = 0;
+
+    if (argc > 2 && !strcmp(argv[1],"-n")) {
+        iterations = atoi(argv[2]);
+        first = 3;
+    }
+    if (first >= argc || iterations <= 0) {
+        fprintf(stderr,"Usage: %s [-n iterations] file...\n",argv[0]);
+        return 1;
+    }
+
+    for (i=first;i<argc;i++) {
+        const char * name = argv[i];
+        char description[64] = "not recognised";
+        clock_t start;
+        double us;
+
+        start = clock();
+        for (n=0;n<iterations;n++) {
+            VGMSTREAM * vgmstream = init_vgmstream(name);
+            if (vgmstream) {
+                if (n == 0)
+                    snprintf(description,sizeof(description),"meta %d, coding %d",
+                            (int)vgmstream->meta_type,(int)vgmstream->coding_type);
+                close_vgmstream(vgmstream);
+            }
+        }
+        us = (double)(clock() - start) * 1000000.0 / CLOCKS_PER_SEC / iterations;
+        total += us;
+
+        printf("%9.1f us  %-24s %s\n",us,description,name);
+    }
+    printf("%9.1f us  total\n",total);
+
+    return 0;
+}
@@ -0,0 +1,147 @@
+/*
+ * seekcheck: checks that seek_vgmstream gives the same samples as decoding
+ * the stream straight from the start
+ *
+ * Synthetic CD-XA files (blocked layout, decoder state kept in the VGMSTREAM)
+ * are written to the temporary directory, decoded once from the start, and
+ * then seeked to random positions, forward and back. The samples decoded
+ * after every seek must be identical to the straight decode.
+ *
+ * There is no build system for vgmstream in this tree; build with e.g.
+ *   cc -O2 -DVAR_ARRAYS -I.. seekcheck.c <the .c files in .., ../coding, ../layout
+ *      and ../meta> -lm
+ *
+ * Usage: seekcheck [seeks]
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../vgmstream.h"
+#include "../util.h"
+
+#define XA_SECTOR_SIZE 2352
+#define CHECK_SAMPLES 3000
+
+static uint32_t rng_state = 0x2468ACE0;
+
+static uint32_t rng(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+/* RIFF CDXA with the given count of raw sectors, sound groups of random
+ * samples with valid filter and range parameters */
+static int write_cdxa(const char * path, int sectors, uint8_t coding) {
+    size_t size = 0x2C + (size_t)sectors * XA_SECTOR_SIZE;
+    uint8_t * buf = calloc(1,size);
+    FILE * f;
+    int s, g, i;
+
+    if (!buf) return 0;
+    memcpy(buf+0x00,"RIFF",4);
+    put_32bitLE(buf+0x04,(int32_t)(size-8));
+    memcpy(buf+0x08,"CDXA",4);
+    memcpy(buf+0x0C,"fmt ",4);
+    put_32bitLE(buf+0x10,0x10);
+    memcpy(buf+0x24,"data",4);
+    put_32bitLE(buf+0x28,(int32_t)(size-0x2C));
+
+    for (s=0;s<sectors;s++) {
+        uint8_t * sector = buf + 0x2C + (size_t)s*XA_SECTOR_SIZE;
+
+        memset(sector+1,0xFF,10); /* sync */
+        sector[0x11] = 0;         /* channel */
+        sector[0x12] = 0x64;      /* audio */
+        sector[0x13] = coding;
+
+        for (g=0;g<18;g++) {
+            uint8_t * group = sector + 0x18 + g*128;
+            for (i=0;i<16;i++)
+                group[i] = (uint8_t)(((rng() % 4) << 4) | (rng() % 13));
+            for (i=16;i<128;i++)
+                group[i] = (uint8_t)rng();
+        }
+    }
+
+    f = fopen(path,"wb");
+    if (!f || fwrite(buf,1,size,f) != size) {
+        if (f) fclose(f);
+        free(buf);
+        return 0;
+    }
+    fclose(f);
+    free(buf);
+    return 1;
+}
+
+static int check_file(const char * name, const char * path, int seeks) {
+    VGMSTREAM * vgmstream = init_vgmstream(path);
+    sample * straight;
+    sample * out;
+    int32_t num_samples, pos;
+    int channels, i, failures = 0;
+
+    if (!vgmstream) {
+        printf("%s: can't open\n",name);
+        return 1;
+    }
+    channels = vgmstream->channels;
+    num_samples = vgmstream->num_samples;
+
+    straight = malloc(sizeof(sample)*channels*num_samples);
+    out = malloc(sizeof(sample)*channels*CHECK_SAMPLES);
+    if (!straight || !out) {
+        close_vgmstream(vgmstream);
+        free(straight);
+        free(out);
+        return 1;
+    }
+
+    for (pos=0;pos<num_samples;pos+=0x400) {
+        int32_t n = num_samples - pos < 0x400 ? num_samples - pos : 0x400;
+        render_vgmstream(straight+pos*channels,n,vgmstream);
+    }
+
+    for (i=0;i<seeks;i++) {
+        int32_t n;
+
+        pos = (int32_t)(rng() % (uint32_t)num_samples);
+        n = num_samples - pos < CHECK_SAMPLES ? num_samples - pos : CHECK_SAMPLES;
+
+        seek_vgmstream(vgmstream,pos);
+        render_vgmstream(out,n,vgmstream);
+        if (memcmp(out,straight+pos*channels,sizeof(sample)*channels*n) != 0)
+            failures++;
+    }
+
+    printf("%s: %d samples, %d of %d seeks differ\n",name,num_samples,failures,seeks);
+
+    close_vgmstream(vgmstream);
+    free(straight);
+    free(out);
+    return failures != 0;
+}
+
+int main(int argc, char ** argv) {
+    int seeks = argc > 1 ? atoi(argv[1]) : 200;
+    const char * tmp = getenv("TMPDIR");
+    char path[PATH_LIMIT];
+    int failed = 0;
+
+    if (!tmp) tmp = "/tmp";
+
+    snprintf(path,sizeof(path),"%s/seekcheck_stereo.xa",tmp);
+    if (!write_cdxa(path,60,0x01)) return 1;
+    failed |= check_file("CD-XA stereo",path,seeks);
+    remove(path);
+
+    snprintf(path,sizeof(path),"%s/seekcheck_mono.xa",tmp);
+    if (!write_cdxa(path,30,0x04)) return 1;
+    failed |= check_file("CD-XA mono",path,seeks);
+    remove(path);
+
+    printf(failed ? "FAILED\n" : "OK\n");
+    return failed;
+}
@@ -12,385 +12,458 @@
 
 /*
  * List of functions that will recognize files. These should correspond pretty
- * directly to the metadata types
+ * directly to the metadata types.
+ *
+ * Each function is listed with the extensions it accepts and/or the id at
+ * 0x00 it requires, so init_vgmstream_internal can skip the ones that would
+ * fail anyway. They are only hints: a function without them is always tried,
+ * and anything skipped is still tried if nothing else recognizes the file.
  */
-VGMSTREAM * (*init_vgmstream_fcns[])(STREAMFILE *streamFile) = {
-    init_vgmstream_adx,
-    init_vgmstream_brstm,
-	init_vgmstream_bfwav,
-	init_vgmstream_bfstm,
-	init_vgmstream_mca,
-	init_vgmstream_btsnd,
-    init_vgmstream_nds_strm,
-    init_vgmstream_agsc,
-    init_vgmstream_ngc_adpdtk,
-    init_vgmstream_rsf,
-    init_vgmstream_afc,
-    init_vgmstream_ast,
-    init_vgmstream_halpst,
-    init_vgmstream_rs03,
-    init_vgmstream_ngc_dsp_std,
-	 init_vgmstream_ngc_dsp_csmp,
-    init_vgmstream_Cstr,
-    init_vgmstream_gcsw,
-    init_vgmstream_ps2_ads,
-    init_vgmstream_ps2_npsf,
-    init_vgmstream_rwsd,
-    init_vgmstream_cdxa,
-    init_vgmstream_ps2_rxw,
-    init_vgmstream_ps2_int,
-    init_vgmstream_ngc_dsp_stm,
-    init_vgmstream_ps2_exst,
-    init_vgmstream_ps2_svag,
-    init_vgmstream_ps2_mib,
-    init_vgmstream_ngc_mpdsp,
-    init_vgmstream_ps2_mic,
-    init_vgmstream_ngc_dsp_std_int,
-    init_vgmstream_raw,
-    init_vgmstream_ps2_vag,
-    init_vgmstream_psx_gms,
-    init_vgmstream_ps2_str,
-    init_vgmstream_ps2_ild,
-    init_vgmstream_ps2_pnb,
-    init_vgmstream_xbox_wavm,
-    init_vgmstream_xbox_xwav,
-    init_vgmstream_ngc_str,
-    init_vgmstream_ea,
-    init_vgmstream_caf,
-    init_vgmstream_ps2_vpk,
-    init_vgmstream_genh,
+typedef struct {
+    VGMSTREAM * (*init)(STREAMFILE *streamFile);
+    const char * extensions;    /* comma-separated, lowercase, NULL for any */
+    uint32_t id;                /* big-endian id at 0x00, 0 for any */
+} meta_init_entry;
+
+static const meta_init_entry init_vgmstream_fcns[] = {
+    {init_vgmstream_adx, "adx", 0},
+    {init_vgmstream_brstm, NULL, 0x5253544D},
+	{init_vgmstream_bfwav, NULL, 0},
+	{init_vgmstream_bfstm, "bfstm", 0},
+	{init_vgmstream_mca, "mca", 0},
+	{init_vgmstream_btsnd, "btsnd", 0},
+    {init_vgmstream_nds_strm, "strm", 0},
+    {init_vgmstream_agsc, "agsc", 0},
+    {init_vgmstream_ngc_adpdtk, "adp,dtk", 0},
+    {init_vgmstream_rsf, "rsf", 0},
+    {init_vgmstream_afc, "afc", 0},
+    {init_vgmstream_ast, "ast", 0},
+    {init_vgmstream_halpst, "hps", 0},
+    {init_vgmstream_rs03, "dsp", 0},
+    {init_vgmstream_ngc_dsp_std, "dsp", 0},
+	 {init_vgmstream_ngc_dsp_csmp, "csmp", 0},
+    {init_vgmstream_Cstr, "dsp", 0},
+    {init_vgmstream_gcsw, "gcw", 0},
+    {init_vgmstream_ps2_ads, "ads,ss2", 0},
+    {init_vgmstream_ps2_npsf, "npsf", 0},
+    {init_vgmstream_rwsd, NULL, 0},
+    {init_vgmstream_cdxa, "xa", 0},
+    {init_vgmstream_ps2_rxw, "rxw", 0},
+    {init_vgmstream_ps2_int, "int,wp2", 0},
+    {init_vgmstream_ngc_dsp_stm, "stm,dsp", 0},
+    {init_vgmstream_ps2_exst, "sts", 0},
+    {init_vgmstream_ps2_svag, "svag", 0},
+    {init_vgmstream_ps2_mib, "mib,mi4,vb,xag", 0},
+    {init_vgmstream_ngc_mpdsp, "mpdsp", 0},
+    {init_vgmstream_ps2_mic, "mic", 0},
+    {init_vgmstream_ngc_dsp_std_int, NULL, 0},
+    {init_vgmstream_raw, "raw", 0},
+    {init_vgmstream_ps2_vag, "vag", 0},
+    {init_vgmstream_psx_gms, "gms", 0},
+    {init_vgmstream_ps2_str, "str", 0},
+    {init_vgmstream_ps2_ild, "ild", 0},
+    {init_vgmstream_ps2_pnb, "pnb", 0},
+    {init_vgmstream_xbox_wavm, "wavm", 0},
+    {init_vgmstream_xbox_xwav, "xwav", 0},
+    {init_vgmstream_ngc_str, "str", 0},
+    {init_vgmstream_ea, "strm,xa,sng,asf,str,xsf,eam", 0},
+    {init_vgmstream_caf, "cfn", 0},
+    {init_vgmstream_ps2_vpk, "vpk", 0},
+    {init_vgmstream_genh, "genh", 0},
 #ifdef VGM_USE_VORBIS
-    init_vgmstream_ogg_vorbis,
-    init_vgmstream_sli_ogg,
-    init_vgmstream_sfl,
+    {init_vgmstream_ogg_vorbis, NULL, 0},
+    {init_vgmstream_sli_ogg, "sli", 0},
+    {init_vgmstream_sfl, "sfl", 0},
 #endif
 #if 0
-	init_vgmstream_mp4_aac,
+	{init_vgmstream_mp4_aac, NULL, 0},
 #endif
 #if defined(VGM_USE_MP4V2) && defined(VGM_USE_FDKAAC)
-	init_vgmstream_akb,
+	{init_vgmstream_akb, NULL, 0x414B4220},
 #endif
-    init_vgmstream_sadb,
-    init_vgmstream_ps2_bmdx,
-    init_vgmstream_wsi,
-    init_vgmstream_aifc,
-    init_vgmstream_str_snds,
-    init_vgmstream_ws_aud,
+    {init_vgmstream_sadb, "sad", 0},
+    {init_vgmstream_ps2_bmdx, "bmdx", 0},
+    {init_vgmstream_wsi, "wsi", 0},
+    {init_vgmstream_aifc, NULL, 0},
+    {init_vgmstream_str_snds, "str", 0},
+    {init_vgmstream_ws_aud, "aud", 0},
 #ifdef VGM_USE_MPEG
-    init_vgmstream_ahx,
+    {init_vgmstream_ahx, "ahx", 0},
 #endif
-    init_vgmstream_ivb,
-    init_vgmstream_amts,
-    init_vgmstream_svs,
-    init_vgmstream_riff,
-    init_vgmstream_rifx,
-    init_vgmstream_pos,
-    init_vgmstream_nwa,
-    init_vgmstream_eacs,
-    init_vgmstream_xss,
-    init_vgmstream_sl3,
-    init_vgmstream_hgc1,
-    init_vgmstream_aus,
-    init_vgmstream_rws,
-    init_vgmstream_fsb1,
+    {init_vgmstream_ivb, "ivb", 0},
+    {init_vgmstream_amts, "amts", 0},
+    {init_vgmstream_svs, "svs", 0},
+    {init_vgmstream_riff, NULL, 0x52494646},
+    {init_vgmstream_rifx, "wav,lwav", 0},
+    {init_vgmstream_pos, "pos", 0},
+    {init_vgmstream_nwa, "nwa", 0},
+    {init_vgmstream_eacs, "cnk,as4,asf", 0},
+    {init_vgmstream_xss, "xss", 0},
+    {init_vgmstream_sl3, "sl3", 0},
+    {init_vgmstream_hgc1, "hgc1", 0},
+    {init_vgmstream_aus, "aus", 0},
+    {init_vgmstream_rws, "rws", 0},
+    {init_vgmstream_fsb1, "fsb", 0},
     // init_vgmstream_fsb2,
-    init_vgmstream_fsb3,
-    init_vgmstream_fsb4,
-    init_vgmstream_fsb4_wav,
-    init_vgmstream_fsb5,
-    init_vgmstream_rwx,
-    init_vgmstream_xwb,
-    init_vgmstream_xwb2,
-    init_vgmstream_xa30,
-    init_vgmstream_musc,
-    init_vgmstream_musx_v004,
-    init_vgmstream_musx_v005,
-    init_vgmstream_musx_v006,
-    init_vgmstream_musx_v010,
-    init_vgmstream_musx_v201,
-    init_vgmstream_leg,
-    init_vgmstream_filp,
-    init_vgmstream_ikm,
-    init_vgmstream_sfs,
-    init_vgmstream_bg00,
-    init_vgmstream_dvi,
-    init_vgmstream_kcey,
-    init_vgmstream_ps2_rstm,
-    init_vgmstream_acm,
-    init_vgmstream_mus_acm,
-    init_vgmstream_ps2_kces,
-    init_vgmstream_ps2_dxh,
-    init_vgmstream_ps2_psh,
-    init_vgmstream_pcm_scd,
-	  init_vgmstream_pcm_ps2,
-    init_vgmstream_ps2_rkv,
-    init_vgmstream_ps2_psw,
-    init_vgmstream_ps2_vas,
-    init_vgmstream_ps2_tec,
-    init_vgmstream_ps2_enth,
-    init_vgmstream_sdt,
-    init_vgmstream_aix,
-    init_vgmstream_ngc_tydsp,
-    init_vgmstream_ngc_swd,
-    init_vgmstream_capdsp,
-    init_vgmstream_xbox_wvs,
-    init_vgmstream_ngc_wvs,
-    init_vgmstream_dc_str,
-    init_vgmstream_dc_str_v2,
-    init_vgmstream_xbox_stma,
-    init_vgmstream_xbox_matx,
-    init_vgmstream_de2,
-    init_vgmstream_vs,
-    init_vgmstream_dc_str,
-    init_vgmstream_dc_str_v2,
-    init_vgmstream_xbox_xmu,
-    init_vgmstream_xbox_xvas,
-    init_vgmstream_ngc_bh2pcm,
-    init_vgmstream_sat_sap,
-    init_vgmstream_dc_idvi,
-    init_vgmstream_ps2_rnd,
-    init_vgmstream_wii_idsp,
-    init_vgmstream_kraw,
-    init_vgmstream_ps2_omu,
-    init_vgmstream_ps2_xa2,
+    {init_vgmstream_fsb3, "fsb", 0},
+    {init_vgmstream_fsb4, "fsb,wii", 0},
+    {init_vgmstream_fsb4_wav, "fsb", 0},
+    {init_vgmstream_fsb5, "fsb", 0},
+    {init_vgmstream_rwx, "rwx", 0},
+    {init_vgmstream_xwb, "xwb", 0},
+    {init_vgmstream_xwb2, "xwb", 0},
+    {init_vgmstream_xa30, "xa30", 0},
+    {init_vgmstream_musc, "mus,musc", 0},
+    {init_vgmstream_musx_v004, "musx", 0},
+    {init_vgmstream_musx_v005, "musx", 0},
+    {init_vgmstream_musx_v006, "musx", 0},
+    {init_vgmstream_musx_v010, "musx", 0},
+    {init_vgmstream_musx_v201, "musx", 0},
+    {init_vgmstream_leg, "leg", 0},
+    {init_vgmstream_filp, "filp", 0},
+    {init_vgmstream_ikm, "ikm", 0},
+    {init_vgmstream_sfs, "sfs", 0},
+    {init_vgmstream_bg00, "bg00", 0},
+    {init_vgmstream_dvi, "dvi", 0},
+    {init_vgmstream_kcey, "kcey", 0},
+    {init_vgmstream_ps2_rstm, "rstm", 0},
+    {init_vgmstream_acm, "acm", 0},
+    {init_vgmstream_mus_acm, "mus", 0},
+    {init_vgmstream_ps2_kces, "kces,vig", 0},
+    {init_vgmstream_ps2_dxh, "dxh", 0},
+    {init_vgmstream_ps2_psh, "psh", 0},
+    {init_vgmstream_pcm_scd, "pcm", 0},
+	  {init_vgmstream_pcm_ps2, "pcm", 0},
+    {init_vgmstream_ps2_rkv, "rkv", 0},
+    {init_vgmstream_ps2_psw, "psw", 0},
+    {init_vgmstream_ps2_vas, "vas", 0},
+    {init_vgmstream_ps2_tec, "tec", 0},
+    {init_vgmstream_ps2_enth, "enth", 0},
+    {init_vgmstream_sdt, "sdt", 0},
+    {init_vgmstream_aix, "aix", 0},
+    {init_vgmstream_ngc_tydsp, "tydsp", 0},
+    {init_vgmstream_ngc_swd, "swd", 0},
+    {init_vgmstream_capdsp, "capdsp", 0},
+    {init_vgmstream_xbox_wvs, "wvs", 0},
+    {init_vgmstream_ngc_wvs, "wvs", 0},
+    {init_vgmstream_dc_str, "str", 0},
+    {init_vgmstream_dc_str_v2, "str", 0},
+    {init_vgmstream_xbox_stma, "stma", 0},
+    {init_vgmstream_xbox_matx, "matx", 0},
+    {init_vgmstream_de2, "de2", 0},
+    {init_vgmstream_vs, "vs", 0},
+    {init_vgmstream_dc_str, "str", 0},
+    {init_vgmstream_dc_str_v2, "str", 0},
+    {init_vgmstream_xbox_xmu, "xmu", 0},
+    {init_vgmstream_xbox_xvas, "xvas", 0},
+    {init_vgmstream_ngc_bh2pcm, "bh2pcm", 0},
+    {init_vgmstream_sat_sap, "sap", 0},
+    {init_vgmstream_dc_idvi, "idvi", 0},
+    {init_vgmstream_ps2_rnd, "rnd", 0},
+    {init_vgmstream_wii_idsp, NULL, 0x49445350},
+    {init_vgmstream_kraw, "kraw", 0},
+    {init_vgmstream_ps2_omu, "omu", 0},
+    {init_vgmstream_ps2_xa2, "xa2", 0},
     //init_vgmstream_idsp,
-    init_vgmstream_idsp2,
-    init_vgmstream_idsp3,
-    init_vgmstream_idsp4,
-    init_vgmstream_ngc_ymf,
-    init_vgmstream_sadl,
-    init_vgmstream_ps2_ccc,
-    init_vgmstream_psx_fag,
-    init_vgmstream_ps2_mihb,
-    init_vgmstream_ngc_pdt,
-    init_vgmstream_wii_mus,
-    init_vgmstream_dc_asd,
-    init_vgmstream_naomi_spsd,
-
-    init_vgmstream_rsd2vag,
-    init_vgmstream_rsd2pcmb,
-    init_vgmstream_rsd2xadp,
-	init_vgmstream_rsd3vag,
-	init_vgmstream_rsd3gadp,
-    init_vgmstream_rsd3pcm,
-	init_vgmstream_rsd3pcmb,
-    init_vgmstream_rsd4pcmb,
-    init_vgmstream_rsd4pcm,
-	init_vgmstream_rsd4radp,
-    init_vgmstream_rsd4vag,
-    init_vgmstream_rsd6vag,
-    init_vgmstream_rsd6wadp,
-    init_vgmstream_rsd6xadp,
-    init_vgmstream_rsd6radp,
-    init_vgmstream_bgw,
-    init_vgmstream_spw,
-    init_vgmstream_ps2_ass,
-    init_vgmstream_waa_wac_wad_wam,
-    init_vgmstream_seg,
-    init_vgmstream_nds_strm_ffta2,
-    init_vgmstream_str_asr,
-    init_vgmstream_zwdsp,
-    init_vgmstream_gca,
-    init_vgmstream_spt_spd,
-    init_vgmstream_ish_isd,
-    init_vgmstream_gsp_gsb,
-    init_vgmstream_ydsp,
-    init_vgmstream_msvp,
-    init_vgmstream_ngc_ssm,
-    init_vgmstream_ps2_joe,
-    init_vgmstream_vgs,
-    init_vgmstream_dc_dcsw_dcs,
-    init_vgmstream_wii_smp,
-    init_vgmstream_emff_ps2,
-    init_vgmstream_emff_ngc,
-    init_vgmstream_ss_stream,
-    init_vgmstream_thp,
-    init_vgmstream_wii_sts,
-    init_vgmstream_ps2_p2bt,
-    init_vgmstream_ps2_gbts,
-    init_vgmstream_wii_sng,
-    init_vgmstream_ngc_dsp_iadp,
-    init_vgmstream_aax,
-    init_vgmstream_utf_dsp,
-    init_vgmstream_ngc_ffcc_str,
-    init_vgmstream_sat_baka,
-    init_vgmstream_nds_swav,
-    init_vgmstream_ps2_vsf,
-    init_vgmstream_nds_rrds,
-    init_vgmstream_ps2_tk5,
-    init_vgmstream_ps2_vsf_tta,
-    init_vgmstream_ads,
-    init_vgmstream_wii_str,
-    init_vgmstream_ps2_mcg,
-    init_vgmstream_zsd,
-    init_vgmstream_ps2_vgs,
-    init_vgmstream_RedSpark,
-    init_vgmstream_ivaud,
-    init_vgmstream_wii_wsd,
-    init_vgmstream_wii_ndp,
-    init_vgmstream_ps2_sps,
-    init_vgmstream_ps2_xa2_rrp,
-    init_vgmstream_nds_hwas,
-	  init_vgmstream_ngc_lps,
-    init_vgmstream_ps2_snd,
-    init_vgmstream_naomi_adpcm,
-	  init_vgmstream_sd9,
-	  init_vgmstream_2dx9,
-	  init_vgmstream_dsp_ygo,
-    init_vgmstream_ps2_vgv,
-    init_vgmstream_ngc_gcub,
-    init_vgmstream_maxis_xa,
-    init_vgmstream_ngc_sck_dsp,
-    init_vgmstream_apple_caff,
-	  init_vgmstream_pc_mxst,
-	  init_vgmstream_sab,
-    init_vgmstream_exakt_sc,
-    init_vgmstream_wii_bns,
-    init_vgmstream_wii_was,
-    init_vgmstream_pona_3do,
-    init_vgmstream_pona_psx,
-    init_vgmstream_xbox_hlwav,
-    init_vgmstream_stx,
-    init_vgmstream_ps2_stm,
-    init_vgmstream_myspd,
-    init_vgmstream_his,
-	  init_vgmstream_ps2_ast,
-	  init_vgmstream_dmsg,
-    init_vgmstream_ngc_dsp_aaap,
-    init_vgmstream_ngc_dsp_konami,
-    init_vgmstream_ps2_ster,
-    init_vgmstream_ps2_wb,
-    init_vgmstream_bnsf,
+    {init_vgmstream_idsp2, "idsp", 0},
+    {init_vgmstream_idsp3, "idsp", 0},
+    {init_vgmstream_idsp4, "idsp", 0},
+    {init_vgmstream_ngc_ymf, "ymf", 0},
+    {init_vgmstream_sadl, "sad", 0},
+    {init_vgmstream_ps2_ccc, "ccc", 0},
+    {init_vgmstream_psx_fag, "fag", 0},
+    {init_vgmstream_ps2_mihb, "mihb", 0},
+    {init_vgmstream_ngc_pdt, "pdt", 0},
+    {init_vgmstream_wii_mus, "mus", 0},
+    {init_vgmstream_dc_asd, "asd", 0},
+    {init_vgmstream_naomi_spsd, "spsd", 0},
+
+    {init_vgmstream_rsd2vag, "rsd", 0},
+    {init_vgmstream_rsd2pcmb, "rsd", 0},
+    {init_vgmstream_rsd2xadp, "rsd", 0},
+	{init_vgmstream_rsd3vag, "rsd", 0},
+	{init_vgmstream_rsd3gadp, "rsd", 0},
+    {init_vgmstream_rsd3pcm, "rsd", 0},
+	{init_vgmstream_rsd3pcmb, "rsd", 0},
+    {init_vgmstream_rsd4pcmb, "rsd", 0},
+    {init_vgmstream_rsd4pcm, "rsd", 0},
+	{init_vgmstream_rsd4radp, "rsd", 0},
+    {init_vgmstream_rsd4vag, "rsd", 0},
+    {init_vgmstream_rsd6vag, "rsd", 0},
+    {init_vgmstream_rsd6wadp, "rsd", 0},
+    {init_vgmstream_rsd6xadp, "rsd", 0},
+    {init_vgmstream_rsd6radp, "rsd", 0},
+    {init_vgmstream_bgw, "bgw", 0},
+    {init_vgmstream_spw, "spw", 0},
+    {init_vgmstream_ps2_ass, "ass", 0},
+    {init_vgmstream_waa_wac_wad_wam, "waa,wac,wad,wam", 0},
+    {init_vgmstream_seg, "seg", 0},
+    {init_vgmstream_nds_strm_ffta2, "strm", 0},
+    {init_vgmstream_str_asr, "str,asr", 0},
+    {init_vgmstream_zwdsp, "zwdsp", 0},
+    {init_vgmstream_gca, "gca", 0},
+    {init_vgmstream_spt_spd, "spd", 0},
+    {init_vgmstream_ish_isd, "isd", 0},
+    {init_vgmstream_gsp_gsb, "gsb", 0},
+    {init_vgmstream_ydsp, "ydsp", 0},
+    {init_vgmstream_msvp, "msvp", 0},
+    {init_vgmstream_ngc_ssm, "ssm", 0},
+    {init_vgmstream_ps2_joe, "joe", 0},
+    {init_vgmstream_vgs, "vgs", 0},
+    {init_vgmstream_dc_dcsw_dcs, "dcs", 0},
+    {init_vgmstream_wii_smp, "smp", 0},
+    {init_vgmstream_emff_ps2, "emff", 0},
+    {init_vgmstream_emff_ngc, "emff", 0},
+    {init_vgmstream_ss_stream, "ss3,ss7", 0},
+    {init_vgmstream_thp, "thp,dsp", 0},
+    {init_vgmstream_wii_sts, "sts", 0},
+    {init_vgmstream_ps2_p2bt, "p2bt", 0},
+    {init_vgmstream_ps2_gbts, "gbts", 0},
+    {init_vgmstream_wii_sng, "sng", 0},
+    {init_vgmstream_ngc_dsp_iadp, "iadp", 0},
+    {init_vgmstream_aax, "aax", 0},
+    {init_vgmstream_utf_dsp, NULL, 0},
+    {init_vgmstream_ngc_ffcc_str, "str", 0},
+    {init_vgmstream_sat_baka, "baka", 0},
+    {init_vgmstream_nds_swav, "swav", 0},
+    {init_vgmstream_ps2_vsf, "vsf", 0},
+    {init_vgmstream_nds_rrds, "rrds", 0},
+    {init_vgmstream_ps2_tk5, "tk5", 0},
+    {init_vgmstream_ps2_vsf_tta, "vsf", 0},
+    {init_vgmstream_ads, "ads", 0},
+    {init_vgmstream_wii_str, "str", 0},
+    {init_vgmstream_ps2_mcg, "mcg", 0},
+    {init_vgmstream_zsd, "zsd", 0},
+    {init_vgmstream_ps2_vgs, "vgs", 0},
+    {init_vgmstream_RedSpark, "rsd", 0},
+    {init_vgmstream_ivaud, "ivaud", 0},
+    {init_vgmstream_wii_wsd, "wsd", 0},
+    {init_vgmstream_wii_ndp, "ndp", 0},
+    {init_vgmstream_ps2_sps, "sps", 0},
+    {init_vgmstream_ps2_xa2_rrp, "xa2", 0},
+    {init_vgmstream_nds_hwas, "hwas", 0},
+	  {init_vgmstream_ngc_lps, "lps", 0},
+    {init_vgmstream_ps2_snd, "snd", 0},
+    {init_vgmstream_naomi_adpcm, "adpcm", 0},
+	  {init_vgmstream_sd9, "sd9", 0},
+	  {init_vgmstream_2dx9, "2dx9", 0},
+	  {init_vgmstream_dsp_ygo, "dsp", 0},
+    {init_vgmstream_ps2_vgv, "vgv", 0},
+    {init_vgmstream_ngc_gcub, "gcub", 0},
+    {init_vgmstream_maxis_xa, "xa", 0},
+    {init_vgmstream_ngc_sck_dsp, "sck", 0},
+    {init_vgmstream_apple_caff, "caf", 0},
+	  {init_vgmstream_pc_mxst, "mxst", 0},
+	  {init_vgmstream_sab, "sab", 0},
+    {init_vgmstream_exakt_sc, "sc", 0},
+    {init_vgmstream_wii_bns, "bns", 0},
+    {init_vgmstream_wii_was, NULL, 0x69535753},
+    {init_vgmstream_pona_3do, "pona", 0},
+    {init_vgmstream_pona_psx, "pona", 0},
+    {init_vgmstream_xbox_hlwav, "hlwav", 0},
+    {init_vgmstream_stx, "stx", 0},
+    {init_vgmstream_ps2_stm, "ps2stm", 0},
+    {init_vgmstream_myspd, "myspd", 0},
+    {init_vgmstream_his, "his", 0},
+	  {init_vgmstream_ps2_ast, "ast", 0},
+	  {init_vgmstream_dmsg, "dmsg", 0},
+    {init_vgmstream_ngc_dsp_aaap, "dsp", 0},
+    {init_vgmstream_ngc_dsp_konami, "dsp", 0},
+    {init_vgmstream_ps2_ster, "ster", 0},
+    {init_vgmstream_ps2_wb, "wb", 0},
+    {init_vgmstream_bnsf, "bnsf", 0},
 #ifdef VGM_USE_G7221
-    init_vgmstream_s14_sss,
+    {init_vgmstream_s14_sss, NULL, 0},
 #endif
-    init_vgmstream_ps2_gcm,
-    init_vgmstream_ps2_smpl,
-    init_vgmstream_ps2_msa,
-    init_vgmstream_ps2_voi,
-    init_vgmstream_ps2_khv,
-    init_vgmstream_pc_smp,
-    init_vgmstream_ngc_bo2,
-    init_vgmstream_dsp_ddsp,
-    init_vgmstream_p3d,
-	init_vgmstream_ps2_tk1,
-	init_vgmstream_ps2_adsc,
-    init_vgmstream_ngc_dsp_mpds,
-    init_vgmstream_dsp_str_ig,
-    init_vgmstream_psx_mgav,
-    init_vgmstream_ngc_dsp_sth_str1,
-    init_vgmstream_ngc_dsp_sth_str2,
-    init_vgmstream_ngc_dsp_sth_str3,
-    init_vgmstream_ps2_b1s,
-    init_vgmstream_ps2_wad,
-    init_vgmstream_dsp_xiii,
-    init_vgmstream_dsp_cabelas,
-    init_vgmstream_ps2_adm,
-	  init_vgmstream_ps2_lpcm,
-    init_vgmstream_dsp_bdsp,
-	  init_vgmstream_ps2_vms,
-	  init_vgmstream_ps2_xau,
-    init_vgmstream_gh3_bar,
-    init_vgmstream_ffw,
-    init_vgmstream_dsp_dspw,
-    init_vgmstream_ps2_jstm,
-    init_vgmstream_ps3_xvag,
-	  init_vgmstream_ps3_cps,
-    init_vgmstream_sqex_scd,
-    init_vgmstream_ngc_nst_dsp,
-    init_vgmstream_baf,
-    init_vgmstream_ps3_msf,
-    init_vgmstream_fsb_mpeg,
-	init_vgmstream_nub_vag,
-	init_vgmstream_ps3_past,
-    init_vgmstream_ps3_sgh_sgb,
-	init_vgmstream_ngca,
-	init_vgmstream_wii_ras,
-	init_vgmstream_ps2_spm,
-	init_vgmstream_x360_tra,
-	init_vgmstream_ps2_iab,
-	init_vgmstream_ps2_strlr,
-    init_vgmstream_lsf_n1nj4n,
-	init_vgmstream_ps3_vawx,
-    init_vgmstream_pc_snds,
-	init_vgmstream_ps2_wmus,
-	init_vgmstream_hyperscan_kvag,
-	init_vgmstream_ios_psnd,
-    init_vgmstream_bos_adp,
-    init_vgmstream_eb_sfx,
-    init_vgmstream_eb_sf0,
-	init_vgmstream_ps3_klbs,
-	init_vgmstream_ps3_sgx,
-    init_vgmstream_ps2_mtaf,
-	init_vgmstream_tun,
-	init_vgmstream_wpd,
-	init_vgmstream_ps3_sgd,
-	init_vgmstream_mn_str,
-	init_vgmstream_ps2_mss,
-	init_vgmstream_ps2_hsf,
-	init_vgmstream_ps3_ivag,
-	init_vgmstream_ps2_2pfs,
-    init_vgmstream_xnbm,
-	init_vgmstream_rsd6oogv,
-	init_vgmstream_ubi_ckd,
-	init_vgmstream_ps2_vbk,
-	init_vgmstream_otm,
-	init_vgmstream_bcstm,
-	init_vgmstream_3ds_idsp,
-	init_vgmstream_g1l,
+    {init_vgmstream_ps2_gcm, "gcm", 0},
+    {init_vgmstream_ps2_smpl, "smpl", 0},
+    {init_vgmstream_ps2_msa, "msa", 0},
+    {init_vgmstream_ps2_voi, "voi", 0},
+    {init_vgmstream_ps2_khv, "khv", 0},
+    {init_vgmstream_pc_smp, "smp", 0},
+    {init_vgmstream_ngc_bo2, "bo2", 0},
+    {init_vgmstream_dsp_ddsp, "ddsp", 0},
+    {init_vgmstream_p3d, "p3d", 0},
+	{init_vgmstream_ps2_tk1, "tk1", 0},
+	{init_vgmstream_ps2_adsc, "ads", 0},
+    {init_vgmstream_ngc_dsp_mpds, "dsp", 0},
+    {init_vgmstream_dsp_str_ig, "str", 0},
+    {init_vgmstream_psx_mgav, "str", 0},
+    {init_vgmstream_ngc_dsp_sth_str1, "sth", 0},
+    {init_vgmstream_ngc_dsp_sth_str2, "sth", 0},
+    {init_vgmstream_ngc_dsp_sth_str3, NULL, 0},
+    {init_vgmstream_ps2_b1s, "b1s", 0},
+    {init_vgmstream_ps2_wad, "wad", 0},
+    {init_vgmstream_dsp_xiii, "dsp", 0},
+    {init_vgmstream_dsp_cabelas, "dsp", 0},
+    {init_vgmstream_ps2_adm, "adm", 0},
+	  {init_vgmstream_ps2_lpcm, "lpcm", 0},
+    {init_vgmstream_dsp_bdsp, "bdsp", 0},
+	  {init_vgmstream_ps2_vms, "vms", 0},
+	  {init_vgmstream_ps2_xau, "xau", 0},
+    {init_vgmstream_gh3_bar, "bar", 0},
+    {init_vgmstream_ffw, "ffw", 0},
+    {init_vgmstream_dsp_dspw, NULL, 0},
+    {init_vgmstream_ps2_jstm, "stm,jstm", 0},
+    {init_vgmstream_ps3_xvag, "xvag", 0},
+	  {init_vgmstream_ps3_cps, "cps", 0},
+    {init_vgmstream_sqex_scd, NULL, 0},
+    {init_vgmstream_ngc_nst_dsp, "dsp", 0},
+    {init_vgmstream_baf, "baf", 0},
+    {init_vgmstream_ps3_msf, "msf", 0},
+    {init_vgmstream_fsb_mpeg, "fsb", 0},
+	{init_vgmstream_nub_vag, "vag", 0},
+	{init_vgmstream_ps3_past, "past", 0},
+    {init_vgmstream_ps3_sgh_sgb, "sgb", 0},
+	{init_vgmstream_ngca, "ngca", 0},
+	{init_vgmstream_wii_ras, "ras", 0},
+	{init_vgmstream_ps2_spm, "spm", 0},
+	{init_vgmstream_x360_tra, "tra", 0},
+	{init_vgmstream_ps2_iab, "iab", 0},
+	{init_vgmstream_ps2_strlr, "str", 0},
+    {init_vgmstream_lsf_n1nj4n, "lsf", 0},
+	{init_vgmstream_ps3_vawx, "vawx", 0},
+    {init_vgmstream_pc_snds, "snds", 0},
+	{init_vgmstream_ps2_wmus, "wmus", 0},
+	{init_vgmstream_hyperscan_kvag, "bvg", 0},
+	{init_vgmstream_ios_psnd, "psnd", 0},
+    {init_vgmstream_bos_adp, "adp", 0},
+    {init_vgmstream_eb_sfx, "sfx,sf0", 0},
+    {init_vgmstream_eb_sf0, "sf0", 0},
+	{init_vgmstream_ps3_klbs, "bnk", 0},
+	{init_vgmstream_ps3_sgx, "sgx", 0},
+    {init_vgmstream_ps2_mtaf, "mtaf", 0},
+	{init_vgmstream_tun, "tun", 0},
+	{init_vgmstream_wpd, "wpd", 0},
+	{init_vgmstream_ps3_sgd, "sgd", 0},
+	{init_vgmstream_mn_str, "mnstr", 0},
+	{init_vgmstream_ps2_mss, "mss", 0},
+	{init_vgmstream_ps2_hsf, "hsf", 0},
+	{init_vgmstream_ps3_ivag, "ivag", 0},
+	{init_vgmstream_ps2_2pfs, "2pfs", 0},
+    {init_vgmstream_xnbm, "xnb", 0},
+	{init_vgmstream_rsd6oogv, "rsd", 0},
+	{init_vgmstream_ubi_ckd, "ckd", 0},
+	{init_vgmstream_ps2_vbk, "vbk", 0},
+	{init_vgmstream_otm, "otm", 0},
+	{init_vgmstream_bcstm, "bcstm", 0},
+	{init_vgmstream_3ds_idsp, NULL, 0},
+	{init_vgmstream_g1l, "g1l", 0},
 #ifdef VGM_USE_VORBIS
-    init_vgmstream_hca,
+    {init_vgmstream_hca, NULL, 0},
 #endif
 };
 
 #define INIT_VGMSTREAM_FCNS (sizeof(init_vgmstream_fcns)/sizeof(init_vgmstream_fcns[0]))
 
+/* check if ext is one of the items of the comma-separated list */
+static int extension_in_list(const char * ext, const char * list) {
+    size_t ext_len = strlen(ext);
+
+    while (*list) {
+        const char * comma = strchr(list,',');
+        size_t len = comma ? (size_t)(comma - list) : strlen(list);
+
+        if (len == ext_len && !memcmp(list,ext,len))
+            return 1;
+        if (!comma)
+            break;
+        list = comma + 1;
+    }
+
+    return 0;
+}
+
+/* checks done after a format is recognized, returns 0 if it should be rejected */
+static int accept_vgmstream(VGMSTREAM * vgmstream, STREAMFILE *streamFile, int do_dfs) {
+    /* these are little hacky checks */
+
+    /* everything should have a reasonable sample rate
+     * (a verification of the metadata) */
+    if (!check_sample_rate(vgmstream->sample_rate))
+        return 0;
+
+    /* dual file stereo */
+    if (do_dfs && (
+                (vgmstream->meta_type == meta_DSP_STD) ||
+                (vgmstream->meta_type == meta_PS2_VAGp) ||
+                (vgmstream->meta_type == meta_GENH) ||
+                (vgmstream->meta_type == meta_KRAW) ||
+                (vgmstream->meta_type == meta_PS2_MIB) ||
+                (vgmstream->meta_type == meta_NGC_LPS) ||
+                (vgmstream->meta_type == meta_DSP_YGO) ||
+                (vgmstream->meta_type == meta_DSP_AGSC) ||
+                (vgmstream->meta_type == meta_PS2_SMPL) ||
+                (vgmstream->meta_type == meta_NGCA) ||
+                (vgmstream->meta_type == meta_NUB_VAG) ||
+                (vgmstream->meta_type == meta_SPT_SPD) ||
+                (vgmstream->meta_type == meta_EB_SFX)
+                ) && vgmstream->channels == 1) {
+        try_dual_file_stereo(vgmstream, streamFile);
+    }
+
+    /* save start things so we can restart for seeking */
+    /* copy the channels */
+    memcpy(vgmstream->start_ch,vgmstream->ch,sizeof(VGMSTREAMCHANNEL)*vgmstream->channels);
+    /* copy the whole VGMSTREAM */
+    memcpy(vgmstream->start_vgmstream,vgmstream,sizeof(VGMSTREAM));
+
+    return 1;
+}
+
 /* internal version with all parameters */
 VGMSTREAM * init_vgmstream_internal(STREAMFILE *streamFile, int do_dfs) {
-    int i;
-    
+    char filename[PATH_LIMIT];
+    char ext[0x10];
+    uint8_t header[0x04];
+    uint32_t id = 0;
+    uint8_t skipped[INIT_VGMSTREAM_FCNS];
+    int i, pass;
+
     if (!streamFile)
         return NULL;
 
-    /* try a series of formats, see which works */
-    for (i=0;i<INIT_VGMSTREAM_FCNS;i++) {
-        VGMSTREAM * vgmstream = (init_vgmstream_fcns[i])(streamFile);
-        if (vgmstream) {
-            /* these are little hacky checks */
-
-            /* everything should have a reasonable sample rate
-             * (a verification of the metadata) */
-            if (!check_sample_rate(vgmstream->sample_rate)) {
-                close_vgmstream(vgmstream);
+    /* the name and the id are the same for every format, get them once */
+    streamFile->get_name(streamFile,filename,sizeof(filename));
+    {
+        /* no listed extension is that long, so a longer one matches nothing */
+        const char * e = filename_extension(filename);
+        size_t n;
+        for (n=0;e[n] && n<sizeof(ext)-1;n++)
+            ext[n] = (e[n] >= 'A' && e[n] <= 'Z') ? e[n] - 'A' + 'a' : e[n];
+        ext[e[n] ? 0 : n] = '\0';
+    }
+    if (read_streamfile(header,0,0x04,streamFile) == 0x04)
+        id = get_32bitBE(header);
+
+    /* try a series of formats, see which works: first the ones that can
+     * take this extension or id, then the rest in case the hints are off */
+    for (pass=0;pass<2;pass++) {
+        for (i=0;i<INIT_VGMSTREAM_FCNS;i++) {
+            const meta_init_entry * entry = &init_vgmstream_fcns[i];
+            VGMSTREAM * vgmstream;
+
+            if (pass == 0) {
+                int candidate =
+                        (!entry->extensions && !entry->id) ||
+                        (entry->extensions && extension_in_list(ext,entry->extensions)) ||
+                        (entry->id && entry->id == id);
+                skipped[i] = !candidate;
+                if (!candidate)
+                    continue;
+            }
+            else if (!skipped[i]) {
                 continue;
             }
 
-            /* dual file stereo */
-            if (do_dfs && (
-                        (vgmstream->meta_type == meta_DSP_STD) ||
-                        (vgmstream->meta_type == meta_PS2_VAGp) ||
-                        (vgmstream->meta_type == meta_GENH) ||
-                        (vgmstream->meta_type == meta_KRAW) ||
-                        (vgmstream->meta_type == meta_PS2_MIB) ||
-                        (vgmstream->meta_type == meta_NGC_LPS) ||
-						 (vgmstream->meta_type == meta_DSP_YGO) ||
-                        (vgmstream->meta_type == meta_DSP_AGSC) ||
-						 (vgmstream->meta_type == meta_PS2_SMPL) ||
-						 (vgmstream->meta_type == meta_NGCA) ||
-		                (vgmstream->meta_type == meta_NUB_VAG) ||
-                        (vgmstream->meta_type == meta_SPT_SPD) ||
-                        (vgmstream->meta_type == meta_EB_SFX)
-                        ) && vgmstream->channels == 1) {
-                try_dual_file_stereo(vgmstream, streamFile);
-            }
-
-            /* save start things so we can restart for seeking */
-            /* copy the channels */
-            memcpy(vgmstream->start_ch,vgmstream->ch,sizeof(VGMSTREAMCHANNEL)*vgmstream->channels);
-            /* copy the whole VGMSTREAM */
-            memcpy(vgmstream->start_vgmstream,vgmstream,sizeof(VGMSTREAM));
-
-            return vgmstream;
+            vgmstream = (entry->init)(streamFile);
+            if (vgmstream) {
+                if (!accept_vgmstream(vgmstream, streamFile, do_dfs)) {
+                    close_vgmstream(vgmstream);
+                    continue;
+                }
+                return vgmstream;
+            }
         }
     }
 
@@ -400,7 +473,7 @@ VGMSTREAM * init_vgmstream_internal(STREAMFILE *streamFile, int do_dfs) {
 /* format detection and VGMSTREAM setup, uses default parameters */
 VGMSTREAM * init_vgmstream(const char * const filename) {
     VGMSTREAM *vgmstream = NULL;
-    STREAMFILE *streamFile = open_stdio_streamfile(filename);
+    STREAMFILE *streamFile = open_cached_streamfile(filename);
     if (streamFile) {
         vgmstream = init_vgmstream_from_STREAMFILE(streamFile);
         close_streamfile(streamFile);
@@ -412,11 +485,23 @@ VGMSTREAM * init_vgmstream_from_STREAMFILE(STREAMFILE *streamFile) {
     return init_vgmstream_internal(streamFile,1);
 }
 
+static void flush_resampler(void * data);
+
 /* Reset a VGMSTREAM to its state at the start of playback.
  * Note that this does not reset the constituent STREAMFILES. */
 void reset_vgmstream(VGMSTREAM * vgmstream) {
+    /* the seek table, the resampler and the decoding threads are made later
+     * than the start copy, keep them */
+    void * seek_table = vgmstream->seek_table;
+    void * resampler = vgmstream->resampler;
+    void * decode_pool = vgmstream->decode_pool;
+
     /* copy the vgmstream back into itself */
     memcpy(vgmstream,vgmstream->start_vgmstream,sizeof(VGMSTREAM));
+    vgmstream->seek_table = seek_table;
+    vgmstream->resampler = resampler;
+    vgmstream->decode_pool = decode_pool;
+    flush_resampler(resampler);
 
     /* copy the initial channels */
     memcpy(vgmstream->ch,vgmstream->start_ch,sizeof(VGMSTREAMCHANNEL)*vgmstream->channels);
@@ -615,6 +700,10 @@ VGMSTREAM * allocate_vgmstream(int channel_count, int looped) {
     return vgmstream;
 }
 
+static void free_seek_table(void * table);
+static void free_resampler(void * data);
+static void free_decode_pool(void * data);
+
 void close_vgmstream(VGMSTREAM * vgmstream) {
     int i,j;
     if (!vgmstream) return;
@@ -849,6 +938,9 @@ void close_vgmstream(VGMSTREAM * vgmstream) {
         }
     }
 
+    if (vgmstream->seek_table) free_seek_table(vgmstream->seek_table);
+    if (vgmstream->resampler) free_resampler(vgmstream->resampler);
+    if (vgmstream->decode_pool) free_decode_pool(vgmstream->decode_pool);
     if (vgmstream->loop_ch) free(vgmstream->loop_ch);
     if (vgmstream->start_ch) free(vgmstream->start_ch);
     if (vgmstream->ch) free(vgmstream->ch);
@@ -928,6 +1020,612 @@ void render_vgmstream(sample * buffer, int32_t sample_count, VGMSTREAM * vgmstre
     }
 }
 
+/* Codecs that decode one channel at a time and use the channel spacing only
+ * to step through the output. The others also read their data with it, or
+ * decode all channels at once into an interleaved buffer. */
+static int planar_decode_supported(VGMSTREAM * vgmstream) {
+    switch (vgmstream->coding_type) {
+        case coding_CRI_ADX:
+        case coding_CRI_ADX_enc_8:
+        case coding_CRI_ADX_enc_9:
+        case coding_NGC_DSP:
+        case coding_PCM16LE:
+        case coding_PCM16BE:
+        case coding_PCM8:
+        case coding_PCM8_U:
+        case coding_NDS_IMA:
+        case coding_DAT4_IMA:
+        case coding_MS_IMA:
+        case coding_RAD_IMA:
+        case coding_RAD_IMA_mono:
+        case coding_NGC_DTK:
+        case coding_G721:
+        case coding_NGC_AFC:
+        case coding_PSX:
+        case coding_PSX_badflags:
+        case coding_invert_PSX:
+        case coding_FFXI:
+        case coding_BAF_ADPCM:
+        case coding_EAXA:
+        case coding_EA_ADPCM:
+        case coding_SDX2:
+        case coding_CBD2:
+        case coding_DVI_IMA:
+        case coding_INT_DVI_IMA:
+        case coding_IMA:
+        case coding_INT_IMA:
+        case coding_APPLE_IMA4:
+        case coding_SNDS_IMA:
+        case coding_WS:
+#ifdef VGM_USE_G7221
+        case coding_G7221:
+        case coding_G7221C:
+#endif
+#ifdef VGM_USE_G719
+        case coding_G719:
+#endif
+#ifdef VGM_USE_MAIATRAC3PLUS
+        case coding_AT3plus:
+#endif
+        case coding_AICA:
+        case coding_NDS_PROCYON:
+        case coding_L5_555:
+        case coding_SASSC:
+        case coding_LSF:
+        case coding_MTAF:
+            return 1;
+        default:
+            return 0;
+    }
+}
+
+/* Layouts that write the output only through decode_vgmstream */
+static int planar_layout_supported(VGMSTREAM * vgmstream) {
+    switch (vgmstream->layout_type) {
+        case layout_acm:
+        case layout_mus_acm:
+        case layout_aix:
+        case layout_aax:
+        case layout_scd_int:
+            return 0;
+        default:
+            return 1;
+    }
+}
+
+/* Samples (of all channels) rendered at once when splitting the interleaved
+ * output of the codecs without planar support */
+#define PLANAR_CHUNK_SAMPLES 0x1000
+
+void render_vgmstream_planar(sample ** buffers, int32_t sample_count, VGMSTREAM * vgmstream) {
+    sample stack_interleaved[PLANAR_CHUNK_SAMPLES];
+    sample * interleaved = stack_interleaved;
+    int32_t samples_written = 0;
+    int32_t chunk_samples;
+    int chan;
+
+    /* one channel is laid out the same either way */
+    if (vgmstream->channels == 1) {
+        render_vgmstream(buffers[0],sample_count,vgmstream);
+        return;
+    }
+
+    if (planar_decode_supported(vgmstream) && planar_layout_supported(vgmstream)) {
+        vgmstream->planar_buffers = buffers;
+        render_vgmstream(NULL,sample_count,vgmstream);
+        vgmstream->planar_buffers = NULL;
+        return;
+    }
+
+    /* with more channels than that, one frame at a time on the heap */
+    chunk_samples = PLANAR_CHUNK_SAMPLES / vgmstream->channels;
+    if (chunk_samples < 1) {
+        chunk_samples = 1;
+        interleaved = malloc(sizeof(sample)*vgmstream->channels);
+        if (!interleaved) {
+            for (chan = 0; chan < vgmstream->channels; chan++)
+                memset(buffers[chan],0,sizeof(sample)*sample_count);
+            return;
+        }
+    }
+
+    while (samples_written < sample_count) {
+        int32_t samples_to_do = sample_count - samples_written;
+        if (samples_to_do > chunk_samples)
+            samples_to_do = chunk_samples;
+
+        render_vgmstream(interleaved,samples_to_do,vgmstream);
+        for (chan = 0; chan < vgmstream->channels; chan++) {
+            sample * out = buffers[chan] + samples_written;
+            const sample * in = interleaved + chan;
+            int32_t i;
+            for (i = 0; i < samples_to_do; i++)
+                out[i] = in[i*vgmstream->channels];
+        }
+        samples_written += samples_to_do;
+    }
+
+    if (interleaved != stack_interleaved)
+        free(interleaved);
+}
+
+/* Distance between the saved positions, in samples */
+#define SEEK_TABLE_INTERVAL 0x4000
+/* Samples decoded at once when going forward to the target */
+#define SEEK_DECODE_SAMPLES 0x400
+
+/* The stream state at one position: the same values looping saves at the
+ * loop start, the decoder and layout values kept in the VGMSTREAM, plus the
+ * loop values themselves, as reset_vgmstream restores them from the start copy */
+typedef struct {
+    int32_t samples_into_block;
+    off_t current_block_offset;
+    size_t current_block_size;
+    off_t next_block_offset;
+    int block_count;
+
+    int32_t xa_sector_length;
+    int8_t get_high_nibble;
+    int32_t ws_output_size;
+    int32_t thpNextFrameSize;
+
+    int hit_loop;
+    int32_t loop_sample;
+    int32_t loop_samples_into_block;
+    off_t loop_block_offset;
+    size_t loop_block_size;
+    off_t loop_next_block_offset;
+} seek_point;
+
+typedef struct {
+    int channels;
+    int32_t count;              /* saved positions, point i is at (i+1)*SEEK_TABLE_INTERVAL */
+    int32_t capacity;
+    seek_point * points;
+    VGMSTREAMCHANNEL * ch;      /* channels*capacity channel states */
+    sample * buffer;            /* decoded samples that are thrown away */
+} seek_table;
+
+static void free_seek_table(void * table) {
+    seek_table * st = table;
+
+    free(st->points);
+    free(st->ch);
+    free(st->buffer);
+    free(st);
+}
+
+static seek_table * get_seek_table(VGMSTREAM * vgmstream) {
+    seek_table * st = vgmstream->seek_table;
+
+    if (!st) {
+        st = calloc(1,sizeof(seek_table));
+        if (!st) return NULL;
+        st->channels = vgmstream->channels;
+        st->buffer = malloc(sizeof(sample)*SEEK_DECODE_SAMPLES*vgmstream->channels);
+        if (!st->buffer) {
+            free(st);
+            return NULL;
+        }
+        vgmstream->seek_table = st;
+    }
+
+    return st;
+}
+
+/* everything the position depends on has to be in the channels and the
+ * values saved in a seek_point; codecs and layouts with their own data can
+ * only be decoded from the start */
+static int seek_table_supported(VGMSTREAM * vgmstream) {
+    return vgmstream->codec_data == NULL;
+}
+
+static void save_seek_point(VGMSTREAM * vgmstream, seek_table * st) {
+    seek_point * point;
+
+    if (st->count == st->capacity) {
+        int32_t capacity = st->capacity ? st->capacity * 2 : 64;
+        seek_point * points = realloc(st->points,sizeof(seek_point)*capacity);
+        VGMSTREAMCHANNEL * ch;
+        if (!points) return;
+        st->points = points;
+        ch = realloc(st->ch,sizeof(VGMSTREAMCHANNEL)*st->channels*capacity);
+        if (!ch) return;
+        st->ch = ch;
+        st->capacity = capacity;
+    }
+
+    point = &st->points[st->count];
+    memcpy(&st->ch[st->count*st->channels],vgmstream->ch,sizeof(VGMSTREAMCHANNEL)*st->channels);
+    point->samples_into_block = vgmstream->samples_into_block;
+    point->current_block_offset = vgmstream->current_block_offset;
+    point->current_block_size = vgmstream->current_block_size;
+    point->next_block_offset = vgmstream->next_block_offset;
+    point->block_count = vgmstream->block_count;
+    point->xa_sector_length = vgmstream->xa_sector_length;
+    point->get_high_nibble = vgmstream->get_high_nibble;
+    point->ws_output_size = vgmstream->ws_output_size;
+    point->thpNextFrameSize = vgmstream->thpNextFrameSize;
+    point->hit_loop = vgmstream->hit_loop;
+    point->loop_sample = vgmstream->loop_sample;
+    point->loop_samples_into_block = vgmstream->loop_samples_into_block;
+    point->loop_block_offset = vgmstream->loop_block_offset;
+    point->loop_block_size = vgmstream->loop_block_size;
+    point->loop_next_block_offset = vgmstream->loop_next_block_offset;
+    st->count++;
+}
+
+static void restore_seek_point(VGMSTREAM * vgmstream, seek_table * st, int32_t index) {
+    seek_point * point = &st->points[index];
+
+    /* loop_ch isn't touched: the loop start was passed on the way to any
+     * point with hit_loop set, and loop_ch is never cleared */
+    memcpy(vgmstream->ch,&st->ch[index*st->channels],sizeof(VGMSTREAMCHANNEL)*st->channels);
+    vgmstream->current_sample = (index+1)*SEEK_TABLE_INTERVAL;
+    vgmstream->samples_into_block = point->samples_into_block;
+    vgmstream->current_block_offset = point->current_block_offset;
+    vgmstream->current_block_size = point->current_block_size;
+    vgmstream->next_block_offset = point->next_block_offset;
+    vgmstream->block_count = point->block_count;
+    vgmstream->xa_sector_length = point->xa_sector_length;
+    vgmstream->get_high_nibble = point->get_high_nibble;
+    vgmstream->ws_output_size = point->ws_output_size;
+    vgmstream->thpNextFrameSize = point->thpNextFrameSize;
+    vgmstream->hit_loop = point->hit_loop;
+    vgmstream->loop_sample = point->loop_sample;
+    vgmstream->loop_samples_into_block = point->loop_samples_into_block;
+    vgmstream->loop_block_offset = point->loop_block_offset;
+    vgmstream->loop_block_size = point->loop_block_size;
+    vgmstream->loop_next_block_offset = point->loop_next_block_offset;
+}
+
+void seek_vgmstream(VGMSTREAM * vgmstream, int32_t seek_sample) {
+    seek_table * st = NULL;
+    sample * buffer;
+    sample stack_dummy[SEEK_DECODE_SAMPLES];
+    sample * dummy = stack_dummy;
+
+    /* with more channels than that, one frame at a time on the heap */
+    if (vgmstream->channels > SEEK_DECODE_SAMPLES) {
+        dummy = malloc(sizeof(sample)*vgmstream->channels);
+        if (!dummy)
+            return;
+    }
+
+    /* positions past the loop end are played again inside the loop */
+    if (seek_sample < 0)
+        seek_sample = 0;
+    if (vgmstream->loop_flag && vgmstream->loop_end_sample > vgmstream->loop_start_sample &&
+            seek_sample >= vgmstream->loop_end_sample) {
+        seek_sample = vgmstream->loop_start_sample +
+                (seek_sample - vgmstream->loop_start_sample) % (vgmstream->loop_end_sample - vgmstream->loop_start_sample);
+    }
+    else if (seek_sample > vgmstream->num_samples) {
+        seek_sample = vgmstream->num_samples;
+    }
+
+    if (seek_table_supported(vgmstream))
+        st = get_seek_table(vgmstream);
+
+    /* start from the closest position before the target: the current one
+     * or a saved one, going back to the start only before the first */
+    if (st) {
+        int32_t index = seek_sample / SEEK_TABLE_INTERVAL - 1;
+        if (index >= st->count)
+            index = st->count - 1;
+        if (index >= 0 && (vgmstream->current_sample > seek_sample ||
+                    vgmstream->current_sample < (index+1)*SEEK_TABLE_INTERVAL)) {
+            restore_seek_point(vgmstream, st, index);
+        }
+        else if (vgmstream->current_sample > seek_sample) {
+            reset_vgmstream(vgmstream);
+        }
+    }
+    else if (vgmstream->current_sample > seek_sample) {
+        reset_vgmstream(vgmstream);
+    }
+
+    /* decode the rest, saving the positions not seen before on the way */
+    buffer = st ? st->buffer : NULL;
+    while (vgmstream->current_sample < seek_sample) {
+        int32_t samples_to_do = seek_sample - vgmstream->current_sample;
+        int32_t max_samples = buffer ? SEEK_DECODE_SAMPLES : SEEK_DECODE_SAMPLES / vgmstream->channels;
+
+        if (max_samples < 1)
+            max_samples = 1;
+        if (samples_to_do > max_samples)
+            samples_to_do = max_samples;
+        if (st) {
+            int32_t next_point = (st->count+1)*SEEK_TABLE_INTERVAL;
+            if (vgmstream->current_sample < next_point &&
+                    vgmstream->current_sample + samples_to_do > next_point)
+                samples_to_do = next_point - vgmstream->current_sample;
+        }
+
+        render_vgmstream(buffer ? buffer : dummy, samples_to_do, vgmstream);
+
+        if (st && vgmstream->current_sample == (st->count+1)*SEEK_TABLE_INTERVAL)
+            save_seek_point(vgmstream, st);
+    }
+
+    if (dummy != stack_dummy)
+        free(dummy);
+    flush_resampler(vgmstream->resampler);
+}
+
+
+/* Float output at any rate, with a windowed-sinc resampler working on the
+ * decoded chunks as they come out of render_vgmstream_planar */
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+/* Zero crossings of the sinc on each side, more when lowering the rate */
+#define RESAMPLE_ZERO_CROSSINGS 24
+#define RESAMPLE_MAX_TAPS 256
+/* Passband edge, relative to the lower of the two Nyquist frequencies */
+#define RESAMPLE_CUTOFF 0.9
+/* Filter phases in the table; when the rates need more, the position
+ * between two input samples is rounded to one of these */
+#define RESAMPLE_MAX_PHASES 512
+/* Input frames decoded at once */
+#define RESAMPLE_CHUNK 0x400
+
+typedef struct {
+    int32_t input_rate;
+    int32_t output_rate;
+    int channels;
+
+    /* output_rate/input_rate in lowest terms */
+    int32_t up;
+    int32_t down;
+
+    int taps;
+    int phases;
+    float * table;              /* phases+1 rows of taps coefficients */
+
+    float * history;            /* input of each channel, capacity frames apart */
+    int32_t capacity;
+    int32_t used;               /* frames in the history */
+    int32_t center;             /* next output is at center+phase/up */
+    int32_t phase;
+
+    sample * decode_buffer;     /* RESAMPLE_CHUNK frames of each channel */
+    sample ** decode_planes;
+} resampler;
+
+static void free_resampler(void * data) {
+    resampler * rs = data;
+    if (!rs) return;
+    free(rs->table);
+    free(rs->history);
+    free(rs->decode_buffer);
+    free(rs->decode_planes);
+    free(rs);
+}
+
+/* Forget the input, the next output starts at the current sample */
+static void flush_resampler(void * data) {
+    resampler * rs = data;
+    if (!rs) return;
+    rs->used = rs->taps/2 - 1;
+    rs->center = rs->used;
+    rs->phase = 0;
+    memset(rs->history,0,sizeof(float)*rs->capacity*rs->channels);
+}
+
+static int32_t gcd32(int32_t a, int32_t b) {
+    while (b) {
+        int32_t t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+static resampler * get_resampler(VGMSTREAM * vgmstream, int32_t output_rate) {
+    resampler * rs = vgmstream->resampler;
+    double cutoff;
+    int half, p, k, chan;
+
+    if (rs && rs->output_rate == output_rate && rs->input_rate == vgmstream->sample_rate)
+        return rs;
+
+    free_resampler(rs);
+    vgmstream->resampler = NULL;
+
+    rs = calloc(1,sizeof(resampler));
+    if (!rs) return NULL;
+    rs->input_rate = vgmstream->sample_rate;
+    rs->output_rate = output_rate;
+    rs->channels = vgmstream->channels;
+    rs->up = output_rate / gcd32(output_rate,vgmstream->sample_rate);
+    rs->down = vgmstream->sample_rate / gcd32(output_rate,vgmstream->sample_rate);
+
+    /* lowering the rate moves the cutoff down and widens the filter */
+    cutoff = rs->up < rs->down ? (double)rs->up / rs->down : 1.0;
+    half = (int)ceil(RESAMPLE_ZERO_CROSSINGS / cutoff);
+    half = (half+1) & ~1;
+    if (half > RESAMPLE_MAX_TAPS/2)
+        half = RESAMPLE_MAX_TAPS/2;
+    rs->taps = half*2;
+    rs->phases = rs->up < RESAMPLE_MAX_PHASES ? rs->up : RESAMPLE_MAX_PHASES;
+    cutoff *= RESAMPLE_CUTOFF;
+
+    rs->capacity = rs->taps + RESAMPLE_CHUNK;
+    rs->table = malloc(sizeof(float)*rs->taps*(rs->phases+1));
+    rs->history = malloc(sizeof(float)*rs->capacity*rs->channels);
+    rs->decode_buffer = malloc(sizeof(sample)*RESAMPLE_CHUNK*rs->channels);
+    rs->decode_planes = malloc(sizeof(sample *)*rs->channels);
+    if (!rs->table || !rs->history || !rs->decode_buffer || !rs->decode_planes) {
+        free_resampler(rs);
+        return NULL;
+    }
+    for (chan = 0; chan < rs->channels; chan++)
+        rs->decode_planes[chan] = rs->decode_buffer + chan*RESAMPLE_CHUNK;
+
+    /* row p is the filter for outputs p/phases after the center sample,
+     * Blackman windowed and scaled to the unity gain */
+    for (p = 0; p <= rs->phases; p++) {
+        float * row = rs->table + p*rs->taps;
+        double sum = 0;
+        for (k = 0; k < rs->taps; k++) {
+            double x = (k - (half-1)) - (double)p / rs->phases;
+            double w = x / half;
+            double h = cutoff;
+            if (x != 0)
+                h = sin(M_PI*cutoff*x) / (M_PI*x);
+            if (w <= -1.0 || w >= 1.0)
+                h = 0;
+            else
+                h *= 0.42 + 0.5*cos(M_PI*w) + 0.08*cos(2*M_PI*w);
+            row[k] = (float)h;
+            sum += h;
+        }
+        for (k = 0; k < rs->taps; k++)
+            row[k] = (float)(row[k] / sum);
+    }
+
+    vgmstream->resampler = rs;
+    flush_resampler(rs);
+    return rs;
+}
+
+/* Move the frames still needed to the start of the history and decode the
+ * next chunk after them. Streams without a loop are followed by silence. */
+static void refill_resampler(VGMSTREAM * vgmstream, resampler * rs) {
+    int32_t start = rs->center - rs->taps/2 + 1;
+    int32_t frames = RESAMPLE_CHUNK;
+    int32_t decoded = frames;
+    int32_t i;
+    int chan;
+
+    if (start > rs->used)
+        start = rs->used;
+    if (start > 0) {
+        for (chan = 0; chan < rs->channels; chan++) {
+            float * h = rs->history + chan*rs->capacity;
+            memmove(h,h+start,sizeof(float)*(rs->used-start));
+        }
+        rs->used -= start;
+        rs->center -= start;
+    }
+
+    if (!vgmstream->loop_flag && vgmstream->num_samples - vgmstream->current_sample < decoded)
+        decoded = vgmstream->num_samples - vgmstream->current_sample;
+    if (decoded < 0)
+        decoded = 0;
+    if (decoded > 0)
+        render_vgmstream_planar(rs->decode_planes,decoded,vgmstream);
+
+    for (chan = 0; chan < rs->channels; chan++) {
+        float * h = rs->history + chan*rs->capacity + rs->used;
+        const sample * in = rs->decode_planes[chan];
+        for (i = 0; i < decoded; i++)
+            h[i] = in[i] * (1.0f/32768.0f);
+        for (; i < frames; i++)
+            h[i] = 0;
+    }
+    rs->used += frames;
+}
+
+/* The output goes to buffers[chan] if there are buffers, else interleaved
+ * into buffer */
+static void render_vgmstream_float_internal(float * buffer, float ** buffers, int32_t sample_count, int32_t output_rate, VGMSTREAM * vgmstream) {
+    const int channels = vgmstream->channels;
+    const int spacing = buffers ? 1 : channels;
+    resampler * rs = NULL;
+    int32_t i;
+    int chan;
+
+    if (output_rate > 0 && output_rate != vgmstream->sample_rate)
+        rs = get_resampler(vgmstream, output_rate);
+
+    if (!rs) {
+        /* same rate (or no memory for the filter): just convert */
+        sample stack_chunk[PLANAR_CHUNK_SAMPLES];
+        sample * chunk = stack_chunk;
+        int32_t chunk_samples = PLANAR_CHUNK_SAMPLES / channels;
+        int32_t samples_written = 0;
+
+        /* with more channels than that, one frame at a time on the heap */
+        if (chunk_samples < 1) {
+            chunk_samples = 1;
+            chunk = malloc(sizeof(sample)*channels);
+            if (!chunk) {
+                for (chan = 0; chan < channels; chan++) {
+                    float * out = buffers ? buffers[chan] : buffer + chan;
+                    for (i = 0; i < sample_count; i++)
+                        out[i*spacing] = 0.0f;
+                }
+                return;
+            }
+        }
+
+        while (samples_written < sample_count) {
+            int32_t samples_to_do = sample_count - samples_written;
+            if (samples_to_do > chunk_samples)
+                samples_to_do = chunk_samples;
+
+            render_vgmstream(chunk,samples_to_do,vgmstream);
+            for (chan = 0; chan < channels; chan++) {
+                float * out = (buffers ? buffers[chan] : buffer + chan) + samples_written*spacing;
+                for (i = 0; i < samples_to_do; i++)
+                    out[i*spacing] = chunk[i*channels+chan] * (1.0f/32768.0f);
+            }
+            samples_written += samples_to_do;
+        }
+
+        if (chunk != stack_chunk)
+            free(chunk);
+        return;
+    }
+
+    for (i = 0; i < sample_count; i++) {
+        const float * row;
+        int32_t first;
+
+        while (rs->center + rs->taps/2 >= rs->used)
+            refill_resampler(vgmstream, rs);
+
+        if (rs->phases == rs->up)
+            row = rs->table + rs->phase*rs->taps;
+        else
+            row = rs->table + (int32_t)(((int64_t)rs->phase*rs->phases + rs->up/2) / rs->up)*rs->taps;
+        first = rs->center - rs->taps/2 + 1;
+
+        for (chan = 0; chan < channels; chan++) {
+            const float * h = rs->history + chan*rs->capacity + first;
+            float acc0 = 0, acc1 = 0, acc2 = 0, acc3 = 0;
+            int k;
+            /* taps is a multiple of 4 */
+            for (k = 0; k < rs->taps; k += 4) {
+                acc0 += h[k+0] * row[k+0];
+                acc1 += h[k+1] * row[k+1];
+                acc2 += h[k+2] * row[k+2];
+                acc3 += h[k+3] * row[k+3];
+            }
+            if (buffers)
+                buffers[chan][i] = (acc0 + acc1) + (acc2 + acc3);
+            else
+                buffer[i*channels+chan] = (acc0 + acc1) + (acc2 + acc3);
+        }
+
+        rs->phase += rs->down;
+        rs->center += rs->phase / rs->up;
+        rs->phase %= rs->up;
+    }
+}
+
+void render_vgmstream_float(float * buffer, int32_t sample_count, int32_t output_rate, VGMSTREAM * vgmstream) {
+    render_vgmstream_float_internal(buffer,NULL,sample_count,output_rate,vgmstream);
+}
+
+void render_vgmstream_float_planar(float ** buffers, int32_t sample_count, int32_t output_rate, VGMSTREAM * vgmstream) {
+    render_vgmstream_float_internal(NULL,buffers,sample_count,output_rate,vgmstream);
+}
+
 int get_vgmstream_samples_per_frame(VGMSTREAM * vgmstream) {
     switch (vgmstream->coding_type) {
         case coding_CRI_ADX:
@@ -1162,13 +1860,22 @@ int get_vgmstream_shortframe_size(VGMSTREAM * vgmstream) {
     }
 }
 
+/* Where the samples of a channel go: the channel's own buffer while
+ * render_vgmstream_planar runs, else its slot in the interleaved buffer */
+static sample * channel_buffer(VGMSTREAM * vgmstream, sample * buffer, int samples_written, int chan) {
+    if (vgmstream->planar_buffers)
+        return vgmstream->planar_buffers[chan]+samples_written;
+    return buffer+samples_written*vgmstream->channels+chan;
+}
+
 void decode_vgmstream_mem(VGMSTREAM * vgmstream, int samples_written, int samples_to_do, sample * buffer, uint8_t * data, int channel) {
+    int spacing = vgmstream->planar_buffers ? 1 : vgmstream->channels;
 
     switch (vgmstream->coding_type) {
         case coding_NGC_DSP:
             decode_ngc_dsp_mem(&vgmstream->ch[channel],
-                    buffer+samples_written*vgmstream->channels+channel,
-                    vgmstream->channels,vgmstream->samples_into_block,
+                    channel_buffer(vgmstream,buffer,samples_written,channel),
+                    spacing,vgmstream->samples_into_block,
                     samples_to_do, data);
             break;
         default:
@@ -1176,235 +1883,239 @@ void decode_vgmstream_mem(VGMSTREAM * vgmstream, int samples_written, int sample
     }
 }
 
-void decode_vgmstream(VGMSTREAM * vgmstream, int samples_written, int samples_to_do, sample * buffer) {
+/* Decode channels first_chan to last_chan-1. Codecs that decode all the
+ * channels at once ignore them, they are only given all the channels. */
+static void decode_vgmstream_channels(VGMSTREAM * vgmstream, int samples_written, int samples_to_do, sample * buffer, int first_chan, int last_chan) {
     int chan;
+    /* only codecs listed in planar_decode_supported may see spacing 1 */
+    int spacing = vgmstream->planar_buffers ? 1 : vgmstream->channels;
 
     switch (vgmstream->coding_type) {
         case coding_CRI_ADX:
-            for (chan=0;chan<vgmstream->channels;chan++) {
-                decode_adx(&vgmstream->ch[chan],buffer+samples_written*vgmstream->channels+chan,
-                        vgmstream->channels,vgmstream->samples_into_block,
+            for (chan=first_chan;chan<last_chan;chan++) {
+                decode_adx(&vgmstream->ch[chan],channel_buffer(vgmstream,buffer,samples_written,chan),
+                        spacing,vgmstream->samples_into_block,
                         samples_to_do);
             }
 
             break;
         case coding_CRI_ADX_enc_8:
         case coding_CRI_ADX_enc_9:
-            for (chan=0;chan<vgmstream->channels;chan++) {
-                decode_adx_enc(&vgmstream->ch[chan],buffer+samples_written*vgmstream->channels+chan,
-                        vgmstream->channels,vgmstream->samples_into_block,
+            for (chan=first_chan;chan<last_chan;chan++) {
+                decode_adx_enc(&vgmstream->ch[chan],channel_buffer(vgmstream,buffer,samples_written,chan),
+                        spacing,vgmstream->samples_into_block,
                         samples_to_do);
             }
 
             break;
         case coding_NGC_DSP:
-            for (chan=0;chan<vgmstream->channels;chan++) {
-                decode_ngc_dsp(&vgmstream->ch[chan],buffer+samples_written*vgmstream->channels+chan,
-                        vgmstream->channels,vgmstream->samples_into_block,
+            for (chan=first_chan;chan<last_chan;chan++) {
+                decode_ngc_dsp(&vgmstream->ch[chan],channel_buffer(vgmstream,buffer,samples_written,chan),
+                        spacing,vgmstream->samples_into_block,
                         samples_to_do);
             }
             break;
         case coding_PCM16LE:
-            for (chan=0;chan<vgmstream->channels;chan++) {
-                decode_pcm16LE(&vgmstream->ch[chan],buffer+samples_written*vgmstream->channels+chan,
-                        vgmstream->channels,vgmstream->samples_into_block,
+            for (chan=first_chan;chan<last_chan;chan++) {
+                decode_pcm16LE(&vgmstream->ch[chan],channel_buffer(vgmstream,buffer,samples_written,chan),
+                        spacing,vgmstream->samples_into_block,
                         samples_to_do);
             }
             break;
         case coding_PCM16LE_int:
-            for (chan=0;chan<vgmstream->channels;chan++) {
+            for (chan=first_chan;chan<last_chan;chan++) {
                 decode_pcm16LE_int(&vgmstream->ch[chan],buffer+samples_written*vgmstream->channels+chan,
                         vgmstream->channels,vgmstream->samples_into_block,
                         samples_to_do);
             }
             break;
         case coding_PCM16LE_XOR_int:
-            for (chan=0;chan<vgmstream->channels;chan++) {
+            for (chan=first_chan;chan<last_chan;chan++) {
                 decode_pcm16LE_XOR_int(&vgmstream->ch[chan],buffer+samples_written*vgmstream->channels+chan,
                         vgmstream->channels,vgmstream->samples_into_block,
                         samples_to_do);
             }
             break;
         case coding_PCM16BE:
-            for (chan=0;chan<vgmstream->channels;chan++) {
-                decode_pcm16BE(&vgmstream->ch[chan],buffer+samples_written*vgmstream->channels+chan,
-                        vgmstream->channels,vgmstream->samples_into_block,
+            for (chan=first_chan;chan<last_chan;chan++) {
+                decode_pcm16BE(&vgmstream->ch[chan],channel_buffer(vgmstream,buffer,samples_written,chan),
+                        spacing,vgmstream->samples_into_block,
                         samples_to_do);
             }
             break;
         case coding_PCM8:
-            for (chan=0;chan<vgmstream->channels;chan++) {
-                decode_pcm8(&vgmstream->ch[chan],buffer+samples_written*vgmstream->channels+chan,
-                        vgmstream->channels,vgmstream->samples_into_block,
+            for (chan=first_chan;chan<last_chan;chan++) {
+                decode_pcm8(&vgmstream->ch[chan],channel_buffer(vgmstream,buffer,samples_written,chan),
+                        spacing,vgmstream->samples_into_block,
                         samples_to_do);
             }
             break;
         case coding_PCM8_U:
-            for (chan=0;chan<vgmstream->channels;chan++) {
-                decode_pcm8_unsigned(&vgmstream->ch[chan],buffer+samples_written*vgmstream->channels+chan,
-                        vgmstream->channels,vgmstream->samples_into_block,
+            for (chan=first_chan;chan<last_chan;chan++) {
+                decode_pcm8_unsigned(&vgmstream->ch[chan],channel_buffer(vgmstream,buffer,samples_written,chan),
+                        spacing,vgmstream->samples_into_block,
                         samples_to_do);
             }
             break;
         case coding_PCM8_int:
-            for (chan=0;chan<vgmstream->channels;chan++) {
+            for (chan=first_chan;chan<last_chan;chan++) {
                 decode_pcm8_int(&vgmstream->ch[chan],buffer+samples_written*vgmstream->channels+chan,
                         vgmstream->channels,vgmstream->samples_into_block,
                         samples_to_do);
             }
             break;
         case coding_PCM8_SB_int:
-            for (chan=0;chan<vgmstream->channels;chan++) {
+            for (chan=first_chan;chan<last_chan;chan++) {
                 decode_pcm8_sb_int(&vgmstream->ch[chan],buffer+samples_written*vgmstream->channels+chan,
                         vgmstream->channels,vgmstream->samples_into_block,
                         samples_to_do);
             }
             break;
         case coding_PCM8_U_int:
-            for (chan=0;chan<vgmstream->channels;chan++) {
+            for (chan=first_chan;chan<last_chan;chan++) {
                 decode_pcm8_unsigned_int(&vgmstream->ch[chan],buffer+samples_written*vgmstream->channels+chan,
                         vgmstream->channels,vgmstream->samples_into_block,
                         samples_to_do);
             }
             break;
         case coding_NDS_IMA:
-            for (chan=0;chan<vgmstream->channels;chan++) {
-                decode_nds_ima(&vgmstream->ch[chan],buffer+samples_written*vgmstream->channels+chan,
-                        vgmstream->channels,vgmstream->samples_into_block,
+            for (chan=first_chan;chan<last_chan;chan++) {
+                decode_nds_ima(&vgmstream->ch[chan],channel_buffer(vgmstream,buffer,samples_written,chan),
+                        spacing,vgmstream->samples_into_block,
                         samples_to_do);
             }
             break;
         case coding_DAT4_IMA:
-            for (chan=0;chan<vgmstream->channels;chan++) {
-                decode_dat4_ima(&vgmstream->ch[chan],buffer+samples_written*vgmstream->channels+chan,
-                        vgmstream->channels,vgmstream->samples_into_block,
+            for (chan=first_chan;chan<last_chan;chan++) {
+                decode_dat4_ima(&vgmstream->ch[chan],channel_buffer(vgmstream,buffer,samples_written,chan),
+                        spacing,vgmstream->samples_into_block,
                         samples_to_do);
             }
             break;
         case coding_XBOX:
-            for (chan=0;chan<vgmstream->channels;chan++) {
+            for (chan=first_chan;chan<last_chan;chan++) {
                 decode_xbox_ima(vgmstream,&vgmstream->ch[chan],buffer+samples_written*vgmstream->channels+chan,
                         vgmstream->channels,vgmstream->samples_into_block,
                         samples_to_do,chan);
             }
             break;
         case coding_INT_XBOX:
-            for (chan=0;chan<vgmstream->channels;chan++) {
+            for (chan=first_chan;chan<last_chan;chan++) {
                 decode_int_xbox_ima(vgmstream,&vgmstream->ch[chan],buffer+samples_written*vgmstream->channels+chan,
                         vgmstream->channels,vgmstream->samples_into_block,
                         samples_to_do,chan);
             }
             break;
         case coding_MS_IMA:
-            for (chan=0;chan<vgmstream->channels;chan++) {
-                decode_ms_ima(vgmstream,&vgmstream->ch[chan],buffer+samples_written*vgmstream->channels+chan,
-                        vgmstream->channels,vgmstream->samples_into_block,
+            for (chan=first_chan;chan<last_chan;chan++) {
+                decode_ms_ima(vgmstream,&vgmstream->ch[chan],channel_buffer(vgmstream,buffer,samples_written,chan),
+                        spacing,vgmstream->samples_into_block,
                         samples_to_do,chan);
             }
             break;
         case coding_RAD_IMA:
-            for (chan=0;chan<vgmstream->channels;chan++) {
-                decode_rad_ima(vgmstream,&vgmstream->ch[chan],buffer+samples_written*vgmstream->channels+chan,
-                        vgmstream->channels,vgmstream->samples_into_block,
+            for (chan=first_chan;chan<last_chan;chan++) {
+                decode_rad_ima(vgmstream,&vgmstream->ch[chan],channel_buffer(vgmstream,buffer,samples_written,chan),
+                        spacing,vgmstream->samples_into_block,
                         samples_to_do,chan);
             }
             break;
         case coding_RAD_IMA_mono:
-            for (chan=0;chan<vgmstream->channels;chan++) {
-                decode_rad_ima_mono(&vgmstream->ch[chan],buffer+samples_written*vgmstream->channels+chan,
-                        vgmstream->channels,vgmstream->samples_into_block,
+            for (chan=first_chan;chan<last_chan;chan++) {
+                decode_rad_ima_mono(&vgmstream->ch[chan],channel_buffer(vgmstream,buffer,samples_written,chan),
+                        spacing,vgmstream->samples_into_block,
                         samples_to_do);
             }
             break;
         case coding_NGC_DTK:
-            for (chan=0;chan<vgmstream->channels;chan++) {
-                decode_ngc_dtk(&vgmstream->ch[chan],buffer+samples_written*vgmstream->channels+chan,
-                        vgmstream->channels,vgmstream->samples_into_block,
+            for (chan=first_chan;chan<last_chan;chan++) {
+                decode_ngc_dtk(&vgmstream->ch[chan],channel_buffer(vgmstream,buffer,samples_written,chan),
+                        spacing,vgmstream->samples_into_block,
                         samples_to_do,chan);
             }
             break;
         case coding_G721:
-            for (chan=0;chan<vgmstream->channels;chan++) {
-                decode_g721(&vgmstream->ch[chan],buffer+samples_written*vgmstream->channels+chan,
-                        vgmstream->channels,vgmstream->samples_into_block,
+            for (chan=first_chan;chan<last_chan;chan++) {
+                decode_g721(&vgmstream->ch[chan],channel_buffer(vgmstream,buffer,samples_written,chan),
+                        spacing,vgmstream->samples_into_block,
                         samples_to_do);
             }
             break;
         case coding_NGC_AFC:
-            for (chan=0;chan<vgmstream->channels;chan++) {
-                decode_ngc_afc(&vgmstream->ch[chan],buffer+samples_written*vgmstream->channels+chan,
-                        vgmstream->channels,vgmstream->samples_into_block,
+            for (chan=first_chan;chan<last_chan;chan++) {
+                decode_ngc_afc(&vgmstream->ch[chan],channel_buffer(vgmstream,buffer,samples_written,chan),
+                        spacing,vgmstream->samples_into_block,
                         samples_to_do);
             }
             break;
         case coding_PSX:
-            for (chan=0;chan<vgmstream->channels;chan++) {
+            for (chan=first_chan;chan<last_chan;chan++) {
 				if(vgmstream->skip_last_channel) 
 				{
 					if(chan!=vgmstream->channels-1) {
-						decode_psx(&vgmstream->ch[chan],buffer+samples_written*vgmstream->channels+chan,
-							vgmstream->channels,vgmstream->samples_into_block,
+						decode_psx(&vgmstream->ch[chan],channel_buffer(vgmstream,buffer,samples_written,chan),
+							spacing,vgmstream->samples_into_block,
 							samples_to_do);
 					}
 
 				} else {
-					decode_psx(&vgmstream->ch[chan],buffer+samples_written*vgmstream->channels+chan,
-                        vgmstream->channels,vgmstream->samples_into_block,
+					decode_psx(&vgmstream->ch[chan],channel_buffer(vgmstream,buffer,samples_written,chan),
+                        spacing,vgmstream->samples_into_block,
                         samples_to_do);
 				}
             }
             break;
         case coding_PSX_badflags:
-            for (chan=0;chan<vgmstream->channels;chan++) {
-                decode_psx_badflags(&vgmstream->ch[chan],buffer+samples_written*vgmstream->channels+chan,
-                        vgmstream->channels,vgmstream->samples_into_block,
+            for (chan=first_chan;chan<last_chan;chan++) {
+                decode_psx_badflags(&vgmstream->ch[chan],channel_buffer(vgmstream,buffer,samples_written,chan),
+                        spacing,vgmstream->samples_into_block,
                         samples_to_do);
             }
             break;
         case coding_invert_PSX:
-            for (chan=0;chan<vgmstream->channels;chan++) {
-                decode_invert_psx(&vgmstream->ch[chan],buffer+samples_written*vgmstream->channels+chan,
-                        vgmstream->channels,vgmstream->samples_into_block,
+            for (chan=first_chan;chan<last_chan;chan++) {
+                decode_invert_psx(&vgmstream->ch[chan],channel_buffer(vgmstream,buffer,samples_written,chan),
+                        spacing,vgmstream->samples_into_block,
                         samples_to_do);
             }
             break;
         case coding_FFXI:
-            for (chan=0;chan<vgmstream->channels;chan++) {
-                decode_ffxi_adpcm(&vgmstream->ch[chan],buffer+samples_written*vgmstream->channels+chan,
-                        vgmstream->channels,vgmstream->samples_into_block,
+            for (chan=first_chan;chan<last_chan;chan++) {
+                decode_ffxi_adpcm(&vgmstream->ch[chan],channel_buffer(vgmstream,buffer,samples_written,chan),
+                        spacing,vgmstream->samples_into_block,
                         samples_to_do);
             }
             break;
         case coding_BAF_ADPCM:
-            for (chan=0;chan<vgmstream->channels;chan++) {
-                decode_baf_adpcm(&vgmstream->ch[chan],buffer+samples_written*vgmstream->channels+chan,
-                        vgmstream->channels,vgmstream->samples_into_block,
+            for (chan=first_chan;chan<last_chan;chan++) {
+                decode_baf_adpcm(&vgmstream->ch[chan],channel_buffer(vgmstream,buffer,samples_written,chan),
+                        spacing,vgmstream->samples_into_block,
                         samples_to_do);
             }
             break;
         case coding_XA:
-            for (chan=0;chan<vgmstream->channels;chan++) {
+            for (chan=first_chan;chan<last_chan;chan++) {
                 decode_xa(vgmstream,buffer+samples_written*vgmstream->channels+chan,
                         vgmstream->channels,vgmstream->samples_into_block,
                         samples_to_do,chan);
             }
             break;
         case coding_EAXA:
-            for (chan=0;chan<vgmstream->channels;chan++) {
-                decode_eaxa(&vgmstream->ch[chan],buffer+samples_written*vgmstream->channels+chan,
-                        vgmstream->channels,vgmstream->samples_into_block,
+            for (chan=first_chan;chan<last_chan;chan++) {
+                decode_eaxa(&vgmstream->ch[chan],channel_buffer(vgmstream,buffer,samples_written,chan),
+                        spacing,vgmstream->samples_into_block,
                         samples_to_do,chan);
             }
             break;
         case coding_EA_ADPCM:
-            for (chan=0;chan<vgmstream->channels;chan++) {
-                decode_ea_adpcm(vgmstream,buffer+samples_written*vgmstream->channels+chan,
-                        vgmstream->channels,vgmstream->samples_into_block,
+            for (chan=first_chan;chan<last_chan;chan++) {
+                decode_ea_adpcm(vgmstream,channel_buffer(vgmstream,buffer,samples_written,chan),
+                        spacing,vgmstream->samples_into_block,
                         samples_to_do,chan);
             }
             break;
         case coding_MAXIS_ADPCM:
-            for (chan=0;chan<vgmstream->channels;chan++) {
+            for (chan=first_chan;chan<last_chan;chan++) {
                 decode_maxis_adpcm(vgmstream,buffer+samples_written*vgmstream->channels+chan,
                         vgmstream->channels,vgmstream->samples_into_block,
                         samples_to_do,chan);
@@ -1430,28 +2141,28 @@ void decode_vgmstream(VGMSTREAM * vgmstream, int samples_written, int samples_to
 			break;
 #endif
         case coding_SDX2:
-            for (chan=0;chan<vgmstream->channels;chan++) {
-                decode_sdx2(&vgmstream->ch[chan],buffer+samples_written*vgmstream->channels+chan,
-                        vgmstream->channels,vgmstream->samples_into_block,
+            for (chan=first_chan;chan<last_chan;chan++) {
+                decode_sdx2(&vgmstream->ch[chan],channel_buffer(vgmstream,buffer,samples_written,chan),
+                        spacing,vgmstream->samples_into_block,
                         samples_to_do);
             }
             break;
         case coding_SDX2_int:
-            for (chan=0;chan<vgmstream->channels;chan++) {
+            for (chan=first_chan;chan<last_chan;chan++) {
                 decode_sdx2_int(&vgmstream->ch[chan],buffer+samples_written*vgmstream->channels+chan,
                         vgmstream->channels,vgmstream->samples_into_block,
                         samples_to_do);
             }
             break;
         case coding_CBD2:
-            for (chan=0;chan<vgmstream->channels;chan++) {
-                decode_cbd2(&vgmstream->ch[chan],buffer+samples_written*vgmstream->channels+chan,
-                        vgmstream->channels,vgmstream->samples_into_block,
+            for (chan=first_chan;chan<last_chan;chan++) {
+                decode_cbd2(&vgmstream->ch[chan],channel_buffer(vgmstream,buffer,samples_written,chan),
+                        spacing,vgmstream->samples_into_block,
                         samples_to_do);
             }
             break;
         case coding_CBD2_int:
-            for (chan=0;chan<vgmstream->channels;chan++) {
+            for (chan=first_chan;chan<last_chan;chan++) {
                 decode_cbd2_int(&vgmstream->ch[chan],buffer+samples_written*vgmstream->channels+chan,
                         vgmstream->channels,vgmstream->samples_into_block,
                         samples_to_do);
@@ -1459,14 +2170,14 @@ void decode_vgmstream(VGMSTREAM * vgmstream, int samples_written, int samples_to
             break;
         case coding_DVI_IMA:
         case coding_INT_DVI_IMA:
-            for (chan=0;chan<vgmstream->channels;chan++) {
-                decode_dvi_ima(&vgmstream->ch[chan],buffer+samples_written*vgmstream->channels+chan,
-                        vgmstream->channels,vgmstream->samples_into_block,
+            for (chan=first_chan;chan<last_chan;chan++) {
+                decode_dvi_ima(&vgmstream->ch[chan],channel_buffer(vgmstream,buffer,samples_written,chan),
+                        spacing,vgmstream->samples_into_block,
                         samples_to_do);
             }
             break;
         case coding_EACS_IMA:
-            for (chan=0;chan<vgmstream->channels;chan++) {
+            for (chan=first_chan;chan<last_chan;chan++) {
                 decode_eacs_ima(vgmstream,buffer+samples_written*vgmstream->channels+chan,
                         vgmstream->channels,vgmstream->samples_into_block,
                         samples_to_do,chan);
@@ -1474,30 +2185,30 @@ void decode_vgmstream(VGMSTREAM * vgmstream, int samples_written, int samples_to
             break;
         case coding_IMA:
         case coding_INT_IMA:
-            for (chan=0;chan<vgmstream->channels;chan++) {
-                decode_ima(&vgmstream->ch[chan],buffer+samples_written*vgmstream->channels+chan,
-                        vgmstream->channels,vgmstream->samples_into_block,
+            for (chan=first_chan;chan<last_chan;chan++) {
+                decode_ima(&vgmstream->ch[chan],channel_buffer(vgmstream,buffer,samples_written,chan),
+                        spacing,vgmstream->samples_into_block,
                         samples_to_do);
             }
             break;
         case coding_APPLE_IMA4:
-            for (chan=0;chan<vgmstream->channels;chan++) {
-                decode_apple_ima4(&vgmstream->ch[chan],buffer+samples_written*vgmstream->channels+chan,
-                        vgmstream->channels,vgmstream->samples_into_block,
+            for (chan=first_chan;chan<last_chan;chan++) {
+                decode_apple_ima4(&vgmstream->ch[chan],channel_buffer(vgmstream,buffer,samples_written,chan),
+                        spacing,vgmstream->samples_into_block,
                         samples_to_do);
             }
             break;
         case coding_SNDS_IMA:
-            for (chan=0;chan<vgmstream->channels;chan++) {
-                decode_snds_ima(&vgmstream->ch[chan],buffer+samples_written*vgmstream->channels+chan,
-                        vgmstream->channels,vgmstream->samples_into_block,
+            for (chan=first_chan;chan<last_chan;chan++) {
+                decode_snds_ima(&vgmstream->ch[chan],channel_buffer(vgmstream,buffer,samples_written,chan),
+                        spacing,vgmstream->samples_into_block,
                         samples_to_do,chan);
             }
             break;
         case coding_WS:
-            for (chan=0;chan<vgmstream->channels;chan++) {
-                decode_ws(vgmstream,chan,buffer+samples_written*vgmstream->channels+chan,
-                        vgmstream->channels,vgmstream->samples_into_block,
+            for (chan=first_chan;chan<last_chan;chan++) {
+                decode_ws(vgmstream,chan,channel_buffer(vgmstream,buffer,samples_written,chan),
+                        spacing,vgmstream->samples_into_block,
                         samples_to_do);
             }
             break;
@@ -1527,10 +2238,10 @@ void decode_vgmstream(VGMSTREAM * vgmstream, int samples_written, int samples_to
 #ifdef VGM_USE_G7221
         case coding_G7221:
         case coding_G7221C:
-            for (chan=0;chan<vgmstream->channels;chan++) {
+            for (chan=first_chan;chan<last_chan;chan++) {
                 decode_g7221(vgmstream,
-                    buffer+samples_written*vgmstream->channels+chan,
-                    vgmstream->channels,
+                    channel_buffer(vgmstream,buffer,samples_written,chan),
+                    spacing,
                     samples_to_do,
                     chan);
             }
@@ -1538,10 +2249,10 @@ void decode_vgmstream(VGMSTREAM * vgmstream, int samples_written, int samples_to
 #endif
 #ifdef VGM_USE_G719
         case coding_G719:
-            for (chan=0;chan<vgmstream->channels;chan++) {
+            for (chan=first_chan;chan<last_chan;chan++) {
                 decode_g719(vgmstream,
-                    buffer+samples_written*vgmstream->channels+chan,
-                    vgmstream->channels,
+                    channel_buffer(vgmstream,buffer,samples_written,chan),
+                    spacing,
                     samples_to_do,
                     chan);
             }
@@ -1549,10 +2260,10 @@ void decode_vgmstream(VGMSTREAM * vgmstream, int samples_written, int samples_to
 #endif
 #ifdef VGM_USE_MAIATRAC3PLUS
 		case coding_AT3plus:
-			for (chan=0;chan<vgmstream->channels;chan++) {
+			for (chan=first_chan;chan<last_chan;chan++) {
 				decode_at3plus(vgmstream,
-					buffer+samples_written*vgmstream->channels+chan,
-					vgmstream->channels,
+					channel_buffer(vgmstream,buffer,samples_written,chan),
+					spacing,
 					samples_to_do,
 					chan);
 			}
@@ -1588,52 +2299,349 @@ void decode_vgmstream(VGMSTREAM * vgmstream, int samples_written, int samples_to
             }
             break;
         case coding_AICA:
-            for (chan=0;chan<vgmstream->channels;chan++) {
-                decode_aica(&vgmstream->ch[chan],buffer+samples_written*vgmstream->channels+chan,
-                        vgmstream->channels,vgmstream->samples_into_block,
+            for (chan=first_chan;chan<last_chan;chan++) {
+                decode_aica(&vgmstream->ch[chan],channel_buffer(vgmstream,buffer,samples_written,chan),
+                        spacing,vgmstream->samples_into_block,
                         samples_to_do);
             }
             break;
         case coding_NDS_PROCYON:
-            for (chan=0;chan<vgmstream->channels;chan++) {
-                decode_nds_procyon(&vgmstream->ch[chan],buffer+samples_written*vgmstream->channels+chan,
-                        vgmstream->channels,vgmstream->samples_into_block,
+            for (chan=first_chan;chan<last_chan;chan++) {
+                decode_nds_procyon(&vgmstream->ch[chan],channel_buffer(vgmstream,buffer,samples_written,chan),
+                        spacing,vgmstream->samples_into_block,
                         samples_to_do);
             }
             break;
         case coding_L5_555:
-            for (chan=0;chan<vgmstream->channels;chan++) {
-                decode_l5_555(&vgmstream->ch[chan],buffer+samples_written*vgmstream->channels+chan,
-                        vgmstream->channels,vgmstream->samples_into_block,
+            for (chan=first_chan;chan<last_chan;chan++) {
+                decode_l5_555(&vgmstream->ch[chan],channel_buffer(vgmstream,buffer,samples_written,chan),
+                        spacing,vgmstream->samples_into_block,
                         samples_to_do);
             }
 
             break;
         case coding_SASSC:
-            for (chan=0;chan<vgmstream->channels;chan++) {
-                decode_SASSC(&vgmstream->ch[chan],buffer+samples_written*vgmstream->channels+chan,
-                        vgmstream->channels,vgmstream->samples_into_block,
+            for (chan=first_chan;chan<last_chan;chan++) {
+                decode_SASSC(&vgmstream->ch[chan],channel_buffer(vgmstream,buffer,samples_written,chan),
+                        spacing,vgmstream->samples_into_block,
                         samples_to_do);
             }
 
             break;
         case coding_LSF:
-            for (chan=0;chan<vgmstream->channels;chan++) {
-                decode_lsf(&vgmstream->ch[chan],buffer+samples_written*vgmstream->channels+chan,
-                        vgmstream->channels,vgmstream->samples_into_block,
+            for (chan=first_chan;chan<last_chan;chan++) {
+                decode_lsf(&vgmstream->ch[chan],channel_buffer(vgmstream,buffer,samples_written,chan),
+                        spacing,vgmstream->samples_into_block,
                         samples_to_do);
             }
             break;
         case coding_MTAF:
-            for (chan=0;chan<vgmstream->channels;chan++) {
-                decode_mtaf(&vgmstream->ch[chan],buffer+samples_written*vgmstream->channels+chan,
-                        vgmstream->channels, vgmstream->samples_into_block, samples_to_do,
+            for (chan=first_chan;chan<last_chan;chan++) {
+                decode_mtaf(&vgmstream->ch[chan],channel_buffer(vgmstream,buffer,samples_written,chan),
+                        spacing, vgmstream->samples_into_block, samples_to_do,
                         chan, vgmstream->channels);
             }
             break;
     }
 }
 
+/* Decoding the channels of a block on worker threads. The caller's thread
+ * takes the first range of channels, each worker the next ones. Every
+ * channel writes only its own samples, so the output is the same as the
+ * serial one. */
+
+/* Samples per channel below which the block is decoded serially, waking
+ * the workers would cost more */
+#define DECODE_THREADS_MIN_SAMPLES 0x40
+#define DECODE_THREADS_MAX 16
+
+#ifdef _WIN32
+#include <windows.h>
+typedef HANDLE pool_thread;
+typedef SRWLOCK pool_mutex;
+typedef CONDITION_VARIABLE pool_cond;
+#define pool_mutex_init(m) InitializeSRWLock(m)
+#define pool_mutex_destroy(m)
+#define pool_lock(m) AcquireSRWLockExclusive(m)
+#define pool_unlock(m) ReleaseSRWLockExclusive(m)
+#define pool_cond_init(c) InitializeConditionVariable(c)
+#define pool_cond_destroy(c)
+#define pool_wait(c,m) SleepConditionVariableSRW(c,m,INFINITE,0)
+#define pool_broadcast(c) WakeAllConditionVariable(c)
+#else
+#include <pthread.h>
+typedef pthread_t pool_thread;
+typedef pthread_mutex_t pool_mutex;
+typedef pthread_cond_t pool_cond;
+#define pool_mutex_init(m) pthread_mutex_init(m,NULL)
+#define pool_mutex_destroy(m) pthread_mutex_destroy(m)
+#define pool_lock(m) pthread_mutex_lock(m)
+#define pool_unlock(m) pthread_mutex_unlock(m)
+#define pool_cond_init(c) pthread_cond_init(c,NULL)
+#define pool_cond_destroy(c) pthread_cond_destroy(c)
+#define pool_wait(c,m) pthread_cond_wait(c,m)
+#define pool_broadcast(c) pthread_cond_broadcast(c)
+#endif
+
+typedef struct decode_pool decode_pool;
+
+typedef struct {
+    decode_pool * pool;
+    int index;
+    pool_thread thread;
+} decode_worker;
+
+struct decode_pool {
+    VGMSTREAM * vgmstream;
+    int thread_count;           /* the caller's thread included */
+    int started;                /* workers running */
+    decode_worker workers[DECODE_THREADS_MAX];
+
+    pool_mutex mutex;
+    pool_cond work_cond;        /* a new block or quit */
+    pool_cond done_cond;        /* pending went to 0 */
+    unsigned generation;        /* blocks handed out so far */
+    int pending;                /* workers still decoding the block */
+    int quit;
+
+    /* the block being decoded */
+    int samples_written;
+    int samples_to_do;
+    sample * buffer;
+};
+
+/* Codecs reading and writing nothing but their own VGMSTREAMCHANNEL and
+ * output samples; anything taking the VGMSTREAM itself stays serial */
+static int channel_decode_supported(VGMSTREAM * vgmstream) {
+    switch (vgmstream->coding_type) {
+        case coding_CRI_ADX:
+        case coding_CRI_ADX_enc_8:
+        case coding_CRI_ADX_enc_9:
+        case coding_NGC_DSP:
+        case coding_PCM16LE:
+        case coding_PCM16LE_int:
+        case coding_PCM16LE_XOR_int:
+        case coding_PCM16BE:
+        case coding_PCM8:
+        case coding_PCM8_U:
+        case coding_PCM8_int:
+        case coding_PCM8_SB_int:
+        case coding_PCM8_U_int:
+        case coding_NDS_IMA:
+        case coding_DAT4_IMA:
+        case coding_RAD_IMA_mono:
+        case coding_NGC_DTK:
+        case coding_G721:
+        case coding_NGC_AFC:
+        case coding_PSX:
+        case coding_PSX_badflags:
+        case coding_invert_PSX:
+        case coding_FFXI:
+        case coding_BAF_ADPCM:
+        case coding_EAXA:
+        case coding_SDX2:
+        case coding_SDX2_int:
+        case coding_CBD2:
+        case coding_CBD2_int:
+        case coding_DVI_IMA:
+        case coding_INT_DVI_IMA:
+        case coding_IMA:
+        case coding_INT_IMA:
+        case coding_APPLE_IMA4:
+        case coding_SNDS_IMA:
+        case coding_AICA:
+        case coding_NDS_PROCYON:
+        case coding_L5_555:
+        case coding_SASSC:
+        case coding_LSF:
+        case coding_MTAF:
+            return 1;
+        default:
+            return 0;
+    }
+}
+
+static void decode_pool_range(decode_pool * pool, int index) {
+    VGMSTREAM * vgmstream = pool->vgmstream;
+    int first_chan = vgmstream->channels*index/pool->thread_count;
+    int last_chan = vgmstream->channels*(index+1)/pool->thread_count;
+
+    if (first_chan < last_chan)
+        decode_vgmstream_channels(vgmstream,pool->samples_written,pool->samples_to_do,pool->buffer,first_chan,last_chan);
+}
+
+#ifdef _WIN32
+static DWORD WINAPI decode_worker_main(LPVOID data) {
+#else
+static void * decode_worker_main(void * data) {
+#endif
+    decode_worker * worker = data;
+    decode_pool * pool = worker->pool;
+    unsigned generation = 0;
+
+    pool_lock(&pool->mutex);
+    for (;;) {
+        while (!pool->quit && pool->generation == generation)
+            pool_wait(&pool->work_cond,&pool->mutex);
+        if (pool->quit)
+            break;
+        generation = pool->generation;
+        pool_unlock(&pool->mutex);
+
+        decode_pool_range(pool,worker->index);
+
+        pool_lock(&pool->mutex);
+        if (--pool->pending == 0)
+            pool_broadcast(&pool->done_cond);
+    }
+    pool_unlock(&pool->mutex);
+    return 0;
+}
+
+static void free_decode_pool(void * data) {
+    decode_pool * pool = data;
+    int i;
+
+    if (!pool) return;
+
+    pool_lock(&pool->mutex);
+    pool->quit = 1;
+    pool_broadcast(&pool->work_cond);
+    pool_unlock(&pool->mutex);
+
+    for (i = 1; i < pool->started; i++) {
+#ifdef _WIN32
+        WaitForSingleObject(pool->workers[i].thread,INFINITE);
+        CloseHandle(pool->workers[i].thread);
+#else
+        pthread_join(pool->workers[i].thread,NULL);
+#endif
+    }
+
+    pool_cond_destroy(&pool->done_cond);
+    pool_cond_destroy(&pool->work_cond);
+    pool_mutex_destroy(&pool->mutex);
+    free(pool);
+}
+
+static decode_pool * new_decode_pool(VGMSTREAM * vgmstream, int thread_count) {
+    decode_pool * pool = calloc(1,sizeof(decode_pool));
+    int i;
+
+    if (!pool) return NULL;
+    pool->vgmstream = vgmstream;
+    pool_mutex_init(&pool->mutex);
+    pool_cond_init(&pool->work_cond);
+    pool_cond_init(&pool->done_cond);
+
+    pool->started = 1;
+    for (i = 1; i < thread_count; i++) {
+        decode_worker * worker = &pool->workers[i];
+        worker->pool = pool;
+        worker->index = i;
+#ifdef _WIN32
+        worker->thread = CreateThread(NULL,0,decode_worker_main,worker,0,NULL);
+        if (!worker->thread) break;
+#else
+        if (pthread_create(&worker->thread,NULL,decode_worker_main,worker) != 0) break;
+#endif
+        pool->started++;
+    }
+    pool->thread_count = pool->started;
+
+    if (pool->thread_count < 2) {
+        free_decode_pool(pool);
+        return NULL;
+    }
+    return pool;
+}
+
+/* Give every channel a STREAMFILE of its own, reopening the file for the
+ * channels that share one. Worker threads can't read through the same
+ * STREAMFILE at once. Returns 0 if a file can't be reopened, the channels
+ * opened so far keep their new files. */
+static int separate_channel_streamfiles(VGMSTREAM * vgmstream) {
+    seek_table * st = vgmstream->seek_table;
+    int chan, prev;
+
+    for (chan = 1; chan < vgmstream->channels; chan++) {
+        STREAMFILE * shared = vgmstream->ch[chan].streamfile;
+        STREAMFILE * own;
+        char filename[PATH_LIMIT];
+        int32_t i;
+
+        if (!shared) continue;
+        for (prev = 0; prev < chan; prev++) {
+            if (vgmstream->ch[prev].streamfile == shared)
+                break;
+        }
+        if (prev == chan) continue;
+
+        shared->get_name(shared,filename,sizeof(filename));
+        own = shared->open(shared,filename,STREAMFILE_DEFAULT_BUFFER_SIZE);
+        if (!own) return 0;
+
+        /* the saved copies of the channel come back on reset, loop and seek */
+        vgmstream->ch[chan].streamfile = own;
+        if (vgmstream->start_ch && vgmstream->start_ch[chan].streamfile == shared)
+            vgmstream->start_ch[chan].streamfile = own;
+        if (vgmstream->loop_ch && vgmstream->loop_ch[chan].streamfile == shared)
+            vgmstream->loop_ch[chan].streamfile = own;
+        if (st) {
+            for (i = 0; i < st->count; i++) {
+                if (st->ch[i*st->channels+chan].streamfile == shared)
+                    st->ch[i*st->channels+chan].streamfile = own;
+            }
+        }
+    }
+
+    return 1;
+}
+
+int set_vgmstream_decode_threads(VGMSTREAM * vgmstream, int thread_count) {
+    free_decode_pool(vgmstream->decode_pool);
+    vgmstream->decode_pool = NULL;
+
+    if (thread_count > vgmstream->channels)
+        thread_count = vgmstream->channels;
+    if (thread_count > DECODE_THREADS_MAX)
+        thread_count = DECODE_THREADS_MAX;
+    if (thread_count < 2 || !channel_decode_supported(vgmstream))
+        return 1;
+    if (!separate_channel_streamfiles(vgmstream))
+        return 1;
+
+    vgmstream->decode_pool = new_decode_pool(vgmstream,thread_count);
+    if (!vgmstream->decode_pool)
+        return 1;
+    return ((decode_pool *)vgmstream->decode_pool)->thread_count;
+}
+
+void decode_vgmstream(VGMSTREAM * vgmstream, int samples_written, int samples_to_do, sample * buffer) {
+    decode_pool * pool = vgmstream->decode_pool;
+
+    if (!pool || samples_to_do < DECODE_THREADS_MIN_SAMPLES) {
+        decode_vgmstream_channels(vgmstream,samples_written,samples_to_do,buffer,0,vgmstream->channels);
+        return;
+    }
+
+    pool_lock(&pool->mutex);
+    pool->samples_written = samples_written;
+    pool->samples_to_do = samples_to_do;
+    pool->buffer = buffer;
+    pool->pending = pool->thread_count-1;
+    pool->generation++;
+    pool_broadcast(&pool->work_cond);
+    pool_unlock(&pool->mutex);
+
+    decode_pool_range(pool,0);
+
+    pool_lock(&pool->mutex);
+    while (pool->pending > 0)
+        pool_wait(&pool->done_cond,&pool->mutex);
+    pool_unlock(&pool->mutex);
+}
+
 int vgmstream_samples_to_do(int samples_this_block, int samples_per_frame, VGMSTREAM * vgmstream) {
     int samples_to_do;
     int samples_left_this_block;
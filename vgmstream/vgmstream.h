@@ -711,6 +711,22 @@ typedef struct {
      * Note also that support must be added for resetting, looping and
      * closing for every codec that uses this, as it will not be handled. */
     void * codec_data;
+
+    /* Positions saved for seeking, built by seek_vgmstream as it goes.
+     * Kept over reset_vgmstream and looping. */
+    void * seek_table;
+
+    /* Output buffers of the channels while render_vgmstream_planar runs,
+     * NULL otherwise. See decode_vgmstream. */
+    sample ** planar_buffers;
+
+    /* Filter state of render_vgmstream_float, made on its first call with
+     * another output rate. Emptied by reset_vgmstream and seek_vgmstream. */
+    void * resampler;
+
+    /* Worker threads decoding the channels of a block together, NULL when
+     * decoding serially. See set_vgmstream_decode_threads. */
+    void * decode_pool;
 } VGMSTREAM;
 
 #ifdef VGM_USE_VORBIS
@@ -872,6 +888,25 @@ int32_t get_vgmstream_play_samples(double looptimes, double fadeseconds, double
 /* render! */
 void render_vgmstream(sample * buffer, int32_t sample_count, VGMSTREAM * vgmstream);
 
+/* render into one buffer per channel, buffers[chan] gets sample_count samples */
+void render_vgmstream_planar(sample ** buffers, int32_t sample_count, VGMSTREAM * vgmstream);
+
+/* render sample_count frames of float samples at output_rate (the stream's
+ * own rate if 0), resampling with a windowed-sinc filter on the way */
+void render_vgmstream_float(float * buffer, int32_t sample_count, int32_t output_rate, VGMSTREAM * vgmstream);
+
+/* the same, into one buffer per channel */
+void render_vgmstream_float_planar(float ** buffers, int32_t sample_count, int32_t output_rate, VGMSTREAM * vgmstream);
+
+/* seek to the given sample, counted from the start with the loops unrolled */
+void seek_vgmstream(VGMSTREAM * vgmstream, int32_t seek_sample);
+
+/* decode the channels of each block on up to thread_count threads (the
+ * calling one included), or serially with 1; the output doesn't change.
+ * Only codecs decoding each channel on its own use the threads, channels
+ * sharing a file get their own. Returns the count of threads used. */
+int set_vgmstream_decode_threads(VGMSTREAM * vgmstream, int thread_count);
+
 /* smallest self-contained group of samples is a frame */
 int get_vgmstream_samples_per_frame(VGMSTREAM * vgmstream);
 /* number of bytes per frame */